@@ -2,6 +2,7 @@
 #define ABM_H
 
 #include "abm_include.h"
+#include <numeric>
 
 /***************************************************** 
  * class: ABM
@@ -50,9 +51,38 @@ public:
 					dt(del_t), infection(del_t) 
 		{
 			time = 0.0;	
+#ifdef ABM_STEP_TIMES
+			step_length_hold = StepLengthHold(dt);
+#endif
 			load_infection_parameters(infile); 
 			load_age_dependent_distributions(dist_files);
 			load_testing(tfile);
+			set_default_interventions();
+			initialize_data_collection();
+		}
+
+	/**
+	 * \brief Creates an ABM object from a published population
+	 * \details Infection parameters, age-dependent distributions, and 
+	 *		testing are taken from the population segment instead of the 
+	 *		input files; places and agents are created with create_population 
+	 *
+	 * @param del_t - time step, days
+	 * @param segment - population published by a loader process
+	 */
+	ABM(double del_t, const PopulationSegment& segment) : dt(del_t), infection(del_t) 
+		{
+			time = 0.0;	
+#ifdef ABM_STEP_TIMES
+			step_length_hold = StepLengthHold(dt);
+#endif
+			infection_parameters = segment.get_infection_parameters();
+			set_infection_properties();
+			age_dependent_distributions = segment.get_age_dependent_distributions();
+			set_age_dependent_properties();
+			set_testing_properties();
+			testing.set_time_varying(segment.get_testing_changes());
+			set_default_interventions();
 			initialize_data_collection();
 		}
 
@@ -133,6 +163,64 @@ public:
 	 */	
 	void create_agents(const std::string filename, const int ninf0 = 0);
 
+	/**
+	 * \brief Create places and agents from a published population 
+	 * \details Same as creating the places and then the agents from 
+	 *		the input files that the segment was published from 
+	 * @param segment - population published by a loader process
+	 * @param ninf0 - number of initially infected - overwriting the published
+	 */
+	void create_population(const PopulationSegment& segment, const int ninf0 = 0);
+
+	/**
+	 * \brief Check the consistency of the agents before registering them
+	 * \details Applies to create_agents and create_population; all the
+	 *		inconsistencies are collected in one report, see input_validator.h,
+	 *		and std::invalid_argument with its summary is thrown if there are 
+	 *		any, before agents are created
+	 * @param validate - true to check the input
+	 * @param exec - executor of the checks, one task per chunk of agents;
+	 *		serial if empty
+	 */
+	void set_input_validation(const bool validate = true, 
+								const InputValidator::executor& exec = InputValidator::executor())
+		{ validate_input = validate; input_validator.set_executor(exec); }
+
+	/// Limits of the coordinates of agents and places checked by the input validation
+	void set_input_bounds(const double xmin, const double xmax, const double ymin, const double ymax)
+		{ input_validator.set_bounds(xmin, xmax, ymin, ymax); }
+
+	/// Report of the last input validation
+	const InputReport& get_input_report() const { return input_report; }
+
+	/**
+	 * \brief Executor of the registration of agents in places
+	 * \details Runs task(i) for i from 0 to n_tasks-1, e.g. on a thread 
+	 *		pool; one task per type of places. Serial if not set.
+	 */
+	void set_registration_executor(const std::function<void(int n_tasks, 
+										const std::function<void(int)>& task)>& exec)
+		{ run_registration = exec; }
+
+	/**
+	 * \brief Replace the interventions from the infection parameters with a timeline
+	 * \details Needs to be called after creation of the places; times need
+	 *		to be multiples of the time step (see interventions.h for the format) 
+	 * @param fname - name of the file with the interventions
+	 */
+	void load_interventions(const std::string fname);
+
+	/**
+	 * \brief Replace values of some of the infection parameters
+	 * \details Places, infection, testing, flu, and the default interventions
+	 *		are set up again from the new values without reading the input files;
+	 *		needs to be called before the first step. Initially infected agents 
+	 *		keep the properties they were created with. Throws std::invalid_argument
+	 *		if a name is not one of the infection parameters. 
+	 * @param new_values - parameter names and their new values
+	 */
+	void set_infection_parameters(const std::map<std::string, double>& new_values);
+
 	/// Set up vaccination of nv members of the random population members activated with testing
 	void set_random_vaccination(int nv) 
 		{ random_vaccines = true; n_vaccinated = nv;}
@@ -142,29 +230,121 @@ public:
 	void set_group_vaccination(std::string group_name, bool verbose = false) 
 		{ group_vaccines = true; vaccine_group_name = group_name; vac_verbose = verbose; } 
 
+	/**
+	 * \brief Vaccinate daily following a campaign
+	 * \details Doses are given at every step of the campaign phases, 
+	 *		independently of the start of testing; see vaccination_campaign.h.
+	 *		Random seed of the campaign is set by set_random_seed called 
+	 *		after this function.
+	 * @param new_campaign - groups and phases of the campaign
+	 */
+	void set_vaccination_campaign(const VaccinationCampaign& new_campaign) 
+		{ campaign = new_campaign; with_campaign = true; }
+
+	/**
+	 * \brief Draw infections of susceptible agents in one batch 
+	 * \details Lambdas of all susceptible agents without flu are collected
+	 *		at the beginning of the state transitions and infections are 
+	 *		sampled at once; agents with flu are still processed one at a time 
+	 * @param batched - true to enable the batched draws
+	 */
+	void set_batched_infection_draws(const bool batched = true) 
+		{ batched_infection_draws = batched; }
+
+	/**
+	 * \brief Sample infections of susceptible agents starting from places
+	 * \details Only places with nonzero infection contribution are visited
+	 *		and their exposed members are drawn with geometric skipping; 
+	 *		agents exposed in several places are infected once. Agents with 
+	 *		flu are still processed one at a time. Takes precedence over
+	 *		the batched infection draws.
+	 * @param by_place - true to enable the place-centric sampling
+	 */
+	void set_place_infection_sampling(const bool by_place = true);
+
+	/**
+	 * \brief Add community transmission that decays with distance
+	 * \details Contribution of infectious agents nearby is added to
+	 *		the infection probability of each susceptible agent, see
+	 *		spatial_transmission.h. Cannot be combined with the 
+	 *		place-centric sampling, distributed runs, or continuous time.
+	 * @param rate - transmission rate
+	 * @param scale - distance scale of the kernel, in units of the coordinates
+	 * @param exponent - exponent of the kernel
+	 * @param cutoff - kernel is summed exactly within this distance
+	 * @param far_field - true to approximate the contributions beyond the cutoff
+	 */
+	void set_spatial_transmission(const double rate, const double scale, const double exponent,
+									const double cutoff, const bool far_field = false);
+
+	/// Executor of the spatial transmission, one task per grid cell, e.g. a thread pool
+	void set_spatial_executor(const SpatialTransmission::executor& exec) { spatial.set_executor(exec); }
+
+	/**
+	 * \brief Restart all random number generators of the model
+	 * \details Seeds of the individual generators are derived from seed 
+	 * @param seed - seed of the whole model 
+	 */
+	void set_random_seed(const unsigned seed);
+
+	/**
+	 * \brief Restrict the simulation to a subset of agents
+	 * \details Used in distributed runs; only the selected agents are
+	 *		processed, contribute to places, and are counted by the getters.
+	 *		States of other agents are not updated in this object.
+	 * @param local_flags - one entry per agent in ID order, true if processed here
+	 */
+	void set_local_agents(const std::vector<bool>& local_flags);
+
+	/**
+	 * \brief Reorder agents and places to improve memory locality
+	 * \details Places of each type are ordered along a Hilbert curve
+	 *		over their coordinates, agents by their household or
+	 *		retirement home and then by the place they attend during
+	 *		the day. All IDs are changed to the new order; printed 
+	 *		outputs still use the IDs from the input files. Needs to
+	 *		be called after creation of all places and agents and
+	 *		before the simulation starts.
+	 */
+	void reorder_for_locality();
+
 	//
 	// Transmission of infection
 	//
 
 	/**
 	 * \brief Transmit infection according to Infection model
+	 * \details Code of the features disabled in Features is removed
+	 *		at compile time; the default are the features of the build 
+	 *		(see model_features.h) 
 	 */
+	template <typename Features = BuildFeatures>
 	void transmit_infection();
 
 	/// \brief Count contributions of all infectious agents in each place 
 	void compute_place_contributions();
 
+	/// \brief Add contributions of infectious agents to sums in their places 
+	template <typename Features = BuildFeatures>
+	void accumulate_place_contributions();
+
+	/// \brief Compute infection contributions of all places from the accumulated sums 
+	void finalize_place_contributions()
+		{ contributions.total_place_contributions(households, schools, workplaces, hospitals, retirement_homes); }
+
 	/// \brief Propagate infection and determine state transitions
+	template <typename Features = BuildFeatures>
 	void compute_state_transitions();
 
 	/// \brief Set the lambda factors to 0.0
 	void reset_contributions()
 		{ contributions.reset_sums(households, schools, workplaces, hospitals, retirement_homes); }
 
-	// Increasing time
-	void advance_in_time() { time += dt; }
+	// Increasing time, temporaries of the step are released
+	void advance_in_time() { time = (++n_steps)*dt; scratch.reset(); }
 
 	/// Verify if anything that requires parameter changes happens at this step 
+	template <typename Features = BuildFeatures>
 	void check_events(std::vector<School>&, std::vector<Workplace>&);
 
 	//
@@ -180,6 +360,18 @@ public:
 	std::vector<int> get_treatment_data() const;
 	/// Current simulation time
 	double get_time() const { return time; }
+	/// Time step
+	double get_time_step() const { return dt; }
+	/// True if the model has spatial transmission
+	bool uses_spatial_transmission() const { return spatial_transmission; }
+	/// Number of interventions so far that changed transmission in places
+	int get_number_of_place_changes() const { return n_place_changes; }
+
+	/// ID of an agent in the input file, same as agent_ID if not reordered 
+	int get_external_agent_ID(const int agent_ID) const
+		{ return agent_external_IDs.empty() ? agent_ID : agent_external_IDs.at(agent_ID-1); }
+	/// ID of a place in the input file, same as place_ID if not reordered 
+	int get_external_place_ID(const PopulationSegment::place_type type, const int place_ID) const;
 
 	/// Retrieve number of total infected
 	int get_total_infected() const { return n_infected_tot; }
@@ -192,7 +384,7 @@ public:
 	/// Retrieve number of total recovered
 	int get_total_recovered() const { return n_recovered_tot; }
 	/// Retrieve cumulative number of exposed that never developed symptoms
-	int get_tot_recovering_exposed() { return n_recovering_exposed; }
+	int get_tot_recovering_exposed() const { return n_recovering_exposed; }
 
 	// Total tested and confirmed COVID-19 + false positives 
 	int get_total_tested() const { return tot_tested; }
@@ -200,15 +392,125 @@ public:
 	int get_total_tested_negative() const { return tot_tested_neg; }
 	int get_total_tested_false_positive() const { return tot_tested_false_pos; }
 	int get_total_tested_false_negative() const { return tot_tested_false_neg; }
+	/// Total vaccinated by all types of vaccination
+	int get_total_vaccinated() const { return n_vaccinated_tot; }
 	// Daily statistics
-	const std::vector<int> get_infected_day() const { return n_infected_day; }
-	const std::vector<int> get_dead_day() const { return n_dead_day; }
-	const std::vector<int> get_recovered_day() const { return n_recovered_day; }
-	const std::vector<int> get_tested_day() const { return tested_day; }
-	const std::vector<int> get_tested_positive_day() const { return tested_pos_day; }	  
-	const std::vector<int> get_tested_negative_day() const { return tested_neg_day; }
-	const std::vector<int> get_tested_false_positive_day() const { return tested_false_pos_day; }
-	const std::vector<int> get_tested_false_negative_day() const { return tested_false_neg_day; }
+	const std::vector<int>& get_infected_day() const { return metrics.get_values(new_infected_metric); }
+	const std::vector<int>& get_dead_day() const { return metrics.get_values(new_dead_metric); }
+	const std::vector<int>& get_recovered_day() const { return metrics.get_values(new_recovered_metric); }
+	const std::vector<int>& get_tested_day() const { return metrics.get_values(new_tested_metric); }
+	const std::vector<int>& get_tested_positive_day() const { return metrics.get_values(new_tested_pos_metric); }	  
+	const std::vector<int>& get_tested_negative_day() const { return metrics.get_values(new_tested_neg_metric); }
+	const std::vector<int>& get_tested_false_positive_day() const 
+		{ return metrics.get_values(new_tested_false_pos_metric); }
+	const std::vector<int>& get_tested_false_negative_day() const 
+		{ return metrics.get_values(new_tested_false_neg_metric); }
+	const std::vector<int>& get_vaccinated_day() const { return metrics.get_values(new_vaccinated_metric); }
+
+	//
+	// Metrics
+	//
+
+	/**
+	 * \brief Preallocate the metrics for a planned number of steps
+	 * \details Recording stays correct beyond it, but allocates
+	 * @param n - total number of steps of the simulation
+	 */
+	void reserve_steps(const int n) { metrics.reserve(n); }
+
+	/**
+	 * \brief Declare a metric recorded by the caller
+	 * \details Values are set between the steps with set_metric and
+	 *		go to the last step taken; see Metrics::add for errors
+	 * @param name - name of the metric
+	 * @param kind - counter or gauge
+	 * @return Handle of the metric
+	 */
+	int add_metric(const std::string& name, const Metrics::kind_type kind) 
+		{ return metrics.add(name, kind); }
+	/// Value of a metric declared with add_metric at the last step taken
+	void set_metric(const int id, const int value) { metrics.set(id, value); }
+
+	/// Events counted in the totals and the built-in daily metrics
+	enum counted_event { infected_event, recovered_event, recovered_exposed_event, 
+		dead_tested_event, dead_not_tested_event, tested_event, tested_positive_event, 
+		tested_negative_event, tested_false_positive_event, tested_false_negative_event };
+
+	/**
+	 * \brief Count an event of a step processed by another driver
+	 * \details Adds to its total and, with daily data, to its metric
+	 *		at the current step, e.g. for the continuous time runs of
+	 *		NextReactionABM; the step starts with check_events
+	 */
+	void count_event(const counted_event event);
+
+	/// Record the totals and the census at the end of a step processed by another driver
+	void finish_step_metrics() { if (BuildFeatures::daily_data){ record_gauges(); } }
+
+	/**
+	 * \brief Also record the current number of infected, exposed, 
+	 *		active cases, and agents in each treatment 
+	 * \details Counted in one pass over the agents at the end of
+	 *		each step; other metrics need no pass
+	 */
+	void set_census_metrics();
+
+	/**
+	 * \brief All the metrics, one value per step
+	 * \details The built-in ones are new infected, dead, recovered,
+	 *		tested, and vaccinated per step, with their totals at the
+	 *		end of each step; recorded only with daily data enabled
+	 */
+	const Metrics& get_metrics() const { return metrics; }
+
+	/**
+	 * \brief Save all the metrics in one file
+	 * @param filename - path of the file
+	 * @param binary - binary format of Metrics if true, comma-separated otherwise
+	 */
+	void print_metrics(const std::string& filename, const bool binary = false) const
+		{ binary ? metrics.print_binary(filename) : metrics.print_csv(filename); }
+
+	/**
+	 * \brief Record where each new infection happens
+	 * \details Infections are attributed to a place or spatial 
+	 *		transmission, see lineage_log.h; disabled by default. Agent 
+	 *		and place IDs of the records are those of the input files,
+	 *		also after reorder_for_locality.
+	 * @param record - true to record
+	 * @param n_reserved - expected number of infections, preallocated
+	 */
+	void set_lineage_recording(const bool record = true, const std::size_t n_reserved = 0)
+		{ record_lineage = record; lineage.reserve(n_reserved); }
+
+	/// Infections recorded so far
+	const LineageLog& get_lineage_log() const { return lineage; }
+
+	/**
+	 * \brief Save summary statistics of the recorded infections
+	 * \details Number of infections and reproduction number in each
+	 *		setting, with all infected agents as potential sources, and
+	 *		secondary attack rates in households of each size
+	 * @param filename - path of the file
+	 */
+	void print_lineage_summary(const std::string& filename) const;
+
+	/**
+	 * \brief Settings of the memory for temporaries of a time step
+	 * \details Memory taken so far is returned to the system
+	 * @param block_bytes - minimum size of a block taken from the system
+	 * @param huge_pages - true to request blocks backed by huge pages
+	 */
+	void set_scratch_memory(const std::size_t block_bytes, const bool huge_pages = false)
+		{ scratch = MemoryArena(block_bytes, huge_pages); }
+
+	/// Memory for temporaries of a time step, with the number of allocations and peak usage
+	const MemoryArena& get_scratch_memory() const { return scratch; }
+
+	/// Campaign with its state, e.g. the number vaccinated per group
+	const VaccinationCampaign& get_vaccination_campaign() const { return campaign; }
+	/// True if the model vaccinates following a campaign
+	bool uses_vaccination_campaign() const { return with_campaign; }
 
 	//
 	// Saving simulation state
@@ -370,6 +672,9 @@ public:
 	/// Return a const reference to parameter map
 	const std::map<std::string, double> get_infection_parameters() const
 		{ return infection_parameters; }
+	/// Age-dependent distributions by tag and age group
+	const std::map<std::string, std::map<std::string, double>>& get_age_dependent_distributions() const
+		{ return age_dependent_distributions; }
 	/// Return a copy of the Flu object
 	Flu get_flu_object() const { return flu; }
 	/// Return a reference to Flu object
@@ -378,15 +683,27 @@ public:
 	Testing get_testing_object() const { return testing; }
 	/// Return the Testing object
 	Testing& get_testing_object() { return testing; }
+	/// Timeline of interventions
+	const Interventions& get_interventions() const { return interventions; }
 private:
 
 	using type_getter = bool(Agent::*)() const;
 
+	/// \brief Places of a susceptible agent before its transitions
+	/// \details The only attributes that the lineage needs and 
+	///		an infection can change 
+	struct SusceptiblePlaces{
+		int household_ID;
+		int hospital_ID;
+	};
+
 	// General model attributes
 	// Time step
 	double dt = 1.0;
 	// Time - updated contiuously throughout the simulation
 	double time = 0.0;
+	// Number of completed time steps
+	int n_steps = 0;
 
 	// Data collection
 	// Total number of infected, dead and recovered
@@ -402,15 +719,19 @@ private:
 	int tot_tested_neg = 0;
 	int tot_tested_false_pos = 0;
 	int tot_tested_false_neg = 0;
-	// Daily new cases and new tested
-	std::vector<int> n_infected_day = {};
-	std::vector<int> n_dead_day = {};
-	std::vector<int> n_recovered_day = {};
-	std::vector<int> tested_day = {};
-	std::vector<int> tested_pos_day = {};	
-	std::vector<int> tested_neg_day = {};
-	std::vector<int> tested_false_pos_day = {};
-	std::vector<int> tested_false_neg_day = {};
+	// Total vaccinated
+	int n_vaccinated_tot = 0;
+	// Per-step metrics, the built-in ones in order of declaration
+	enum builtin_metric { new_infected_metric, new_dead_metric, new_recovered_metric, 
+		new_tested_metric, new_tested_pos_metric, new_tested_neg_metric, 
+		new_tested_false_pos_metric, new_tested_false_neg_metric, new_vaccinated_metric,
+		total_infected_metric, total_dead_metric, tested_dead_metric, not_tested_dead_metric,
+		total_recovered_metric, total_tested_metric, total_tested_pos_metric, 
+		total_tested_neg_metric, total_tested_false_pos_metric, total_tested_false_neg_metric,
+		total_vaccinated_metric };
+	Metrics metrics = builtin_metrics();
+	// Handle of the first census metric, -1 if not recorded
+	int census_metric = -1;
 
 	// Infection parameters
 	std::map<std::string, double> infection_parameters = {};
@@ -422,6 +743,28 @@ private:
 	Infection infection;
 	// Testing properties and their time dependence
 	Testing testing;	
+	// Closures, reopenings, and other interventions
+	Interventions interventions;
+	// Interventions applied so far that changed transmission in places
+	int n_place_changes = 0;
+	// Step length of the agent times, held while the model exists
+	StepLengthHold step_length_hold;
+	// Executor of the registration in places
+	std::function<void(int, const std::function<void(int)>&)> run_registration;
+	// Optional checks of the input
+	bool validate_input = false;
+	InputValidator input_validator;
+	InputReport input_report;
+	// Optional record of where infections happen
+	bool record_lineage = false;
+	LineageLog lineage;
+	// Temporaries of a time step, reset at its end
+	MemoryArena scratch;
+	// Community transmission by distance
+	SpatialTransmission spatial;
+	bool spatial_transmission = false;
+	// True if the interventions come from the infection parameters
+	bool default_interventions = true;
 	// Class for computing infection contributions
 	Contributions contributions;
 	// Class for computing agent transitions
@@ -434,21 +777,133 @@ private:
 
 	// Vectors of individual model objects
 	std::vector<Agent> agents;
+	// Owner of the profiles the agents point to, 
+	// shared with copies of the model
+	std::shared_ptr<const void> profile_storage;
 	std::vector<Household> households;
 	std::vector<RetirementHome> retirement_homes;
 	std::vector<School> schools;
 	std::vector<Workplace> workplaces;
 	std::vector<Hospital> hospitals;
 
+	// Batched infection draws and their work buffers
+	bool batched_infection_draws = false;
+	std::vector<double> batch_lambdas;
+	std::vector<int> batch_infected;
+	// Agents already processed in this step by batched draws 
+	// or place-centric sampling, in increasing order
+	std::vector<int> batch_agent_IDs;
+
+	// Place-centric infection sampling and its work buffers
+	bool place_infection_sampling = false;
+	std::vector<int> exposed_positions;
+	std::vector<char> newly_infected_flags;
+	std::vector<int> flu_at_step_start;
+
+	// True if the model was verified against the features 
+	bool features_checked = false;
+
+	// Agents processed by this object, empty if all
+	std::vector<bool> local_agents;
+
+	// IDs from the input files in order of current IDs,
+	// empty if not reordered
+	std::vector<int> agent_external_IDs;
+	std::vector<int> household_external_IDs;
+	std::vector<int> school_external_IDs;
+	std::vector<int> workplace_external_IDs;
+	std::vector<int> hospital_external_IDs;
+	std::vector<int> retirement_home_external_IDs;
+
 	// Vaccination properties
 	bool random_vaccines = false;
 	int n_vaccinated = 0;
 	bool group_vaccines = false;
 	std::string vaccine_group_name;
 	bool vac_verbose = false;
+	// Daily doses for prioritized groups
+	VaccinationCampaign campaign;
+	bool with_campaign = false;
 
 	// Private methods
 
+	/// Sample infections of susceptible agents without flu and process the infected
+	template <typename Features>
+	void draw_batched_infections();
+
+	/// Sample infections of susceptible agents without flu from places with infected and process the infected
+	template <typename Features>
+	void sample_infections_by_place();
+
+	/// Throw if the model uses features disabled in Features
+	template <typename Features>
+	void check_features();
+
+	/// Add one to a total and, with daily data, to its counter for this step
+	template <typename Features>
+	void record_count(const builtin_metric id, int& total)
+		{ ++total; if (Features::daily_data){ metrics.increment(id); } }
+
+	/// \brief Count a new infection and, if recorded, where it happened
+	/// \details Agent in its state before the infection was processed
+	template <typename Features>
+	void record_infection(const Agent& agent)
+	{ 
+		record_count<Features>(new_infected_metric, n_infected_tot);
+		if (record_lineage){
+			record_infection_source(agent);
+		}
+	}
+
+	/// \brief Count a new infection and, if recorded, where it happened
+	/// \details Agent after the infection was processed and its earlier places
+	template <typename Features>
+	void record_infection(const Agent& agent, const SusceptiblePlaces& before)
+	{ 
+		record_count<Features>(new_infected_metric, n_infected_tot);
+		if (record_lineage){
+			record_infection_source(agent, before);
+		}
+	}
+
+	/// Attribute a new infection to one of the places of the agent or spatial transmission
+	void record_infection_source(const Agent& agent);
+	/// Same, for an agent that may have moved to a hospital or home when infected
+	void record_infection_source(const Agent& agent, const SusceptiblePlaces& before);
+
+	/// Places of one type that contribute to the lambda of an agent
+	template <typename T>
+	void add_infection_sources(const Agent& agent, const std::vector<T>& places, 
+					const LineageLog::setting_type setting, LineageLog::Source* sources, 
+					int& n_sources) const;
+
+	/// Registry with the built-in metrics
+	static Metrics builtin_metrics();
+	/// Gauges at the end of a step
+	void record_gauges();
+
+	/// Find agents infected in each place of a given type
+	template <typename T>
+	void sample_infections_in_places(const std::vector<T>& places);
+
+	/// True if the agent is processed by this object
+	bool is_local(const Agent& agent) const
+		{ return local_agents.empty() || local_agents.at(agent.get_ID()-1); }
+
+	/**
+	 * \brief Sort places along a Hilbert curve and assign new IDs
+	 * @param places - places of one type, reordered on return
+	 * @param external_IDs - input file IDs in current order, updated
+	 * @return New ID of each place indexed by the old ID - 1
+	 */
+	template <typename T>
+	std::vector<int> order_by_location(std::vector<T>& places, std::vector<int>& external_IDs);
+
+	/// Copy of places with IDs from the input files, in their order
+	template <typename T>
+	std::vector<T> with_external_IDs(const std::vector<T>& places, 
+							const std::vector<int>& external_IDs) const;
+
 	/// Set initial values on all the data collection variables and containers
 	void initialize_data_collection();
 
@@ -461,6 +916,32 @@ private:
 	/// Initialize testing and its time dependence
 	void load_testing(const std::string);
 
+	/// Infection distributions and probabilities from the infection parameters
+	void set_infection_properties();
+	/// Age-dependent infection properties from the stored distributions
+	void set_age_dependent_properties();
+	/// Testing properties from the infection parameters
+	void set_testing_properties();
+	/// Flu properties from the infection parameters
+	void set_flu_properties();
+
+	//
+	// Places with the current infection parameters
+	//
+
+	Household make_household(const int ID, const double x, const double y) const;
+	RetirementHome make_retirement_home(const int ID, const double x, const double y) const;
+	School make_school(const int ID, const double x, const double y, const std::string& school_type) const;
+	Workplace make_workplace(const int ID, const double x, const double y) const;
+	Hospital make_hospital(const int ID, const double x, const double y, 
+							const std::map<const std::string, const double>& betas) const;
+	/// Transmission rates of all hospitals, for make_hospital
+	std::map<const std::string, const double> hospital_betas() const;
+
+	/// Replace each place with a new one keeping its registered agents
+	template <typename T, typename F>
+	void rebuild_places(std::vector<T>& places, F make_place);
+
 	/**
 	 * \brief Read object information from a file	
 	 * @param filename - path of the file to print to
@@ -470,13 +951,27 @@ private:
 	/// \brief Set properties of initially infected - exposed
 	void initial_exposed(Agent&);
 
-	/// Vaccinate random members of the population that are not Flu or infected agents
-	void vaccinate_random();
+	/// Interventions defined by the infection parameters
+	void set_default_interventions();
+	/// Change places or agents as given by an intervention
+	void apply_intervention(const Interventions::Intervention& intervention,
+					std::vector<School>& schools, std::vector<Workplace>& workplaces);
+	/// \brief Apply a change to the places in the range of an intervention
+	/// \details Range of IDs from the input files, external_IDs of reordered places
+	template <typename T, typename F>
+	void change_places(std::vector<T>& places, const std::vector<int>& external_IDs,
+						const Interventions::Intervention& intervention, F change);
+
+	/// Vaccinate n_vac random members of the population that are not Flu or infected agents
+	void vaccinate_random(const int n_vac);
 	/// Vaccinate specific group of agents in the population
 	void vaccinate_group();
 	/// Assign removed (vaccinated equivalent) flag to the group with specified type
 	/// @param atype - agent member function that checks if the agent is of requested type 
 	void implement_group_vaccination(type_getter atype);
+	/// Add to the total vaccinated and, with daily data, to the entry for this step
+	void count_vaccinated(const int n) 
+		{ n_vaccinated_tot += n; metrics.increment(new_vaccinated_metric, n); }
 
 	/**
 	 * \brief Print basic places information to a file
@@ -494,12 +989,121 @@ private:
 	 */
 	void load_agents(const std::string fname, const int ninf0 = 0);
 
+	/// Random choice of IDs of initially infected, ninf0 out of n_agents
+	std::vector<int> random_infected_IDs(const int n_agents, const int ninf0);
+
 	/**
 	 * \brief Assign agents to households, schools, and worplaces
+	 * \details Rosters of each type of places are laid out in one buffer
 	 */
 	void register_agents();
+
+	/**
+	 * \brief Places of one type where an agent is registered
+	 * @param agent - the agent
+	 * @param type - type of the places
+	 * @param place_IDs - IDs of the places
+	 * @return Number of the places, at most 2
+	 */
+	int registered_places(const Agent& agent, const PopulationSegment::place_type type, int place_IDs[2]) const;
+
+	/// Register all the agents in the places of one type, in two passes
+	template <typename T>
+	void register_in_places(std::vector<T>& places, const PopulationSegment::place_type type);
+
+	/// Register agents in places of one type with the rosters of a segment
+	template <typename T>
+	void register_from_rosters(std::vector<T>& places, const PopulationSegment::place_type type,
+								const PopulationSegment& segment);
+
+
+	/// Lay out the rosters of places of one type in one buffer
+	template <typename T>
+	static void pack_rosters(std::vector<T>& places);
+
+	/**
+	 * \brief Validate agent columns against the created places
+	 * \details Throws std::invalid_argument if inconsistent
+	 * @param n_agents - number of agents
+	 * @param values - integer attributes in the layout of PopulationSegment 
+	 * @param x - x coordinates of the agents
+	 * @param y - y coordinates of the agents
+	 */
+	void check_input(const int n_agents, const std::int32_t* values, const double* x, const double* y);
+
+	/// Places of one type for the input validation
+	template <typename T>
+	void set_validated_places(const PopulationSegment::place_type type, const std::vector<T>& places);
 };
 
+// Sort places along a Hilbert curve and assign new IDs
+template <typename T>
+std::vector<int> ABM::order_by_location(std::vector<T>& places, std::vector<int>& external_IDs)
+{
+	std::vector<int> new_IDs(places.size());
+	if (places.empty()){
+		return new_IDs;
+	}
+
+	// Map coordinates to a 2^16 x 2^16 grid
+	const int order = 16;
+	const double n_cells = static_cast<double>((1 << order) - 1);
+	double x_min = places.front().get_x_location(), x_max = x_min;
+	double y_min = places.front().get_y_location(), y_max = y_min;
+	for (const auto& place : places){
+		x_min = std::min(x_min, place.get_x_location());
+		x_max = std::max(x_max, place.get_x_location());
+		y_min = std::min(y_min, place.get_y_location());
+		y_max = std::max(y_max, place.get_y_location());
+	}
+	const double x_scale = (x_max > x_min) ? n_cells/(x_max - x_min) : 0.0;
+	const double y_scale = (y_max > y_min) ? n_cells/(y_max - y_min) : 0.0;
+
+	std::vector<std::pair<std::uint64_t, int>> curve_order;
+	for (int i = 0; i < places.size(); ++i){
+		const std::uint32_t ix = static_cast<std::uint32_t>((places.at(i).get_x_location() - x_min)*x_scale);
+		const std::uint32_t iy = static_cast<std::uint32_t>((places.at(i).get_y_location() - y_min)*y_scale);
+		curve_order.push_back(std::make_pair(hilbert_curve_index(ix, iy, order), i));
+	}
+	std::sort(curve_order.begin(), curve_order.end());
+
+	if (external_IDs.empty()){
+		for (const auto& place : places){
+			external_IDs.push_back(place.get_ID());
+		}
+	}
+	std::vector<T> ordered;
+	std::vector<int> ordered_external_IDs;
+	ordered.reserve(places.size());
+	for (const auto& co : curve_order){
+		ordered.push_back(places.at(co.second));
+		ordered.back().set_ID(ordered.size());
+		ordered_external_IDs.push_back(external_IDs.at(co.second));
+		new_IDs.at(co.second) = ordered.size();
+	}
+	places.swap(ordered);
+	external_IDs.swap(ordered_external_IDs);
+	return new_IDs;
+}
+
+// Copy of places with IDs from the input files, in their order
+template <typename T>
+std::vector<T> ABM::with_external_IDs(const std::vector<T>& places, 
+							const std::vector<int>& external_IDs) const
+{
+	if (external_IDs.empty()){
+		return places;
+	}
+	std::vector<T> restored(places.size());
+	for (int i = 0; i < places.size(); ++i){
+		T& place = restored.at(external_IDs.at(i) - 1);
+		place = places.at(i);
+		place.set_ID(external_IDs.at(i));
+		place.remap_agent_IDs(agent_external_IDs);
+	}
+	return restored;
+}
+
 // Write Place objects
 template <typename T>
 void ABM::print_places(std::vector<T> places, const std::string fname) const
@@ -514,6 +1118,43 @@ void ABM::print_places(std::vector<T> places, const std::string fname) const
 	abm_io.write_vector<T>(places);
 }
 
+// Find agents infected in each place of a given type
+template <typename T>
+void ABM::sample_infections_in_places(const std::vector<T>& places)
+{
+	for (const auto& place : places){
+		const double lambda = place.get_infected_contribution();
+		if (lambda <= 0.0){
+			continue;
+		}
+		const Roster& members = place.get_agent_IDs_ref();
+		infection.sample_place_exposures(lambda, members.size(), exposed_positions);
+		for (const auto& pos : exposed_positions){
+			const int agent_ID = members.at(pos);
+			const Agent& agent = agents.at(agent_ID-1);
+			if (newly_infected_flags.at(agent_ID-1) == 1 || !is_local(agent) 
+					|| agent.removed() || agent.vaccinated()
+					|| agent.infected() || agent.symptomatic_non_covid()){
+				continue;
+			}
+			// Registrations in this place that count towards the agent's lambda 
+			const int n_exposures = transitions.susceptible_exposures(agent, place);
+			if (n_exposures == 0){
+				continue;
+			}
+			const int n_registered = members.multiplicity(agent_ID);
+			if (n_exposures > n_registered){
+				throw std::runtime_error("Agent " + std::to_string(agent_ID) 
+								+ " is not registered in a place contributing to their lambda");
+			}
+			if (infection.confirm_exposure(lambda, static_cast<double>(n_exposures)/n_registered)){
+				newly_infected_flags.at(agent_ID-1) = 1;
+				batch_agent_IDs.push_back(agent_ID);
+			}
+		}
+	}
+}
+
 // Write agent IDs in Place objects
 template <typename T>
 void ABM::print_agents_in_places(std::vector<T> places, const std::string fname) const
@@ -539,4 +1180,153 @@ void ABM::print_agents_in_places(std::vector<T> places, const std::string fname)
 	abm_io.write_vector<int>(agents_all_places);
 }
 
+// Register all the agents in the places of one type, in two passes
+template <typename T>
+void ABM::register_in_places(std::vector<T>& places, const PopulationSegment::place_type type)
+{
+	// Number of agents in each place, at the position of the next one
+	std::vector<int> offsets(places.size() + 1, 0);
+	std::vector<int> n_infected(places.size(), 0);
+	int place_IDs[2] = {0, 0};
+	for (const auto& agent : agents){
+		const int n_places = registered_places(agent, type, place_IDs);
+		for (int ip = 0; ip < n_places; ++ip){
+			if (place_IDs[ip] < 1 || place_IDs[ip] > places.size()){
+				throw std::out_of_range("Agent " + std::to_string(agent.get_ID()) 
+							+ " registered in a place that does not exist, ID " 
+							+ std::to_string(place_IDs[ip]));
+			}
+			++offsets.at(place_IDs[ip]);
+			if (agent.infected()){
+				++n_infected.at(place_IDs[ip]-1);
+			}
+		}
+	}
+	std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+	// Agent IDs in the order of the agents within each place
+	std::vector<int> IDs(offsets.back());
+	std::vector<int> next(offsets.begin(), offsets.end() - 1);
+	for (const auto& agent : agents){
+		const int n_places = registered_places(agent, type, place_IDs);
+		for (int ip = 0; ip < n_places; ++ip){
+			IDs[next[place_IDs[ip]-1]++] = agent.get_ID();
+		}
+	}
+	std::vector<Roster> rosters = Roster::split(std::move(IDs), offsets);
+	for (std::size_t ip = 0; ip < places.size(); ++ip){
+		places[ip].register_agents(std::move(rosters[ip]), n_infected[ip]);
+	}
+}
+
+// Register agents in places of one type with the rosters of a segment
+template <typename T>
+void ABM::register_from_rosters(std::vector<T>& places, const PopulationSegment::place_type type,
+								const PopulationSegment& segment)
+{
+	std::vector<Roster> rosters = segment.get_rosters(type);
+	if (rosters.size() != places.size()){
+		throw std::runtime_error("Population segment has rosters for a different number of places");
+	}
+	// Only the infected need to be found
+	std::vector<int> n_infected(places.size(), 0);
+	int place_IDs[2] = {0, 0};
+	for (const auto& agent : agents){
+		if (!agent.infected()){
+			continue;
+		}
+		const int n_places = registered_places(agent, type, place_IDs);
+		for (int ip = 0; ip < n_places; ++ip){
+			++n_infected.at(place_IDs[ip]-1);
+		}
+	}
+	for (std::size_t ip = 0; ip < places.size(); ++ip){
+		places[ip].register_agents(std::move(rosters[ip]), n_infected[ip]);
+	}
+}
+
+// Places of one type that contribute to the lambda of an agent
+template <typename T>
+void ABM::add_infection_sources(const Agent& agent, const std::vector<T>& places, 
+					const LineageLog::setting_type setting, LineageLog::Source* sources, 
+					int& n_sources) const
+{
+	// Places of any type are identified by one of these
+	const int candidates[] = {agent.get_household_ID(), agent.get_school_ID(), 
+								agent.get_work_ID(), agent.get_hospital_ID()};
+	for (int ic = 0; ic < 4; ++ic){
+		const int ID = candidates[ic];
+		if (ID < 1 || ID > places.size() || std::find(candidates, candidates + ic, ID) != candidates + ic){
+			continue;
+		}
+		const T& place = places[ID-1];
+		const int n_exposures = transitions.susceptible_exposures(agent, place);
+		if (n_exposures > 0){
+			sources[n_sources++] = {setting, ID, n_exposures*place.get_infected_contribution()};
+		}
+	}
+}
+
+// Lay out the rosters of places of one type in one buffer
+template <typename T>
+void ABM::pack_rosters(std::vector<T>& places)
+{
+	std::vector<Roster> rosters;
+	rosters.reserve(places.size());
+	for (const auto& place : places){
+		rosters.push_back(place.get_agent_IDs_ref());
+	}
+	Roster::pack(rosters);
+	for (std::size_t ip = 0; ip < places.size(); ++ip){
+		places[ip].set_agent_IDs(std::move(rosters[ip]));
+	}
+}
+
+// Places of one type for the input validation
+template <typename T>
+void ABM::set_validated_places(const PopulationSegment::place_type type, const std::vector<T>& places)
+{
+	std::vector<int> IDs;
+	std::vector<double> x, y;
+	for (const auto& place : places){
+		IDs.push_back(place.get_ID());
+		x.push_back(place.get_x_location());
+		y.push_back(place.get_y_location());
+	}
+	input_validator.set_places(type, IDs, x, y);
+}
+
+// Apply a change to the places in the range of an intervention
+template <typename T, typename F>
+void ABM::change_places(std::vector<T>& places, const std::vector<int>& external_IDs,
+						const Interventions::Intervention& intervention, F change)
+{
+	// Positions are the IDs from the input files
+	if (intervention.last == 0 || external_IDs.empty()){
+		const int last = (intervention.last == 0) ? places.size() : intervention.last;
+		for (int i = intervention.first; i < last; ++i){
+			change(places.at(i));
+		}
+		return;
+	}
+	// Reordered, places with input IDs in the range are anywhere
+	for (std::size_t i = 0; i < places.size(); ++i){
+		const int ID = external_IDs.at(i);
+		if (ID > intervention.first && ID <= intervention.last){
+			change(places.at(i));
+		}
+	}
+}
+
+// Replace each place with a new one keeping its registered agents
+template <typename T, typename F>
+void ABM::rebuild_places(std::vector<T>& places, F make_place)
+{
+	for (auto& place : places){
+		T rebuilt = make_place(place);
+		rebuilt.set_agent_IDs(place.get_agent_IDs_ref());
+		place = rebuilt;
+	}
+}
+
 #endif
@@ -31,11 +31,21 @@
 #include "common.h"
 #include "./io_operations/abm_io.h"
 #include "./io_operations/load_parameters.h"
+#include "./io_operations/state_snapshots.h"
+#include "./io_operations/input_validator.h"
 #include "agent.h"
 #include "infection.h"
 #include "testing.h"
+#include "interventions.h"
+#include "spatial_transmission.h"
+#include "vaccination_campaign.h"
+#include "metrics.h"
+#include "lineage_log.h"
+#include "memory_arena.h"
 #include "contributions.h"
 #include "flu.h"
+#include "model_features.h"
+#include "shared_population/population_segment.h"
 #include "utils.h"
 
 #endif
@@ -3,37 +3,36 @@
 
 #include "common.h"
 #include "infection.h"
+#include "step_time.h"
 
 class Infection;
 
 /***************************************************** 
- * class: Agent
+ * struct: AgentProfile
  * 
- * Defines and stores attributes of a single agent
+ * Attributes of an agent that do not change during
+ * a simulation
+ *
+ * Profiles of all the agents of a model are stored
+ * together by the model and shared by its copies; 
+ * models created from a published population read
+ * them from the shared segment, so each worker process
+ * only stores the state of its agents.
  * 
  *****************************************************/
 
-class Agent{
-public:
-	
-	//
-	// Constructors
-	//
+struct AgentProfile{
+	/// Profile with default attributes
+	AgentProfile() = default;
 
 	/**
-	 * \brief Creates an Agent object with default attributes
-	 */
-	Agent() = default;
-
-	/**
- 	 * \brief Creates an Agent object with custom attributes
+ 	 * \brief Creates a profile with custom attributes
  	 *
  	 * @param student - true (marked as 1) if Agent is a student
  	 * @param works - true (marked as 1) if Agent works
  	 * @param yrs - age of the Agent
  	 * @param xi - x coordinate of the Agent
  	 * @param yi - y coordinate of the Agent
- 	 * @param houseID - household ID
 	 * @param isPatient - true if hospitalized with a condition other than covid
  	 * @param schoolID - ID of the school Agent attends
 	 * @param lvRH - true if agent lives at a retirement home
@@ -41,17 +40,64 @@ public:
 	 * @param wrkSch - true if agent works at a school
 	 * @param workID - ID of the workplace Agent works at
 	 * @param worksHospital - true if agent works at a hospital
-	 * @param HospitalID - ID of the hospital where agent is staff or patient
- 	 * @param infected - true if Agent is infected
  	 */	
-	Agent(const bool student, const bool works, const int yrs, const double xi, 
-			const double yi, const int houseID, const bool isPatient, const int schoolID, 
-			const bool lvRH, const bool wrkRH, const bool wrkSch, const int workID, 
-			const bool worksHospital, const int hospitalID, const bool infected) 
-			: is_student(student), is_working(works), age(yrs),
-		   		x(xi), y(yi), house_ID(houseID), is_non_covid_patient(isPatient), school_ID(schoolID), 
-				livesRH(lvRH), worksRH(wrkRH), worksSch(wrkSch), work_ID(workID),  
-				works_at_hospital(worksHospital), hospital_ID(hospitalID), is_infected(infected) { }  
+	AgentProfile(const bool student, const bool works, const int yrs, const double xi, 
+			const double yi, const bool isPatient, const int schoolID, const bool lvRH, 
+			const bool wrkRH, const bool wrkSch, const int workID, const bool worksHospital)
+		: x(xi), y(yi), age(yrs), school_ID(schoolID), work_ID(workID), student(student),
+			works(works), non_covid_patient(isPatient), hospital_employee(worksHospital),
+			retirement_home_employee(wrkRH), school_employee(wrkSch), 
+			retirement_home_resident(lvRH) { }
+
+	// Location
+	double x = 0.0, y = 0.0;
+	int age = 0;
+	// School and work IDs
+	int school_ID = -1;
+	int work_ID = -1;
+	// Demographic information and types
+	bool student = false;
+	bool works = false;
+	bool non_covid_patient = false;
+	bool hospital_employee = false;
+	bool retirement_home_employee = false;
+	bool school_employee = false;
+	bool retirement_home_resident = false;
+};
+
+/***************************************************** 
+ * class: Agent
+ * 
+ * Defines and stores attributes of a single agent
+ * 
+ *****************************************************/
+
+class Agent{
+public:
+	
+	//
+	// Constructors
+	//
+
+	/**
+	 * \brief Creates an Agent object with default attributes
+	 */
+	Agent() = default;
+
+	/**
+	 * \brief Creates an Agent object with a stored profile
+	 * \details The profile is not copied and has to outlive
+	 *		the agent; the model owns the profiles of its agents
+	 *
+	 * @param agent_profile - attributes that do not change
+	 * @param houseID - household ID
+	 * @param hospitalID - ID of the hospital where agent is staff or patient
+	 * @param infected - true if Agent is infected
+	 */
+	Agent(const AgentProfile* agent_profile, const int houseID, 
+			const int hospitalID, const bool infected) 
+			: profile(agent_profile), house_ID(houseID), hospital_ID(hospitalID), 
+				is_infected(infected) { }
 
 	//
 	// Infection related computations
@@ -64,37 +110,40 @@ public:
 	/// Retrieve this agents ID
 	int get_ID() const { return ID; }
 	/// Agents age
-	int get_age() const { return age; }
+	int get_age() const { return profile->age; }
 	/// House ID
 	int get_household_ID() const { return house_ID; }
 	/// School ID
-	int get_school_ID() const { return school_ID; }
+	int get_school_ID() const { return profile->school_ID; }
 	/// Work ID
-	int get_work_ID() const { return work_ID; }
+	int get_work_ID() const { return profile->work_ID; }
 	/// Hospital ID if staff or patient
 	int get_hospital_ID() const { return hospital_ID; }
 
+	/// Attributes that do not change
+	const AgentProfile& get_profile() const { return *profile; }
+
 	/// Location - x coordinates
-	double get_x_location() const { return x; }	
+	double get_x_location() const { return profile->x; }
 	/// Location - y coordinates
-	double get_y_location() const { return y; }
+	double get_y_location() const { return profile->y; }
 
 	/// True if infected
 	bool infected() const { return is_infected; }
 	/// True if student
-	bool student() const { return is_student; }
+	bool student() const { return profile->student; }
 	/// True if agent works
-	bool works() const { return is_working; }
+	bool works() const { return profile->works; }
 	/// True if agent works at a hospital
-	bool hospital_employee() const { return works_at_hospital; }
+	bool hospital_employee() const { return profile->hospital_employee; }
 	/// True if agent is a hospital patient with condition other than COVID
-	bool hospital_non_covid_patient() const { return is_non_covid_patient; }
+	bool hospital_non_covid_patient() const { return profile->non_covid_patient; }
 	/// True if agent works in a retirement home 
-	bool retirement_home_employee() const { return worksRH; }
+	bool retirement_home_employee() const { return profile->retirement_home_employee; }
 	/// True if agent works at a school
-	bool school_employee() const { return worksSch; }
+	bool school_employee() const { return profile->school_employee; }
 	/// True if agent lives in a retirement home 
-	bool retirement_home_resident() const { return livesRH; }
+	bool retirement_home_resident() const { return profile->retirement_home_resident; }
 
 	/// State getters
 	bool exposed() const { return is_exposed; }
@@ -113,7 +162,7 @@ public:
 	bool tested_in_hospital() const { return is_tested_in_hospital; }
 	bool tested_awaiting_results() const { return is_tested_awaiting_results; }
 	bool tested_awaiting_test() const { return is_tested_awaiting_test; } 
-	double get_time_for_flu_isolation() { return time_flu_ih; }
+	scheduled_time get_time_for_flu_isolation() { return time_flu_ih; }
 	bool get_testing_since_exposed() { return is_testing_since_exposed; }
 	// Treatment types
 	bool being_treated() const { return is_treated; }
@@ -132,28 +181,30 @@ public:
 
 	/// Get infectiousness variability factor of an agent
 	double get_inf_variability_factor() const { return inf_var; }
+	/// Contribution to the infection probability from spatial transmission
+	double get_spatial_lambda() const { return spatial_lambda; }
 	/// Get latency end time
-	double get_latency_end_time() const { return latency_end_time; }
+	scheduled_time get_latency_end_time() const { return latency_end_time; }
 	/// Time when the latent-non infectious period ends
-	double get_infectiousness_start_time() const { return infectiousness_start; }
+	scheduled_time get_infectiousness_start_time() const { return infectiousness_start; }
 	/// Get time of death if not recovering
-	double get_time_of_death() const { return death_time; }
+	scheduled_time get_time_of_death() const { return death_time; }
 	/// Get time of recovery
-	double get_recovery_time() const { return recovery_time; } 
+	scheduled_time get_recovery_time() const { return recovery_time; } 
 	/// Time of testing
-	double get_time_of_test() const { return time_of_test; }
+	scheduled_time get_time_of_test() const { return time_of_test; }
 	/// Time when agent gets their testing results
-	double get_time_of_results() const { return time_of_results; }
+	scheduled_time get_time_of_results() const { return time_of_results; }
 	/// Time when dying agent is transferred from hospital to ICU
-	double get_time_hsp_to_icu() const { return time_hsp_to_ICU; }
+	scheduled_time get_time_hsp_to_icu() const { return time_hsp_to_ICU; }
 	/// Time when agent is transferred from ICU to hospital
-	double get_time_icu_to_hsp() const { return time_icu_to_hsp; }
+	scheduled_time get_time_icu_to_hsp() const { return time_icu_to_hsp; }
 	/// Time when recovering agent is transferred from hospital to home isolation
-	double get_time_hsp_to_ih() const { return time_hsp_to_ih; }
+	scheduled_time get_time_hsp_to_ih() const { return time_hsp_to_ih; }
 	/// Time when dying agent is transferred from home isolation to ICU
-	double get_time_ih_to_icu() const { return time_ih_to_icu; }
+	scheduled_time get_time_ih_to_icu() const { return time_ih_to_icu; }
 	/// Time when recovering agent is transferred from home isolation to hospital
-	double get_time_ih_to_hsp() const { return time_ih_to_hsp; }
+	scheduled_time get_time_ih_to_hsp() const { return time_ih_to_hsp; }
 
 	//
 	// Setters
@@ -168,6 +219,9 @@ public:
 	/// Assign household ID
 	void set_household_ID(const int ID) { house_ID = ID; }
 
+	/// Use another stored profile, e.g. one with changed school or work IDs
+	void set_profile(const AgentProfile* agent_profile) { profile = agent_profile; }
+
 	/// Change infection status
 	void set_infected(const bool infected) { is_infected = infected; }
 
@@ -251,6 +305,8 @@ public:
 
 	/// Set infectiousness variability factor of an agent
 	void set_inf_variability_factor(const double var) { inf_var = var; }
+	/// Set contribution to the infection probability from spatial transmission
+	void set_spatial_lambda(const double lambda) { spatial_lambda = lambda; }
 
 	//
 	// I/O
@@ -266,73 +322,64 @@ public:
 
 private:
 
-	// General demographic information
-	bool is_student = false;
-	bool is_working = false;
-	int age = 0;
+	// Attributes that do not change, stored by the model
+	// and shared with copies of the agent
+	const AgentProfile* profile = &empty_profile();
+
+	// Timing - times of scheduled events and durations used to
+	// compute them; step indices and single precision durations
+	// if compiled with ABM_STEP_TIMES (see step_time.h)
 
 	// Latency duration in time
-	double latency_duration = 0.0; 
+	time_duration latency_duration = 0.0; 
 	// Start of infectiousness
-	double infectiousness_start = 0.0;
+	scheduled_time infectiousness_start = 0.0;
 	// End of latency period within the simulation time
-	double latency_end_time = 0.0;
+	scheduled_time latency_end_time = 0.0;
 	// Time from becoming symptomatic (onset) to death
-	double otd_duration = 0.0;
+	time_duration otd_duration = 0.0;
 	// Time of death
-	double death_time = 0.0;
+	scheduled_time death_time = 0.0;
 	// Time to recover
-	double recovery_duration = 0.0;
+	time_duration recovery_duration = 0.0;
 	// Time of recovery
-	double recovery_time = 0.0;
+	scheduled_time recovery_time = 0.0;
 	// Time between testing decision and the test
-	double time_to_test = 0.0;
+	time_duration time_to_test = 0.0;
 	// Exact time of testing
-	double time_of_test = 0.0;
+	scheduled_time time_of_test = 0.0;
 	// Time from testing until results
-	double time_until_results = 0.0;
+	time_duration time_until_results = 0.0;
 	// Time when results are available
-	double time_of_results = 0.0;
+	scheduled_time time_of_results = 0.0;
 	// Time when dying agent is transferred from hospital to ICU
-	double time_hsp_to_ICU = 0.0;
+	scheduled_time time_hsp_to_ICU = 0.0;
 	// Time from hospitalization to home isolation
-	double time_hsp_to_ih = 0.0;
+	scheduled_time time_hsp_to_ih = 0.0;
 	// Time from ICU to hospitalization
-	double time_icu_to_hsp = 0.0;
+	scheduled_time time_icu_to_hsp = 0.0;
 	// Time from IH to ICU
-	double time_ih_to_icu = 0.0;
+	scheduled_time time_ih_to_icu = 0.0;
 	// Time from IH to hospitalization
-	double time_ih_to_hsp = 0.0;
+	scheduled_time time_ih_to_hsp = 0.0;
 	// Start home isolation for flu agents
 	// before getting tested
-	double time_flu_ih = 0.0;
+	scheduled_time time_flu_ih = 0.0;
 
 	// ID
 	int ID = 0;
 
-	// Location
-	double x = 0.0, y = 0.0;
-
-	// Household ID
+	// Household ID, changes for hospital patients
 	int house_ID = -1;
-	// Hospital patient with something else than COVID
-	bool is_non_covid_patient = false;
-
-	// School and work IDs and types
-	int school_ID = -1;
-	int work_ID = -1;
+	// Hospital ID, changes with testing and treatment
 	int hospital_ID = -1;
-	int agent_school_type = -1; 
-	bool works_at_hospital = false;
-	bool worksRH = false;
-	bool worksSch = false;
-	bool livesRH = false;
 
 	// Infection status
 	bool is_infected = false;
 
-	// Ratio of distances with infected and all distances
-	double dist_ratio = 0.0;
+	// Contribution to the infection probability from infectious 
+	// agents nearby, used with spatial transmission
+	double spatial_lambda = 0.0;
 
 	// State information
 	bool is_exposed = false;
@@ -369,19 +416,8 @@ private:
 	// Infectiousness variability parameter
 	double inf_var = -1.0;
 
-	//
-	// Private member functions
-	//
-	
-	/** 
-	 * \brief Function of distance for infection propagation
-	 * @param a - Infection parameter for distance scaling, units of distance
-	 * @param b - Infection parameter for distance scaling, unitless
-     * @param dij - distance between agents i and j 
-	 *
- 	 * @returns Value of the distance function
-	 */	
-	double distance_function(const double a, const double b, const double dij) const;
+	/// Profile of default constructed agents
+	static const AgentProfile& empty_profile();
 };
 
 /// Overloaded ostream operator for I/O
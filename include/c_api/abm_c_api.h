@@ -0,0 +1,186 @@
+#ifndef ABM_C_API_H
+#define ABM_C_API_H
+
+#include <stddef.h>
+
+/*****************************************************
+ * C interface of the model
+ *
+ * Stable C ABI for embedding the model in other
+ * languages (Python with ctypes, MATLAB with loadlibrary,
+ * Julia, R) without running the executable and parsing
+ * its output files.
+ *
+ * Build as a shared library from all the sources in
+ * src/ and src/c_api/abm_c_api.cpp with -fPIC -shared,
+ * e.g. tests/c_api/compilation.py builds libabm.so.
+ *
+ * Conventions:
+ *	- A model is an opaque handle created by one of the
+ *		abm_create functions and freed with abm_destroy
+ *	- Functions that can fail return NULL or a negative
+ *		value; abm_last_error then gives the message. No
+ *		exception crosses the interface.
+ *	- Daily series are contiguous int arrays owned by the
+ *		model. The pointer stays valid until the next call
+ *		to abm_step or abm_destroy, so the caller can wrap
+ *		it as a NumPy or MATLAB array without copying and
+ *		copy it only if it needs to keep it.
+ *	- Enumerations only get new values at the end, and
+ *		ABM_C_API_VERSION changes when a function changes.
+ *	- Different models can be used from different threads
+ *		at the same time; one model from one thread at a time.
+ *
+ *****************************************************/
+
+#define ABM_C_API_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Opaque model
+typedef struct abm_model abm_model;
+
+/// Paths of the input files, as used by the executable
+typedef struct abm_input_files{
+	const char* infection_parameters;
+	// Age-dependent distributions
+	const char* exposed_never_symptomatic;
+	const char* hospitalization;
+	const char* icu;
+	const char* mortality;
+	// Testing changes with time
+	const char* testing;
+	// Places
+	const char* households;
+	const char* schools;
+	const char* workplaces;
+	const char* hospitals;
+	const char* retirement_homes;
+	const char* agents;
+} abm_input_files;
+
+/// Counters of the model, current state and totals
+typedef enum abm_counter{
+	ABM_NUM_INFECTED,
+	ABM_NUM_EXPOSED,
+	ABM_NUM_ACTIVE_CASES,
+	ABM_TOTAL_INFECTED,
+	ABM_TOTAL_DEAD,
+	ABM_TESTED_DEAD,
+	ABM_NOT_TESTED_DEAD,
+	ABM_TOTAL_RECOVERED,
+	ABM_TOTAL_TESTED,
+	ABM_TOTAL_TESTED_POSITIVE,
+	ABM_TOTAL_TESTED_NEGATIVE,
+	ABM_TOTAL_TESTED_FALSE_POSITIVE,
+	ABM_TOTAL_TESTED_FALSE_NEGATIVE,
+	ABM_TOTAL_VACCINATED
+} abm_counter;
+
+/// Daily series, one entry per time step
+typedef enum abm_series{
+	ABM_INFECTED_DAY,
+	ABM_TESTED_DAY,
+	ABM_TESTED_POSITIVE_DAY,
+	ABM_TESTED_NEGATIVE_DAY,
+	ABM_TESTED_FALSE_POSITIVE_DAY,
+	ABM_TESTED_FALSE_NEGATIVE_DAY,
+	ABM_VACCINATED_DAY
+} abm_series;
+
+/// Version of the interface of the library, ABM_C_API_VERSION it was built with
+int abm_api_version(void);
+
+/**
+ * \brief Message of the last error in the calling thread
+ * \details Empty string if there was no error; valid until
+ *		the next failing call in the same thread
+ */
+const char* abm_last_error(void);
+
+//
+// Creation
+//
+
+/**
+ * \brief Create a model from the input files
+ * @param dt - time step, days
+ * @param files - paths of all the input files
+ * @param n_infected - number of initially infected chosen at random,
+ *		0 to use the ones in the agents file
+ * @param seed - seed of the random number generators, also used 
+ *		for the initially infected and their properties
+ * @return New model or NULL on error
+ */
+abm_model* abm_create(double dt, const abm_input_files* files, int n_infected, unsigned seed);
+
+/**
+ * \brief Create a model from a published population segment file
+ * \details The file is only read during the call
+ * @param dt - time step, days
+ * @param fname - path of the segment
+ * @param n_infected - number of initially infected chosen at random,
+ *		0 to use the published ones
+ * @param seed - seed of the random number generators
+ * @return New model or NULL on error
+ */
+abm_model* abm_create_from_segment(double dt, const char* fname, int n_infected, unsigned seed);
+
+/**
+ * \brief Create a model from the contents of a population segment in memory
+ * \details The buffer is only read during the call and can be 
+ *		freed or reused afterwards
+ * @param dt - time step, days
+ * @param buffer - contents of a segment file, aligned to 8 bytes
+ * @param size - size of the buffer in bytes
+ * @param n_infected - number of initially infected chosen at random,
+ *		0 to use the published ones
+ * @param seed - seed of the random number generators
+ * @return New model or NULL on error
+ */
+abm_model* abm_create_from_buffer(double dt, const void* buffer, size_t size, int n_infected, unsigned seed);
+
+/// Free a model, no effect for NULL
+void abm_destroy(abm_model* model);
+
+//
+// Simulation
+//
+
+/// Seed the random number generators again, 0 on success, -1 on error
+int abm_set_random_seed(abm_model* model, unsigned seed);
+
+/**
+ * \brief Advance the model by a number of time steps
+ * @return 0 on success, -1 on error; the model should not be
+ *		stepped further after an error
+ */
+int abm_step(abm_model* model, int n_steps);
+
+//
+// Results
+//
+
+/// Current simulation time, days
+double abm_get_time(const abm_model* model);
+
+/// Value of a counter, -1 on error
+int abm_get_counter(const abm_model* model, abm_counter counter);
+
+/**
+ * \brief Pointer to the entries of a daily series
+ * \details Valid until the next abm_step or abm_destroy
+ * @param model - model
+ * @param series - series to retrieve
+ * @param length - set to the number of entries
+ * @return First entry, NULL on error or if empty
+ */
+const int* abm_get_series(const abm_model* model, abm_series series, size_t* length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
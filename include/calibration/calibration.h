@@ -0,0 +1,248 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include "../abm.h"
+#include "../parameter_sweep/work_stealing_pool.h"
+#include <functional>
+#include <limits>
+#include <mutex>
+
+/*****************************************************
+ * class: Calibration
+ *
+ * Fits infection parameters to observed data with
+ * simulations run in the same process
+ *
+ * A candidate is a set of values of the calibrated
+ * parameters. Its error is the weighted sum of squared
+ * differences between the observations and the model
+ * totals at the observation times, averaged over the
+ * replicates. Replicate r uses the same random seed for
+ * every candidate (common random numbers) and the
+ * replicates run in parallel on a thread pool.
+ *
+ * The error only grows during a simulation, so a 
+ * candidate is abandoned as soon as the sum over its
+ * replicates exceeds the bound given by the method, 
+ * e.g. the worst vertex in Nelder-Mead or the tolerance
+ * in ABC-SMC. Abandoned candidates have infinite error.
+ *
+ * Methods:
+ *	- Nelder-Mead simplex
+ *	- CMA-ES - evolution strategy with covariance 
+ *		matrix adaptation, without abandoning
+ *	- ABC-SMC - approximate Bayesian computation with 
+ *		sequential Monte Carlo and uniform priors
+ *
+ * Parameters are searched within their ranges; the 
+ * methods work in the unit hypercube mapped to them.
+ *
+ *****************************************************/
+
+class Calibration{
+public:
+
+	/// Model totals that can be compared with observations
+	enum quantity_type { total_infected, total_dead, total_recovered, total_tested, 
+							total_tested_positive, active_infected };
+
+	/// Observed value at a time
+	struct Observation{
+		double time = 0.0;
+		double value = 0.0;
+	};
+
+	/// Evaluated set of parameters
+	struct Candidate{
+		// Values of the calibrated parameters, in order of addition
+		std::vector<double> parameters;
+		double error = 0.0;
+		// Normalized weight of an ABC-SMC particle
+		double weight = 1.0;
+	};
+
+	/**
+	 * \brief Errors of a batch of candidates
+	 * \details Each candidate is given as values of the calibrated 
+	 *		parameters with a bound; errors above the bound can be 
+	 *		returned as infinity
+	 */
+	typedef std::function<std::vector<double>(const std::vector<std::vector<double>>& candidates, 
+				const std::vector<double>& bounds)> batch_objective;
+
+	//
+	// Constructors
+	//
+
+	/**
+	 * \brief Creates a calibration against a model
+	 * \details Model needs to have all the places and agents
+	 *		created; it needs to exist and not be modified during
+	 *		the calibration
+	 * @param model - ABM object at the initial time
+	 */
+	explicit Calibration(const ABM& model);
+
+	//
+	// Setup
+	//
+
+	/**
+	 * \brief Add a parameter to calibrate
+	 * \details Throws std::invalid_argument if the name is not one 
+	 *		of the infection parameters or min_value >= max_value
+	 * @param name - name of the infection parameter
+	 * @param min_value - lowest value
+	 * @param max_value - highest value
+	 */
+	void add_parameter(const std::string& name, const double min_value, const double max_value);
+
+	/**
+	 * \brief Add observations of a model quantity
+	 * \details Times cannot be negative; simulations run until
+	 *		the last observation of all the targets
+	 * @param quantity - model total compared with the observations
+	 * @param observations - observed values
+	 * @param weight - weight of this target in the error 
+	 */
+	void add_target(const quantity_type quantity, const std::vector<Observation>& observations, 
+						const double weight = 1.0);
+
+	/**
+	 * \brief Read observations from columns of a text file
+	 * \details Lines where the two columns are not numbers, like 
+	 *		headers or missing values, are skipped
+	 * @param fname - name of the file, whitespace delimited
+	 * @param time_column - column with times, starting with 0
+	 * @param value_column - column with values
+	 * @param time_shift - added to the times, e.g. start of the data in the model 
+	 */
+	static std::vector<Observation> load_observations(const std::string& fname, 
+			const int time_column, const int value_column, const double time_shift = 0.0);
+
+	/// Number of simulations per candidate
+	void set_replicates(const int n);
+	/// Seed of the replicates and of the methods
+	void set_seed(const unsigned seed) { calibration_seed = seed; }
+	/// Number of threads for the simulations
+	void set_number_of_threads(const int n);
+	/// Replace the simulations with another objective, e.g. for testing of the methods 
+	void set_objective(const batch_objective& objective) { custom_objective = objective; }
+
+	//
+	// Evaluation
+	//
+
+	/**
+	 * \brief Error of one candidate
+	 * @param parameters - values of the calibrated parameters
+	 * @param bound - candidate is abandoned above this error 
+	 * @return Error averaged over replicates, infinity if abandoned
+	 */
+	double evaluate(const std::vector<double>& parameters, 
+				const double bound = std::numeric_limits<double>::infinity());
+
+	//
+	// Methods
+	//
+
+	/**
+	 * \brief Minimize the error with the Nelder-Mead method
+	 * @param start - initial values of the parameters
+	 * @param max_evaluations - maximum number of candidates evaluated
+	 * @param tol - stop when the simplex is smaller than this, in the unit hypercube
+	 * @return Best candidate
+	 */
+	Candidate nelder_mead(const std::vector<double>& start, const int max_evaluations, 
+							const double tol = 1e-6);
+
+	/**
+	 * \brief Minimize the error with CMA-ES
+	 * @param start - initial mean of the search distribution
+	 * @param sigma - initial step size, relative to the ranges
+	 * @param max_evaluations - maximum number of candidates evaluated
+	 * @return Best candidate
+	 */
+	Candidate cma_es(const std::vector<double>& start, const double sigma, const int max_evaluations);
+
+	/**
+	 * \brief Sample the approximate posterior with ABC-SMC
+	 * \details Tolerance of each generation is a quantile of the errors 
+	 *		accepted in the previous one. Throws std::runtime_error if 
+	 *		more than max_evaluations candidates are needed.
+	 * @param n_particles - number of accepted particles in each generation
+	 * @param n_generations - number of generations after the first 
+	 * @param quantile - fraction of errors below the next tolerance
+	 * @param max_evaluations - maximum number of candidates evaluated
+	 * @return Weighted particles of the last generation
+	 */
+	std::vector<Candidate> abc_smc(const int n_particles, const int n_generations, 
+							const double quantile, const int max_evaluations);
+
+	//
+	// Getters
+	//
+
+	/// Names of the calibrated parameters
+	const std::vector<std::string>& get_parameter_names() const { return names; }
+	/// Number of candidates evaluated
+	int get_number_of_evaluations() const { return n_evaluations; }
+	/// Number of candidates abandoned before the end of their simulations
+	int get_number_abandoned() const { return n_abandoned; }
+	/// Tolerances of the ABC-SMC generations
+	const std::vector<double>& get_tolerances() const { return tolerances; }
+	/// Seed of replicate r, same for all the candidates
+	unsigned replicate_seed(const int r) const;
+
+private:
+	// Weighted observation of a quantity
+	struct WeightedObservation{
+		double time = 0.0;
+		double value = 0.0;
+		quantity_type quantity = total_infected;
+		double weight = 1.0;
+	};
+
+	// Model shared by all the simulations
+	const ABM& base;
+	int n_replicates = 1;
+	int n_threads = 1;
+	unsigned calibration_seed = 2021;
+	batch_objective custom_objective;
+
+	// Calibrated parameters and their ranges
+	std::vector<std::string> names;
+	std::vector<std::pair<double, double>> ranges;
+
+	// Observations of all the targets ordered by time
+	std::vector<WeightedObservation> observed;
+
+	int n_evaluations = 0;
+	int n_abandoned = 0;
+	std::vector<double> tolerances;
+
+	/// Errors of a batch of candidates given in the unit hypercube
+	std::vector<double> evaluate_batch(const std::vector<std::vector<double>>& points, 
+						const std::vector<double>& bounds);
+	/// Errors from simulations, averaged over replicates
+	std::vector<double> simulate_batch(const std::vector<std::vector<double>>& candidates, 
+						const std::vector<double>& bounds);
+	/**
+	 * \brief Add the squared errors of one simulation to a sum shared by the replicates
+	 * \details Stops when the shared sum exceeds the bound or another replicate has
+	 *		already abandoned the candidate
+	 */
+	void simulate(const std::map<std::string, double>& values, const int replicate, 
+						const double bound, double& shared_sum, char& abandoned, std::mutex& mtx) const;
+
+	/// Current value of a model quantity
+	static double model_value(const ABM& abm, const quantity_type quantity);
+
+	/// Parameter values of a point in the unit hypercube and back
+	std::vector<double> from_unit(const std::vector<double>& point) const;
+	std::vector<double> to_unit(const std::vector<double>& values) const;
+	/// Check the number of values and that there are targets
+	void check_setup(const std::vector<double>& values) const;
+};
+
+#endif
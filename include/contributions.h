@@ -19,6 +19,7 @@
 #include "common.h"
 #include "agent.h"
 #include "flu.h"
+#include "model_features.h"
 
 /***************************************************** 
  * class: Contributions
@@ -45,10 +46,12 @@ public:
 	
 	/** 
 	 * \brief Count contributions of an exposed agent
+	 * \details Branches of the features disabled in Features are removed
 	 * @param agent - reference to Agent object
 	 * @param time - current time
 	 * @param households... - references to vectors of places 
 	 */
+	template <typename Features = BuildFeatures>
 	void compute_exposed_contributions(const Agent& agent, const double time,	
 					std::vector<Household>& households, std::vector<School>& schools,
 					std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
@@ -56,10 +59,12 @@ public:
 
 	/** 
 	 * \brief Count contributions of a symptomatic agent
+	 * \details Branches of the features disabled in Features are removed
 	 * @param agent - reference to Agent object
 	 * @param time -  current time
 	 * @param households... - references to vectors of places
 	 */
+	template <typename Features = BuildFeatures>
 	void compute_symptomatic_contributions(const Agent& agent, const double time,	
 					std::vector<Household>& households, std::vector<School>& schools,
 					std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
@@ -82,6 +87,7 @@ private:
 	//
 	
 	/// \brief Count contributions of a untreated and not tested symptomatic agent
+	template <typename Features>
 	void compute_regular_symptomatic_contributions(const Agent& agent,  
 				const double inf_var, std::vector<Household>& households, 
 				std::vector<School>& schools, std::vector<Workplace>& workplaces,
@@ -92,6 +98,7 @@ private:
 				const double inf_var, std::vector<Hospital>& hospitals);   
 
 	/// \brief Count contributions of a home-isolated agent 
+	template <typename Features>
 	void compute_home_isolated_contributions(const Agent& agent, 
 				const double inf_vari, std::vector<Household>& households,
 				std::vector<RetirementHome>& retirement_homes);
@@ -0,0 +1,54 @@
+#ifndef COMMUNICATOR_H
+#define COMMUNICATOR_H
+
+#include "../common.h"
+
+/*****************************************************
+ * class: Communicator
+ *
+ * Interface for message passing between processes
+ * of a distributed simulation
+ *
+ * All the operations are collective - every process
+ * calls them in the same order and with vectors of
+ * the same size
+ *
+ *****************************************************/
+
+class Communicator{
+public:
+
+	/// Index of this process, 0 to size()-1
+	virtual int rank() const = 0;
+
+	/// Total number of processes
+	virtual int size() const = 0;
+
+	/**
+	 * \brief Element-wise sum over all processes
+	 * \details Result is stored in values on every process
+	 * @param values - local values, overwritten with the sums
+	 */
+	virtual void allreduce_sum(std::vector<double>& values) = 0;
+
+	/**
+	 * \brief Element-wise sum over all processes
+	 * \details Result is stored in values on every process
+	 * @param values - local values, overwritten with the sums
+	 */
+	virtual void allreduce_sum(std::vector<int>& values) = 0;
+
+	/**
+	 * \brief Element-wise sum over all processes collected at rank 0
+	 * \details Values on other processes are not modified
+	 * @param values - local values, overwritten with the sums on rank 0
+	 */
+	virtual void reduce_sum(std::vector<int>& values) = 0;
+
+	/// Wait until all the processes reach this point
+	virtual void barrier() = 0;
+
+	virtual ~Communicator() = default;
+};
+
+#endif
@@ -0,0 +1,223 @@
+#ifndef DISTRIBUTED_ABM_H
+#define DISTRIBUTED_ABM_H
+
+#include "../abm.h"
+#include "communicator.h"
+#include "population_partitioner.h"
+#include "numa_topology.h"
+
+/*****************************************************
+ * class: DistributedABM
+ *
+ * Divides the work of the time steps of an ABM
+ * simulation between processes
+ *
+ * This is parallel execution of a population that
+ * already fits in the memory of one process, not a way
+ * to run larger ones. Every process holds a complete
+ * copy of the model, i.e. all the agents and places,
+ * and updates only the agents assigned to it by the
+ * partition. Agent and place storage is not divided
+ * between the processes, so a run needs as much memory
+ * per process as a single process run; populations
+ * that do not fit on one machine, e.g. of a whole
+ * state, cannot be simulated with it.
+ *
+ * Places with all their members on one process are
+ * computed by that process alone. Sums of the places
+ * shared between processes, and numbers of tested in
+ * hospitals, are added up in a single exchange per
+ * step, after which every process computes the same
+ * contributions of the shared places.
+ *
+ * On machines with several memory nodes each process
+ * can be pinned to the node of its rank. Its agents and
+ * households, copied from the parent process on the
+ * first write, are then stored on that node.
+ *
+ * Apart from the getters of local objects, all the
+ * functions are collective - every process needs
+ * to call them in the same order.
+ *
+ *****************************************************/
+
+class DistributedABM{
+public:
+
+	/**
+	 * \brief Sets up a distributed run of an ABM
+	 * \details ABM needs to have the places and agents already
+	 *		created; partition needs to have as many ranks as the
+	 *		communicator; the random number generators are restarted
+	 *		with a different seed on each process
+	 * @param model - ABM object of this process
+	 * @param communicator - message passing between the processes
+	 * @param partition - assignment of agents to processes
+	 * @param seed - seed of the whole run
+	 */
+	DistributedABM(ABM& model, Communicator& communicator,
+					const PopulationPartitioner& partition, const unsigned seed);
+
+	/**
+	 * \brief Sets up a distributed run with each process on a memory node
+	 * \details Same as the other constructor, but first pins the process
+	 *		to the node of its rank, then writes to its agents and their
+	 *		households so that their storage is copied to that node;
+	 *		meant for processes created with fork
+	 * @param model - ABM object of this process
+	 * @param communicator - message passing between the processes
+	 * @param partition - assignment of agents to processes
+	 * @param seed - seed of the whole run
+	 * @param topology - nodes and the node of each rank
+	 */
+	DistributedABM(ABM& model, Communicator& communicator,
+					const PopulationPartitioner& partition, const unsigned seed,
+					const NumaTopology& topology);
+
+	/**
+	 * \brief Set up vaccination of nv random agents activated with testing
+	 * \details Number of vaccinated is divided between the processes
+	 *		proportionally to their number of agents
+	 * @param nv - total number of vaccinated
+	 */
+	void set_random_vaccination(const int nv);
+
+	//
+	// Transmission of infection
+	//
+
+	/// \brief Transmit infection according to Infection model
+	void transmit_infection();
+
+	/// \brief Compute contributions of all places using agents of all processes
+	void compute_place_contributions();
+
+	//
+	// Getters - collective, totals are only valid on rank 0
+	//
+
+	int get_num_infected();
+	int get_num_exposed();
+	int get_num_active_cases();
+	std::vector<int> get_treatment_data();
+
+	int get_total_infected() { return sum_total(infected); }
+	int get_total_dead() { return sum_total(dead); }
+	int get_tested_dead() { return sum_total(tested_dead); }
+	int get_not_tested_dead() { return sum_total(not_tested_dead); }
+	int get_total_recovered() { return sum_total(recovered); }
+	int get_tot_recovering_exposed() { return sum_total(recovering_exposed); }
+
+	int get_total_tested() { return sum_total(tested); }
+	int get_total_tested_positive() { return sum_total(tested_positive); }
+	int get_total_tested_negative() { return sum_total(tested_negative); }
+	int get_total_tested_false_positive() { return sum_total(tested_false_positive); }
+	int get_total_tested_false_negative() { return sum_total(tested_false_negative); }
+
+	std::vector<int> get_infected_day() { return sum_series(abm.get_infected_day()); }
+	std::vector<int> get_dead_day() { return sum_series(abm.get_dead_day()); }
+	std::vector<int> get_recovered_day() { return sum_series(abm.get_recovered_day()); }
+	std::vector<int> get_tested_day() { return sum_series(abm.get_tested_day()); }
+	std::vector<int> get_tested_positive_day() { return sum_series(abm.get_tested_positive_day()); }
+	std::vector<int> get_tested_negative_day() { return sum_series(abm.get_tested_negative_day()); }
+	std::vector<int> get_tested_false_positive_day() { return sum_series(abm.get_tested_false_positive_day()); }
+	std::vector<int> get_tested_false_negative_day() { return sum_series(abm.get_tested_false_negative_day()); }
+	std::vector<int> get_vaccinated_day() { return sum_series(abm.get_vaccinated_day()); }
+
+	//
+	// Getters - local
+	//
+
+	double get_time() const { return abm.get_time(); }
+	int get_rank() const { return comm.rank(); }
+	/// Number of agents processed by this process
+	int get_number_of_local_agents() const { return n_local_agents; }
+	/// ABM object of this process
+	ABM& get_abm() { return abm; }
+	/// Memory node of this process, -1 if not assigned
+	int get_node() const { return node; }
+	/// True if the process is restricted to the CPUs of its node
+	bool is_pinned() const { return pinned; }
+	/// Number of places with contributions exchanged between processes
+	int get_number_of_shared_places() const;
+
+private:
+	ABM& abm;
+	Communicator& comm;
+
+	// Number of agents of this process and of all
+	// processes with lower ranks
+	int n_local_agents = 0;
+	int n_agents_before = 0;
+	int n_agents_total = 0;
+
+	// Memory node of this process
+	int node = -1;
+	bool pinned = false;
+
+	// Indices of places of one type exchanged between
+	// processes and of the ones computed by this process
+	struct PlaceExchange{
+		std::vector<int> shared;
+		std::vector<int> local;
+		// Numbers of agents registered in shared places
+		// at the beginning; each process only updates
+		// the registration of its own agents
+		std::vector<int> initial_sizes;
+	};
+	PlaceExchange household_exchange;
+	PlaceExchange school_exchange;
+	PlaceExchange workplace_exchange;
+	PlaceExchange hospital_exchange;
+	PlaceExchange retirement_home_exchange;
+
+	// Totals collected by the ABM, in order of local_totals()
+	enum total_type { infected, dead, tested_dead, not_tested_dead, recovered, recovering_exposed, 
+						tested, tested_positive, tested_negative, tested_false_positive, 
+						tested_false_negative };
+	// Totals and length of the daily series at the beginning,
+	// identical on all processes and counted only once
+	std::vector<int> initial_totals;
+	std::size_t n_initial_steps = 0;
+
+	// Sums, numbers of infected, and numbers of registered
+	// agents of shared places, then the numbers of tested
+	// in hospitals; counts are exact as doubles
+	std::vector<double> exchanged;
+
+	/// Settings common to both constructors
+	void initialize(const PopulationPartitioner& partition, const unsigned seed);
+
+	/// Write to the agents of this process and their households
+	void touch_local_population(const PopulationPartitioner& partition);
+
+	/// Shared places and places of this process, resets the sums of the rest
+	template <typename T>
+	PlaceExchange split_places(std::vector<T>& places, const std::vector<int>& ranks);
+
+	/// Contributions of places with all members on this process
+	template <typename T>
+	void compute_local_contributions(std::vector<T>& places, const PlaceExchange& exchange);
+
+	/// Local sums and changes in registered agents of shared places
+	template <typename T>
+	void pack_contributions(const std::vector<T>& places, const PlaceExchange& exchange);
+
+	/// Set the total sums and compute contributions of shared places
+	template <typename T>
+	void unpack_contributions(std::vector<T>& places, const PlaceExchange& exchange, std::size_t& iv);
+
+	/// Sum over all processes, valid on rank 0
+	int sum_at_root(const int value);
+	/// Element-wise sum over all processes, valid on rank 0
+	std::vector<int> sum_at_root(std::vector<int> values);
+
+	/// Current totals of this process
+	std::vector<int> local_totals();
+	/// Total of a given type of all processes, valid on rank 0
+	int sum_total(const total_type which);
+	/// Daily series of all processes, valid on rank 0
+	std::vector<int> sum_series(std::vector<int> values);
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef LOCAL_COMMUNICATOR_H
+#define LOCAL_COMMUNICATOR_H
+
+#include "communicator.h"
+#include <memory>
+#include <sys/types.h>
+
+/*****************************************************
+ * class: LocalCommunicator
+ *
+ * Message passing between processes on a single node
+ *
+ * Processes are created with fork and connected to
+ * rank 0 with socket pairs (star topology); meant
+ * for testing of the distributed execution without
+ * an MPI installation
+ *
+ *****************************************************/
+
+class LocalCommunicator : public Communicator{
+public:
+
+	/**
+	 * \brief Create n_ranks processes and connect them
+	 * \details The calling process becomes rank 0, the other
+	 *		ranks are its forked copies that continue from this call;
+	 *		all objects created before the call are copied to every rank
+	 * @param n_ranks - total number of processes, at least 1
+	 * @return Communicator of the process that returns from this call
+	 */
+	static std::unique_ptr<LocalCommunicator> spawn(const int n_ranks);
+
+	/**
+	 * \brief End the distributed part of the run
+	 * \details Processes other than rank 0 exit here and do not
+	 *		return; rank 0 waits for them to finish
+	 * @return True if all the other processes exited normally
+	 */
+	bool finalize();
+
+	//
+	// Communication
+	//
+
+	int rank() const override { return my_rank; }
+	int size() const override { return n_procs; }
+
+	void allreduce_sum(std::vector<double>& values) override;
+	void allreduce_sum(std::vector<int>& values) override;
+	void reduce_sum(std::vector<int>& values) override;
+	void barrier() override;
+
+	~LocalCommunicator();
+
+private:
+	// Rank of this process and total number of processes
+	int my_rank = 0;
+	int n_procs = 1;
+	// On rank 0 - sockets connected to each other rank,
+	// index corresponds to rank; on other ranks only
+	// the first entry is used and connects to rank 0
+	std::vector<int> sockets;
+	// Process IDs of other ranks, rank 0 only
+	std::vector<pid_t> children;
+	// True after finalize on rank 0
+	bool finalized = false;
+
+	LocalCommunicator() = default;
+
+	/// Element-wise sum, result on rank 0, optionally sent back to every rank
+	template <typename T>
+	void sum_values(std::vector<T>& values, const bool to_all);
+
+	/// Send size bytes from data, throws if the connection is lost
+	void send_bytes(const int fd, const void* data, const std::size_t size);
+	/// Receive size bytes into data, throws if the connection is lost
+	void receive_bytes(const int fd, void* data, const std::size_t size);
+};
+
+#endif
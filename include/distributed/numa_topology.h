@@ -0,0 +1,91 @@
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include "../common.h"
+
+/*****************************************************
+ * class: NumaTopology
+ *
+ * Memory nodes of the machine, their CPUs, and the
+ * node assigned to each process of a distributed run
+ *
+ * Nodes are read from the Linux sysfs layout, i.e.
+ * directories node0, node1, ... each with a cpulist
+ * file; nodes without CPUs are skipped. If there is
+ * no such directory the machine is treated as a single
+ * node with all of its CPUs.
+ *
+ * By default processes are assigned to nodes in
+ * contiguous blocks of ranks. The partition also gives
+ * contiguous ranks neighbouring households and places,
+ * so each node processes one contiguous shard of the
+ * population.
+ *
+ *****************************************************/
+
+class NumaTopology{
+public:
+
+	/// Detects the nodes of this machine
+	NumaTopology() : NumaTopology("/sys/devices/system/node") { }
+
+	/**
+	 * \brief Reads the nodes from a directory with the sysfs layout
+	 * @param node_dir - directory with the node subdirectories
+	 */
+	explicit NumaTopology(const std::string& node_dir);
+
+	/**
+	 * \brief CPUs of a list in the sysfs format, e.g. "0-3,8,10-11"
+	 * \details Throws std::invalid_argument if the format is wrong
+	 */
+	static std::vector<int> parse_cpu_list(const std::string& list);
+
+	//
+	// Mapping of processes
+	//
+
+	/**
+	 * \brief Assign processes to nodes instead of the default blocks
+	 * \details Throws std::invalid_argument if a node does not exist
+	 * @param nodes - node of each rank, in rank order
+	 */
+	void set_rank_nodes(const std::vector<int>& nodes);
+
+	/**
+	 * \brief Node of a process
+	 * \details Throws std::invalid_argument if the nodes were set
+	 *		for a different number of processes
+	 * @param rank - rank of the process
+	 * @param n_ranks - total number of processes
+	 */
+	int get_rank_node(const int rank, const int n_ranks) const;
+
+	/**
+	 * \brief Restrict the calling thread to the CPUs of a node
+	 * \details Memory that the thread writes first afterwards is then
+	 *		allocated on that node by the operating system
+	 * @param node - index of the node
+	 * @return False if the operating system does not support it or refused
+	 */
+	bool pin_to_node(const int node) const;
+
+	//
+	// Getters
+	//
+
+	/// Number of nodes with CPUs
+	int get_number_of_nodes() const { return node_cpus.size(); }
+	/// True if there is more than one node
+	bool is_numa() const { return node_cpus.size() > 1; }
+	/// CPUs of a node
+	const std::vector<int>& get_cpus(const int node) const { return node_cpus.at(node); }
+
+private:
+	// CPUs of each node
+	std::vector<std::vector<int>> node_cpus;
+	// Node of each rank if set by the user
+	std::vector<int> rank_nodes;
+};
+
+#endif
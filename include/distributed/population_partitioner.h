@@ -0,0 +1,110 @@
+#ifndef POPULATION_PARTITIONER_H
+#define POPULATION_PARTITIONER_H
+
+#include "../abm.h"
+
+/*****************************************************
+ * class: PopulationPartitioner
+ *
+ * Divides agents of an ABM between processes
+ *
+ * Households, retirement home residents, and each
+ * non-COVID hospital patient are kept whole on one
+ * process. These units are ordered by the place most of
+ * their members attend during the day so that members
+ * of the same school or workplace are mostly on the
+ * same process, and then split into contiguous parts
+ * with similar number of agents. Places shared between
+ * processes are assigned an owner process.
+ *
+ * Membership of a place is fixed by the agents that
+ * can be registered in it, i.e. its residents, students,
+ * and employees. Places with all such agents on one
+ * process are not shared and need no communication.
+ * Hospitals are always shared since agents of any
+ * process can be tested or treated there.
+ *
+ *****************************************************/
+
+class PopulationPartitioner{
+public:
+
+	/**
+	 * \brief Creates a partition of the ABM population
+	 * @param abm - ABM object with created places and agents
+	 * @param n_ranks - number of processes, at least 1
+	 */
+	PopulationPartitioner(const ABM& abm, const int n_ranks);
+
+	//
+	// Getters
+	//
+
+	/// Number of processes
+	int get_number_of_ranks() const { return n_procs; }
+
+	/// Process of an agent
+	/// @param agent_ID - agent ID (starts with 1)
+	int get_agent_rank(const int agent_ID) const { return agent_ranks.at(agent_ID-1); }
+
+	/// Processes of all the agents in ID order
+	const std::vector<int>& get_agent_ranks() const { return agent_ranks; }
+
+	/// Flags of agents processed by a given process, in ID order
+	std::vector<bool> get_local_agents(const int rank) const;
+
+	/// Number of agents processed by each process
+	std::vector<int> get_number_of_agents_per_rank() const;
+
+	/// Owner processes of schools, in ID order
+	const std::vector<int>& get_school_owners() const { return school_owners; }
+	/// Owner processes of workplaces, in ID order
+	const std::vector<int>& get_workplace_owners() const { return workplace_owners; }
+	/// Owner processes of hospitals, in ID order
+	const std::vector<int>& get_hospital_owners() const { return hospital_owners; }
+	/// Owner processes of retirement homes, in ID order
+	const std::vector<int>& get_retirement_home_owners() const { return retirement_home_owners; }
+
+	/// Processes of the members of households, in ID order, -1 if shared
+	const std::vector<int>& get_household_ranks() const { return household_ranks; }
+	/// Processes of the members of schools, in ID order, -1 if shared
+	const std::vector<int>& get_school_ranks() const { return school_ranks; }
+	/// Processes of the members of workplaces, in ID order, -1 if shared
+	const std::vector<int>& get_workplace_ranks() const { return workplace_ranks; }
+	/// Processes of the members of retirement homes, in ID order, -1 if shared
+	const std::vector<int>& get_retirement_home_ranks() const { return retirement_home_ranks; }
+
+private:
+	// Number of processes
+	int n_procs = 1;
+	// Process of each agent, in ID order
+	std::vector<int> agent_ranks;
+	// Owners of shared places
+	std::vector<int> school_owners;
+	std::vector<int> workplace_owners;
+	std::vector<int> hospital_owners;
+	std::vector<int> retirement_home_owners;
+	// Process of the members of each place, -1 if
+	// on more than one, owner if there are none
+	std::vector<int> household_ranks;
+	std::vector<int> school_ranks;
+	std::vector<int> workplace_ranks;
+	std::vector<int> retirement_home_ranks;
+
+	// Place types used for ordering,
+	// households last
+	enum place_type { school, workplace, hospital, retirement_home, household };
+
+	/// Place an agent attends during the day, household if none
+	std::pair<int, int> daytime_place(const Agent& agent) const;
+
+	/// Rank with most registered agents in a place
+	template <typename T>
+	std::vector<int> find_owners(const std::vector<T>& places) const;
+
+	/// Process of the agents that can be registered in each place
+	std::vector<int> find_member_ranks(const std::vector<Agent>& agents, const place_type type,
+										const std::vector<int>& owners) const;
+};
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef SPLITTING_ENSEMBLE_H
+#define SPLITTING_ENSEMBLE_H
+
+#include "../abm.h"
+#include "../parameter_sweep/work_stealing_pool.h"
+#include <functional>
+
+/*****************************************************
+ * class: SplittingEnsemble
+ *
+ * Ensemble of weighted replicates that concentrates
+ * on rare outcomes by splitting and pruning
+ *
+ * All the replicates start from one ABM and run in
+ * segments of a fixed number of steps. At the end of
+ * each segment every replicate is scored and a new
+ * population of the same size is selected with
+ * probabilities proportional to
+ *		weight * exp(selection_strength * score),
+ * using systematic resampling. Promising replicates are
+ * split into clones, each continuing with a new random
+ * seed, and unpromising ones are removed. Each selected
+ * replicate gets the weight of its parent divided by
+ * the expected number of copies, so weighted sums over
+ * the final replicates are unbiased estimates of the
+ * ensemble averages. With selection strength 0 this is
+ * a regular ensemble.
+ *
+ * Clones are copies of the ABM made in parallel and
+ * replicates that are kept are moved, not copied. The
+ * number of replicates is constant, so every segment
+ * runs the same number of jobs on the thread pool.
+ * Results do not depend on the number of threads.
+ *
+ *****************************************************/
+
+class SplittingEnsemble{
+public:
+
+	/// Score of a replicate, higher is closer to the outcome of interest
+	typedef std::function<double(const ABM&)> score_function;
+
+	/// Running simulation with its importance weight
+	struct Replicate{
+		ABM abm;
+		double weight = 0.0;
+		// Highest score at any checkpoint and at the end
+		double max_score = 0.0;
+		// Initial replicate this one descends from
+		int origin = 0;
+	};
+
+	/// Selection at one checkpoint
+	struct Checkpoint{
+		int step = 0;
+		// Effective sample size before the selection
+		double ess = 0.0;
+		// Number of new clones and of removed replicates
+		int n_split = 0;
+		int n_removed = 0;
+		double max_score = 0.0;
+	};
+
+	//
+	// Constructors
+	//
+
+	/**
+	 * \brief Creates an ensemble from a model
+	 * \details Model needs to have all the places and agents
+	 *		created; it is copied and not modified
+	 * @param model - ABM object to start from
+	 * @param replicates - number of replicates, at least 1
+	 * @param steps - number of time steps of each replicate
+	 */
+	SplittingEnsemble(const ABM& model, const int replicates, const int steps);
+
+	//
+	// Setup
+	//
+
+	/**
+	 * \brief Score and selection of the replicates
+	 * @param score - score of a replicate
+	 * @param interval - number of steps between checkpoints
+	 * @param selection_strength - 0 for no selection, higher to
+	 *		favor high scores more strongly
+	 */
+	void set_selection(const score_function& score, const int interval, 
+							const double selection_strength);
+
+	/// Seed of the whole ensemble
+	void set_seed(const unsigned seed) { ensemble_seed = seed; }
+
+	//
+	// Execution
+	//
+
+	/**
+	 * \brief Run all the replicates
+	 * \details Replicates and checkpoints replace those of a previous run
+	 * @param n_threads - number of threads, at least 1
+	 */
+	void run(const int n_threads);
+
+	//
+	// Estimates
+	//
+
+	/// Weighted sum of a quantity over the final replicates
+	double estimate(const std::function<double(const Replicate&)>& quantity) const;
+
+	/// Estimated probability that the score reached the threshold
+	double exceedance_probability(const double threshold) const;
+
+	//
+	// Getters
+	//
+
+	/// Replicates at the end of the run
+	const std::vector<Replicate>& get_replicates() const { return replicates; }
+	/// Selection steps of the run
+	const std::vector<Checkpoint>& get_checkpoints() const { return checkpoints; }
+	/// Seed of a replicate started or cloned at a checkpoint, 0 for the start
+	unsigned replicate_seed(const int checkpoint, const int replicate) const;
+
+private:
+	// Model copied by all the replicates
+	const ABM base;
+	int n_replicates = 1;
+	int n_steps = 0;
+	unsigned ensemble_seed = 2021;
+
+	// Selection
+	score_function score;
+	int interval = 0;
+	double strength = 0.0;
+
+	std::vector<Replicate> replicates;
+	std::vector<Checkpoint> checkpoints;
+
+	/// Number of copies of each replicate from systematic resampling
+	std::vector<int> copies(const std::vector<double>& probabilities, const double u) const;
+	/// Replace the replicates with the selected ones
+	void select(WorkStealingPool& pool, std::mt19937& engine, const std::vector<double>& scores);
+};
+
+#endif
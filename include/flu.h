@@ -32,6 +32,9 @@ public:
 	/// \brief Specifies the offset in days for the time Flu agents can be tested
 	void set_testing_duration(const double dt) { testing_period = dt; }
 
+	/// \brief Restart the random number generator from a given seed
+	void set_rng_seed(const unsigned seed) { rng.set_seed(seed); }
+
 	//
 	//	Flu computations and agent management 
 	//
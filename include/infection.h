@@ -5,6 +5,7 @@
 #include "rng.h"
 #include "utils.h"
 #include <tuple>
+#include <limits>
 
 class RNG;
 
@@ -43,6 +44,65 @@ public:
 	/// @param lambda - probability factor
 	bool infected(const double lambda);
 
+	/**
+	 * \brief Compute which agents in a batch got infected
+	 * \details Equivalent to calling infected() for each entry; draws
+	 *		all the random numbers at once and evaluates the probabilities
+	 *		in a loop the compiler can vectorize 
+	 * @param lambdas - probability factors of all the agents in the batch
+	 * @param infected_indices - positions in lambdas that got infected, overwritten
+	 */
+	void infected_batch(const std::vector<double>& lambdas, std::vector<int>& infected_indices);
+
+	/**
+	 * \brief Sample members of a place exposed to its infection contribution
+	 * \details Each member is exposed with probability 1-exp(-dt*lambda);
+	 *		uses geometric skipping so the cost is proportional to the 
+	 *		number of exposed rather than the number of members 
+	 * @param lambda - infection contribution of the place
+	 * @param n_members - number of agents registered in the place 
+	 * @param exposed - positions of the exposed in the place, overwritten 
+	 */
+	void sample_place_exposures(const double lambda, const int n_members, std::vector<int>& exposed);
+
+	/**
+	 * \brief Confirm an exposure when only part of the contribution applies 
+	 * \details Thinning of an exposure from sample_place_exposures, for agents
+	 *		registered in a place more times than the place counts towards 
+	 *		their lambda; result is as if the agent was exposed to fraction*lambda
+	 * @param lambda - infection contribution of the place
+	 * @param fraction - fraction of lambda the agent is exposed to, 0 < fraction <= 1 
+	 */
+	bool confirm_exposure(const double lambda, const double fraction);
+
+	/**
+	 * \brief Time until the next exposure in continuous time
+	 * \details Exposures are a Poisson process with the given total rate;
+	 *		returns infinity if the rate is not positive
+	 * @param total_rate - sum of the exposure rates of all places, 1/time
+	 */
+	double time_to_exposure(const double total_rate);
+
+	/**
+	 * \brief Select an entry with probability proportional to its rate
+	 * @param rates - non-negative rates, at least one positive
+	 * @param total_rate - sum of the rates
+	 * @return Position of the selected entry
+	 */
+	int select_by_rate(const std::vector<double>& rates, const double total_rate);
+
+	/// \brief Position of a random member of a place with n_members agents, starts with 0
+	int get_random_member(const int n_members)
+		{ return rng.get_random_int(0, n_members - 1); }
+
+	/**
+	 * \brief Accept an exposure when only part of the rate applies
+	 * \details Thinning in continuous time - the exposure is accepted
+	 *		with probability fraction
+	 * @param fraction - fraction of the rate the agent is exposed to, 0 < fraction <= 1
+	 */
+	bool accept_exposure(const double fraction);
+
 	/// \brief Get latency period from a distribution
 	double latency();
 
@@ -99,13 +159,17 @@ public:
 	double wait_time_for_test(double t_max);
 
 	/// Randomly shuffles a vector of ints
-	void vector_shuffle(std::vector<int>& v) 
+	template <typename Alloc>
+	void vector_shuffle(std::vector<int, Alloc>& v) 
 		{ rng.vector_shuffle(v); }
 		
 	//
 	// Setters
 	//
 
+	/// Restart the random number generator from a given seed
+	void set_rng_seed(const unsigned seed) { rng.set_seed(seed); }
+
 	void set_latency_distribution(const double mean, const double std)
 		{ ln_mean_lat = mean; ln_std_lat = std; }
 
@@ -230,6 +294,10 @@ protected:
 
 	// Random distribution generator
 	RNG rng;
+
+	// Work buffers for batched infection draws
+	std::vector<double> batch_uniforms;
+	std::vector<double> batch_probs;
 	
 	//
 	// Age-dependent distributions
@@ -0,0 +1,112 @@
+#ifndef INTERVENTIONS_H
+#define INTERVENTIONS_H
+
+#include "common.h"
+#include "step_time.h"
+
+/*****************************************************
+ * class: Interventions
+ *
+ * Timeline of interventions sorted by time
+ *
+ * Each intervention applies one action to a range of
+ * places of one type or to the population. Checking
+ * for due interventions costs O(1) per step when none
+ * is due.
+ *
+ * File format, one intervention per line, lines
+ * starting with // are comments:
+ *	time target action value [first_ID last_ID]
+ *	- target: households, schools, workplaces, population
+ *	- action:
+ *		transmission - transmission rate multiplied by
+ *			value, relative to the input parameters
+ *		employee_transmission - same for school employees
+ *		absenteeism - absenteeism correction of workplaces
+ *		closure - transmission rates set to 0
+ *		vaccination - value random agents vaccinated,
+ *			target population only
+ *	- first_ID, last_ID - optional inclusive range of
+ *		place IDs from the input files, all places of
+ *		the type if not given
+ *
+ *****************************************************/
+
+class Interventions{
+public:
+
+	/// Places or agents an intervention applies to
+	enum target_type { households, schools, workplaces, population };
+	/// Change made by an intervention
+	enum action_type { transmission, employee_transmission, absenteeism, closure, vaccination };
+
+	struct Intervention{
+		double time = 0.0;
+		target_type target = population;
+		action_type action = transmission;
+		double value = 0.0;
+		// First place ID from the input files minus one
+		// and the last ID; both 0 for all places
+		int first = 0;
+		int last = 0;
+	};
+
+	//
+	// Constructors
+	//
+
+	/// Creates an empty timeline
+	Interventions() = default;
+
+	//
+	// Setup
+	//
+
+	/**
+	 * \brief Add an intervention to the timeline
+	 * \details Interventions with equal times are applied
+	 *		in the order they were added
+	 */
+	void add(const Intervention& intervention);
+
+	/**
+	 * \brief Add interventions from a file
+	 * \details Throws std::invalid_argument for a wrong format,
+	 *		target, action, or a combination of the two
+	 * @param fname - name of the file
+	 */
+	void load(const std::string& fname);
+
+	/// Remove all the interventions
+	void clear() { events.clear(); next_event = 0; }
+
+	//
+	// Timeline
+	//
+
+	/**
+	 * \brief Next intervention due at this time
+	 * \details Interventions with earlier times that were
+	 *		not due at any step are skipped
+	 * @param time - current simulation time
+	 * @param intervention - due intervention, unchanged if none
+	 * @return True if an intervention was due
+	 */
+	bool next_due(const double time, Intervention& intervention);
+
+	//
+	// Getters
+	//
+
+	/// All the interventions, sorted by time
+	const std::vector<Intervention>& get_interventions() const { return events; }
+	/// Number of interventions not applied yet
+	int get_number_remaining() const { return events.size() - next_event; }
+
+private:
+	std::vector<Intervention> events;
+	// Position of the next intervention to apply
+	std::size_t next_event = 0;
+};
+
+#endif
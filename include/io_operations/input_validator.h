@@ -0,0 +1,161 @@
+#ifndef INPUT_VALIDATOR_H
+#define INPUT_VALIDATOR_H
+
+#include "../common.h"
+#include "../shared_population/population_segment.h"
+#include <cstdint>
+#include <functional>
+
+/*****************************************************
+ * Input validation
+ *
+ * Consistency checks of a population before its agents
+ * are registered in places, the same as in
+ * scripts/input_check.py:
+ *	- value range - flags are 0 or 1, ages not negative
+ *	- place reference - household, school, work, and
+ *		hospital IDs refer to existing places, and
+ *		place IDs are continuous starting with 1
+ *	- role flags - place IDs are set only for agents
+ *		with the corresponding role, and employee types
+ *		are consistent with working
+ *	- coordinates - finite and, if bounds are set,
+ *		within them
+ *
+ * Agents are checked on their parsed integer columns,
+ * in the layout of PopulationSegment::agent_column,
+ * split into chunks processed as independent tasks by
+ * an executor, serially by default. All inconsistencies
+ * are collected in one report.
+ *
+ *****************************************************/
+
+/// Result of a validation
+class InputReport{
+public:
+
+	/// Categories of checks
+	enum check_type { value_range, place_reference, role_flags, coordinates, n_checks };
+
+	/// One inconsistency in the input
+	struct Error{
+		check_type check;
+		// Type of objects, e.g. "agents" or "schools"
+		std::string input;
+		// ID of the object, same as its line in the input file
+		int ID;
+		std::string message;
+	};
+
+	/// True if no inconsistencies were found
+	bool passed() const { return errors.empty(); }
+	/// All the inconsistencies, agents in order of IDs
+	const std::vector<Error>& get_errors() const { return errors; }
+	/// Number of inconsistencies of one category
+	int count(const check_type check) const;
+
+	/// Number of students, workers, and infected as in the input, for comparison with the expected
+	int get_students() const { return n_students; }
+	int get_workers() const { return n_workers; }
+	int get_infected() const { return n_infected; }
+
+	/**
+	 * \brief Readable summary
+	 * \details Number of inconsistencies of each category,
+	 *		then the first max_errors of them, one per line
+	 * @param max_errors - maximum number of listed inconsistencies
+	 */
+	std::string summary(const int max_errors = 20) const;
+
+	/// Name of a category
+	static std::string check_name(const check_type check);
+
+private:
+	std::vector<Error> errors;
+	int n_students = 0;
+	int n_workers = 0;
+	int n_infected = 0;
+
+	friend class InputValidator;
+};
+
+/*****************************************************
+ * class: InputValidator
+ *
+ * Parallel consistency checks of a population
+ *
+ *****************************************************/
+
+class InputValidator{
+public:
+
+	/// Runs task(i) for i from 0 to n_tasks-1, e.g. on a thread pool
+	typedef std::function<void(int n_tasks, const std::function<void(int)>& task)> executor;
+
+	//
+	// Setup
+	//
+
+	/// Executor of the tasks, one task per chunk of agents
+	void set_executor(const executor& exec) { run_tasks = exec; }
+
+	/// Number of agents checked by one task
+	void set_chunk_size(const int n);
+
+	/**
+	 * \brief Limits of the coordinates of agents and places
+	 * \details Without them coordinates only need to be finite
+	 */
+	void set_bounds(const double xmin, const double xmax, const double ymin, const double ymax);
+
+	/**
+	 * \brief Places of one type
+	 * @param type - type of the places
+	 * @param IDs - ID of each place in order of the input
+	 * @param x - x coordinate of each place
+	 * @param y - y coordinate of each place
+	 */
+	void set_places(const PopulationSegment::place_type type, const std::vector<int>& IDs,
+					const std::vector<double>& x, const std::vector<double>& y);
+
+	//
+	// Validation
+	//
+
+	/**
+	 * \brief Check the agents and all the places
+	 * \details Columns are not copied and need to stay valid
+	 *		during the call
+	 * @param n_agents - number of agents
+	 * @param values - integer attributes, one column of n_agents entries
+	 *		per PopulationSegment::agent_column, in that order
+	 * @param x - x coordinate of each agent
+	 * @param y - y coordinate of each agent
+	 */
+	InputReport validate(const int n_agents, const std::int32_t* values,
+							const double* x, const double* y) const;
+
+private:
+	executor run_tasks;
+	int chunk_size = 100000;
+
+	bool with_bounds = false;
+	double x_min = 0.0, x_max = 0.0;
+	double y_min = 0.0, y_max = 0.0;
+
+	// Places by type
+	std::vector<std::vector<int>> place_IDs = std::vector<std::vector<int>>(5);
+	std::vector<std::vector<double>> place_x = std::vector<std::vector<double>>(5);
+	std::vector<std::vector<double>> place_y = std::vector<std::vector<double>>(5);
+
+	/// Checks of the places of one type
+	void check_places(const PopulationSegment::place_type type, InputReport& report) const;
+	/// Checks of the agents with IDs first+1 to last
+	void check_agents(const int first, const int last, const int n_agents,
+						const std::int32_t* values, const double* x, const double* y,
+						InputReport& report) const;
+	/// True if coordinates are finite and within the bounds
+	bool valid_location(const double x, const double y) const;
+};
+
+#endif
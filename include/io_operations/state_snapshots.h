@@ -0,0 +1,178 @@
+#ifndef STATE_SNAPSHOTS_H
+#define STATE_SNAPSHOTS_H
+
+#include "../common.h"
+#include "../agent.h"
+#include <cstdint>
+
+class ABM;
+
+/*****************************************************
+ * State snapshots
+ *
+ * Stream of the states of all agents at every
+ * recorded step, e.g. for contact tracing analysis
+ *
+ * The state of an agent is the set of its state flags,
+ * packed into one 32-bit value. The stream stores all
+ * the states only at keyframes, written periodically,
+ * and in between only the agents whose state changed
+ * since the previous recorded step. The size of the
+ * output scales with the number of transitions, not
+ * with the population times the number of steps.
+ *
+ * Agents are identified by their IDs in the input
+ * files, also when the model reordered them for
+ * locality, so that streams of different runs of the
+ * same population can be compared.
+ *
+ * Binary file format, all integers 32-bit in the
+ * byte order of the machine that wrote it:
+ *	- "ABMSNAP1", number of agents, number of flags
+ *	- frames, each with the step, 0 for a keyframe
+ *		and 1 for changes, and the number of entries
+ *		- keyframe: state of every agent in order of IDs
+ *		- changes: agent ID and its new state
+ *
+ *****************************************************/
+
+namespace StateSnapshots{
+	/// Bits of the packed state of an agent
+	enum state_flag { infected, exposed, recovering_exposed, symptomatic,
+		symptomatic_non_covid, tested_covid_negative, tested_false_negative,
+		tested_false_positive, tested_covid_positive, tested, tested_exposed,
+		tested_in_car, tested_in_hospital, tested_awaiting_results,
+		tested_awaiting_test, treated, home_isolated, hospitalized,
+		hospitalized_ICU, will_be_hospitalized, will_be_in_ICU,
+		will_be_home_isolated, dying, recovering, removed, vaccinated,
+		n_flags };
+
+	/// Packed state flags of an agent
+	std::uint32_t pack(const Agent& agent);
+
+	/// True if the flag is set in a packed state
+	inline bool has(const std::uint32_t state, const state_flag flag)
+		{ return (state >> flag) & 1u; }
+}
+
+/*****************************************************
+ * class: SnapshotWriter
+ *
+ * Writes the stream of agent states of a simulation
+ *
+ *****************************************************/
+
+class SnapshotWriter{
+public:
+
+	/**
+	 * \brief Creates a stream in a new file
+	 * \details Throws std::runtime_error if the file cannot be
+	 *		opened and std::invalid_argument if the interval is
+	 *		less than 1
+	 * @param fname - name of the output file
+	 * @param keyframe_interval - number of recorded steps between
+	 *		keyframes, the first recorded step is always one
+	 */
+	SnapshotWriter(const std::string& fname, const int keyframe_interval);
+
+	/**
+	 * \brief Record the states of the agents at a step
+	 * \details The number of agents cannot change; throws
+	 *		std::invalid_argument if it does or if the step is
+	 *		not after the previous one
+	 * @param step - number of the time step
+	 * @param agents - all the agents of the model
+	 */
+	void record(const int step, const std::vector<Agent>& agents);
+
+	/**
+	 * \brief Record the states of the agents of a model at a step
+	 * \details Agents are written with their IDs from the input
+	 *		files; throws like the version with agents
+	 * @param step - number of the time step
+	 * @param abm - the model
+	 */
+	void record(const int step, const ABM& abm);
+
+	/// Number of agents written since the beginning, in keyframes and as changes
+	std::size_t get_entries_written() const { return n_entries; }
+
+private:
+	std::ofstream out;
+	int interval = 1;
+	// Recorded steps since the last keyframe
+	int since_keyframe = 0;
+	int last_step = -1;
+	std::size_t n_entries = 0;
+
+	// States at the previous recorded step and
+	// work buffer for the changes
+	std::vector<std::uint32_t> previous;
+	std::vector<std::uint32_t> changes;
+
+	/// Record the agents, external_ID gives the ID written for each
+	template <typename F>
+	void record_states(const int step, const std::vector<Agent>& agents, F external_ID);
+};
+
+/*****************************************************
+ * class: SnapshotReader
+ *
+ * States of all the agents at any recorded step
+ *
+ * Indexes the frames on opening; a state is then
+ * rebuilt from the closest preceding keyframe.
+ *
+ *****************************************************/
+
+class SnapshotReader{
+public:
+
+	/**
+	 * \brief Opens and indexes a stream
+	 * \details Throws std::runtime_error if the file cannot be
+	 *		read or is not a snapshot stream
+	 * @param fname - name of the file
+	 */
+	explicit SnapshotReader(const std::string& fname);
+
+	/// Number of agents
+	int get_n_agents() const { return n_agents; }
+	/// Steps that were recorded, in increasing order
+	const std::vector<int>& get_steps() const { return steps; }
+
+	/**
+	 * \brief Packed states of all agents at a step
+	 * \details Throws std::invalid_argument if the step was
+	 *		not recorded
+	 * @param step - recorded step
+	 * @return State of each agent, in order of IDs
+	 */
+	std::vector<std::uint32_t> states_at(const int step);
+
+	/**
+	 * \brief Agents whose state changed at a step
+	 * \details IDs and new states since the previous recorded step;
+	 *		empty for the first one
+	 * @param step - recorded step
+	 */
+	std::vector<std::pair<int, std::uint32_t>> changes_at(const int step);
+
+private:
+	std::ifstream in;
+	int n_agents = 0;
+
+	// Recorded steps, and for each the position of its
+	// frame and the position of its keyframe in steps
+	std::vector<int> steps;
+	std::vector<std::streamoff> offsets;
+	std::vector<int> keyframes;
+
+	/// Position in steps, throws if not recorded
+	int find_step(const int step) const;
+	/// Apply one frame to the states
+	void read_frame(const int is, std::vector<std::uint32_t>& states);
+};
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef LINEAGE_LOG_H
+#define LINEAGE_LOG_H
+
+#include "common.h"
+#include "rng.h"
+#include <cstdint>
+
+/*****************************************************
+ * class: LineageLog
+ *
+ * Record of where each infection happened
+ *
+ * A new infection is attributed to one of the places
+ * of the infected agent, or to spatial transmission,
+ * sampled in proportion to their shares of the total
+ * lambda of the agent. Records are appended to a
+ * preallocated buffer; logs of models that run on
+ * different threads or processes are merged at the end.
+ * Sampling uses its own random number generator, so
+ * recording does not change the simulation.
+ *
+ * Binary file format, all integers 32-bit in the
+ * byte order of the machine that wrote it:
+ *	- "ABMLINE1"
+ *	- number of records
+ *	- for each record: step, agent ID, setting, place ID
+ *
+ *****************************************************/
+
+class LineageLog{
+public:
+
+	/// Where an infection happened, places in the order of PopulationSegment::place_type
+	enum setting_type { households, retirement_homes, schools, workplaces, hospitals,
+						spatial, unknown, n_settings };
+
+	/// One infection
+	struct Record{
+		std::int32_t step;
+		std::int32_t agent_ID;
+		std::int32_t setting;
+		// 0 if not in a place
+		std::int32_t place_ID;
+	};
+
+	/// Possible source of an infection and its lambda
+	struct Source{
+		setting_type setting;
+		int place_ID;
+		double lambda;
+	};
+
+	//
+	// Constructors
+	//
+
+	/// Creates an empty log
+	LineageLog() = default;
+
+	/**
+	 * \brief Read a log saved with print_binary
+	 * \details Throws std::runtime_error if the file cannot be
+	 *		read or is not a lineage file
+	 * @param fname - name of the file
+	 */
+	static LineageLog read_binary(const std::string& fname);
+
+	/**
+	 * \brief Merge logs, e.g. of models that ran on different threads
+	 * \details Records are ordered by step, then by the position of
+	 *		the log, then as recorded
+	 * @param logs - logs to merge
+	 */
+	static LineageLog merge(const std::vector<const LineageLog*>& logs);
+
+	//
+	// Recording
+	//
+
+	/// Preallocate space for n records in total
+	void reserve(const std::size_t n) { records.reserve(n); }
+
+	/// Restart the random number generator
+	void set_rng_seed(const unsigned seed) { rng.set_seed(seed); }
+
+	/**
+	 * \brief Record an infection attributed to one of its sources
+	 * \details Source is sampled proportionally to the lambdas;
+	 *		the setting is unknown if all of them are 0
+	 * @param step - time step of the infection
+	 * @param agent_ID - ID of the infected agent
+	 * @param sources - possible sources
+	 * @param n_sources - number of the sources
+	 */
+	void record(const int step, const int agent_ID, const Source* sources, const int n_sources);
+
+	/// Remove all the records
+	void clear() { records.clear(); }
+
+	//
+	// Getters
+	//
+
+	/// All the records in order of recording
+	const std::vector<Record>& get_records() const { return records; }
+	/// Number of records
+	std::size_t size() const { return records.size(); }
+
+	//
+	// Summary statistics
+	//
+
+	/// Number of infections in each setting, indexed by setting_type
+	std::vector<int> infections_by_setting() const;
+
+	/**
+	 * \brief Reproduction number split by setting
+	 * \details Infections in each setting per agent that was a
+	 *		potential source, e.g. all the infected until the last
+	 *		recorded step; the sum over the settings is the mean
+	 *		number of infections caused by one agent
+	 * @param n_infectious - number of agents that were potential sources
+	 */
+	std::vector<double> reproduction_by_setting(const int n_infectious) const;
+
+	/**
+	 * \brief Secondary attack rate in households by household size
+	 * \details For households with at least one infected member,
+	 *		infections in the household divided by the number of
+	 *		other members, summed over households of each size
+	 * @param household_sizes - number of members of each household, by ID - 1
+	 * @param infected_households - household IDs with an infected member
+	 *		not in the log, e.g. the initially infected
+	 * @param agent_households - household ID of each agent by agent ID - 1,
+	 *		0 if not a member of a household
+	 * @return Attack rate for each household size with an infected member
+	 */
+	std::map<int, double> household_attack_rates(const std::vector<int>& household_sizes,
+						const std::vector<int>& agent_households,
+						const std::vector<int>& infected_households) const;
+
+	/// Name of a setting
+	static std::string setting_name(const setting_type setting);
+
+	//
+	// I/O
+	//
+
+	/**
+	 * \brief Save all the records in the binary format
+	 * @param fname - name of the output file
+	 */
+	void print_binary(const std::string& fname) const;
+
+private:
+	std::vector<Record> records;
+	RNG rng;
+};
+
+#endif
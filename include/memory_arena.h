@@ -0,0 +1,153 @@
+#ifndef MEMORY_ARENA_H
+#define MEMORY_ARENA_H
+
+#include "common.h"
+#include <cstddef>
+
+/*****************************************************
+ * class: MemoryArena
+ *
+ * Monotonic memory for short-lived objects
+ *
+ * Memory is taken from large blocks by moving a
+ * pointer and is never returned piece by piece; reset
+ * makes all of it available again while keeping the
+ * blocks, so an arena reset at the end of every time
+ * step stops allocating from the system once it has
+ * grown to the largest step. Blocks can be backed by
+ * huge pages where the operating system supports it;
+ * reserved huge pages are used if available, otherwise
+ * transparent ones are only advised and the system
+ * may still use regular pages.
+ *
+ * A copy of an arena starts empty with the same
+ * settings, so that objects holding one stay copyable;
+ * the memory of the original is not shared.
+ *
+ *****************************************************/
+
+class MemoryArena{
+public:
+
+	//
+	// Constructors
+	//
+
+	/**
+	 * \brief Creates an arena without any memory
+	 * @param block_bytes - minimum size of a block taken from the system
+	 * @param huge_pages - true to request blocks backed by huge pages
+	 */
+	explicit MemoryArena(const std::size_t block_bytes = 1 << 16, const bool huge_pages = false);
+
+	MemoryArena(const MemoryArena& other) : MemoryArena(other.block_bytes, other.huge_pages) { }
+	MemoryArena& operator=(const MemoryArena& other);
+	MemoryArena(MemoryArena&& other) noexcept;
+	MemoryArena& operator=(MemoryArena&& other) noexcept;
+	~MemoryArena() { release(); }
+
+	//
+	// Memory
+	//
+
+	/**
+	 * \brief Memory for bytes with a given alignment
+	 * \details Valid until the next reset or release
+	 * @param bytes - number of bytes
+	 * @param alignment - power of 2, at most the alignment of std::max_align_t
+	 */
+	void* allocate(const std::size_t bytes, const std::size_t alignment = alignof(std::max_align_t));
+
+	/// \brief Make all the memory available again, keeps the blocks
+	void reset();
+
+	/// \brief Return all the blocks to the system
+	void release();
+
+	//
+	// Statistics
+	//
+
+	/// Number of calls to allocate since construction
+	long get_number_of_allocations() const { return n_allocations; }
+	/// Number of blocks taken from the system since construction
+	long get_number_of_blocks_allocated() const { return n_system_allocations; }
+	/// Bytes in use since the last reset, including padding
+	std::size_t get_bytes_used() const { return bytes_used; }
+	/// Largest number of bytes in use at one time
+	std::size_t get_peak_bytes() const { return peak_bytes; }
+	/// Total size of the blocks held
+	std::size_t get_capacity() const;
+	/// True if huge pages were requested
+	bool requests_huge_pages() const { return huge_pages; }
+	/// True if at least one block is mapped with reserved huge pages or advised to use transparent ones
+	bool huge_pages_advised() const;
+
+private:
+	// Memory from the system
+	struct Block{
+		char* data;
+		std::size_t size;
+		// True if from mmap, false if from malloc
+		bool mapped;
+		// True if huge pages were reserved or advised
+		bool huge_advised;
+	};
+
+	std::size_t block_bytes = 1 << 16;
+	bool huge_pages = false;
+
+	std::vector<Block> blocks;
+	// Block currently used and the first free byte in it
+	std::size_t current = 0;
+	std::size_t offset = 0;
+
+	long n_allocations = 0;
+	long n_system_allocations = 0;
+	std::size_t bytes_used = 0;
+	std::size_t peak_bytes = 0;
+
+	/// Take a block of at least size bytes from the system
+	Block new_block(const std::size_t size);
+};
+
+/*****************************************************
+ * class: ArenaAllocator
+ *
+ * Standard library allocator that takes its memory
+ * from a MemoryArena; deallocation does nothing, the
+ * memory is reclaimed by resetting the arena
+ *
+ *****************************************************/
+
+template <typename T>
+class ArenaAllocator{
+public:
+	typedef T value_type;
+
+	explicit ArenaAllocator(MemoryArena& memory) : arena(&memory) { }
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.get_arena()) { }
+
+	T* allocate(const std::size_t n)
+		{ return static_cast<T*>(arena->allocate(n*sizeof(T), alignof(T))); }
+	void deallocate(T*, const std::size_t) { }
+
+	MemoryArena* get_arena() const { return arena; }
+
+private:
+	MemoryArena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+	{ return a.get_arena() == b.get_arena(); }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+	{ return !(a == b); }
+
+/// Vector with the memory of an arena
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef METAPOPULATION_ABM_H
+#define METAPOPULATION_ABM_H
+
+#include "../abm.h"
+#include "../parameter_sweep/work_stealing_pool.h"
+#include <memory>
+
+/*****************************************************
+ * class: MetapopulationABM
+ *
+ * Runs several communities, each an ABM with its own
+ * input files, coupled by commuters
+ *
+ * A commuter is registered in a school or workplace of
+ * its own community that mirrors a place of another
+ * community, the owner. The mirror is listed in the
+ * files of the commuter's community like any other
+ * place, and a link connects it to its owner. Every
+ * step the contribution sums of the owner and all its
+ * mirrors are added, the owner computes the infection
+ * contribution from the totals, and the mirrors copy
+ * it - the same exchange as between processes of a
+ * DistributedABM, but only for the linked places.
+ *
+ * Communities step in parallel, one task per community,
+ * except for the exchange. By default the tasks run on
+ * a WorkStealingPool with a thread per community.
+ *
+ * Links file format, one link per line:
+ *	community type place_ID owner_community owner_ID
+ * with type either "schools" or "workplaces"; lines
+ * starting with // are skipped.
+ *
+ *****************************************************/
+
+class MetapopulationABM{
+public:
+
+	/// Runs task(i) for i from 0 to n_tasks-1, e.g. on a thread pool
+	typedef std::function<void(int n_tasks, const std::function<void(int)>& task)> executor;
+
+	//
+	// Setup
+	//
+
+	/**
+	 * \brief Add a community
+	 * \details The ABM needs to have its places and agents created.
+	 *		Throws std::invalid_argument if the name is empty or
+	 *		already used, if the model uses spatial transmission, or
+	 *		if its time step or time differ from the other communities.
+	 * @param name - name of the community, used in the outputs
+	 * @param model - model of the community
+	 * @return Index of the community
+	 */
+	int add_community(const std::string& name, ABM&& model);
+
+	/**
+	 * \brief Link a place to the place it mirrors in another community
+	 * \details Throws std::invalid_argument if the type is not schools
+	 *		or workplaces, the communities are the same, the place is
+	 *		already linked or is an owner, or the owner is a mirror;
+	 *		std::out_of_range if a community or a place does not exist
+	 * @param community - name of the community of the mirror
+	 * @param type - type of the places
+	 * @param place_ID - ID of the mirror in its community
+	 * @param owner_community - name of the community of the owner
+	 * @param owner_ID - ID of the owner in its community
+	 */
+	void link_places(const std::string& community, const PopulationSegment::place_type type,
+						const int place_ID, const std::string& owner_community, const int owner_ID);
+
+	/**
+	 * \brief Load links from a file
+	 * \details Throws std::runtime_error if the file cannot be opened
+	 *		and std::invalid_argument if a line has a wrong format
+	 * @param fname - name of the file, one link per line
+	 */
+	void load_links(const std::string& fname);
+
+	/// Executor of the tasks, one task per community
+	void set_executor(const executor& exec) { run_tasks = exec; }
+
+	//
+	// Transmission of infection
+	//
+
+	/// \brief Transmit infection in all communities
+	void transmit_infection();
+
+	/// \brief Compute contributions of all places, including the commuters
+	void compute_place_contributions();
+
+	//
+	// Getters
+	//
+
+	/// Number of communities
+	int get_number_of_communities() const { return communities.size(); }
+	/// Number of links
+	int get_number_of_links() const { return links.size(); }
+	/// Index of a community, throws std::out_of_range if there is none with this name
+	int get_community_index(const std::string& name) const;
+	/// Name of a community
+	const std::string& get_community_name(const int index) const { return names.at(index); }
+	/// Model of a community
+	ABM& get_community(const int index) { return communities.at(index); }
+	const ABM& get_community(const int index) const { return communities.at(index); }
+
+	double get_time() const { return communities.empty() ? 0.0 : communities.front().get_time(); }
+
+	// Totals of the region
+	int get_num_infected() const { return regional_sum(&ABM::get_num_infected); }
+	int get_num_exposed() const { return regional_sum(&ABM::get_num_exposed); }
+	int get_total_infected() const { return regional_sum(&ABM::get_total_infected); }
+	int get_total_dead() const { return regional_sum(&ABM::get_total_dead); }
+	int get_total_recovered() const { return regional_sum(&ABM::get_total_recovered); }
+	int get_total_tested() const { return regional_sum(&ABM::get_total_tested); }
+	int get_total_tested_positive() const { return regional_sum(&ABM::get_total_tested_positive); }
+
+	// Series of the region, element-wise sums
+	std::vector<int> get_infected_day() const { return regional_series(&ABM::get_infected_day); }
+	std::vector<int> get_dead_day() const { return regional_series(&ABM::get_dead_day); }
+	std::vector<int> get_recovered_day() const { return regional_series(&ABM::get_recovered_day); }
+	std::vector<int> get_tested_day() const { return regional_series(&ABM::get_tested_day); }
+	std::vector<int> get_tested_positive_day() const { return regional_series(&ABM::get_tested_positive_day); }
+
+	/**
+	 * \brief Metrics of all the communities and of the region
+	 * \details Metrics of each community are named "community/metric",
+	 *		their sums over the communities "region/metric"; only
+	 *		metrics recorded by all the communities are summed
+	 */
+	Metrics get_metrics() const;
+
+	//
+	// I/O
+	//
+
+	/// Save the metrics of all communities and of the region as comma-separated values
+	void print_metrics(const std::string& fname) const { get_metrics().print_csv(fname); }
+
+private:
+	std::vector<ABM> communities;
+	std::vector<std::string> names;
+
+	// Place of one community that mirrors a place of another
+	struct Link{
+		PopulationSegment::place_type type;
+		int community;
+		int place_ID;
+		int owner_community;
+		int owner_ID;
+	};
+	// Links sorted by owner, so that all mirrors of
+	// an owner are next to each other
+	std::vector<Link> links;
+
+	executor run_tasks;
+	std::unique_ptr<WorkStealingPool> pool;
+
+	/// Add the sums of owners and their mirrors, owners compute the contributions
+	void exchange_contributions();
+
+	/// Run task(i) for each community
+	void for_each_community(const std::function<void(int)>& task);
+
+	/// Place of a community
+	Place& place(const int community, const PopulationSegment::place_type type, const int ID);
+	/// Number of places of a type in a community
+	int number_of_places(const int community, const PopulationSegment::place_type type) const;
+
+	/// Sum of a total over the communities
+	int regional_sum(int (ABM::*total)() const) const;
+	/// Element-wise sum of a series over the communities
+	std::vector<int> regional_series(const std::vector<int>& (ABM::*series)() const) const;
+};
+
+#endif
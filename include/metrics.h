@@ -0,0 +1,135 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "common.h"
+
+/*****************************************************
+ * class: Metrics
+ *
+ * Registry of named per-step metrics
+ *
+ * Each metric is declared once and gets an integer
+ * handle. Values are stored by column, one column per
+ * metric and one entry per time step. Columns can be
+ * reserved for the planned number of steps, so that
+ * recording during a simulation does not allocate.
+ *
+ * Two kinds of metrics:
+ *	- counter - number of events during a step,
+ *		incremented where the events happen
+ *	- gauge - value of a quantity at the end of a step,
+ *		e.g. a cumulative total or a current count
+ *
+ * Binary file format, all integers 32-bit in the
+ * byte order of the machine that wrote it:
+ *	- "ABMMETR1"
+ *	- number of metrics, number of steps
+ *	- for each metric: kind, length of the name, name
+ *	- for each metric: values of all the steps
+ *
+ *****************************************************/
+
+class Metrics{
+public:
+
+	/// Kinds of metrics
+	enum kind_type { counter, gauge };
+
+	//
+	// Constructors
+	//
+
+	/// Creates an empty registry
+	Metrics() = default;
+
+	/**
+	 * \brief Read a registry saved with print_binary
+	 * \details Throws std::runtime_error if the file cannot be
+	 *		read or is not a metrics file
+	 * @param fname - name of the file
+	 */
+	static Metrics read_binary(const std::string& fname);
+
+	//
+	// Setup
+	//
+
+	/**
+	 * \brief Declare a metric
+	 * \details Metrics declared after the first step start with
+	 *		zeros for the earlier steps. Throws std::invalid_argument
+	 *		if the name is empty, already used, or has a comma or
+	 *		a newline.
+	 * @param name - name of the metric
+	 * @param kind - counter or gauge
+	 * @return Handle of the metric
+	 */
+	int add(const std::string& name, const kind_type kind);
+
+	/// Preallocate all the columns for this many steps in total
+	void reserve(const int n_steps);
+
+	/// Remove the values of all steps, keeping the metrics
+	void clear();
+
+	//
+	// Recording
+	//
+
+	/// New step with all the values 0
+	void start_step();
+
+	/// Add n to a counter at the current step, no effect before the first step
+	void increment(const int id, const int n = 1)
+		{ if (n_steps > 0){ columns[id][n_steps-1] += n; } }
+
+	/// Value of a gauge at the current step, no effect before the first step
+	void set(const int id, const int value)
+		{ if (n_steps > 0){ columns[id][n_steps-1] = value; } }
+
+	//
+	// Getters
+	//
+
+	/// Handle of a metric, -1 if there is none with this name
+	int find(const std::string& name) const;
+	/// Number of metrics
+	int size() const { return names.size(); }
+	/// Number of steps recorded
+	int get_n_steps() const { return n_steps; }
+	/// Name of a metric
+	const std::string& get_name(const int id) const { return names.at(id); }
+	/// Kind of a metric
+	kind_type get_kind(const int id) const { return kinds.at(id); }
+	/// Values of a metric, one per step
+	const std::vector<int>& get_values(const int id) const { return columns.at(id); }
+
+	//
+	// I/O
+	//
+
+	/**
+	 * \brief Save all the metrics as comma-separated values
+	 * \details Header line with "step" and the names, then
+	 *		one line per step
+	 * @param fname - name of the output file
+	 */
+	void print_csv(const std::string& fname) const;
+
+	/**
+	 * \brief Save all the metrics in the binary format
+	 * @param fname - name of the output file
+	 */
+	void print_binary(const std::string& fname) const;
+
+private:
+	std::vector<std::string> names;
+	std::vector<kind_type> kinds;
+	// One column per metric
+	std::vector<std::vector<int>> columns;
+	int n_steps = 0;
+	// Steps reserved in each column
+	int capacity = 0;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef MODEL_FEATURES_H
+#define MODEL_FEATURES_H
+
+/*****************************************************
+ * struct: ModelFeatures
+ *
+ * Compile-time policy with the parts of the model
+ * that a simulation uses
+ *
+ * Code of a disabled feature is removed by the compiler
+ * from the time step of the ABM, the dispatch in the
+ * transitions, and the contributions. The ABM rejects
+ * a model that uses a disabled feature before the first
+ * step.
+ *
+ * Features:
+ *	- flu - agents with flu (non-COVID symptomatic)
+ *	- testing - testing, and vaccination and flu
+ *		which start with it
+ *	- hospitals - hospital employees and hospital
+ *		non-COVID patients
+ *	- retirement homes - retirement homes with their
+ *		residents and employees
+ *	- daily data - series with one entry per step,
+ *		otherwise only the totals are collected
+ *
+ * With all the features the results are the same
+ * as without a policy.
+ *
+ ******************************************************/
+
+template <bool with_flu, bool with_testing, bool with_hospitals,
+			bool with_retirement_homes, bool with_daily_data>
+struct ModelFeatures{
+	static constexpr bool flu = with_flu;
+	static constexpr bool testing = with_testing;
+	static constexpr bool hospitals = with_hospitals;
+	static constexpr bool retirement_homes = with_retirement_homes;
+	static constexpr bool daily_data = with_daily_data;
+};
+
+/// All the features of the model
+typedef ModelFeatures<true, true, true, true, true> AllFeatures;
+
+//
+// Features of this build, each can be disabled with
+// a compiler flag to build a specialized executable
+//
+
+#ifdef ABM_WITHOUT_FLU
+	#define ABM_FEATURE_FLU false
+#else
+	#define ABM_FEATURE_FLU true
+#endif
+
+#ifdef ABM_WITHOUT_TESTING
+	#define ABM_FEATURE_TESTING false
+#else
+	#define ABM_FEATURE_TESTING true
+#endif
+
+#ifdef ABM_WITHOUT_HOSPITAL_AGENTS
+	#define ABM_FEATURE_HOSPITALS false
+#else
+	#define ABM_FEATURE_HOSPITALS true
+#endif
+
+#ifdef ABM_WITHOUT_RETIREMENT_HOMES
+	#define ABM_FEATURE_RETIREMENT_HOMES false
+#else
+	#define ABM_FEATURE_RETIREMENT_HOMES true
+#endif
+
+#ifdef ABM_TOTALS_ONLY
+	#define ABM_FEATURE_DAILY_DATA false
+#else
+	#define ABM_FEATURE_DAILY_DATA true
+#endif
+
+// Build features differ from AllFeatures
+#if defined(ABM_WITHOUT_FLU) || defined(ABM_WITHOUT_TESTING) \
+	|| defined(ABM_WITHOUT_HOSPITAL_AGENTS) || defined(ABM_WITHOUT_RETIREMENT_HOMES) \
+	|| defined(ABM_TOTALS_ONLY)
+	#define ABM_SPECIALIZED_FEATURES
+#endif
+
+/// Features used by default in this build
+typedef ModelFeatures<ABM_FEATURE_FLU, ABM_FEATURE_TESTING, ABM_FEATURE_HOSPITALS,
+			ABM_FEATURE_RETIREMENT_HOMES, ABM_FEATURE_DAILY_DATA> BuildFeatures;
+
+#endif
@@ -0,0 +1,233 @@
+#ifndef NEXT_REACTION_ABM_H
+#define NEXT_REACTION_ABM_H
+
+#include "../abm.h"
+#include <queue>
+#include <unordered_map>
+
+/*****************************************************
+ * class: NextReactionABM
+ *
+ * Runs an ABM simulation in continuous time
+ *
+ * Events of infected agents are taken from a priority
+ * queue ordered by their scheduled times and processed
+ * with the regular transitions exactly at these times.
+ * New infections are a Poisson process with the total
+ * rate of places with infectious agents; the place is
+ * selected proportionally to its rate and its exposed
+ * member by thinning. Contributions of a place are
+ * updated only when an agent contributing to it or
+ * registered in it changes state, so the cost of a
+ * step depends on the number of infected rather than
+ * on the size of the population.
+ *
+ * Events defined per time step - changes in testing,
+ * closures and reopenings, vaccination, and agents with
+ * flu - are processed at the beginning of each step
+ * with the same rules as in the ABM.
+ *
+ * Events are counted in the totals and metrics of
+ * the ABM, so daily series and print_metrics are the
+ * same as for the ABM; entry k of a series counts the
+ * events in [k dt, (k+1) dt).
+ *
+ * Not for use with distributed runs.
+ *
+ *****************************************************/
+
+class NextReactionABM{
+public:
+
+	/**
+	 * \brief Sets up a continuous time run of an ABM
+	 * \details ABM needs to have the places and agents already
+	 *		created; the simulation continues from its current time
+	 *		and data collected so far
+	 * @param model - ABM object that holds the population
+	 */
+	NextReactionABM(ABM& model);
+
+	//
+	// Transmission of infection
+	//
+
+	/// \brief Process all the events in one time step of the ABM
+	void transmit_infection();
+
+	//
+	// Getters
+	//
+
+	/// Current simulation time, beginning of the next step
+	double get_time() const { return abm.get_time(); }
+	/// Number of agent events and infections processed so far
+	long long get_number_of_events() const { return n_events; }
+
+	int get_num_infected() const { return abm.get_num_infected(); }
+	int get_num_exposed() const { return abm.get_num_exposed(); }
+	int get_num_active_cases() const { return abm.get_num_active_cases(); }
+	std::vector<int> get_treatment_data() const { return abm.get_treatment_data(); }
+
+	int get_total_infected() const { return abm.get_total_infected(); }
+	int get_total_dead() const { return abm.get_total_dead(); }
+	int get_tested_dead() const { return abm.get_tested_dead(); }
+	int get_not_tested_dead() const { return abm.get_not_tested_dead(); }
+	int get_total_recovered() const { return abm.get_total_recovered(); }
+	int get_tot_recovering_exposed() const { return abm.get_tot_recovering_exposed(); }
+
+	int get_total_tested() const { return abm.get_total_tested(); }
+	int get_total_tested_positive() const { return abm.get_total_tested_positive(); }
+	int get_total_tested_negative() const { return abm.get_total_tested_negative(); }
+	int get_total_tested_false_positive() const { return abm.get_total_tested_false_positive(); }
+	int get_total_tested_false_negative() const { return abm.get_total_tested_false_negative(); }
+
+	const std::vector<int>& get_infected_day() const { return abm.get_infected_day(); }
+	const std::vector<int>& get_dead_day() const { return abm.get_dead_day(); }
+	const std::vector<int>& get_recovered_day() const { return abm.get_recovered_day(); }
+	const std::vector<int>& get_tested_day() const { return abm.get_tested_day(); }
+	const std::vector<int>& get_tested_positive_day() const { return abm.get_tested_positive_day(); }
+	const std::vector<int>& get_tested_negative_day() const { return abm.get_tested_negative_day(); }
+	const std::vector<int>& get_tested_false_positive_day() const { return abm.get_tested_false_positive_day(); }
+	const std::vector<int>& get_tested_false_negative_day() const { return abm.get_tested_false_negative_day(); }
+	const std::vector<int>& get_vaccinated_day() const { return abm.get_vaccinated_day(); }
+
+	/// ABM object with the population
+	ABM& get_abm() { return abm; }
+
+private:
+	ABM& abm;
+	double dt = 1.0;
+	std::map<std::string, double> infection_parameters;
+	Transitions transitions;
+	Contributions contributions;
+	bool initialized = false;
+	long long n_events = 0;
+
+	// Place with its type for the type-specific rules
+	enum place_type { household, school, workplace, hospital, retirement_home };
+	struct PlaceRef{
+		Place* place;
+		place_type type;
+		bool operator< (const PlaceRef& other) const { return place < other.place; }
+		bool operator== (const PlaceRef& other) const { return place == other.place; }
+	};
+
+	// Part of the sums of a place added by one agent
+	struct PlaceShare{
+		PlaceRef ref;
+		double lambda_sum;
+		int n_infected;
+	};
+
+	// Scheduled event of an agent; outdated if the version
+	// differs from the current version of the agent
+	struct AgentEvent{
+		double time;
+		int agent_ID;
+		int version;
+		bool operator> (const AgentEvent& other) const
+			{ return time > other.time || (time == other.time && agent_ID > other.agent_ID); }
+	};
+	std::priority_queue<AgentEvent, std::vector<AgentEvent>, std::greater<AgentEvent>> events;
+	std::vector<int> event_versions;
+
+	// Infected agents that are not removed
+	std::vector<int> active_agents;
+	// Position in active_agents, -1 if not active
+	std::vector<int> active_positions;
+	// Current shares of each agent in place sums
+	std::vector<std::vector<PlaceShare>> agent_shares;
+
+	// Places with contributing agents, their exposure rates
+	// (contribution times number of registered agents), and
+	// numbers of contributing agents
+	std::vector<PlaceRef> active_places;
+	std::vector<double> place_rates;
+	std::vector<int> place_contributors;
+	std::unordered_map<const Place*, int> active_place_index;
+	double total_rate = 0.0;
+	// Changes of transmission in places by the ABM when the
+	// shares were last computed, -1 before the first step
+	int place_changes = -1;
+
+	// Places affected by the current event
+	std::vector<PlaceRef> touched_places;
+	std::vector<PlaceRef> candidate_places;
+	// Sums of the candidate places before adding shares
+	std::vector<std::pair<double, int>> sums_before;
+
+	/**
+	 * \brief Time at which agent states are evaluated for an event at time
+	 * \details With ABM_STEP_TIMES agent times are stored as steps, so 
+	 *		all events of a step are evaluated at its beginning t_start 
+	 */
+	double state_time(const double time, const double t_start) const;
+
+	/// Find all infected agents and schedule their first events
+	void initialize();
+
+	/// Events that happen at the beginning of a step and agents with flu
+	void start_step(const double time);
+
+	/// Process agents with flu with the ABM rules
+	void flu_transitions(const double time);
+
+	/// Process the due events of an agent
+	void process_agent(Agent& agent, const double time);
+
+	/// Infect a member of a place selected by its exposure rate
+	void process_exposure(const double time);
+
+	/**
+	 * \brief Count the changes in state of an infected agent
+	 * @param agent - agent after the transitions
+	 * @param state_changes - changes returned by the transitions
+	 * @param was_exposed - true if the agent was exposed before the transitions
+	 * @param time - time of the event
+	 */
+	void record_transitions(const Agent& agent, const StateChanges& state_changes,
+								const bool was_exposed, const double time);
+
+	/// Start following a newly infected agent, its events are processed from time
+	void activate(Agent& agent, const double time);
+
+	/// Stop following a removed agent
+	void deactivate(const Agent& agent);
+
+	/// Schedule the next event of an agent at a given time
+	void schedule(const Agent& agent, const double time);
+
+	/// Earliest time of an agent event later than time
+	double next_event_time(const Agent& agent, const double time) const;
+
+	/// Bit mask of agent states that the transitions change
+	unsigned int agent_status(const Agent& agent) const;
+
+	/// Add all places an agent is associated with to a list
+	void agent_places(const Agent& agent, std::vector<PlaceRef>& places);
+
+	/// Add the current contributions of an agent to places
+	void add_shares(Agent& agent, const double time);
+
+	/// Remove the contributions of an agent from places
+	void remove_shares(const Agent& agent);
+
+	/**
+	 * \brief Recompute all contributions from the active agents
+	 * \details Needed only when transmission rates of places change, 
+	 *		otherwise the shares are updated at the agent events
+	 */
+	void rebuild_contributions(const double time);
+
+	/// Recompute the exposure rates of all places with contributing agents
+	void refresh_rates();
+
+	/// Recompute contributions and exposure rates of places
+	void update_places(std::vector<PlaceRef>& places);
+
+	/// Registrations in a place that count towards the agent's lambda
+	int susceptible_exposures(const Agent& agent, const PlaceRef& ref) const;
+};
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef PARAMETER_SWEEP_H
+#define PARAMETER_SWEEP_H
+
+#include "../abm.h"
+#include "work_stealing_pool.h"
+#include <numeric>
+#include <cstdint>
+
+/*****************************************************
+ * class: ParameterSweep
+ *
+ * Runs simulations for many sets of infection
+ * parameters in one process
+ *
+ * All the simulations start from one ABM with loaded
+ * places and agents that is never modified. Each job,
+ * a parameter set and a replicate, copies it, sets the
+ * new parameter values without reading the input files,
+ * and runs for a given number of steps. Jobs are run
+ * on a work-stealing thread pool.
+ *
+ * Parameter sets are generated from ranges of the
+ * varied parameters as a grid, a Latin hypercube, or
+ * a Sobol sequence. Replicate r uses the same random
+ * seed for every parameter set (common random numbers),
+ * so results do not depend on the number of threads.
+ *
+ *****************************************************/
+
+class ParameterSweep{
+public:
+
+	/// Methods of generating the parameter sets
+	enum design_type { grid, latin_hypercube, sobol };
+
+	/// Results of one simulation
+	struct Result{
+		int set = 0;
+		int replicate = 0;
+		unsigned seed = 0;
+		// Values of the varied parameters, in order of ranges
+		std::vector<double> parameters;
+		// Summary metrics, in order of get_metric_names()
+		std::vector<double> metrics;
+		// Daily series, in order of get_series_names(),
+		// empty if not collected
+		std::vector<std::vector<int>> series;
+	};
+
+	//
+	// Constructors
+	//
+
+	/**
+	 * \brief Creates a sweep over a model
+	 * \details Model needs to have all the places and agents
+	 *		created; it needs to exist and not be modified during
+	 *		the sweep
+	 * @param model - ABM object at the initial time
+	 * @param steps - number of time steps of each simulation
+	 */
+	ParameterSweep(const ABM& model, const int steps);
+
+	//
+	// Setup
+	//
+
+	/**
+	 * \brief Add a parameter to vary
+	 * \details Throws std::invalid_argument if the name is not one 
+	 *		of the infection parameters or min_value > max_value
+	 * @param name - name of the infection parameter
+	 * @param min_value - lowest value
+	 * @param max_value - highest value
+	 */
+	void add_range(const std::string& name, const double min_value, const double max_value);
+
+	/**
+	 * \brief Generate the parameter sets from the ranges
+	 * \details For the grid, n is the number of values per parameter 
+	 *		including the ends of the ranges (middle of the range if n 
+	 *		is 1); otherwise it is the number of sets. Latin hypercube
+	 *		uses the seed of the sweep.
+	 * @param design - method of generating the sets
+	 * @param n - number of values or sets, at least 1
+	 */
+	void generate(const design_type design, const int n);
+
+	/// Number of simulations with each parameter set
+	void set_replicates(const int n);
+	/// Seed of the whole sweep
+	void set_seed(const unsigned seed) { sweep_seed = seed; }
+	/// Store the daily series of each simulation 
+	void set_collect_series(const bool collect = true) { collect_series = collect; }
+
+	//
+	// Execution
+	//
+
+	/**
+	 * \brief Run all the jobs
+	 * \details Results replace those of a previous run
+	 * @param n_threads - number of threads, at least 1
+	 */
+	void run(const int n_threads);
+
+	//
+	// Getters
+	//
+
+	/// Parameter sets, one value per range in order of addition
+	const std::vector<std::vector<double>>& get_parameter_sets() const { return parameter_sets; }
+	/// Names of the varied parameters
+	const std::vector<std::string>& get_parameter_names() const { return names; }
+	/// Results of all the jobs ordered by set and replicate
+	const std::vector<Result>& get_results() const { return results; }
+	/// Seed of replicate r, same for all the parameter sets
+	unsigned replicate_seed(const int r) const;
+	/// New parameter values of a set as used by the ABM
+	std::map<std::string, double> parameter_values(const int set) const;
+
+	/// Names of the summary metrics
+	static const std::vector<std::string>& get_metric_names();
+	/// Names of the daily series
+	static const std::vector<std::string>& get_series_names();
+
+	//
+	// I/O
+	//
+
+	/**
+	 * \brief Save results of all the jobs as one table
+	 * \details One row per job, columns are set, replicate, seed,
+	 *		the varied parameters and the summary metrics with a 
+	 *		header line; space delimited 
+	 * @param fname - name of the output file
+	 */
+	void print_results(const std::string& fname) const;
+
+	/**
+	 * \brief Save the daily series of all the jobs
+	 * \details One row per job and series; columns are set, replicate, 
+	 *		series name, and the values
+	 * @param fname - name of the output file
+	 */
+	void print_series(const std::string& fname) const;
+
+private:
+	// Model shared by all the jobs
+	const ABM& base;
+	int n_steps = 0;
+	int n_replicates = 1;
+	unsigned sweep_seed = 2021;
+	bool collect_series = false;
+
+	// Varied parameters and their ranges
+	std::vector<std::string> names;
+	std::vector<std::pair<double, double>> ranges;
+
+	std::vector<std::vector<double>> parameter_sets;
+	std::vector<Result> results;
+
+	/// Run one simulation 
+	Result run_job(const int set, const int replicate) const;
+
+	/// Points of each design in a unit hypercube
+	std::vector<std::vector<double>> grid_points(const int n) const;
+	std::vector<std::vector<double>> latin_hypercube_points(const int n) const;
+	std::vector<std::vector<double>> sobol_points(const int n) const;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include "../common.h"
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <exception>
+
+/*****************************************************
+ * class: WorkStealingPool
+ *
+ * Runs independent tasks on a fixed number of threads
+ *
+ * Tasks are first divided into contiguous blocks, one
+ * per thread. Each thread takes tasks from the end of
+ * its own queue and, once it is empty, steals from the
+ * beginning of the queues of other threads, so that
+ * tasks of very different length are still balanced.
+ *
+ *****************************************************/
+
+class WorkStealingPool{
+public:
+
+	/**
+	 * \brief Creates a pool with a given number of threads
+	 * @param n_threads - number of threads, at least 1
+	 */
+	explicit WorkStealingPool(const int n_threads);
+
+	/**
+	 * \brief Run task(i) for every i from 0 to n_tasks-1
+	 * \details Returns when all the tasks are finished; if a task
+	 *		throws, the remaining tasks are not started and the 
+	 *		first exception is rethrown in the calling thread
+	 * @param n_tasks - number of tasks
+	 * @param task - function called with the task index
+	 */
+	void run(const int n_tasks, const std::function<void(int)>& task);
+
+	/// Number of threads
+	int get_number_of_threads() const { return n_workers; }
+
+	/// Number of tasks taken from queues of other threads in the last run
+	int get_number_of_steals() const { return n_steals; }
+
+private:
+	// Tasks of one thread 
+	struct TaskQueue{
+		std::mutex mtx;
+		std::deque<int> tasks;
+	};
+
+	int n_workers = 1;
+	int n_steals = 0;
+
+	/// Take the next task of a thread, from its own queue or stolen
+	bool next_task(std::vector<TaskQueue>& queues, const int worker, int& task_index, bool& stolen);
+};
+
+#endif
@@ -35,7 +35,7 @@ public:
 	 * @param betas - map of infection transmission rates, 1/time; name : value
 	 */
 	Hospital(const int hospital_ID, const double xi, const double yi,
-			 const double severity_cor, const std::map<const std::string, const double> betas) : 
+			 const double severity_cor, const std::map<const std::string, const double>& betas) : 
 			Place(hospital_ID, xi, yi, severity_cor, 0.0)
 	{ 
 				beta_employee = betas.at("hospital employee"); 
@@ -106,13 +106,14 @@ public:
 		{ lambda_tot = 0.0; lambda_sum = 0.0; num_infected = 0; n_tested = 0; }
 
 	/// \brief Contribution takes into account agents tested at current step
-	void compute_infected_contribution() override;
+	using Place::compute_infected_contribution;
+	void compute_infected_contribution(const int n_agents) override;
 
-	/// \brief Returns number of Flu agents being tested in a hospital at that step
-	int get_n_tested() const { return n_tested; }
+	/// \brief Overwrite number of tested with the total from all processes
+	void set_n_tested(const int n_total_tested) { n_tested = n_total_tested; }
 
 	/// \brief Returns number of Flu agents being tested in a hospital at that step
-	double get_lambda_sum() const { return lambda_sum; }
+	int get_n_tested() const { return n_tested; }
 
 	//
  	// I/O
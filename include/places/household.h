@@ -63,9 +63,10 @@ public:
 	/**
 	 * \brief Calculates and stores probability contribution of infected agents if any 
 	 *
-	 * @param infection - infection object class instance
+	 * @param n_agents - number of agents registered in this place
 	 */
-	void compute_infected_contribution() override;
+	using Place::compute_infected_contribution;
+	void compute_infected_contribution(const int n_agents) override;
 
 	/** 
 	 *  \brief Include contribution of a symptomatic, home isolated agent in the sum
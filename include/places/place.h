@@ -2,6 +2,7 @@
 #define PLACE_H
 
 #include "../common.h"
+#include "roster.h"
 
 /***************************************************** 
  * class: Place
@@ -56,7 +57,16 @@ public:
 	/**
 	 * \brief Calculates and stores fraction of infected agents if any  
 	 */
-	virtual void compute_infected_contribution();
+	void compute_infected_contribution() 
+		{ compute_infected_contribution(agent_IDs.size()); }
+
+	/**
+	 * \brief Calculates and stores fraction of infected agents if any  
+	 * \details Version with a given number of registered agents, e.g. 
+	 *		the total from all processes in a distributed run 
+	 * @param n_agents - number of agents registered in this place
+	 */
+	virtual void compute_infected_contribution(const int n_agents);
 
 	/**
 	 *	\brief Reset the lambda sum of a place after transmission step
@@ -68,8 +78,27 @@ public:
 	// Setters
 	//
 	
+	/// Assign new place ID
+	void set_ID(const int place_ID) { ID = place_ID; }
+
 	void change_transmission_rate(const double new_beta) { beta_j = new_beta; } 
 
+	/// Replace the registered agents, e.g. with those of another place
+	void set_agent_IDs(const std::vector<int>& IDs) { agent_IDs = Roster(IDs); }
+	/// Replace the registered agents keeping the storage of the roster
+	void set_agent_IDs(Roster roster) { agent_IDs = std::move(roster); }
+
+	/**
+	 * \brief Overwrite the sums with totals from all processes
+	 * @param sum - sum of contributions of the infected
+	 * @param n_infected - number of infected 
+	 */
+	void set_contribution_sums(const double sum, const int n_infected)
+		{ lambda_sum = sum; num_infected = n_infected; }
+
+	/// Overwrite the infection contribution, e.g. with one computed by another process
+	void set_infected_contribution(const double lambda) { lambda_tot = lambda; }
+
 	//
 	// Getters
 	//
@@ -77,8 +106,16 @@ public:
 	/// Return place ID
 	int get_ID() const { return ID; }
 
+	/// x coordinate of the place
+	double get_x_location() const { return x; }
+	/// y coordinate of the place
+	double get_y_location() const { return y; }
+
 	/// Return IDs of agents registered in this place	
-	virtual std::vector<int> get_agent_IDs() const { return agent_IDs; }
+	virtual std::vector<int> get_agent_IDs() const { return agent_IDs.to_vector(); }
+
+	/// Return a const reference to IDs of agents registered in this place	
+	const Roster& get_agent_IDs_ref() const { return agent_IDs; }
 
 	/// Return total number of infected agents
 	int get_total_infected() const { return num_infected; }
@@ -86,6 +123,9 @@ public:
 	/// Return probability contribution of infected agents
 	double get_infected_contribution() const { return lambda_tot; }
 
+	/// Return sum of contributions of the infected 
+	double get_lambda_sum() const { return lambda_sum; }
+
 	/// Transmission rate
 	double get_transmission_rate() const { return beta_j; }
 
@@ -114,6 +154,15 @@ public:
 	 */
 	void register_agent(const int agent_ID, const bool is_infected);
 
+	/**
+	 * \brief Assign all agents of this place at once
+	 * \details Replaces the registered agents 
+	 * @param roster - IDs of the agents
+	 * @param n_infected - number of infected among them
+	 */
+	void register_agents(Roster roster, const int n_infected)
+		{ num_tot = roster.size(); num_infected = n_infected; agent_IDs = std::move(roster); }
+
 	/**
 	 * \brief Add a new agent to this place
 	 * @param index - agent ID (starts with 1)
@@ -126,6 +175,13 @@ public:
 	 */
 	void remove_agent(const int index);
 
+	/**
+	 * \brief Change IDs of all registered agents
+	 * \details Registered agents are stored in order of new IDs
+	 * @param new_IDs - new ID of each agent, indexed by the current ID - 1
+	 */
+	void remap_agent_IDs(const std::vector<int>& new_IDs) { agent_IDs.remap(new_IDs); }
+
 	// Virtual dtor - avoid UDB and memory leaks
 	virtual ~Place() = default;
 
@@ -135,7 +191,7 @@ protected:
 	// Location
 	double x = 0.0, y = 0.0;
 	// IDs of agents in this place
-	std::vector<int> agent_IDs;
+	Roster agent_IDs;
 	// Total number of agents
 	int num_tot = 0;
 	// Total number of infected
@@ -0,0 +1,168 @@
+#ifndef ROSTER_H
+#define ROSTER_H
+
+#include "../common.h"
+#include <atomic>
+#include <memory>
+
+/*****************************************************
+ * class: Roster
+ *
+ * IDs of the agents registered in a place
+ *
+ * Rosters of all places of a type are created together
+ * as spans of one contiguous buffer, with exactly one 
+ * entry per registration. The buffer counts the rosters 
+ * that use each span. A roster that is the only user 
+ * of its span changes it in place - agents can be 
+ * removed and added back up to the original size of 
+ * the span without allocations. A roster that shares 
+ * its span with copies, e.g. in copies of a model, 
+ * or outgrows it first copies the IDs into its own 
+ * storage. Rosters can also be views of read-only
+ * memory, e.g. of a shared population segment, that 
+ * are copied on the first change.
+ *
+ *****************************************************/
+
+class Roster{
+public:
+
+	//
+	// Constructors
+	//
+
+	/// Empty roster
+	Roster() = default;
+
+	/// Roster with its own copy of the IDs
+	explicit Roster(const std::vector<int>& IDs) : own(IDs) { }
+
+	/// Copies share the span until one of them changes
+	Roster(const Roster& other);
+	Roster& operator=(const Roster& other);
+	/// Moves take over the span
+	Roster(Roster&& other) noexcept;
+	Roster& operator=(Roster&& other) noexcept;
+
+	~Roster() { release(); }
+
+	/**
+	 * \brief Rosters as spans of one buffer
+	 * \details Throws std::invalid_argument if the offsets 
+	 * 		do not split the whole buffer
+	 * @param IDs - IDs of agents of all places of a type 
+	 * @param offsets - position of the first ID of each place, 
+	 *		followed by the size of the buffer
+	 * @return One roster per place
+	 */
+	static std::vector<Roster> split(std::vector<int>&& IDs, const std::vector<int>& offsets);
+
+	/**
+	 * \brief Rosters as spans of read-only memory
+	 * \details The IDs are not copied until a roster changes; throws 
+	 *		std::invalid_argument if the offsets are not ordered
+	 * @param IDs - IDs of agents of all places of a type 
+	 * @param offsets - position of the first ID of each place, 
+	 *		followed by the number of IDs; n_rosters + 1 values
+	 * @param n_rosters - number of places
+	 * @param owner - keeps the memory alive, empty if it outlives the rosters
+	 * @return One roster per place
+	 */
+	static std::vector<Roster> view(const int* IDs, const int* offsets, const int n_rosters,
+									std::shared_ptr<const void> owner);
+
+	/**
+	 * \brief Lay out rosters in one buffer
+	 * \details Each roster becomes a span of the buffer with the same IDs
+	 * @param rosters - rosters to lay out, in order of the buffer
+	 */
+	static void pack(std::vector<Roster>& rosters);
+
+	//
+	// Access
+	//
+
+	/// First ID
+	const int* begin() const { return buffer ? buffer->data() + first : own.data(); }
+	/// One past the last ID
+	const int* end() const { return begin() + size(); }
+	/// Number of IDs
+	int size() const { return buffer ? count : static_cast<int>(own.size()); }
+	/// True if no agents are registered
+	bool empty() const { return size() == 0; }
+	/// First ID, the roster cannot be empty
+	int front() const { return *begin(); }
+	/// Last ID, the roster cannot be empty
+	int back() const { return *(end() - 1); }
+	/// ID at a position without checking the range
+	int operator[](const int i) const { return begin()[i]; }
+	/// ID at a position, throws std::out_of_range if there is none
+	int at(const int i) const;
+	/// Copy of the IDs
+	std::vector<int> to_vector() const { return std::vector<int>(begin(), end()); }
+	/**
+	 * \brief Number of entries of an ID, e.g. of an agent registered twice
+	 * \details The ID needs to be in the roster; repeated IDs are found 
+	 *		once after each change of the roster, later calls only search 
+	 *		them, so calls on one roster cannot run concurrently
+	 */
+	int multiplicity(const int ID) const;
+	/// True if the IDs are still in the buffer of all places of the type
+	bool shares_buffer() const { return buffer != nullptr; }
+
+	/// Same IDs in the same order
+	bool operator==(const Roster& other) const 
+		{ return size() == other.size() && std::equal(begin(), end(), other.begin()); }
+	bool operator!=(const Roster& other) const { return !(*this == other); }
+
+	//
+	// Changes
+	//
+
+	/// Add an ID at the end
+	void push_back(const int ID);
+
+	/// Remove all entries of an ID, keeps the order of the others
+	void remove(const int ID);
+
+	/**
+	 * \brief Change all the IDs
+	 * \details IDs are sorted afterwards
+	 * @param new_IDs - new value of each ID, indexed by the current ID - 1
+	 */
+	void remap(const std::vector<int>& new_IDs);
+
+private:
+	// IDs of all places of a type and the number of rosters using each span,
+	// or read-only IDs stored elsewhere
+	struct Buffer{
+		std::vector<int> IDs;
+		std::vector<std::atomic<int>> users;
+		const int* read_only = nullptr;
+		std::shared_ptr<const void> owner;
+		explicit Buffer(const std::size_t n_spans) : users(n_spans) { }
+		const int* data() const { return read_only ? read_only : IDs.data(); }
+	};
+
+	// Buffer and the span of this roster
+	std::shared_ptr<Buffer> buffer;
+	int span = 0;
+	int first = 0;
+	int count = 0;
+	int capacity = 0;
+	// IDs after the roster shared or outgrew its span 
+	std::vector<int> own;
+	// IDs with more than one entry, sorted; none 
+	// until needed and after each change
+	mutable std::unique_ptr<std::vector<int>> repeated;
+
+	/// IDs that can be changed in place 
+	int* writable();
+	/// Copy the span into own storage
+	void detach();
+	/// Stop using the span
+	void release();
+};
+
+#endif
@@ -36,11 +36,12 @@ public:
 	 * @param psi - student absenteeism correction
 	 * @param beta_e - employee infection transmission rate, 1/time
 	 * @param beta_s - student infection transmission rate, 1/time
+	 * @param school_type - daycare, primary, middle, high, or college
 	 */
 	School(const int school_ID, const double xi, const double yi, 
 			const double severity_cor, const double psi_e, const double psi, 
-			const double beta_e, const double beta_s) : 
-		psi_emp(psi_e), psi_j(psi), beta_emp(beta_e),  Place(school_ID, xi, yi, severity_cor, beta_s){ } 
+			const double beta_e, const double beta_s, const std::string& school_type = "") : 
+		psi_emp(psi_e), psi_j(psi), beta_emp(beta_e), type(school_type), Place(school_ID, xi, yi, severity_cor, beta_s){ } 
 
 	//
 	// Infection related computations
@@ -76,6 +77,8 @@ public:
 	//
 	
 	double get_employee_transmission_rate() const { return beta_emp; } 
+	/// Type of the school as in the input file
+	std::string get_type() const { return type; }
 
 	//
  	// I/O
@@ -97,6 +100,8 @@ private:
 	double psi_emp = 0.0;
 	// Employee infection transmission rate, 1/time 
 	double beta_emp = 0.0;
+	// School type
+	std::string type = "";
 };
 
 #endif
@@ -0,0 +1,150 @@
+#ifndef REPLICATE_SERVER_H
+#define REPLICATE_SERVER_H
+
+#include "../abm.h"
+
+/*****************************************************
+ * class: ReplicateServer
+ *
+ * Long-lived process that runs replicates of one
+ * loaded model on request
+ *
+ * The population and parameters are loaded once, by
+ * whoever creates the model, and the server then
+ * listens on a local Unix socket. Each connection is
+ * handed right after it is accepted to a forked child
+ * that shares the pages of the loaded model
+ * copy-on-write, or, without forking, served in the
+ * server process itself. Every run request
+ * starts from a fresh copy of the loaded model, so
+ * runs with the same seed and parameters give the
+ * same results in either mode.
+ *
+ * The protocol is line-based text, one token per
+ * field, with spaces in names written as underscores:
+ *
+ *	run
+ *	seed 2021
+ *	steps 400
+ *	parameter time_in_hospital 7.5
+ *	output tested_positive
+ *	end
+ *
+ * Parameters and outputs are optional and can repeat.
+ * The response has one line per metric and requested
+ * series, written as soon as the run finishes, and a
+ * closing line:
+ *
+ *	metric total_infected 1234
+ *	series tested_positive 0 0 1 ...
+ *	end
+ *
+ * or "error <message>" followed by "end". Any number
+ * of requests can be sent over one connection. A
+ * connection with "shutdown" as its first line stops
+ * the server once all the children have finished.
+ *
+ *****************************************************/
+
+class ReplicateServer{
+public:
+
+	/// Ways of serving connections
+	enum mode_type { fork_children, in_process };
+
+	/// One run
+	struct Request{
+		unsigned seed = 0;
+		int steps = 0;
+		// Infection parameters to change, names with spaces
+		std::map<std::string, double> parameters;
+		// Requested daily series, names with spaces
+		std::vector<std::string> outputs;
+	};
+
+	//
+	// Constructors
+	//
+
+	/**
+	 * \brief Creates a server of a model listening on a socket
+	 * \details Model needs to have all the places and agents
+	 *		created and to outlive the server. An existing file
+	 *		with the socket name is replaced. Throws
+	 *		std::runtime_error if the socket cannot be created.
+	 * @param model - ABM object at the initial time
+	 * @param socket_path - path of the Unix socket
+	 */
+	ReplicateServer(const ABM& model, const std::string& socket_path);
+
+	/// Closes and removes the socket
+	~ReplicateServer();
+
+	ReplicateServer(const ReplicateServer&) = delete;
+	ReplicateServer& operator=(const ReplicateServer&) = delete;
+
+	//
+	// Setup
+	//
+
+	/// Serve connections in forked children or in this process
+	void set_mode(const mode_type new_mode) { mode = new_mode; }
+	/// Maximum number of children running at the same time, at least 1
+	void set_max_children(const int n);
+
+	//
+	// Execution
+	//
+
+	/**
+	 * \brief Serve connections until a shutdown request
+	 * \details Throws std::runtime_error if accepting connections
+	 *		or forking fails
+	 */
+	void serve();
+
+	/**
+	 * \brief Run one request on a copy of the model
+	 * \details Throws std::invalid_argument for unknown parameters
+	 *		or outputs
+	 * @param request - seed, steps, parameters, and outputs
+	 * @return Response lines without the closing line
+	 */
+	std::string run(const Request& request) const;
+
+	//
+	// Protocol
+	//
+
+	/**
+	 * \brief Request from its lines, without "run" and "end"
+	 * \details Throws std::invalid_argument for lines that are
+	 *		not a field of a request
+	 */
+	static Request parse_request(const std::vector<std::string>& lines);
+
+	/// Names of the series that can be requested
+	static const std::vector<std::string>& get_series_names();
+
+private:
+	// Model copied by each run
+	const ABM& base;
+	std::string path;
+	// Listening socket
+	int listen_fd = -1;
+	mode_type mode = fork_children;
+	int max_children = 4;
+
+	// Buffered reading of lines from a socket
+	class LineReader;
+
+	/**
+	 * \brief Serve all the requests of one connection
+	 * \details Reads every line of the connection, including the
+	 *		first one, so that a slow client only holds up its child
+	 * @return True if the connection asked for a shutdown, not yet answered
+	 */
+	bool serve_connection(const int fd) const;
+};
+
+#endif
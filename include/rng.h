@@ -2,6 +2,8 @@
 #define RNG_H
 
 #include <random>
+#include <vector>
+#include <algorithm>
 
 /***************************************************** 
  * class: RNG
@@ -15,6 +17,9 @@ class RNG
 public:
     RNG() : gen(std::random_device()()) { } 
 
+	/// Restart the generator from a given seed
+	void set_seed(const unsigned seed) { gen.seed(seed); }
+
 	/**
 	 *	\brief Random number sampled from uniform distribution
 	 *	@param dmin - minimum, inclusive
@@ -70,8 +75,24 @@ public:
         return dist(gen);
     }
 
+	/**
+	 *	\brief Fill a vector with numbers sampled from uniform distribution
+	 *	\details Uses a single distribution object for all the entries
+	 *	@param values - vector to fill, all its entries are overwritten 
+	 *	@param dmin - minimum, inclusive
+	 *	@param dmax - maximum, exclusive
+	 */
+    void fill_random(std::vector<double>& values, const double dmin, const double dmax)
+	{
+        std::uniform_real_distribution<double> dist(dmin, dmax);
+		for (auto& val : values){
+			val = dist(gen);
+		}
+	}
+
 	/// Performs in-place random shuffling of a vector
-	void vector_shuffle(std::vector<int>& v)
+	template <typename Alloc>
+	void vector_shuffle(std::vector<int, Alloc>& v)
 	{ 
 		std::shuffle(v.begin(), v.end(), gen);
 	}
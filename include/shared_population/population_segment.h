@@ -0,0 +1,215 @@
+#ifndef POPULATION_SEGMENT_H
+#define POPULATION_SEGMENT_H
+
+#include "../common.h"
+#include "../agent.h"
+#include "../places/roster.h"
+#include <cstdint>
+#include <memory>
+
+class ABM;
+
+/*****************************************************
+ * class: PopulationSegment
+ *
+ * Read-only view of a population published to a file
+ *
+ * A loader process publishes the parts of a model that
+ * do not change during a simulation - agent attributes,
+ * place locations, infection parameters, age-dependent 
+ * distributions, and the testing schedule - as one binary
+ * file with a column per attribute. Worker processes map
+ * the file into memory read-only, so all of them share
+ * the same pages, and create their models from it 
+ * without reading or parsing the text input files. A
+ * file in /dev/shm works as a named shared-memory 
+ * segment. Contents of a file already in memory, e.g.
+ * received by an application embedding the model, can
+ * be used in the same way.
+ *
+ * Models keep using the segment - agent profiles and
+ * the initial rosters of places are read from it and 
+ * not copied, so each worker only stores the state of
+ * its agents and the rosters that change. Mapped files
+ * stay mapped while any model created from them exists.
+ *
+ * The file is only valid on machines with the same
+ * byte order and type sizes as the one that wrote it.
+ *
+ *****************************************************/
+
+class PopulationSegment{
+public:
+
+	/// Types of places, in order of storage
+	enum place_type { households, retirement_homes, schools, workplaces, hospitals };
+
+	/// Integer attributes of agents
+	enum agent_column { student, works, age, household_ID, non_covid_patient, school_ID, 
+						retirement_home_resident, retirement_home_employee, school_employee, 
+						work_ID, hospital_employee, hospital_ID, infected };
+
+	//
+	// Constructors
+	//
+
+	/**
+	 * \brief Map a published population read-only
+	 * \details Throws std::runtime_error if the file cannot be
+	 *		mapped or is not a valid population segment
+	 * @param fname - name of the file
+	 */
+	explicit PopulationSegment(const std::string& fname);
+
+	/**
+	 * \brief View of a published population already in memory
+	 * \details The buffer holds the contents of a segment file, is 
+	 *		not copied, and needs to outlive this object and the models 
+	 *		being created from it; throws std::runtime_error if it is 
+	 *		not a valid population segment
+	 * @param buffer - contents of a segment file, aligned to 8 bytes
+	 * @param buffer_size - size of the buffer in bytes
+	 */
+	PopulationSegment(const void* buffer, const std::size_t buffer_size);
+
+	/**
+	 * \brief View of a published population in memory owned with models
+	 * \details Same as the other constructor, but the buffer is kept 
+	 *		alive by this object and by the models created from it
+	 * @param buffer - contents of a segment file, aligned to 8 bytes
+	 * @param buffer_size - size of the buffer in bytes
+	 */
+	PopulationSegment(std::shared_ptr<const void> buffer, const std::size_t buffer_size);
+
+	PopulationSegment(const PopulationSegment&) = delete;
+	PopulationSegment& operator=(const PopulationSegment&) = delete;
+
+	/// Unmaps the file if mapped and not used by any model
+	~PopulationSegment() = default;
+
+	/**
+	 * \brief Publish the population of a model to a file
+	 * \details Model needs to be at the initial time; the file is 
+	 *		written under a temporary name and then renamed so that
+	 *		workers never map a partly written file
+	 * @param abm - model with created places and agents
+	 * @param fname - name of the file
+	 */
+	static void publish(const ABM& abm, const std::string& fname);
+
+	//
+	// Agents
+	//
+
+	/// Number of agents
+	int get_number_of_agents() const { return header->n_agents; }
+	/// Integer attribute of all the agents in ID order
+	const std::int32_t* agent_values(const agent_column column) const
+		{ return agent_ints + static_cast<std::size_t>(column)*header->n_agents; }
+	/// x coordinates of the agents
+	const double* agent_x() const { return agent_xy; }
+	/// y coordinates of the agents
+	const double* agent_y() const { return agent_xy + header->n_agents; }
+	/**
+	 * \brief Profile of an agent, stored in the segment
+	 * \details Valid as long as the storage is kept
+	 * @param index - position of the agent, starts with 0
+	 */
+	const AgentProfile* get_agent_profile(const int index) const
+		{ return agent_profiles + index; }
+	/// Owner of the mapping or buffer, keeps the profiles valid
+	const std::shared_ptr<const char>& get_storage() const { return storage; }
+
+	//
+	// Places
+	//
+
+	/// Number of places of a type
+	int get_number_of_places(const place_type type) const { return header->n_places[type]; }
+	/// ID of a place, index starts with 0
+	int get_place_ID(const place_type type, const int index) const 
+		{ return place_ints[2*(place_start(type) + index)]; }
+	/// x coordinate of a place
+	double get_place_x(const place_type type, const int index) const 
+		{ return place_xy[2*(place_start(type) + index)]; }
+	/// y coordinate of a place
+	double get_place_y(const place_type type, const int index) const 
+		{ return place_xy[2*(place_start(type) + index) + 1]; }
+	/// Type of a school as in the input file
+	std::string get_school_type(const int index) const;
+	/// Agents registered in places of a type at the initial time, not copied
+	std::vector<Roster> get_rosters(const place_type type) const;
+
+	//
+	// Model input
+	//
+
+	/// Infection parameters
+	std::map<std::string, double> get_infection_parameters() const;
+	/// Age-dependent distributions by tag and age group 
+	std::map<std::string, std::map<std::string, double>> get_age_dependent_distributions() const;
+	/// Testing changes in the format of Testing::set_time_varying
+	std::vector<std::vector<double>> get_testing_changes() const;
+
+	/// Size of the mapped file or the buffer in bytes
+	std::size_t get_size() const { return size; }
+
+private:
+	// Layout of the beginning of the file
+	struct Header{
+		char magic[8];
+		std::uint64_t size;
+		std::int32_t n_agents;
+		std::int32_t n_places[5];
+		std::int32_t n_parameters;
+		std::int32_t n_distribution_entries;
+		std::int32_t n_testing_changes;
+		std::int32_t padding;
+		// Byte offsets of the sections
+		std::uint64_t agent_ints;
+		std::uint64_t agent_xy;
+		std::uint64_t place_ints;
+		std::uint64_t place_xy;
+		std::uint64_t parameter_values;
+		std::uint64_t distribution_values;
+		std::uint64_t testing_changes;
+		std::uint64_t agent_profiles;
+		// Rosters of all places, offsets per type followed by the IDs
+		std::uint64_t roster_offsets;
+		std::uint64_t roster_IDs;
+		// Names, null-separated
+		std::uint64_t names;
+		std::uint64_t names_size;
+	};
+
+	// Mapped file or buffer
+	const char* data = nullptr;
+	std::size_t size = 0;
+	// Owner of the mapping, unmaps the file once the segment
+	// and all the models using it are gone; empty for a buffer
+	std::shared_ptr<const char> storage;
+
+	// Sections
+	const Header* header = nullptr;
+	const std::int32_t* agent_ints = nullptr;
+	const double* agent_xy = nullptr;
+	// ID and school type of each place
+	const std::int32_t* place_ints = nullptr;
+	const double* place_xy = nullptr;
+	const AgentProfile* agent_profiles = nullptr;
+	const std::int32_t* roster_offsets = nullptr;
+	const std::int32_t* roster_IDs = nullptr;
+
+	/// Check the header and locate the sections, false if not a valid segment
+	bool set_sections();
+	/// Index of the first place of a type
+	int place_start(const place_type type) const;
+	/// Names stored after the numeric sections
+	std::vector<std::string> stored_names() const;
+	/// Recognizes a segment file
+	static const char* magic() { return "ABMPOP02"; }
+	/// School types and their codes
+	static const std::vector<std::string>& school_types();
+};
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef SPATIAL_TRANSMISSION_H
+#define SPATIAL_TRANSMISSION_H
+
+#include "common.h"
+#include "agent.h"
+#include "memory_arena.h"
+#include <functional>
+
+/*****************************************************
+ * class: SpatialTransmission
+ *
+ * Community transmission that decays with the 
+ * distance between agents
+ *
+ * Each infectious agent outside of isolation and 
+ * treatment contributes
+ *		rate * inf_var * K(d), K(d) = 1/(1 + (d/a)^b)
+ * to the infection probability of every susceptible
+ * agent at distance d, where a is the distance scale
+ * and b the exponent. Distances are in the units of
+ * the agent coordinates.
+ *
+ * Agents are binned into a uniform grid with cells of
+ * the size of the cutoff radius. The kernel is summed
+ * exactly over sources within the cutoff, which are
+ * all in the 3x3 block of cells around the agent.
+ *
+ * Optionally, sources in the other cells are added
+ * from a hierarchy of grids, each cell of a level 
+ * made of 2x2 cells of the level below. On each level,
+ * the cells that are not neighbors of the agent's cell
+ * but whose parents are neighbors of its parent count
+ * as one point at their weighted center, evaluated at
+ * the center of the agent's cell; such cells are at
+ * least their size away. The 3x3 block is then summed
+ * exactly in full. The cost is linear in the number
+ * of agents plus, for the far field, at most 27 cells
+ * per level for each cell with receivers, with the
+ * number of levels logarithmic in the grid size.
+ *
+ * Cells are processed as independent tasks by an 
+ * executor, serially by default. Temporaries of the
+ * computation are taken from an arena by the calling
+ * thread only.
+ *
+ *****************************************************/
+
+class SpatialTransmission{
+public:
+
+	/// Runs task(i) for i from 0 to n_tasks-1, e.g. on a thread pool
+	typedef std::function<void(int n_tasks, const std::function<void(int)>& task)> executor;
+
+	//
+	// Constructors
+	//
+
+	/// Default constructor only
+	SpatialTransmission() = default;
+
+	//
+	// Setup
+	//
+
+	/**
+	 * \brief Kernel and its evaluation
+	 * \details Throws std::invalid_argument for negative rate or 
+	 *		nonpositive scale, exponent, or cutoff
+	 * @param rate - transmission rate
+	 * @param scale - distance scale a of the kernel
+	 * @param exponent - exponent b of the kernel
+	 * @param cutoff - kernel is summed exactly within this distance
+	 * @param far_field - true to approximate the sources beyond the cutoff
+	 */
+	void set_parameters(const double rate, const double scale, const double exponent, 
+							const double cutoff, const bool far_field);
+
+	/// Executor of the tasks, one task per grid cell
+	void set_executor(const executor& exec) { run_tasks = exec; }
+
+	//
+	// Computation
+	//
+
+	/**
+	 * \brief Set the spatial contribution of every susceptible agent
+	 * \details Agents that are infected, removed, vaccinated, or 
+	 *		hospital patients get 0
+	 * @param agents - all the agents of the model
+	 * @param time - current time
+	 * @param scratch - memory for the temporaries, e.g. of the time step
+	 */
+	void compute(std::vector<Agent>& agents, const double time, MemoryArena& scratch);
+
+	/// Set the spatial contributions with temporaries in memory of their own
+	void compute(std::vector<Agent>& agents, const double time)
+		{ MemoryArena scratch; compute(agents, time, scratch); }
+
+	/// Value of the kernel at distance d
+	double kernel(const double d) const 
+		{ return 1.0/(1.0 + std::pow(d/kernel_scale, kernel_exponent)); }
+
+	//
+	// Getters
+	//
+
+	/// Number of grid cells in x and y
+	int get_number_of_cells_x() const { return nx; }
+	int get_number_of_cells_y() const { return ny; }
+
+private:
+	double transmission_rate = 0.0;
+	double kernel_scale = 1.0;
+	double kernel_exponent = 1.0;
+	double cutoff_radius = 1.0;
+	bool with_far_field = false;
+	executor run_tasks;
+
+	// Grid over the agents, built once as agents don't move
+	double x_min = 0.0, y_min = 0.0;
+	int nx = 0, ny = 0;
+	// Cell of each agent by position
+	std::vector<int> agent_cells;
+
+	// Sources and receivers sorted by cell, with positions of
+	// the first entry of each cell and one past the last cell
+	std::vector<int> source_start, receiver_start;
+	std::vector<int> source_IDs, receiver_IDs;
+	std::vector<double> source_strength;
+	// Grids of the far field, level 0 is the grid of the agents
+	// and the last one has at most 2x2 cells
+	struct Level{
+		int nx = 0, ny = 0;
+		// Total strength and its weighted center in each cell
+		std::vector<double> strength, x, y;
+	};
+	std::vector<Level> levels;
+
+	/// Bin the agents into the grid
+	void build_grid(const std::vector<Agent>& agents);
+	/// Sort agent positions by cell; start has one entry per cell plus one
+	void sort_by_cell(const ArenaVector<int>& positions, std::vector<int>& start, 
+							std::vector<int>& sorted, MemoryArena& scratch) const;
+	/// Strength of the cells on all the levels of the far field
+	void build_levels(const std::vector<Agent>& agents);
+	/// Far field at the center of a cell from sources outside of its neighbors
+	double far_field(const int cx, const int cy) const;
+	/// True if the agent contributes at this time
+	bool is_source(const Agent& agent, const double time) const;
+	/// Spatial contributions to the receivers in one cell
+	void compute_cell(std::vector<Agent>& agents, const int cell) const;
+};
+
+#endif
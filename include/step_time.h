@@ -0,0 +1,213 @@
+#ifndef STEP_TIME_H
+#define STEP_TIME_H
+
+#include "common.h"
+#include "utils.h"
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+/*****************************************************
+ * class: StepTime
+ *
+ * Time of a scheduled event stored as an index
+ * of a simulation time step
+ *
+ * Used for the agent timing fields when compiled
+ * with -DABM_STEP_TIMES; otherwise these are double.
+ *
+ * Rounding rules:
+ *	- A scheduled time t is stored as ceil(t/dt), i.e.
+ *		the first step at which it is due. Times within
+ *		1e-6 of a step from a boundary are taken as that
+ *		boundary so that accumulated round-off does not
+ *		move an event by a whole step.
+ *	- Simulation time is a multiple of dt and is converted
+ *		to a step by rounding to the nearest integer.
+ *	- An event at t is due at time when ceil(t/dt) <=
+ *		round(time/dt); this is the same step as for
+ *		t <= time with unrounded t.
+ *	- Conversion back to double gives the time of the
+ *		step, i.e. t rounded up to a multiple of dt.
+ *
+ * The step length is common to the whole process. 
+ * Each ABM built with -DABM_STEP_TIMES holds it with 
+ * a StepLengthHold for its lifetime, and models with 
+ * a different step length cannot be created while it 
+ * is held.
+ *
+ *****************************************************/
+
+class StepTime{
+public:
+
+	StepTime() = default;
+
+	/// Time of the first step at which t is due
+	StepTime(const double t) : steps(scheduled_step(t)) { }
+
+	/// Time of the step in the same units as dt
+	operator double() const { return steps*step_length(); }
+
+	/// Index of the step
+	std::int32_t get_steps() const { return steps; }
+
+	/**
+	 * \brief Set the length of a time step common to the process
+	 * \details Throws std::invalid_argument if dt is not positive and 
+	 *		std::runtime_error if a different length is held
+	 */
+	static void set_step_length(const double dt)
+	{
+		std::lock_guard<std::mutex> lock(hold_state().mtx);
+		change_step_length(dt);
+	}
+
+	/**
+	 * \brief Set the step length and keep it until released
+	 * \details Throws like set_step_length; every successful
+	 *		call needs one release_step_length
+	 */
+	static void hold_step_length(const double dt)
+	{
+		std::lock_guard<std::mutex> lock(hold_state().mtx);
+		change_step_length(dt);
+		++hold_state().n_holders;
+	}
+
+	/// Release the step length held by hold_step_length
+	static void release_step_length()
+	{
+		std::lock_guard<std::mutex> lock(hold_state().mtx);
+		--hold_state().n_holders;
+	}
+
+	/// Number of holders of the step length
+	static int get_number_of_holders()
+	{
+		std::lock_guard<std::mutex> lock(hold_state().mtx);
+		return hold_state().n_holders;
+	}
+
+	/// Step corresponding to a simulation time
+	static std::int32_t current_step(const double time)
+		{ return static_cast<std::int32_t>(std::lround(time/step_length())); }
+
+	/// First step at which a scheduled time is due
+	static std::int32_t scheduled_step(const double t)
+	{
+		const double n_steps = std::ceil(t/step_length() - 1e-6);
+		const double max_steps = static_cast<double>(std::numeric_limits<std::int32_t>::max());
+		return static_cast<std::int32_t>(std::max(std::min(n_steps, max_steps), -max_steps));
+	}
+
+private:
+	std::int32_t steps = 0;
+
+	/// Length of a time step
+	static double& step_length()
+		{ static double dt = 1.0; return dt; }
+
+	// Number of models that hold the step length
+	struct HoldState{
+		std::mutex mtx;
+		int n_holders = 0;
+	};
+	static HoldState& hold_state()
+		{ static HoldState state; return state; }
+
+	/// Change the step length, called with the lock of hold_state
+	static void change_step_length(const double dt)
+	{
+		if (dt <= 0.0){
+			throw std::invalid_argument("Time step needs to be positive");
+		}
+		if (hold_state().n_holders > 0 && dt != step_length()){
+			throw std::runtime_error("Time step of the process is held at " 
+						+ std::to_string(step_length()) + ", cannot change to " + std::to_string(dt));
+		}
+		step_length() = dt;
+	}
+};
+
+/*****************************************************
+ * class: StepLengthHold
+ *
+ * Holds the step length of StepTime while the object
+ * exists; copies hold the same length and a default 
+ * constructed object holds nothing
+ *
+ *****************************************************/
+
+class StepLengthHold{
+public:
+
+	StepLengthHold() = default;
+
+	/// Set and hold the step length, throws if a different one is held
+	explicit StepLengthHold(const double step) : dt(step) { StepTime::hold_step_length(dt); }
+
+	StepLengthHold(const StepLengthHold& other) : dt(other.dt) 
+		{ if (dt > 0.0) StepTime::hold_step_length(dt); }
+
+	StepLengthHold& operator=(const StepLengthHold& other)
+	{
+		if (this != &other){
+			StepLengthHold copy(other);
+			std::swap(dt, copy.dt);
+		}
+		return *this;
+	}
+
+	~StepLengthHold() { if (dt > 0.0) StepTime::release_step_length(); }
+
+	/// Step length held, 0 if none
+	double get_step_length() const { return dt; }
+
+private:
+	double dt = 0.0;
+};
+
+// Comparisons with the simulation time are exact step comparisons
+
+/// True if the event is due at this time
+inline bool operator<= (const StepTime event, const double time)
+	{ return event.get_steps() <= StepTime::current_step(time); }
+/// True if the event is due at this time
+inline bool operator>= (const double time, const StepTime event)
+	{ return event <= time; }
+/// True if the event is not yet due at this time
+inline bool operator< (const double time, const StepTime event)
+	{ return !(event <= time); }
+/// True if the event is not yet due at this time
+inline bool operator> (const StepTime event, const double time)
+	{ return !(event <= time); }
+
+#ifdef ABM_STEP_TIMES
+	// Times of scheduled events
+	typedef StepTime scheduled_time;
+	// Durations used to schedule events
+	typedef float time_duration;
+#else
+	typedef double scheduled_time;
+	typedef double time_duration;
+#endif
+
+/**
+ * \brief True if an event scheduled at event_time happens at time
+ * \details With ABM_STEP_TIMES the steps are compared exactly,
+ *		otherwise the times are compared with tolerance tol
+ * @param event_time - time of the event
+ * @param time - current simulation time
+ * @param tol - tolerance for comparison of the times
+ */
+inline bool event_at_time(const double event_time, const double time, const double tol = 1e-3)
+{
+#ifdef ABM_STEP_TIMES
+	return StepTime::scheduled_step(event_time) == StepTime::current_step(time);
+#else
+	return equal_floats<double>(event_time, time, tol);
+#endif
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "common.h"
 #include "utils.h"
+#include "step_time.h"
 #include <deque>
 
 /***************************************************** 
@@ -71,6 +72,9 @@ public:
 	/// Probability flu (non-covid symptomatic) gets tested
 	double get_prob_flu_tested() const { return flu_fraction_to_test; } 
 
+	/// Changes of testing not applied yet, in the format of set_time_varying
+	std::vector<std::vector<double>> get_time_varying() const;
+
 private:
 	// Vector of times marking the time testing is supposed
 	// to change value and corresponding values, i.e. 
@@ -22,6 +22,8 @@
 #include "../states_manager/regular_states_manager.h"
 #include "../flu.h"
 #include "../testing.h"
+#include "state_changes.h"
+#include "parameter_keys.h"
 
 /***************************************************** 
  * class: FluTransitions 
@@ -43,8 +45,8 @@ public:
 	FluTransitions() = default;
 
 	/// \brief Implement transitions relevant to susceptible
-	/// \details Returns 1 if the agent got infected 
-	std::vector<int> susceptible_transitions(Agent& agent, const double time, Infection& infection,	
+	/// \details Infected and testing at this step 
+	StateChanges susceptible_transitions(Agent& agent, const double time, Infection& infection,	
 				std::vector<Household>& households, std::vector<School>& schools,
 				std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
 			    std::vector<RetirementHome>& retirement_homes,	
@@ -21,6 +21,8 @@
 #include "../states_manager/hsp_employee_states_manager.h"
 #include "../flu.h"
 #include "../testing.h"
+#include "state_changes.h"
+#include "parameter_keys.h"
 
 /***************************************************** 
  * class: HspEmployeeTransitions 
@@ -48,9 +50,20 @@ public:
 				std::vector<Hospital>& hospitals, const std::map<std::string, double>& infection_parameters, 
 				std::vector<Agent>& agents, const Testing& testing);
 
+	/// \brief Return total lambda of susceptible agent
+	double compute_susceptible_lambda(const Agent& agent, const double time, 
+					const std::vector<Household>& households, const std::vector<School>& schools,
+					const std::vector<Hospital>& hospitals);
+
+	/// \brief Set properties of an agent that just got infected
+	/// \details Latency, infectiousness variability, and testing status 
+	void process_new_infection(Agent& agent, const double time, Infection& infection,	
+				std::vector<School>& schools, std::vector<Hospital>& hospitals, 
+				const std::map<std::string, double>& infection_parameters, const Testing& testing);
+
 	/// \brief Implement transitions relevant to exposed
-	/// \details Return 1 if recovered without symptoms 
-	std::vector<int> exposed_transitions(Agent& agent, Infection& infection, const double time, const double dt, 
+	/// \details Recovered is 1 if recovered without symptoms; also testing at this step 
+	StateChanges exposed_transitions(Agent& agent, Infection& infection, const double time, const double dt, 
 				std::vector<Household>& households, std::vector<School>& schools,
 				std::vector<Hospital>& hospitals, const std::map<std::string, double>& infection_parameters, 
 				const Testing& testing);
@@ -61,8 +74,8 @@ public:
 				const std::map<std::string, double>& infection_parameters, const Testing& testing);
 
 	/// \brief Transitions of a symptomatic agent 
-	/// @return Vector where first entry is one if agent recovered, second if agent died
-	std::vector<int> symptomatic_transitions(Agent& agent, const double time, 
+	/// @return Recovered or dead, and testing at this step
+	StateChanges symptomatic_transitions(Agent& agent, const double time, 
 				const double dt, Infection& infection,
 				std::vector<Household>& households, std::vector<School>& schools,
 				std::vector<Hospital>& hospitals, const std::map<std::string, double>& infection_parameters);
@@ -88,11 +101,6 @@ private:
 	// For changing agent states
 	HspEmployeeStatesManager states_manager;
 
-	/// \brief Return total lambda of susceptible agent
-	double compute_susceptible_lambda(const Agent& agent, const double time, 
-					const std::vector<Household>& households, const std::vector<School>& schools,
-					const std::vector<Hospital>& hospitals);
-
 	/// \brief Compte and set agent properties related to recovery without symptoms and incubation
 	void recovery_and_incubation(Agent& agent, Infection& infection, const double time,
 				                const std::map<std::string, double>& infection_parameters);
@@ -105,8 +113,8 @@ private:
 			const std::map<std::string, double>& infection_parameters);
 
 	/// \brief Verifies and manages removal of an agent from the model
-	/// @return Vector where first entry is one if agent recovered, second if agent died
-	std::vector<int> check_agent_removal(Agent& agent, const double time,
+	/// @return Recovered or dead, dead tested only if confirmed positive
+	StateChanges check_agent_removal(Agent& agent, const double time,
 					std::vector<Household>& households, std::vector<School>& schools,
 					std::vector<Hospital>& hospitals);
 
@@ -0,0 +1,34 @@
+#ifndef PARAMETER_KEYS_H
+#define PARAMETER_KEYS_H
+
+#include "../common.h"
+
+/*****************************************************
+ * namespace: ParameterKeys
+ *
+ * Names of the infection parameters looked up by
+ * the transitions of each agent
+ *
+ * The names are constructed once. A lookup with a
+ * string literal creates a temporary string, which
+ * for names longer than the small-string buffer is
+ * a heap allocation per agent and time step.
+ *
+ ******************************************************/
+
+namespace ParameterKeys{
+	const std::string recovery_time("recovery time");
+	const std::string time_exposed_to_infectiousness("time from exposed to infectiousness");
+	const std::string time_decision_to_test("time from decision to test");
+	const std::string time_test_to_results("time from test to results");
+	const std::string fraction_tested_in_hospitals("fraction tested in hospitals");
+	const std::string fraction_false_negative("fraction false negative");
+	const std::string fraction_false_positive("fraction false positive");
+	const std::string flu_testing_duration("flu testing duration");
+	const std::string time_in_hospital("time in hospital");
+	const std::string time_in_ICU("time in ICU");
+	const std::string time_in_hospital_after_ICU("time in hospital after ICU");
+	const std::string time_before_death_to_ICU("time before death to ICU");
+}
+
+#endif
@@ -22,6 +22,8 @@
 #include "../states_manager/regular_states_manager.h"
 #include "../flu.h"
 #include "../testing.h"
+#include "state_changes.h"
+#include "parameter_keys.h"
 
 /***************************************************** 
  * class: RegularTransitions 
@@ -51,9 +53,22 @@ public:
 				const std::map<std::string, double>& infection_parameters, 
 				std::vector<Agent>& agents,	Flu& flu, const Testing& testing);
 
+	/// \brief Return total lambda of susceptible agent
+	double compute_susceptible_lambda(const Agent& agent, const double time, 
+					const std::vector<Household>& households, const std::vector<School>& schools,
+					const std::vector<Workplace>& workplaces, const std::vector<RetirementHome>& retirement_homes);
+
+	/// \brief Set properties of an agent that just got infected
+	/// \details Latency, infectiousness variability, and testing status 
+	void process_new_infection(Agent& agent, const double time, Infection& infection,	
+				std::vector<School>& schools, std::vector<Workplace>& workplaces, 
+				std::vector<Hospital>& hospitals, std::vector<RetirementHome>& retirement_homes,	
+				const std::map<std::string, double>& infection_parameters, 
+				Flu& flu, const Testing& testing);
+
 	/// \brief Implement transitions relevant to exposed
-	/// \details Return 1 if recovered without symptoms 
-	std::vector<int> exposed_transitions(Agent& agent, Infection& infection, const double time, const double dt, 
+	/// \details Recovered is 1 if recovered without symptoms; also testing at this step 
+	StateChanges exposed_transitions(Agent& agent, Infection& infection, const double time, const double dt, 
 				std::vector<Household>& households, std::vector<School>& schools,
 				std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
 				std::vector<RetirementHome>& retirement_homes,
@@ -67,8 +82,8 @@ public:
 				const std::map<std::string, double>& infection_parameters, const Testing& testing);
 
 	/// \brief Transitions of a symptomatic agent 
-	/// @return Vector where first entry is one if agent recovered, second if agent died
-	std::vector<int> symptomatic_transitions(Agent& agent, const double time, 
+	/// @return Recovered or dead, and testing at this step
+	StateChanges symptomatic_transitions(Agent& agent, const double time, 
 				const double dt, Infection& infection,
 				std::vector<Household>& households, std::vector<School>& schools,
 				std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
@@ -99,11 +114,6 @@ private:
 	// For changing agent states
 	RegularStatesManager states_manager;
 
-	/// \brief Return total lambda of susceptible agent
-	double compute_susceptible_lambda(const Agent& agent, const double time, 
-					const std::vector<Household>& households, const std::vector<School>& schools,
-					const std::vector<Workplace>& workplaces, const std::vector<RetirementHome>& retirement_homes);
-
 	/// \brief Compte and set agent properties related to recovery without symptoms and incubation
 	void recovery_and_incubation(Agent& agent, Infection& infection, const double time,
 				                const std::map<std::string, double>& infection_parameters);
@@ -141,8 +151,8 @@ private:
 			const std::map<std::string, double>& infection_parameters);
 
 	/// \brief Verifies and manages removal of an agent from the model
-	/// @return Vector where first entry is one if agent recovered, second if agent died
-	std::vector<int> check_agent_removal(Agent& agent, const double time,
+	/// @return Recovered or dead, dead tested only if confirmed positive
+	StateChanges check_agent_removal(Agent& agent, const double time,
 					std::vector<Household>& households, std::vector<School>& schools,
 					std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
 				 	std::vector<RetirementHome>& retirement_homes);
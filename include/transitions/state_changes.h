@@ -0,0 +1,48 @@
+#ifndef STATE_CHANGES_H
+#define STATE_CHANGES_H
+
+/*****************************************************
+ * struct: StateChanges
+ *
+ * Changes in state of one agent during a time step
+ * reported by the transitions
+ *
+ * Plain fixed-size structure returned by value so
+ * that the transitions do not allocate memory for
+ * each agent. Value-initialize to start from no
+ * changes, i.e. StateChanges changes = {};
+ *
+ * Each entry is 1 if the change happened, 0 otherwise:
+ *	- infected - susceptible agent got infected
+ *	- recovered - infected agent recovered
+ *	- dead_tested - died after a positive test
+ *	- dead_not_tested - died without testing, with a false
+ *		negative result, or before receiving the results
+ *	- tested - tested at this step
+ *	- tested_positive, tested_negative, tested_false_positive,
+ *		tested_false_negative - results received at this step
+ *
+ ******************************************************/
+
+struct StateChanges{
+	int infected;
+	int recovered;
+	int dead_tested;
+	int dead_not_tested;
+	int tested;
+	int tested_positive;
+	int tested_negative;
+	int tested_false_positive;
+	int tested_false_negative;
+
+	/// True if none of the changes happened
+	bool none() const
+	{
+		return infected == 0 && recovered == 0 && dead_tested == 0
+			&& dead_not_tested == 0 && tested == 0 && tested_positive == 0
+			&& tested_negative == 0 && tested_false_positive == 0
+			&& tested_false_negative == 0;
+	}
+};
+
+#endif
@@ -20,6 +20,7 @@
 #include "hsp_employee_transitions.h"
 #include "hsp_patient_transitions.h"
 #include "flu_transitions.h"
+#include "state_changes.h"
 
 //
 // Other
@@ -30,6 +31,7 @@
 #include "../infection.h"
 #include "../flu.h"
 #include "../testing.h"
+#include "../model_features.h"
 
 /***************************************************** 
  * class: Transitions 
@@ -54,8 +56,10 @@ public:
 	//
 
 	/// \brief Implement transitions relevant to susceptible
-	/// \details Returns 1 if the agent got infected 
-	std::vector<int> susceptible_transitions(Agent& agent, const double time, 
+	/// \details Infected and testing at this step; agent types 
+	///		of the features disabled in Features are not considered 
+	template <typename Features = BuildFeatures>
+	StateChanges susceptible_transitions(Agent& agent, const double time, 
 				const double dt, Infection& infection,	
 				std::vector<Household>& households, std::vector<School>& schools,
 				std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
@@ -63,17 +67,42 @@ public:
 				const std::map<std::string, double>& infection_parameters, 
 				std::vector<Agent>& agents, Flu& flu, const Testing& testing);
 
+	/// \brief Total lambda of a susceptible agent without flu
+	/// \details Used by the batched infection draws 
+	double susceptible_lambda(const Agent& agent, const double time, 
+				const std::vector<Household>& households, const std::vector<School>& schools,
+				const std::vector<Workplace>& workplaces, const std::vector<Hospital>& hospitals,
+				const std::vector<RetirementHome>& retirement_homes);
+
+	/// \brief Number of times a place counts towards the lambda of a susceptible agent without flu
+	/// \details One overload per place type; used by the place-centric infection sampling
+	int susceptible_exposures(const Agent& agent, const Household& house) const;
+	int susceptible_exposures(const Agent& agent, const School& school) const;
+	int susceptible_exposures(const Agent& agent, const Workplace& workplace) const;
+	int susceptible_exposures(const Agent& agent, const Hospital& hospital) const;
+	int susceptible_exposures(const Agent& agent, const RetirementHome& rh) const;
+
+	/// \brief Set properties of a newly infected agent without flu 
+	/// \details Counterpart of susceptible_transitions once the agent is known to be infected
+	void process_new_infection(Agent& agent, const double time, Infection& infection,	
+				std::vector<School>& schools, std::vector<Workplace>& workplaces, 
+				std::vector<Hospital>& hospitals, std::vector<RetirementHome>& retirement_homes,
+				const std::map<std::string, double>& infection_parameters, 
+				Flu& flu, const Testing& testing);
+
 	/// \brief Implement transitions relevant to exposed
-	/// \details Return 1 if recovered without symptoms 
-	std::vector<int> exposed_transitions(Agent& agent, Infection& infection, const double time, const double dt, 
+	/// \details Recovered is 1 if recovered without symptoms; also testing at this step 
+	template <typename Features = BuildFeatures>
+	StateChanges exposed_transitions(Agent& agent, Infection& infection, const double time, const double dt, 
 				std::vector<Household>& households, std::vector<School>& schools,
 				std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
 				std::vector<RetirementHome>& retirement_homes,
 				const std::map<std::string, double>& infection_parameters, const Testing& testing);
 
 	/// \brief Transitions of a symptomatic agent 
-	/// @return Vector where first entry is one if agent recovered, second if agent died
-	std::vector<int> symptomatic_transitions(Agent& agent, const double time, 
+	/// @return Recovered or dead, and testing at this step
+	template <typename Features = BuildFeatures>
+	StateChanges symptomatic_transitions(Agent& agent, const double time, 
 				const double dt, Infection& infection,
 				std::vector<Household>& households, std::vector<School>& schools,
 				std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
@@ -2,6 +2,8 @@
 #define UTILS_H
 
 #include "common.h"
+#include <cstdint>
+#include <cstring>
 
 /**
  * \brief Convert a string to all lower case
@@ -24,6 +26,26 @@ std::string str_to_lower(std::string s);
 template <typename T>
 bool equal_floats(T, T, T);
 
+/**
+ * \brief Position of a point along a Hilbert curve
+ * \details Points close on the curve are also close in the plane
+ * @param x - first coordinate, 0 to 2^order - 1 
+ * @param y - second coordinate, 0 to 2^order - 1
+ * @param order - number of bits of each coordinate, at most 31
+ */
+std::uint64_t hilbert_curve_index(std::uint32_t x, std::uint32_t y, const int order);
+
+/**
+ * \brief Exponential of a non-positive number
+ * \details Range reduction to x = k*ln(2) + r and a Taylor polynomial
+ *		for exp(r); relative error is close to machine precision. Has no 
+ *		branches or library calls so loops using it can be vectorized.
+ *		Results for arguments below -708 are not valid, the caller 
+ *		needs to handle them separately.
+ * @param x - exponent, -708 <= x <= 0
+ */
+inline double exp_non_positive(const double x);
+
 //
 // Implementations
 //
@@ -36,5 +58,42 @@ bool equal_floats(T num1, T num2, T tol)
     return std::fabs(num1 - num2) <= tol*max_num_one;
 }
 
+// Exponential of a non-positive number
+inline double exp_non_positive(const double x)
+{
+	// Adding this shifts the rounded integer into low mantissa bits 
+	const double shift = 6755399441055744.0;
+	const double log2e = 1.4426950408889634;
+	const double ln2_hi = 6.93147180369123816490e-01;
+	const double ln2_lo = 1.90821492927058770002e-10;
+
+	// k = round(x/ln(2)) and reduced argument r
+	const double t = x*log2e + shift;
+	const double kd = t - shift;
+	const double r = (x - kd*ln2_hi) - kd*ln2_lo;
+
+	// exp(r), |r| <= ln(2)/2
+	double p = 1.0/39916800.0;
+	p = p*r + 1.0/3628800.0;
+	p = p*r + 1.0/362880.0;
+	p = p*r + 1.0/40320.0;
+	p = p*r + 1.0/5040.0;
+	p = p*r + 1.0/720.0;
+	p = p*r + 1.0/120.0;
+	p = p*r + 1.0/24.0;
+	p = p*r + 1.0/6.0;
+	p = p*r + 0.5;
+	p = p*r + 1.0;
+	p = p*r + 1.0;
+
+	// 2^k assembled directly from the exponent bits 
+	std::uint64_t t_bits = 0;
+	std::memcpy(&t_bits, &t, sizeof(double));
+	const std::uint64_t scale_bits = (t_bits + 1023) << 52;
+	double scale = 0.0;
+	std::memcpy(&scale, &scale_bits, sizeof(double));
+
+	return p*scale;
+}
 
 #endif
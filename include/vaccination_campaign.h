@@ -0,0 +1,144 @@
+#ifndef VACCINATION_CAMPAIGN_H
+#define VACCINATION_CAMPAIGN_H
+
+#include "common.h"
+#include "agent.h"
+#include "rng.h"
+#include <limits>
+
+/*****************************************************
+ * class: VaccinationCampaign
+ *
+ * Daily dose schedules for prioritized groups of
+ * agents
+ *
+ * A group is a type of agents, e.g. school employees
+ * or the whole population, within an age range. A
+ * phase gives the number of doses per day during a
+ * time interval and the quota of each group, i.e. the
+ * fraction of the doses reserved for it. Doses that a
+ * group cannot use, because its quota is not set or no
+ * eligible members are left, go to the groups in the
+ * order they were added, which is their priority.
+ *
+ * Each group keeps a pool of its members that can 
+ * still be vaccinated. Doses are drawn from the pool
+ * without replacement by partial Fisher-Yates, so a
+ * step costs O(doses). Members that were infected,
+ * removed, or vaccinated through another group are
+ * dropped from the pool when drawn; members with flu
+ * are skipped for that step only.
+ *
+ *****************************************************/
+
+class VaccinationCampaign{
+public:
+
+	/// Types of agents a group is selected from
+	enum group_type { population, hospital_employees, school_employees, 
+						retirement_home_employees, retirement_home_residents };
+
+	struct Group{
+		std::string name;
+		group_type type = population;
+		// Inclusive range of ages
+		int min_age = 0;
+		int max_age = std::numeric_limits<int>::max();
+	};
+
+	struct Phase{
+		double start = 0.0;
+		double end = 0.0;
+		double daily_doses = 0.0;
+		// Fraction of the doses for each group, in order of groups
+		std::vector<double> quotas;
+	};
+
+	//
+	// Constructors
+	//
+
+	/// Creates an empty campaign
+	VaccinationCampaign() = default;
+
+	//
+	// Setup
+	//
+
+	/**
+	 * \brief Add a group, after all the groups with higher priority
+	 * \details Throws std::invalid_argument for a wrong age range
+	 * @param name - name of the group 
+	 * @param type - type of agents in the group
+	 * @param min_age - lowest age
+	 * @param max_age - highest age
+	 */
+	void add_group(const std::string& name, const group_type type, const int min_age = 0, 
+						const int max_age = std::numeric_limits<int>::max());
+
+	/**
+	 * \brief Add a phase of the campaign
+	 * \details Doses are given in steps with start <= time < end. Throws
+	 *		std::invalid_argument for a wrong interval, negative doses, or
+	 *		quotas that are negative, sum to more than 1, or do not match 
+	 *		the groups.
+	 * @param start - first time of the phase
+	 * @param end - time when the phase ends
+	 * @param daily_doses - number of doses per day 
+	 * @param quotas - fraction of the doses of each group, in order of groups
+	 */
+	void add_phase(const double start, const double end, const double daily_doses, 
+						const std::vector<double>& quotas);
+
+	/// Restart the random number generator 
+	void set_rng_seed(const unsigned seed) { rng.set_seed(seed); }
+
+	//
+	// Vaccination
+	//
+
+	/**
+	 * \brief Vaccinate the agents of this step
+	 * \details Pools are created at the first call. Fractions of doses 
+	 *		are carried over to the next steps.
+	 * @param agents - all the agents of the model
+	 * @param local - true for the agents processed by this model, all if empty
+	 * @param time - current time
+	 * @param dt - time step
+	 * @return Number of agents vaccinated
+	 */
+	int vaccinate(std::vector<Agent>& agents, const std::vector<bool>& local, 
+					const double time, const double dt);
+
+	//
+	// Getters
+	//
+
+	const std::vector<Group>& get_groups() const { return groups; }
+	const std::vector<Phase>& get_phases() const { return phases; }
+	/// Number of agents vaccinated through each group
+	const std::vector<int>& get_vaccinated_per_group() const { return n_vaccinated; }
+	/// Number of agents left in the pool of each group, including those not eligible anymore
+	std::vector<int> get_pool_sizes() const;
+
+private:
+	std::vector<Group> groups;
+	std::vector<Phase> phases;
+	RNG rng;
+
+	// Agent IDs that can still be vaccinated in each group
+	std::vector<std::vector<int>> pools;
+	bool pools_created = false;
+	// Doses not given yet, fractions from previous steps
+	double carried_doses = 0.0;
+	std::vector<int> n_vaccinated;
+
+	/// Create the pools of all the groups
+	void create_pools(const std::vector<Agent>& agents, const std::vector<bool>& local);
+	/// True if the agent belongs to the group
+	bool in_group(const Agent& agent, const Group& group) const;
+	/// Vaccinate up to n members of a group, return the number vaccinated
+	int vaccinate_group(std::vector<Agent>& agents, const int group, const int n);
+};
+
+#endif
@@ -4,6 +4,8 @@
 #
 #	- Does not check for upper numeric limits since they are rather
 #		high 	
+#	- The same checks run in the C++ loader when enabled with
+#		ABM::set_input_validation, see io_operations/input_validator.h
 #
 # ------------------------------------------------------------------
 
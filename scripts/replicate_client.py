@@ -0,0 +1,86 @@
+# # # # # # # # # # # # # # # # # # # # # # # # #
+# Client of the replicate server
+#
+# Sends run requests to a server started with a
+# loaded population, e.g. covid_server, over its
+# Unix socket and returns the results
+#
+# Usage:
+#	with ReplicateClient('covid_server.sock') as client:
+#		metrics, series = client.run(seed=2021, steps=400,
+#			parameters={'household transmission rate' : 0.5},
+#			outputs=['infected', 'tested positive'])
+#
+# # # # # # # # # # # # # # # # # # # # # # # # #
+
+import socket
+
+class ReplicateClient:
+	''' Connection to a replicate server, any number of runs '''
+
+	def __init__(self, socket_path):
+		''' Connect to the server listening on socket_path '''
+		self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+		self.sock.connect(socket_path)
+		self.stream = self.sock.makefile('r')
+
+	def __enter__(self):
+		return self
+
+	def __exit__(self, *args):
+		self.close()
+
+	def close(self):
+		''' Close the connection '''
+		self.stream.close()
+		self.sock.close()
+
+	def run(self, seed, steps, parameters={}, outputs=[]):
+		''' Run one replicate, returns dictionaries of metrics and
+				requested series, names with spaces; raises
+				RuntimeError if the server reports an error '''
+		lines = ['run', 'seed ' + str(seed), 'steps ' + str(steps)]
+		for name, value in parameters.items():
+			lines.append('parameter ' + protocol_name(name) + ' ' + repr(float(value)))
+		for name in outputs:
+			lines.append('output ' + protocol_name(name))
+		lines.append('end')
+		self.sock.sendall(('\n'.join(lines) + '\n').encode())
+
+		metrics = {}
+		series = {}
+		for line in self.read_response():
+			fields = line.split()
+			if fields[0] == 'error':
+				raise RuntimeError(line[len('error '):])
+			if fields[0] == 'metric':
+				metrics[model_name(fields[1])] = float(fields[2])
+			elif fields[0] == 'series':
+				series[model_name(fields[1])] = [int(x) for x in fields[2:]]
+		return metrics, series
+
+	def read_response(self):
+		''' Lines of one response without the closing line '''
+		lines = []
+		for line in self.stream:
+			line = line.rstrip('\n')
+			if line == 'end':
+				return lines
+			lines.append(line)
+		raise RuntimeError('Connection closed by the server')
+
+def shutdown(socket_path):
+	''' Stop the server once its current runs finish '''
+	sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+	sock.connect(socket_path)
+	sock.sendall(b'shutdown\n')
+	sock.recv(16)
+	sock.close()
+
+def protocol_name(name):
+	''' Name with spaces written as underscores '''
+	return name.replace(' ', '_')
+
+def model_name(name):
+	''' Name with underscores written as spaces '''
+	return name.replace('_', ' ')
@@ -17,6 +17,15 @@ src_files += ' ' + path + 'agent.cpp'
 src_files += ' ' + path + 'infection.cpp'
 src_files += ' ' + path + 'contributions.cpp'
 src_files += ' ' + path + 'testing.cpp'
+src_files += ' ' + path + 'interventions.cpp'
+src_files += ' ' + path + 'spatial_transmission.cpp'
+src_files += ' ' + path + 'vaccination_campaign.cpp'
+src_files += ' ' + path + 'metrics.cpp'
+src_files += ' ' + path + 'lineage_log.cpp'
+src_files += ' ' + path + 'memory_arena.cpp'
+src_files += ' ' + path + 'io_operations/state_snapshots.cpp'
+src_files += ' ' + path + 'io_operations/input_validator.cpp'
+src_files += ' ' + path + 'shared_population/population_segment.cpp'
 src_files += ' ' + path + 'transitions/transitions.cpp'
 src_files += ' ' + path + 'transitions/regular_transitions.cpp'
 src_files += ' ' + path + 'transitions/hsp_employee_transitions.cpp'
@@ -28,6 +37,7 @@ src_files += ' ' + path + 'states_manager/hsp_employee_states_manager.cpp'
 src_files += ' ' + path + 'flu.cpp'
 src_files += ' ' + path + 'utils.cpp'
 src_files += ' ' + path + 'places/place.cpp'
+src_files += ' ' + path + 'places/roster.cpp'
 src_files += ' ' + path + 'places/household.cpp'
 src_files += ' ' + path + 'places/workplace.cpp'
 src_files += ' ' + path + 'places/school.cpp'
@@ -35,6 +45,7 @@ src_files += ' ' + path + 'places/hospital.cpp'
 src_files += ' ' + path + 'places/retirement_home.cpp'
 src_files += ' ' + path + 'io_operations/FileHandler.cpp'
 src_files += ' ' + path + 'io_operations/load_parameters.cpp'
+src_files += ' ' + path + 'replicate_server/replicate_server.cpp'
 tst_files = '../common/test_utils.cpp'
 
 # Name of the executable
@@ -44,4 +55,21 @@ spec_files = 'covid_model.cpp '
 compile_com = ' '.join([cx, std, opt, '-o', exe_name, spec_files, src_files])
 subprocess.call([compile_com], shell=True)
 
+# Specialized builds of the same model, see include/model_features.h
+# Only the totals, without the series of every step
+exe_name = 'covid_exe_totals'
+spec_files = 'covid_model.cpp '
+compile_com = ' '.join([cx, std, opt, '-DABM_TOTALS_ONLY', '-o', exe_name, spec_files, src_files])
+subprocess.call([compile_com], shell=True)
 
+# Only the totals and no agents with flu
+exe_name = 'covid_exe_totals_no_flu'
+spec_files = 'covid_model.cpp '
+compile_com = ' '.join([cx, std, opt, '-DABM_TOTALS_ONLY', '-DABM_WITHOUT_FLU', '-o', exe_name, spec_files, src_files])
+subprocess.call([compile_com], shell=True)
+
+# Replicate server, loads the population once
+exe_name = 'covid_server'
+spec_files = 'covid_server.cpp '
+compile_com = ' '.join([cx, std, opt, '-o', exe_name, spec_files, src_files])
+subprocess.call([compile_com], shell=True)
@@ -0,0 +1,61 @@
+#include "../../include/replicate_server/replicate_server.h"
+
+/***************************************************** 
+ *
+ * Replicate server for COVID-19 SEIR in New Rochelle, NY 
+ *
+ * Loads the population once and serves run requests
+ * on a Unix socket, e.g. from scripts/replicate_client.py
+ *
+ * Usage: ./covid_server [socket path]
+ *
+ ******************************************************/
+
+int main(int argc, char* argv[])
+{
+	// Time in days, space in km
+	double dt = 0.25;
+	// Number of initially infected
+	int inf0 = 22;
+	// Socket for the requests
+	std::string socket_path = (argc > 1) ? argv[1] : "covid_server.sock";
+
+	// Input files
+	std::string fin("input_data/NR_agents.txt");
+	std::string hfile("input_data/NR_households.txt");
+	std::string sfile("input_data/NR_schools.txt");
+	std::string wfile("input_data/NR_workplaces.txt");
+	std::string hsp_file("input_data/NR_hospitals.txt");
+	std::string rh_file("input_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("input_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("input_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("input_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("input_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("input_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles = 
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name}, 
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with testing changes	
+	std::string tfname("input_data/tests_with_time.txt");
+
+	ABM abm(dt, pfname, dfiles, tfname);
+
+	// First the places
+	abm.create_households(hfile);
+	abm.create_schools(sfile);
+	abm.create_workplaces(wfile);
+	abm.create_hospitals(hsp_file);
+	abm.create_retirement_homes(rh_file);
+
+	// Then the agents
+	abm.create_agents(fin, inf0);
+
+	// Serve until a shutdown request
+	ReplicateServer server(abm, socket_path);
+	std::cout << "Serving replicates on " << socket_path << std::endl;
+	server.serve();
+}
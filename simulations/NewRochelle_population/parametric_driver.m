@@ -7,7 +7,8 @@ num_sim = 100;
 num_steps = 600;
 num_pop = 79205;
 dt = 0.25;
-time=0:dt:dt*num_steps;
+% Metrics are recorded at the end of each step (see read_metrics.m)
+time=dt:dt:dt*(num_steps+1);
 
 % All the collected data
 inf_data = zeros(num_sim, num_steps+1);
@@ -35,28 +36,29 @@ tot_icu = zeros(num_sim, num_steps+1);
 for i=1:num_sim
    !./covid_exe >> output/simulation.log
    % Collect 
-   inf_data(i,:) = load('output/infected_with_time.txt');
-   new_pos_data(i,:) = load('output/new_tested_pos_step.txt');
-   new_neg_data(i,:) = load('output/new_tested_neg_step.txt');
-   new_fpos_data(i,:) = load('output/new_tested_false_pos_step.txt');
-   new_fneg_data(i,:) = load('output/new_tested_false_neg_step.txt');
+   metrics = read_metrics('output/metrics.csv');
+   inf_data(i,:) = metrics('infected');
+   new_pos_data(i,:) = metrics('new tested positive');
+   new_neg_data(i,:) = metrics('new tested negative');
+   new_fpos_data(i,:) = metrics('new tested false positive');
+   new_fneg_data(i,:) = metrics('new tested false negative');
    %
-   new_tested(i,:) = load('output/new_tested_step.txt');
-   new_infected(i,:) = load('output/new_infected_step.txt');
+   new_tested(i,:) = metrics('new tested');
+   new_infected(i,:) = metrics('new infected');
    %
-   tot_pos(i,:) = load('output/total_tested_pos.txt');
-   tot_tested(i,:) = load('output/total_tested.txt');
-   tot_active(i,:) = load('output/active_with_time.txt');
-   tot_deaths(i,:) = load('output/dead_with_time.txt');
-   tested_deaths(i,:) = load('output/tested_dead_with_time.txt');
-   not_tested_deaths(i,:) = load('output/not_tested_dead_with_time.txt');
-   tot_fneg(i,:) = load('output/total_tested_false_neg.txt');
-   tot_fpos(i,:) = load('output/total_tested_false_pos.txt');
-   tot_neg(i,:) = load('output/total_tested_neg.txt');
+   tot_pos(i,:) = metrics('total tested positive');
+   tot_tested(i,:) = metrics('total tested');
+   tot_active(i,:) = metrics('active');
+   tot_deaths(i,:) = metrics('total dead');
+   tested_deaths(i,:) = metrics('tested dead');
+   not_tested_deaths(i,:) = metrics('not tested dead');
+   tot_fneg(i,:) = metrics('total tested false negative');
+   tot_fpos(i,:) = metrics('total tested false positive');
+   tot_neg(i,:) = metrics('total tested negative');
    %
-   tot_ih(i,:) = load('output/home_isolated_with_time.txt');
-   tot_hn(i,:) = load('output/hospitalized_with_time.txt');
-   tot_icu(i,:) = load('output/icu_with_time.txt');
+   tot_ih(i,:) = metrics('home isolated');
+   tot_hn(i,:) = metrics('hospitalized');
+   tot_icu(i,:) = metrics('ICU');
 end
 
 save('base_case')
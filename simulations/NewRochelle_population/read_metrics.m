@@ -0,0 +1,20 @@
+function metrics = read_metrics(fname)
+% Read the metrics saved by the model as a map from
+% the metric names to their values, one per step
+%
+% Values of a step are recorded at its end: counters
+% hold what happened during the step, gauges (totals
+% and census) the state after it. Value i is at time
+% i*dt, one step later than the totals and census of
+% the earlier drivers, which were saved before each
+% step; the initial state is not included.
+
+fid = fopen(fname);
+names = strsplit(fgetl(fid), ',');
+fclose(fid);
+
+values = csvread(fname, 1, 0);
+metrics = containers.Map();
+for j=1:length(names)
+    metrics(names{j}) = values(:,j)';
+end
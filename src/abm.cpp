@@ -37,14 +37,7 @@ void ABM::initialize_data_collection()
 	tot_tested_false_pos = 0;
 	tot_tested_false_neg = 0;
 
-	n_infected_day = {};
-	n_dead_day = {};
-	n_recovered_day = {};
-	tested_day = {};
-	tested_pos_day = {};	
-	tested_neg_day = {};
-	tested_false_pos_day = {};
-	tested_false_neg_day = {};
+	metrics.clear();
 }
 
 // Load infection parameters, store in a map
@@ -53,7 +46,12 @@ void ABM::load_infection_parameters(const std::string infile)
 	// Load parameters
 	LoadParameters ldparam;
 	infection_parameters = ldparam.load_parameter_map(infile);
+	set_infection_properties();
+}
 
+// Infection distributions and probabilities from the infection parameters
+void ABM::set_infection_properties()
+{
 	// Set infection distributions
 	infection.set_latency_distribution(infection_parameters.at("latency log-normal mean"),
 					infection_parameters.at("latency log-normal standard deviation"));	
@@ -83,6 +81,12 @@ void ABM::load_age_dependent_distributions(const std::map<std::string, std::stri
 		one_file.clear();
 	}
 
+	set_age_dependent_properties();
+}
+
+// Age-dependent infection properties from the stored distributions
+void ABM::set_age_dependent_properties()
+{
 	// Send to Infection class for further processing 
 	infection.set_expN2sy_fractions(age_dependent_distributions.at("exposed never symptomatic"));
 	infection.set_mortality_rates(age_dependent_distributions.at("mortality"));
@@ -94,12 +98,7 @@ void ABM::load_age_dependent_distributions(const std::map<std::string, std::stri
 void ABM::load_testing(const std::string fname) 
 {
 	// Regular properties
-	testing.initialize_testing(infection_parameters.at("start testing"),
-					infection_parameters.at("negative tests fraction"),
-					infection_parameters.at("fraction false negative"),
-					infection_parameters.at("fraction false positive"),
-					infection_parameters.at("fraction to get tested"),
-					infection_parameters.at("exposed fraction to get tested"));	
+	set_testing_properties();
 	// Time-dependent test fractions
 	std::vector<std::vector<std::string>> file = read_object(fname);
 	std::vector<std::vector<double>> fractions_times = {};
@@ -113,6 +112,107 @@ void ABM::load_testing(const std::string fname)
 	testing.set_time_varying(fractions_times);
 }
 
+// Testing properties from the infection parameters
+void ABM::set_testing_properties()
+{
+	testing.initialize_testing(infection_parameters.at("start testing"),
+					infection_parameters.at("negative tests fraction"),
+					infection_parameters.at("fraction false negative"),
+					infection_parameters.at("fraction false positive"),
+					infection_parameters.at("fraction to get tested"),
+					infection_parameters.at("exposed fraction to get tested"));	
+}
+
+// Interventions defined by the infection parameters
+void ABM::set_default_interventions()
+{
+	interventions.clear();
+
+	Interventions::Intervention closure;
+	closure.time = infection_parameters.at("school closure");
+	closure.target = Interventions::schools;
+	closure.action = Interventions::closure;
+	interventions.add(closure);
+
+	// Lockdown and reopening of businesses
+	const std::vector<std::pair<std::string, std::string>> phases = 
+		{{"lockdown", "fraction of ld businesses"}, 
+		 {"reopening phase 1", "fraction of phase 1 businesses"},
+		 {"reopening phase 2", "fraction of phase 2 businesses"},
+		 {"reopening phase 3", "fraction of phase 3 businesses"}};
+	for (const auto& phase : phases){
+		Interventions::Intervention change;
+		change.time = infection_parameters.at(phase.first);
+		change.target = Interventions::workplaces;
+		change.action = Interventions::transmission;
+		change.value = infection_parameters.at(phase.second);
+		interventions.add(change);
+		change.action = Interventions::absenteeism;
+		change.value = infection_parameters.at("lockdown absenteeism");
+		interventions.add(change);
+	}
+}
+
+// Replace the interventions with a timeline from a file
+void ABM::load_interventions(const std::string fname)
+{
+	Interventions timeline;
+	timeline.load(fname);
+	for (const auto& intervention : timeline.get_interventions()){
+		int n_places = 0;
+		if (intervention.target == Interventions::households){
+			n_places = households.size();
+		} else if (intervention.target == Interventions::schools){
+			n_places = schools.size();
+		} else if (intervention.target == Interventions::workplaces){
+			n_places = workplaces.size();
+		}
+		if (intervention.last > n_places){
+			throw std::invalid_argument("Range of places in an intervention outside of the existing places");
+		}
+		const double n_steps = intervention.time/dt;
+		if (std::abs(n_steps - std::round(n_steps)) > 1e-6){
+			throw std::invalid_argument("Time of an intervention is not a multiple of the time step");
+		}
+	}
+	interventions = timeline;
+	default_interventions = false;
+}
+
+// Replace values of infection parameters and set up the model again
+void ABM::set_infection_parameters(const std::map<std::string, double>& new_values)
+{
+	if (time > 0.0){
+		throw std::runtime_error("Infection parameters can only be changed before the first step");
+	}
+	for (const auto& entry : new_values){
+		if (infection_parameters.count(entry.first) == 0){
+			throw std::invalid_argument("Unknown infection parameter: " + entry.first);
+		}
+		infection_parameters.at(entry.first) = entry.second;
+	}
+
+	set_infection_properties();
+	set_testing_properties();
+	set_flu_properties();
+	if (default_interventions){
+		set_default_interventions();
+	}
+
+	// Places with the same locations and agents
+	rebuild_places(households, [this](const Household& house)
+		{ return make_household(house.get_ID(), house.get_x_location(), house.get_y_location()); });
+	rebuild_places(retirement_homes, [this](const RetirementHome& rh)
+		{ return make_retirement_home(rh.get_ID(), rh.get_x_location(), rh.get_y_location()); });
+	rebuild_places(schools, [this](const School& school)
+		{ return make_school(school.get_ID(), school.get_x_location(), school.get_y_location(), school.get_type()); });
+	rebuild_places(workplaces, [this](const Workplace& work)
+		{ return make_workplace(work.get_ID(), work.get_x_location(), work.get_y_location()); });
+	const std::map<const std::string, const double> betas = hospital_betas();
+	rebuild_places(hospitals, [this, &betas](const Hospital& hospital)
+		{ return make_hospital(hospital.get_ID(), hospital.get_x_location(), hospital.get_y_location(), betas); });
+}
+
 // Generate and store household objects
 void ABM::create_households(const std::string fname)
 {
@@ -121,15 +221,8 @@ void ABM::create_households(const std::string fname)
 	
 	// One household per line
 	for (auto& house : file){
-		// Extract properties, add infection parameters
-		Household temp_house(std::stoi(house.at(0)), 
-			std::stod(house.at(1)), std::stod(house.at(2)),
-			infection_parameters.at("household scaling parameter"),
-			infection_parameters.at("severity correction"),
-			infection_parameters.at("household transmission rate"),
-			infection_parameters.at("transmission rate of home isolated"));
-		// Store 
-		households.push_back(temp_house);
+		households.push_back(make_household(std::stoi(house.at(0)), 
+			std::stod(house.at(1)), std::stod(house.at(2))));
 	}
 }
 
@@ -139,18 +232,10 @@ void ABM::create_retirement_homes(const std::string fname)
 	// Read the whole file
 	std::vector<std::vector<std::string>> file = read_object(fname);
 	
-	// One household per line
+	// One retirement home per line
 	for (auto& rh : file){
-		// Extract properties, add infection parameters
-		RetirementHome temp_RH(std::stoi(rh.at(0)), 
-			std::stod(rh.at(1)), std::stod(rh.at(2)),
-			infection_parameters.at("severity correction"),
-			infection_parameters.at("RH employee absenteeism factor"),
-			infection_parameters.at("RH employee transmission rate"),
-			infection_parameters.at("RH resident transmission rate"),
-			infection_parameters.at("RH transmission rate of home isolated"));
-		// Store 
-		retirement_homes.push_back(temp_RH);
+		retirement_homes.push_back(make_retirement_home(std::stoi(rh.at(0)), 
+			std::stod(rh.at(1)), std::stod(rh.at(2))));
 	}
 }
 
@@ -160,33 +245,10 @@ void ABM::create_schools(const std::string fname)
 	// Read the whole file
 	std::vector<std::vector<std::string>> file = read_object(fname);
 	
-	// One workplace per line
+	// One school per line
 	for (auto& school : file){
-		// Extract properties, add infection parameters
-
-		// School-type dependent absenteeism
-		double psi = 0.0;
-		std::string school_type = school.at(3);
-		if (school_type == "daycare")
- 			psi = infection_parameters.at("daycare absenteeism correction");
-		else if (school_type == "primary" || school_type == "middle")
- 			psi = infection_parameters.at("primary and middle school absenteeism correction");
-		else if (school_type == "high")
- 			psi = infection_parameters.at("high school absenteeism correction");
-		else if (school_type == "college")
- 			psi = infection_parameters.at("college absenteeism correction");
-		else
-			throw std::invalid_argument("Wrong school type: " + school_type);
-
-		School temp_school(std::stoi(school.at(0)), 
-			std::stod(school.at(1)), std::stod(school.at(2)),
-			infection_parameters.at("severity correction"),	
-			infection_parameters.at("school employee absenteeism correction"), psi,
-			infection_parameters.at("school employee transmission rate"), 
-			infection_parameters.at("school transmission rate"));
-		
-		// Store 
-		schools.push_back(temp_school);
+		schools.push_back(make_school(std::stoi(school.at(0)), 
+			std::stod(school.at(1)), std::stod(school.at(2)), school.at(3)));
 	}
 }
 
@@ -198,15 +260,8 @@ void ABM::create_workplaces(const std::string fname)
 	
 	// One workplace per line
 	for (auto& work : file){
-		// Extract properties, add infection parameters
-		Workplace temp_work(std::stoi(work.at(0)), 
-			std::stod(work.at(1)), std::stod(work.at(2)),
-			infection_parameters.at("severity correction"),
-			infection_parameters.at("work absenteeism correction"),
-			infection_parameters.at("workplace transmission rate"));
-
-		// Store 
-		workplaces.push_back(temp_work);
+		workplaces.push_back(make_workplace(std::stoi(work.at(0)), 
+			std::stod(work.at(1)), std::stod(work.at(2))));
 	}
 }
 
@@ -216,69 +271,152 @@ void ABM::create_hospitals(const std::string fname)
 	// Read the whole file
 	std::vector<std::vector<std::string>> file = read_object(fname);
 	
-	// One hospital per line
+	// One hospital per line, all with the same transmission rates
+	const std::map<const std::string, const double> betas = hospital_betas();
 	for (auto& hospital : file){
-		// Make a map of transmission rates for different 
-		// hospital-related categories
-		std::map<const std::string, const double> betas = 
-			{{"hospital employee", infection_parameters.at("healthcare employees transmission rate")}, 
-			 {"hospital non-COVID patient", infection_parameters.at("hospital patients transmission rate")},
-			 {"hospital testee", infection_parameters.at("hospital tested transmission rate")},
-			 {"hospitalized", infection_parameters.at("hospitalized transmission rate")}, 
-			 {"hospitalized ICU", infection_parameters.at("hospitalized ICU transmission rate")}};
+		hospitals.push_back(make_hospital(std::stoi(hospital.at(0)), 
+			std::stod(hospital.at(1)), std::stod(hospital.at(2)), betas));
+	}
+}
 
-		Hospital temp_hospital(std::stoi(hospital.at(0)), 
-			std::stod(hospital.at(1)), std::stod(hospital.at(2)),
-			infection_parameters.at("severity correction"), betas);
+// Household with the current infection parameters
+Household ABM::make_household(const int ID, const double x, const double y) const
+{
+	return Household(ID, x, y, 
+			infection_parameters.at("household scaling parameter"),
+			infection_parameters.at("severity correction"),
+			infection_parameters.at("household transmission rate"),
+			infection_parameters.at("transmission rate of home isolated"));
+}
 
-		// Store 
-		hospitals.push_back(temp_hospital);
-	}
+// Retirement home with the current infection parameters
+RetirementHome ABM::make_retirement_home(const int ID, const double x, const double y) const
+{
+	return RetirementHome(ID, x, y,
+			infection_parameters.at("severity correction"),
+			infection_parameters.at("RH employee absenteeism factor"),
+			infection_parameters.at("RH employee transmission rate"),
+			infection_parameters.at("RH resident transmission rate"),
+			infection_parameters.at("RH transmission rate of home isolated"));
 }
 
-// Create agents and assign them to appropriate places
-void ABM::create_agents(const std::string fname, const int ninf0)
+// School with the current infection parameters
+School ABM::make_school(const int ID, const double x, const double y, const std::string& school_type) const
 {
-	load_agents(fname, ninf0);
-	register_agents();
+	// School-type dependent absenteeism
+	double psi = 0.0;
+	if (school_type == "daycare")
+		psi = infection_parameters.at("daycare absenteeism correction");
+	else if (school_type == "primary" || school_type == "middle")
+		psi = infection_parameters.at("primary and middle school absenteeism correction");
+	else if (school_type == "high")
+		psi = infection_parameters.at("high school absenteeism correction");
+	else if (school_type == "college")
+		psi = infection_parameters.at("college absenteeism correction");
+	else
+		throw std::invalid_argument("Wrong school type: " + school_type);
+
+	return School(ID, x, y,
+			infection_parameters.at("severity correction"),	
+			infection_parameters.at("school employee absenteeism correction"), psi,
+			infection_parameters.at("school employee transmission rate"), 
+			infection_parameters.at("school transmission rate"), school_type);
 }
 
-// Retrieve agent information from a file
-void ABM::load_agents(const std::string fname, const int ninf0)
+// Workplace with the current infection parameters
+Workplace ABM::make_workplace(const int ID, const double x, const double y) const
 {
-	// Read the whole file
-	std::vector<std::vector<std::string>> file = read_object(fname);
+	return Workplace(ID, x, y,
+			infection_parameters.at("severity correction"),
+			infection_parameters.at("work absenteeism correction"),
+			infection_parameters.at("workplace transmission rate"));
+}
 
-	// Flu settings
+// Hospital with the current infection parameters
+Hospital ABM::make_hospital(const int ID, const double x, const double y, 
+							const std::map<const std::string, const double>& betas) const
+{
+	return Hospital(ID, x, y, infection_parameters.at("severity correction"), betas);
+}
+
+// Transmission rates of all hospitals
+std::map<const std::string, const double> ABM::hospital_betas() const
+{
+	// Make a map of transmission rates for different 
+	// hospital-related categories
+	return {{"hospital employee", infection_parameters.at("healthcare employees transmission rate")}, 
+		 {"hospital non-COVID patient", infection_parameters.at("hospital patients transmission rate")},
+		 {"hospital testee", infection_parameters.at("hospital tested transmission rate")},
+		 {"hospitalized", infection_parameters.at("hospitalized transmission rate")}, 
+		 {"hospitalized ICU", infection_parameters.at("hospitalized ICU transmission rate")}};
+}
+
+// Flu properties from the infection parameters
+void ABM::set_flu_properties()
+{
 	// Set fraction of flu (non-covid symptomatic)
 	flu.set_fraction(infection_parameters.at("fraction with flu"));
 	flu.set_fraction_tested_false_positive(infection_parameters.at("fraction false positive"));
 	// Time interval for testing
 	flu.set_testing_duration(infection_parameters.at("flu testing duration"));
+}
 
-	// For custom generation of initially infected
-	std::vector<int> infected_IDs(ninf0);
-	bool not_unique = true;
-	int inf_ID = 0;
-	if (ninf0 != 0){
-		int nIDs = file.size();
-		// Random choice of IDs
-		for (int i=0; i<ninf0; ++i){
-			not_unique = true;
-			while (not_unique){
-				inf_ID = infection.get_random_agent_ID(nIDs);
-				auto iter = std::find(infected_IDs.begin(), infected_IDs.end(), inf_ID);
-				not_unique = (iter != infected_IDs.end()); 
+// Create agents and assign them to appropriate places
+void ABM::create_agents(const std::string fname, const int ninf0)
+{
+	load_agents(fname, ninf0);
+	register_agents();
+}
+
+// Retrieve agent information from a file
+void ABM::load_agents(const std::string fname, const int ninf0)
+{
+	typedef PopulationSegment PS;
+	const int n_cols = PS::infected + 1;
+	// Input columns of the integer attributes, in order of PS::agent_column 
+	const int file_columns[n_cols] = {0, 1, 2, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14};
+
+	// Parse the whole file into columns, one line per agent
+	int n_agents = 0;
+	std::vector<std::int32_t> values;
+	std::vector<double> xy;
+	{
+		std::vector<std::vector<std::string>> file = read_object(fname);
+		n_agents = file.size();
+		values.resize(n_cols*n_agents);
+		xy.resize(2*n_agents);
+		for (int i = 0; i < n_agents; ++i){
+			const std::vector<std::string>& line = file.at(i);
+			for (int jc = 0; jc < n_cols; ++jc){
+				values.at(jc*n_agents + i) = std::stoi(line.at(file_columns[jc]));
 			}
-			infected_IDs.at(i) = inf_ID;
+			xy.at(i) = std::stod(line.at(3));
+			xy.at(n_agents + i) = std::stod(line.at(4));
 		}
 	}
+	if (validate_input){
+		check_input(n_agents, values.data(), xy.data(), xy.data() + n_agents);
+	}
+	auto value = [&values, n_agents](const PS::agent_column col, const int i)
+		{ return values[col*n_agents + i]; };
+
+	// Flu settings
+	set_flu_properties();
+
+	// For custom generation of initially infected
+	std::vector<int> infected_IDs = random_infected_IDs(n_agents, ninf0);
 
 	// Counter for agent IDs
 	int agent_ID = 1;
+
+	// One storage for the profiles of all agents
+	auto profiles = std::make_shared<std::vector<AgentProfile>>();
+	profiles->reserve(n_agents);
+	agents.reserve(n_agents);
 	
 	// One agent per line, with properties as defined in the line
-	for (auto agent : file){
+	agents.reserve(n_agents);
+	for (int i = 0; i < n_agents; ++i){
 		// Agent status
 		bool student = false, works = false, livesRH = false, worksRH = false,  
 			 worksSch = false, patient = false, hospital_staff = false;
@@ -286,22 +424,22 @@ void ABM::load_agents(const std::string fname, const int ninf0)
 
 		// Household ID only if not hospitalized with condition
 		// different than COVID-19
-		if (std::stoi(agent.at(6)) == 1){
+		if (value(PS::non_covid_patient, i) == 1){
 			patient = true;
 			house_ID = 0;
 		}else{
-			house_ID = std::stoi(agent.at(5));
+			house_ID = value(PS::household_ID, i);
 		}
 
 		// No school or work if patient with condition other than COVID
-		if (std::stoi(agent.at(12)) == 1 && !patient){
+		if (value(PS::hospital_employee, i) == 1 && !patient){
 			hospital_staff = true;
 		}
-		if (std::stoi(agent.at(0)) == 1 && !patient){
+		if (value(PS::student, i) == 1 && !patient){
 			student = true;
 		}
 	   	// No work if a hospital employee	
-		if (std::stoi(agent.at(1)) == 1 && !(patient || hospital_staff)){
+		if (value(PS::works, i) == 1 && !(patient || hospital_staff)){
 			works = true; 
 		}
 			
@@ -315,31 +453,30 @@ void ABM::load_agents(const std::string fname, const int ninf0)
 				n_infected_tot++;
 			}
 		} else {
-			if (std::stoi(agent.at(14)) == 1){
+			if (value(PS::infected, i) == 1){
 				infected = true;
 				n_infected_tot++;
 			}
 		}
 
 		// Retirement home resident
-		if (std::stoi(agent.at(8)) == 1){
+		if (value(PS::retirement_home_resident, i) == 1){
 			 livesRH = true;
 		}
 
 		// Retirement home or school employee
-		if (std::stoi(agent.at(9)) == 1){
+		if (value(PS::retirement_home_employee, i) == 1){
 			 worksRH = true;
 		}
 		
-		if (std::stoi(agent.at(10)) == 1){
+		if (value(PS::school_employee, i) == 1){
 			 worksSch = true;
 		}
 
-		Agent temp_agent(student, works, std::stoi(agent.at(2)), 
-			std::stod(agent.at(3)), std::stod(agent.at(4)), house_ID,
-			patient, std::stoi(agent.at(7)), livesRH, worksRH,
-		    worksSch, std::stoi(agent.at(11)), 
-			hospital_staff, std::stoi(agent.at(13)), infected);
+		profiles->emplace_back(student, works, value(PS::age, i), 
+			xy.at(i), xy.at(n_agents + i), patient, value(PS::school_ID, i), 
+			livesRH, worksRH, worksSch, value(PS::work_ID, i), hospital_staff);
+		Agent temp_agent(&profiles->back(), house_ID, value(PS::hospital_ID, i), infected);
 
 		// Set Agent ID
 		temp_agent.set_ID(agent_ID++);
@@ -350,65 +487,198 @@ void ABM::load_agents(const std::string fname, const int ninf0)
 		}	
 		
 		// Store
-		agents.push_back(temp_agent);
+		agents.push_back(std::move(temp_agent));
 	}
+	profile_storage = std::move(profiles);
 }
 
-// Assign agents to households, schools, and worplaces
-void ABM::register_agents()
+// Random choice of IDs of initially infected
+std::vector<int> ABM::random_infected_IDs(const int n_agents, const int ninf0)
 {
-	int house_ID = 0, school_ID = 0, work_ID = 0, hospital_ID = 0;
-	int agent_ID = 0;
-	bool infected = false;
+	std::vector<int> infected_IDs(ninf0);
+	bool not_unique = true;
+	int inf_ID = 0;
+	for (int i=0; i<ninf0; ++i){
+		not_unique = true;
+		while (not_unique){
+			inf_ID = infection.get_random_agent_ID(n_agents);
+			auto iter = std::find(infected_IDs.begin(), infected_IDs.end(), inf_ID);
+			not_unique = (iter != infected_IDs.end()); 
+		}
+		infected_IDs.at(i) = inf_ID;
+	}
+	return infected_IDs;
+}
 
-	for (const auto& agent : agents){
-		
-		// Agent ID and infection status
-		agent_ID = agent.get_ID();
-		infected = agent.infected();
+// Create places and agents from a published population
+void ABM::create_population(const PopulationSegment& segment, const int ninf0)
+{
+	if (!agents.empty()){
+		throw std::runtime_error("Population already created");
+	}
 
-		// If not a non-COVID hospital patient, 
-		// register in the household or a retirement home
-		if (agent.hospital_non_covid_patient() == false){
-			if (agent.retirement_home_resident()){
-				house_ID = agent.get_household_ID();
-				RetirementHome& rh = retirement_homes.at(house_ID - 1); 
-				rh.register_agent(agent_ID, infected);
-			} else {
-				house_ID = agent.get_household_ID();
-				Household& house = households.at(house_ID - 1); 
-				house.register_agent(agent_ID, infected);
+	// Places
+	typedef PopulationSegment PS;
+	for (int i = 0; i < segment.get_number_of_places(PS::households); ++i){
+		households.push_back(make_household(segment.get_place_ID(PS::households, i),
+			segment.get_place_x(PS::households, i), segment.get_place_y(PS::households, i)));
+	}
+	for (int i = 0; i < segment.get_number_of_places(PS::retirement_homes); ++i){
+		retirement_homes.push_back(make_retirement_home(segment.get_place_ID(PS::retirement_homes, i),
+			segment.get_place_x(PS::retirement_homes, i), segment.get_place_y(PS::retirement_homes, i)));
+	}
+	for (int i = 0; i < segment.get_number_of_places(PS::schools); ++i){
+		schools.push_back(make_school(segment.get_place_ID(PS::schools, i),
+			segment.get_place_x(PS::schools, i), segment.get_place_y(PS::schools, i), 
+			segment.get_school_type(i)));
+	}
+	for (int i = 0; i < segment.get_number_of_places(PS::workplaces); ++i){
+		workplaces.push_back(make_workplace(segment.get_place_ID(PS::workplaces, i),
+			segment.get_place_x(PS::workplaces, i), segment.get_place_y(PS::workplaces, i)));
+	}
+	const std::map<const std::string, const double> betas = hospital_betas();
+	for (int i = 0; i < segment.get_number_of_places(PS::hospitals); ++i){
+		hospitals.push_back(make_hospital(segment.get_place_ID(PS::hospitals, i),
+			segment.get_place_x(PS::hospitals, i), segment.get_place_y(PS::hospitals, i), betas));
+	}
+
+	// Agents
+	const int n_agents = segment.get_number_of_agents();
+	if (validate_input){
+		check_input(n_agents, segment.agent_values(PS::student), segment.agent_x(), segment.agent_y());
+	}
+	set_flu_properties();
+	std::vector<int> infected_IDs = random_infected_IDs(n_agents, ninf0);
+	auto column = [&segment](const PS::agent_column col){ return segment.agent_values(col); };
+	agents.reserve(n_agents);
+	for (int i = 0; i < n_agents; ++i){
+		// Random or as published
+		bool infected = false;
+		if (ninf0 != 0){
+			auto iter = std::find(infected_IDs.begin(), infected_IDs.end(), i + 1); 
+			if (iter != infected_IDs.end()){
+				infected_IDs.erase(iter);
+				infected = true;
 			}
+		} else {
+			infected = (column(PS::infected)[i] == 1);
 		}
-
-		// Register in schools, workplaces, and hospitals 
-		if (agent.student()){
-			school_ID = agent.get_school_ID();
-			School& school = schools.at(school_ID - 1); 
-			school.register_agent(agent_ID, infected);		
+		if (infected){
+			n_infected_tot++;
 		}
 
-		if (agent.works()){
-			work_ID = agent.get_work_ID();
-			if (agent.retirement_home_employee()){
-				RetirementHome& rh = retirement_homes.at(work_ID - 1);
-				rh.register_agent(agent_ID, infected);
-			} else if (agent.school_employee()){
-				School& school = schools.at(work_ID - 1); 
-				school.register_agent(agent_ID, infected);
-			} else {
-				Workplace& work = workplaces.at(work_ID - 1);
-				work.register_agent(agent_ID, infected);
-			}		
+		// Profile stays in the segment
+		Agent temp_agent(segment.get_agent_profile(i), column(PS::household_ID)[i], 
+			column(PS::hospital_ID)[i], infected);
+		temp_agent.set_ID(i + 1);
+		if (infected){
+			initial_exposed(temp_agent);
 		}
+		agents.push_back(std::move(temp_agent));
+	}
 
-		if (agent.hospital_employee() || 
-				agent.hospital_non_covid_patient()){
-			hospital_ID = agent.get_hospital_ID();
-			Hospital& hospital = hospitals.at(hospital_ID - 1);
-			hospital.register_agent(agent_ID, infected);	
+	profile_storage = segment.get_storage();
+
+	// Rosters stay in the segment until they change
+	register_from_rosters(households, PS::households, segment);
+	register_from_rosters(retirement_homes, PS::retirement_homes, segment);
+	register_from_rosters(schools, PS::schools, segment);
+	register_from_rosters(workplaces, PS::workplaces, segment);
+	register_from_rosters(hospitals, PS::hospitals, segment);
+}
+
+// Assign agents to households, schools, and worplaces
+void ABM::register_agents()
+{
+	typedef PopulationSegment PS;
+	// Places of each type are independent
+	const std::function<void(int)> task = [this](int type){
+			switch (type){
+				case PS::households: 
+					register_in_places(households, PS::households); 
+					break;
+				case PS::retirement_homes: 
+					register_in_places(retirement_homes, PS::retirement_homes); 
+					break;
+				case PS::schools: 
+					register_in_places(schools, PS::schools); 
+					break;
+				case PS::workplaces: 
+					register_in_places(workplaces, PS::workplaces); 
+					break;
+				case PS::hospitals: 
+					register_in_places(hospitals, PS::hospitals); 
+					break;
+			}
+		};
+	const int n_types = PS::hospitals + 1;
+	if (run_registration){
+		run_registration(n_types, task);
+	} else {
+		for (int it = 0; it < n_types; ++it){
+			task(it);
 		}
-	} 
+	}
+}
+
+// Places of one type where an agent is registered
+int ABM::registered_places(const Agent& agent, const PopulationSegment::place_type type, 
+							int place_IDs[2]) const
+{
+	typedef PopulationSegment PS;
+	int n_places = 0;
+	switch (type){
+		// If not a non-COVID hospital patient, 
+		// in the household or a retirement home
+		case PS::households:
+			if (!agent.hospital_non_covid_patient() && !agent.retirement_home_resident()){
+				place_IDs[n_places++] = agent.get_household_ID();
+			}
+			break;
+		case PS::retirement_homes:
+			if (!agent.hospital_non_covid_patient() && agent.retirement_home_resident()){
+				place_IDs[n_places++] = agent.get_household_ID();
+			}
+			if (agent.works() && agent.retirement_home_employee()){
+				place_IDs[n_places++] = agent.get_work_ID();
+			}
+			break;
+		// Schools, workplaces, and hospitals 
+		case PS::schools:
+			if (agent.student()){
+				place_IDs[n_places++] = agent.get_school_ID();
+			}
+			if (agent.works() && !agent.retirement_home_employee() && agent.school_employee()){
+				place_IDs[n_places++] = agent.get_work_ID();
+			}
+			break;
+		case PS::workplaces:
+			if (agent.works() && !agent.retirement_home_employee() && !agent.school_employee()){
+				place_IDs[n_places++] = agent.get_work_ID();
+			}
+			break;
+		case PS::hospitals:
+			if (agent.hospital_employee() || agent.hospital_non_covid_patient()){
+				place_IDs[n_places++] = agent.get_hospital_ID();
+			}
+			break;
+	}
+	return n_places;
+}
+
+// Validate agent columns against the created places
+void ABM::check_input(const int n_agents, const std::int32_t* values, const double* x, const double* y)
+{
+	typedef PopulationSegment PS;
+	set_validated_places(PS::households, households);
+	set_validated_places(PS::retirement_homes, retirement_homes);
+	set_validated_places(PS::schools, schools);
+	set_validated_places(PS::workplaces, workplaces);
+	set_validated_places(PS::hospitals, hospitals);
+	input_report = input_validator.validate(n_agents, values, x, y);
+	if (!input_report.passed()){
+		throw std::invalid_argument(input_report.summary());
+	}
 }
 
 // Initial set-up of exposed agents
@@ -436,27 +706,241 @@ void ABM::initial_exposed(Agent& agent)
 	agent.set_recovering_exposed(never_sy);
 }
 
+// Restart all random number generators of the model
+void ABM::set_random_seed(const unsigned seed)
+{
+	std::seed_seq seq = {seed};
+	std::vector<unsigned> seeds(2);
+	seq.generate(seeds.begin(), seeds.end());
+	infection.set_rng_seed(seeds.at(0));
+	flu.set_rng_seed(seeds.at(1));
+	// Separate sequence so that the other generators are unchanged
+	std::seed_seq campaign_seq = {seed, 1u};
+	campaign_seq.generate(seeds.begin(), seeds.begin() + 1);
+	campaign.set_rng_seed(seeds.at(0));
+	std::seed_seq lineage_seq = {seed, 2u};
+	lineage_seq.generate(seeds.begin(), seeds.begin() + 1);
+	lineage.set_rng_seed(seeds.at(0));
+}
+
+// Sample infections of susceptible agents starting from places
+void ABM::set_place_infection_sampling(const bool by_place)
+{
+	if (by_place && spatial_transmission){
+		throw std::invalid_argument("Place-centric sampling cannot be combined with spatial transmission");
+	}
+	place_infection_sampling = by_place;
+}
+
+// Add community transmission that decays with distance
+void ABM::set_spatial_transmission(const double rate, const double scale, const double exponent,
+									const double cutoff, const bool far_field)
+{
+	if (place_infection_sampling){
+		throw std::invalid_argument("Spatial transmission cannot be combined with place-centric sampling");
+	}
+	spatial.set_parameters(rate, scale, exponent, cutoff, far_field);
+	spatial_transmission = true;
+}
+
+// Restrict the simulation to a subset of agents
+void ABM::set_local_agents(const std::vector<bool>& local_flags)
+{
+	if (local_flags.size() != agents.size()){
+		throw std::invalid_argument("Number of local agent flags does not match the number of agents");
+	}
+	local_agents = local_flags;
+}
+
+// ID of a place in the input file
+int ABM::get_external_place_ID(const PopulationSegment::place_type type, const int place_ID) const
+{
+	typedef PopulationSegment PS;
+	const std::vector<int>* external_IDs = nullptr;
+	switch (type){
+		case PS::households: external_IDs = &household_external_IDs; break;
+		case PS::retirement_homes: external_IDs = &retirement_home_external_IDs; break;
+		case PS::schools: external_IDs = &school_external_IDs; break;
+		case PS::workplaces: external_IDs = &workplace_external_IDs; break;
+		case PS::hospitals: external_IDs = &hospital_external_IDs; break;
+	}
+	return external_IDs->empty() ? place_ID : external_IDs->at(place_ID-1);
+}
+
+// Reorder agents and places to improve memory locality
+void ABM::reorder_for_locality()
+{
+	if (time > 0.0 || !local_agents.empty() || !flu.get_susceptible_IDs().empty()){
+		throw std::runtime_error("Agents and places can only be reordered before the simulation");
+	}
+
+	// Places
+	const std::vector<int> new_household_IDs = order_by_location(households, household_external_IDs);
+	const std::vector<int> new_school_IDs = order_by_location(schools, school_external_IDs);
+	const std::vector<int> new_workplace_IDs = order_by_location(workplaces, workplace_external_IDs);
+	const std::vector<int> new_hospital_IDs = order_by_location(hospitals, hospital_external_IDs);
+	const std::vector<int> new_rh_IDs = order_by_location(retirement_homes, retirement_home_external_IDs);
+
+	// References from agents to places, profiles
+	// with the new IDs replace the stored ones
+	auto profiles = std::make_shared<std::vector<AgentProfile>>();
+	profiles->reserve(agents.size());
+	for (auto& agent : agents){
+		profiles->push_back(agent.get_profile());
+		AgentProfile& profile = profiles->back();
+		if (!agent.hospital_non_covid_patient()){
+			if (agent.retirement_home_resident()){
+				agent.set_household_ID(new_rh_IDs.at(agent.get_household_ID()-1));
+			} else {
+				agent.set_household_ID(new_household_IDs.at(agent.get_household_ID()-1));
+			}
+		}
+		if (agent.student()){
+			profile.school_ID = new_school_IDs.at(agent.get_school_ID()-1);
+		}
+		if (agent.works()){
+			if (agent.retirement_home_employee()){
+				profile.work_ID = new_rh_IDs.at(agent.get_work_ID()-1);
+			} else if (agent.school_employee()){
+				profile.work_ID = new_school_IDs.at(agent.get_work_ID()-1);
+			} else {
+				profile.work_ID = new_workplace_IDs.at(agent.get_work_ID()-1);
+			}
+		}
+		agent.set_profile(&profile);
+		if (agent.get_hospital_ID() > 0 && agent.get_hospital_ID() <= hospitals.size()){
+			agent.set_hospital_ID(new_hospital_IDs.at(agent.get_hospital_ID()-1));
+		}
+	}
+	profile_storage = std::move(profiles);
+
+	// Agents by where they live and then where they spend the day;
+	// residents and patients after households 
+	std::vector<std::vector<int>> agent_order;
+	for (const auto& agent : agents){
+		std::vector<int> key(5, 0);
+		if (agent.hospital_non_covid_patient()){
+			key.at(0) = 2;
+			key.at(1) = agent.get_hospital_ID();
+		} else {
+			key.at(0) = agent.retirement_home_resident() ? 1 : 0;
+			key.at(1) = agent.get_household_ID();
+		}
+		if (agent.hospital_employee()){
+			key.at(2) = 1;
+			key.at(3) = agent.get_hospital_ID();
+		} else if (agent.works()){
+			key.at(2) = agent.retirement_home_employee() ? 2 : (agent.school_employee() ? 3 : 4);
+			key.at(3) = agent.get_work_ID();
+		} else if (agent.student()){
+			key.at(2) = 3;
+			key.at(3) = agent.get_school_ID();
+		}
+		key.at(4) = agent.get_ID();
+		agent_order.push_back(key);
+	}
+	std::sort(agent_order.begin(), agent_order.end());
+
+	if (agent_external_IDs.empty()){
+		for (const auto& agent : agents){
+			agent_external_IDs.push_back(agent.get_ID());
+		}
+	}
+	std::vector<int> new_agent_IDs(agents.size());
+	std::vector<Agent> ordered;
+	std::vector<int> ordered_external_IDs;
+	ordered.reserve(agents.size());
+	for (const auto& key : agent_order){
+		const int old_ID = key.back();
+		ordered.push_back(agents.at(old_ID-1));
+		ordered.back().set_ID(ordered.size());
+		ordered_external_IDs.push_back(agent_external_IDs.at(old_ID-1));
+		new_agent_IDs.at(old_ID-1) = ordered.size();
+	}
+	agents.swap(ordered);
+	agent_external_IDs.swap(ordered_external_IDs);
+
+	// References from places to agents
+	auto remap_agents = [&new_agent_IDs](Place& place){ place.remap_agent_IDs(new_agent_IDs); };
+	std::for_each(households.begin(), households.end(), remap_agents);
+	std::for_each(schools.begin(), schools.end(), remap_agents);
+	std::for_each(workplaces.begin(), workplaces.end(), remap_agents);
+	std::for_each(hospitals.begin(), hospitals.end(), remap_agents);
+	std::for_each(retirement_homes.begin(), retirement_homes.end(), remap_agents);
+	pack_rosters(households);
+	pack_rosters(schools);
+	pack_rosters(workplaces);
+	pack_rosters(hospitals);
+	pack_rosters(retirement_homes);
+}
+
+// Attribute a new infection to one of the places of the agent or spatial transmission
+void ABM::record_infection_source(const Agent& agent)
+{
+	typedef LineageLog LL;
+	// At most four places of each type
+	LL::Source sources[4*5 + 1];
+	int n_sources = 0;
+	add_infection_sources(agent, households, LL::households, sources, n_sources);
+	add_infection_sources(agent, retirement_homes, LL::retirement_homes, sources, n_sources);
+	add_infection_sources(agent, schools, LL::schools, sources, n_sources);
+	add_infection_sources(agent, workplaces, LL::workplaces, sources, n_sources);
+	add_infection_sources(agent, hospitals, LL::hospitals, sources, n_sources);
+	if (spatial_transmission){
+		sources[n_sources++] = {LL::spatial, 0, agent.get_spatial_lambda()};
+	}
+	// IDs from the input files, settings of places follow PopulationSegment::place_type
+	for (int is = 0; is < n_sources; ++is){
+		if (sources[is].setting < LL::spatial){
+			sources[is].place_ID = get_external_place_ID(
+					static_cast<PopulationSegment::place_type>(sources[is].setting), sources[is].place_ID);
+		}
+	}
+	lineage.record(n_steps, get_external_agent_ID(agent.get_ID()), sources, n_sources);
+}
+
+// Attribute a new infection of an agent in the places it had before the infection
+void ABM::record_infection_source(const Agent& agent, const SusceptiblePlaces& before)
+{
+	if (agent.get_household_ID() == before.household_ID 
+			&& agent.get_hospital_ID() == before.hospital_ID){
+		record_infection_source(agent);
+		return;
+	}
+	Agent susceptible(&agent.get_profile(), before.household_ID, before.hospital_ID, false);
+	susceptible.set_ID(agent.get_ID());
+	susceptible.set_spatial_lambda(agent.get_spatial_lambda());
+	record_infection_source(susceptible);
+}
+
 // Vaccinate random members of the population that are not Flu or infected agents
-void ABM::vaccinate_random()
+void ABM::vaccinate_random(const int n_vac)
 {
-	std::vector<int> can_be_vaccinated;
+	ArenaVector<int> can_be_vaccinated{ArenaAllocator<int>(scratch)};
+	can_be_vaccinated.reserve(agents.size());
 	// Select qualifying agents
 	for (auto& agent : agents){
 		if (!agent.symptomatic_non_covid() && !agent.infected()
 				&& !agent.exposed() && !agent.symptomatic() 
-				&& !agent.removed()){
+				&& !agent.removed() && is_local(agent)){
 			can_be_vaccinated.push_back(agent.get_ID());
 		}
 	}
 	// Shuffle randomly
 	infection.vector_shuffle(can_be_vaccinated);
-	// Remove first n_vaccinated
-	if (n_vaccinated > can_be_vaccinated.size()){
+	// Remove first n_vac
+	if (n_vac > can_be_vaccinated.size()){
 		throw std::runtime_error("Requested number of agents to vaccinate larger than number of available agents");
 	}
-	for (int i=0; i<n_vaccinated; ++i){
-		agents.at(can_be_vaccinated.at(i)-1).set_vaccinated(true);
+	int n_new = 0;
+	for (int i=0; i<n_vac; ++i){
+		Agent& agent = agents.at(can_be_vaccinated.at(i)-1);
+		if (!agent.vaccinated()){
+			++n_new;
+		}
+		agent.set_vaccinated(true);
 	}	
+	count_vaccinated(n_new);
 }
 
 // Vaccinate specific group of agents in the population
@@ -478,15 +962,19 @@ void ABM::vaccinate_group()
 // Assign removed (vaccinated equivalent) flag to the group with specified type
 void ABM::implement_group_vaccination(type_getter atype)
 {
-	int v_final = 0;
+	int v_final = 0, n_new = 0;
 	for (auto& agent : agents){
 		if ((agent.*atype)() == true && !agent.infected()
 				&& !agent.exposed() && !agent.symptomatic()
-				&& !agent.removed()){
+				&& !agent.removed() && is_local(agent)){
+			if (!agent.vaccinated()){
+				++n_new;
+			}
 			agent.set_vaccinated(true);
 			++v_final;			
 		}
 	}
+	count_vaccinated(n_new);
 	if (vac_verbose){
 		std::cout << "Total number of vaccinated in the group " 
 				  << vaccine_group_name << " " << v_final << std::endl;
@@ -498,111 +986,180 @@ void ABM::implement_group_vaccination(type_getter atype)
 //
 
 // Transmit infection according to Infection model
+template <typename Features>
 void ABM::transmit_infection() 
 {
-	testing.check_switch_time(time);	
-	check_events(schools, workplaces);
-	compute_place_contributions();	
-	compute_state_transitions();
+	if (Features::testing){
+		testing.check_switch_time(time);	
+	}
+	check_events<Features>(schools, workplaces);
+	accumulate_place_contributions<Features>();
+	finalize_place_contributions();
+	if (spatial_transmission){
+		spatial.compute(agents, time, scratch);
+	}
+	compute_state_transitions<Features>();
 	reset_contributions();
 	advance_in_time();	
 }
 
 // Verify if anything that requires parameter changes happens at this step 
+template <typename Features>
 void ABM::check_events(std::vector<School>& schools, std::vector<Workplace>& workplaces)
 {
 	double tol = 1e-3;
-	double new_tr_rate = 0.0;
+
+	if (features_checked == false){
+		check_features<Features>();
+	}
+	if (Features::daily_data){
+		metrics.start_step();
+	}
 
 	// Initialize agents with flu the time step the testing starts 
 	// Optionally also vaccinate part of the population or/and specific groups
-	if (equal_floats<double>(time, infection_parameters.at("start testing"), tol)){
+	if (event_at_time(infection_parameters.at("start testing"), time, tol)){
+		if (!Features::testing){
+			throw std::runtime_error("Testing starts in a model built without testing");
+		}
 		// Vaccinate
 		if (random_vaccines == true){
-			vaccinate_random();
+			vaccinate_random(n_vaccinated);
 		}
 		if (group_vaccines == true){
 			vaccinate_group();
 		}
-		// Initialize flu agents
-		for (const auto& agent : agents){
-			if (!agent.infected() && !agent.removed() && !agent.vaccinated()){
-				// If not patient or hospital employee
-				// Add to potential flu group
-				if (!agent.hospital_employee() && !agent.hospital_non_covid_patient()){
-					flu.add_susceptible_agent(agent.get_ID());
+		if (Features::flu){
+			// Initialize flu agents
+			for (const auto& agent : agents){
+				if (!agent.infected() && !agent.removed() && !agent.vaccinated() && is_local(agent)){
+					// If not patient or hospital employee
+					// Add to potential flu group
+					if (!agent.hospital_employee() && !agent.hospital_non_covid_patient()){
+						flu.add_susceptible_agent(agent.get_ID());
+					}
 				}
 			}
-		}
-		// Randomly assign portion of susceptible with flu
-		// The set agents flags
-		std::vector<int> flu_IDs = flu.generate_flu();
-		for (const auto& ind : flu_IDs){
-			Agent& agent = agents.at(ind-1);
-			const int n_hospitals = hospitals.size();
-			transitions.process_new_flu(agent, n_hospitals, time,
-					   		 schools, workplaces, retirement_homes, 
-							 infection, infection_parameters, flu, testing);
+			// Randomly assign portion of susceptible with flu
+			// The set agents flags
+			std::vector<int> flu_IDs = flu.generate_flu();
+			for (const auto& ind : flu_IDs){
+				Agent& agent = agents.at(ind-1);
+				const int n_hospitals = hospitals.size();
+				transitions.process_new_flu(agent, n_hospitals, time,
+						   		 schools, workplaces, retirement_homes, 
+								 infection, infection_parameters, flu, testing);
+			}
 		}
 	}
 
-	// Closures
-	if (equal_floats<double>(time, infection_parameters.at("school closure"), tol)){
-		new_tr_rate = 0.0;
-		for (auto& school : schools){
-			school.change_transmission_rate(new_tr_rate);
-			school.change_employee_transmission_rate(new_tr_rate);
-		}
+	// Closures, reopenings, and other interventions
+	Interventions::Intervention intervention;
+	while (interventions.next_due(time, intervention)){
+		apply_intervention(intervention, schools, workplaces);
 	}
-	if (equal_floats<double>(time, infection_parameters.at("lockdown"), tol)){
-		new_tr_rate = infection_parameters.at("workplace transmission rate")*infection_parameters.at("fraction of ld businesses");
-		for (auto& workplace : workplaces){
-			workplace.change_transmission_rate(new_tr_rate);
-			workplace.change_absenteeism_correction(infection_parameters.at("lockdown absenteeism"));
-		}
+
+	// Daily doses of a campaign
+	if (with_campaign){
+		count_vaccinated(campaign.vaccinate(agents, local_agents, time, dt));
 	}
+}
 
-	// Reopening
-	if (equal_floats<double>(time, infection_parameters.at("reopening phase 1"), tol)){
-		new_tr_rate = infection_parameters.at("workplace transmission rate") * 
-				infection_parameters.at("fraction of phase 1 businesses");
-		for (auto& workplace : workplaces){
-			workplace.change_transmission_rate(new_tr_rate);
-			workplace.change_absenteeism_correction(infection_parameters.at("lockdown absenteeism"));
+// Change places or agents as given by an intervention
+void ABM::apply_intervention(const Interventions::Intervention& intervention,
+				std::vector<School>& schools, std::vector<Workplace>& workplaces)
+{
+	const double value = intervention.value;
+	switch (intervention.action){
+		case Interventions::transmission:
+			if (intervention.target == Interventions::households){
+				const double new_tr_rate = value*infection_parameters.at("household transmission rate");
+				change_places(households, household_external_IDs, intervention, 
+						[new_tr_rate](Household& house){ house.change_transmission_rate(new_tr_rate); });
+			} else if (intervention.target == Interventions::schools){
+				const double new_tr_rate = value*infection_parameters.at("school transmission rate");
+				change_places(schools, school_external_IDs, intervention, 
+						[new_tr_rate](School& school){ school.change_transmission_rate(new_tr_rate); });
+			} else if (intervention.target == Interventions::workplaces){
+				const double new_tr_rate = value*infection_parameters.at("workplace transmission rate");
+				change_places(workplaces, workplace_external_IDs, intervention, 
+						[new_tr_rate](Workplace& work){ work.change_transmission_rate(new_tr_rate); });
+			}
+			break;
+		case Interventions::employee_transmission: {
+			const double new_tr_rate = value*infection_parameters.at("school employee transmission rate");
+			change_places(schools, school_external_IDs, intervention, 
+					[new_tr_rate](School& school){ school.change_employee_transmission_rate(new_tr_rate); });
+			break;
 		}
+		case Interventions::absenteeism:
+			change_places(workplaces, workplace_external_IDs, intervention, 
+					[value](Workplace& work){ work.change_absenteeism_correction(value); });
+			break;
+		case Interventions::closure:
+			if (intervention.target == Interventions::households){
+				change_places(households, household_external_IDs, intervention, 
+						[](Household& house){ house.change_transmission_rate(0.0); });
+			} else if (intervention.target == Interventions::schools){
+				change_places(schools, school_external_IDs, intervention, [](School& school){ 
+						school.change_transmission_rate(0.0);
+						school.change_employee_transmission_rate(0.0); });
+			} else if (intervention.target == Interventions::workplaces){
+				change_places(workplaces, workplace_external_IDs, intervention, 
+						[](Workplace& work){ work.change_transmission_rate(0.0); });
+			}
+			break;
+		case Interventions::vaccination:
+			vaccinate_random(static_cast<int>(value));
+			return;
 	}
-	if (equal_floats<double>(time, infection_parameters.at("reopening phase 2"), tol)){
-		new_tr_rate = infection_parameters.at("workplace transmission rate") * 
-				infection_parameters.at("fraction of phase 2 businesses");
-		for (auto& workplace : workplaces){
-			workplace.change_transmission_rate(new_tr_rate);
-			workplace.change_absenteeism_correction(infection_parameters.at("lockdown absenteeism"));
-		}
+	++n_place_changes;
+}
+
+// Throw if the model uses features disabled in Features
+template <typename Features>
+void ABM::check_features()
+{
+	if (!Features::flu && infection_parameters.at("fraction with flu") > 0.0){
+		throw std::invalid_argument("Model with flu in a build without flu");
 	}
-	if (equal_floats<double>(time, infection_parameters.at("reopening phase 3"), tol)){
-		new_tr_rate = infection_parameters.at("workplace transmission rate") * 
-				infection_parameters.at("fraction of phase 3 businesses");
-		for (auto& workplace : workplaces){
-			workplace.change_transmission_rate(new_tr_rate);
-			workplace.change_absenteeism_correction(infection_parameters.at("lockdown absenteeism"));
+	if (!Features::retirement_homes && !retirement_homes.empty()){
+		throw std::invalid_argument("Model with retirement homes in a build without retirement homes");
+	}
+	for (const auto& agent : agents){
+		if (!Features::hospitals && (agent.hospital_employee() || agent.hospital_non_covid_patient())){
+			throw std::invalid_argument("Model with hospital employees or patients in a build without them");
+		}
+		if (!Features::retirement_homes && (agent.retirement_home_resident() 
+					|| agent.retirement_home_employee())){
+			throw std::invalid_argument("Model with retirement homes in a build without retirement homes");
 		}
 	}
+	features_checked = true;
 }
 
 // Count contributions of all infectious agents in each place
 void ABM::compute_place_contributions()
+{
+	accumulate_place_contributions();
+	finalize_place_contributions();
+}
+
+// Add contributions of infectious agents to sums in their places 
+template <typename Features>
+void ABM::accumulate_place_contributions()
 {
 	for (const auto& agent : agents){
 
 		// Removed and vaccinated don't contribute
-		if (agent.removed() == true || agent.vaccinated() == true){
+		if (agent.removed() == true || agent.vaccinated() == true || !is_local(agent)){
 			continue;
 		}
 
 		// If susceptible and being tested - add to hospital's
 		// total number of people present at this time step
 		if (agent.infected() == false){
-			if ((agent.tested() == true) && 
+			if (Features::testing && (agent.tested() == true) && 
 				(agent.tested_in_hospital() == true) &&
 				(agent.get_time_of_test() <= time) && 
 		 		(agent.tested_awaiting_test() == true)){
@@ -614,83 +1171,99 @@ void ABM::compute_place_contributions()
 		// Consider all infectious cases, raise 
 		// exception if no existing case
 		if (agent.exposed() == true){
-			contributions.compute_exposed_contributions(agent, time, households, 
+			contributions.compute_exposed_contributions<Features>(agent, time, households, 
 							schools, workplaces, hospitals, retirement_homes);
 		}else if (agent.symptomatic() == true){
-			contributions.compute_symptomatic_contributions(agent, time, households, 
+			contributions.compute_symptomatic_contributions<Features>(agent, time, households, 
 							schools, workplaces, hospitals, retirement_homes);
 		}else{
 			throw std::runtime_error("Agent does not have any state");
 		}
 	}
-	contributions.total_place_contributions(households, schools, 
-											workplaces, hospitals, retirement_homes);
 }
 
 // Determine infection propagation and
 // state changes 
+template <typename Features>
 void ABM::compute_state_transitions()
 {
-	int newly_infected = 0, is_recovered = 0;
-	// Infected state change flags: 
-	// recovered - healthy, recovered - dead, tested at this step,
-	// tested positive at this step, tested false negative
-	std::vector<int> state_changes = {0, 0, 0, 0, 0};
-	// Susceptible state changes
-	// infected, tested, tested negative, tested false positive
-	std::vector<int> s_state_changes = {0, 0, 0, 0};
-	// First entry is one if agent recovered, second if agent died
-	std::vector<int> removed = {0,0};
-
-	// Store information for that day
-	n_infected_day.push_back(0);
-	tested_day.push_back(0);
-	tested_pos_day.push_back(0);
-	tested_neg_day.push_back(0);
-	tested_false_pos_day.push_back(0);
-	tested_false_neg_day.push_back(0);
+	// Changes in state of the current agent, no allocations per agent
+	StateChanges state_changes = {};
+	// Places of a susceptible agent before the transitions, only for the lineage
+	SusceptiblePlaces susceptible_places = {0, 0};
+
+	// Collect only after a specified time
+	const bool collect_data = (time >= infection_parameters.at("time to start data collection"));
+
+	// Optionally infections of susceptible agents without flu, all at once
+	// Position of the next agent that was already processed
+	std::size_t next_batched = 0;
+	batch_agent_IDs.clear();
+	if (place_infection_sampling == true){
+		sample_infections_by_place<Features>();
+	} else if (batched_infection_draws == true){
+		draw_batched_infections<Features>();
+	}
 
 	for (auto& agent : agents){
 
-		// Skip the removed and the vaccinated 
-		if (agent.removed() == true || agent.vaccinated() == true){
+		// Skip the agents already processed 
+		if (next_batched < batch_agent_IDs.size() 
+				&& batch_agent_IDs.at(next_batched) == agent.get_ID()){
+			++next_batched;
+			continue;
+		}
+
+		// Skip the removed, the vaccinated, and agents processed elsewhere
+		if (agent.removed() == true || agent.vaccinated() == true || !is_local(agent)){
 			continue;
 		}
 		
-		std::fill(state_changes.begin(), state_changes.end(), 0);
-		std::fill(s_state_changes.begin(), s_state_changes.end(), 0);
+		state_changes = StateChanges();
 
 		if (agent.infected() == false){
-			s_state_changes = transitions.susceptible_transitions(agent, time,
+			// Agents without flu at the beginning of the step were already sampled 
+			if (place_infection_sampling == true && (!Features::flu || agent.symptomatic_non_covid() == false
+					|| std::binary_search(flu_at_step_start.begin(), flu_at_step_start.end(), 
+						agent.get_ID()) == false)){
+				continue;
+			}
+			if (record_lineage){
+				susceptible_places = {agent.get_household_ID(), agent.get_hospital_ID()};
+			}
+			state_changes = transitions.susceptible_transitions<Features>(agent, time,
 							dt, infection, households, schools, workplaces, 
 							hospitals, retirement_homes, 
 							infection_parameters, agents, flu, testing);
-			n_infected_tot += s_state_changes.at(0);
 			// True infected by timestep, from the first time step
-			if (s_state_changes.at(0) == 1){
-				++n_infected_day.back();
+			if (state_changes.infected == 1){
+				record_infection<Features>(agent, susceptible_places);
 			}
 		}else if (agent.exposed() == true){
-			state_changes = transitions.exposed_transitions(agent, infection, time, dt, 
+			state_changes = transitions.exposed_transitions<Features>(agent, infection, time, dt, 
 										households, schools, workplaces, hospitals,
 										retirement_homes, infection_parameters, testing);
-			n_recovering_exposed += state_changes.at(0);
-			n_recovered_tot += state_changes.at(0);
+			n_recovering_exposed += state_changes.recovered;
+			if (state_changes.recovered == 1){
+				record_count<Features>(new_recovered_metric, n_recovered_tot);
+			}
 		}else if (agent.symptomatic() == true){
-			state_changes = transitions.symptomatic_transitions(agent, time, dt,
+			state_changes = transitions.symptomatic_transitions<Features>(agent, time, dt,
 						infection, households, schools, workplaces, hospitals,
 							retirement_homes, infection_parameters);
-			n_recovered_tot += state_changes.at(0);
+			if (state_changes.recovered == 1){
+				record_count<Features>(new_recovered_metric, n_recovered_tot);
+			}
 			// Collect only after a specified time
-			if (time >= infection_parameters.at("time to start data collection")){
-				if (state_changes.at(1) == 1){
+			if (collect_data){
+				if (state_changes.dead_tested == 1){
 					// Dead after testing
 					++n_dead_tested;
-					++n_dead_tot;
-				} else if (state_changes.at(1) == 2){
+					record_count<Features>(new_dead_metric, n_dead_tot);
+				} else if (state_changes.dead_not_tested == 1){
 					// Dead with no testing
 					++n_dead_not_tested;
-					++n_dead_tot;
+					record_count<Features>(new_dead_metric, n_dead_tot);
 				}
 			}
 		}else{
@@ -698,37 +1271,206 @@ void ABM::compute_state_transitions()
 		}
 
 		// Recording testing changes for this agent
-		if (time >= infection_parameters.at("time to start data collection")){
+		if (Features::testing && collect_data){
 			if (agent.exposed() || agent.symptomatic()){
-				if (state_changes.at(2) == 1){
-					++tested_day.back();
-					++tot_tested;
+				if (state_changes.tested == 1){
+					record_count<Features>(new_tested_metric, tot_tested);
 				}
-				if (state_changes.at(3) == 1){
-					++tested_pos_day.back();
-					++tot_tested_pos;
+				if (state_changes.tested_positive == 1){
+					record_count<Features>(new_tested_pos_metric, tot_tested_pos);
 				}
-				if (state_changes.at(4) == 1){
-					++tested_false_neg_day.back();
-					++tot_tested_false_neg;
+				if (state_changes.tested_false_negative == 1){
+					record_count<Features>(new_tested_false_neg_metric, tot_tested_false_neg);
 				}
 			} else {
 				// Susceptible
-				if (s_state_changes.at(1) == 1){
-					++tested_day.back();
-					++tot_tested;
+				if (state_changes.tested == 1){
+					record_count<Features>(new_tested_metric, tot_tested);
 				}
-				if (s_state_changes.at(2) == 1){
-					++tested_neg_day.back();
-					++tot_tested_neg;
+				if (state_changes.tested_negative == 1){
+					record_count<Features>(new_tested_neg_metric, tot_tested_neg);
 				}
-				if (s_state_changes.at(3) == 1){
-					++tested_false_pos_day.back();
-					++tot_tested_false_pos;
+				if (state_changes.tested_false_positive == 1){
+					record_count<Features>(new_tested_false_pos_metric, tot_tested_false_pos);
 				}
 			}
 		}
 	}
+
+	if (Features::daily_data){
+		record_gauges();
+	}
+}
+
+// Sample infections of susceptible agents without flu and process the infected
+template <typename Features>
+void ABM::draw_batched_infections()
+{
+	batch_lambdas.clear();
+	for (const auto& agent : agents){
+		if (agent.removed() == true || agent.vaccinated() == true || !is_local(agent)){
+			continue;
+		}
+		if (agent.infected() == false && agent.symptomatic_non_covid() == false){
+			batch_lambdas.push_back(transitions.susceptible_lambda(agent, time, 
+							households, schools, workplaces, hospitals, retirement_homes));
+			batch_agent_IDs.push_back(agent.get_ID());
+		}
+	}
+
+	infection.infected_batch(batch_lambdas, batch_infected);
+	for (const auto& ind : batch_infected){
+		Agent& agent = agents.at(batch_agent_IDs.at(ind)-1);
+		record_infection<Features>(agent);
+		transitions.process_new_infection(agent, time, infection, 
+						schools, workplaces, hospitals, retirement_homes, 
+						infection_parameters, flu, testing);
+	}
+}
+
+// Sample infections of susceptible agents without flu from places with infected and process the infected
+template <typename Features>
+void ABM::sample_infections_by_place()
+{
+	if (Features::flu){
+		flu_at_step_start = flu.get_flu_IDs();
+		std::sort(flu_at_step_start.begin(), flu_at_step_start.end());
+	}
+	newly_infected_flags.resize(agents.size(), 0);
+
+	sample_infections_in_places(households);
+	sample_infections_in_places(schools);
+	sample_infections_in_places(workplaces);
+	sample_infections_in_places(hospitals);
+	sample_infections_in_places(retirement_homes);
+
+	// Same order as in the main loop over agents
+	std::sort(batch_agent_IDs.begin(), batch_agent_IDs.end());
+	for (const auto& agent_ID : batch_agent_IDs){
+		newly_infected_flags.at(agent_ID-1) = 0;
+		Agent& agent = agents.at(agent_ID-1);
+		record_infection<Features>(agent);
+		transitions.process_new_infection(agent, time, infection, 
+						schools, workplaces, hospitals, retirement_homes, 
+						infection_parameters, flu, testing);
+	}
+}
+
+//
+// Metrics
+//
+
+// Registry with the built-in metrics
+Metrics ABM::builtin_metrics()
+{
+	// Same order as builtin_metric
+	const std::vector<std::string> counters = {"new infected", "new dead", "new recovered", 
+		"new tested", "new tested positive", "new tested negative", "new tested false positive", 
+		"new tested false negative", "new vaccinated"};
+	const std::vector<std::string> gauges = {"total infected", "total dead", "tested dead",
+		"not tested dead", "total recovered", "total tested", "total tested positive", 
+		"total tested negative", "total tested false positive", "total tested false negative",
+		"total vaccinated"};
+	Metrics builtin;
+	for (const auto& name : counters){
+		builtin.add(name, Metrics::counter);
+	}
+	for (const auto& name : gauges){
+		builtin.add(name, Metrics::gauge);
+	}
+	return builtin;
+}
+
+// Count an event of a step processed by another driver
+void ABM::count_event(const counted_event event)
+{
+	switch (event){
+		case infected_event:
+			record_count<BuildFeatures>(new_infected_metric, n_infected_tot);
+			break;
+		case recovered_exposed_event:
+			++n_recovering_exposed;
+			record_count<BuildFeatures>(new_recovered_metric, n_recovered_tot);
+			break;
+		case recovered_event:
+			record_count<BuildFeatures>(new_recovered_metric, n_recovered_tot);
+			break;
+		case dead_tested_event:
+			++n_dead_tested;
+			record_count<BuildFeatures>(new_dead_metric, n_dead_tot);
+			break;
+		case dead_not_tested_event:
+			++n_dead_not_tested;
+			record_count<BuildFeatures>(new_dead_metric, n_dead_tot);
+			break;
+		case tested_event:
+			record_count<BuildFeatures>(new_tested_metric, tot_tested);
+			break;
+		case tested_positive_event:
+			record_count<BuildFeatures>(new_tested_pos_metric, tot_tested_pos);
+			break;
+		case tested_negative_event:
+			record_count<BuildFeatures>(new_tested_neg_metric, tot_tested_neg);
+			break;
+		case tested_false_positive_event:
+			record_count<BuildFeatures>(new_tested_false_pos_metric, tot_tested_false_pos);
+			break;
+		case tested_false_negative_event:
+			record_count<BuildFeatures>(new_tested_false_neg_metric, tot_tested_false_neg);
+			break;
+	}
+}
+
+// Also record the current numbers of agents in some states
+void ABM::set_census_metrics()
+{
+	if (census_metric >= 0){
+		return;
+	}
+	census_metric = metrics.add("infected", Metrics::gauge);
+	for (const auto& name : {"exposed", "active", "home isolated", "hospitalized", "ICU"}){
+		metrics.add(name, Metrics::gauge);
+	}
+}
+
+// Gauges at the end of a step
+void ABM::record_gauges()
+{
+	// Same order as builtin_metric
+	const int totals[] = {n_infected_tot, n_dead_tot, n_dead_tested, 
+		n_dead_not_tested, n_recovered_tot, tot_tested, tot_tested_pos, tot_tested_neg,
+		tot_tested_false_pos, tot_tested_false_neg, n_vaccinated_tot};
+	for (int i = 0; i < 11; ++i){
+		metrics.set(total_infected_metric + i, totals[i]);
+	}
+	if (census_metric < 0){
+		return;
+	}
+
+	// Infected, exposed, active, home isolated, hospitalized, ICU
+	int census[6] = {0, 0, 0, 0, 0, 0};
+	for (const auto& agent : agents){
+		if (!is_local(agent)){
+			continue;
+		}
+		census[0] += agent.infected();
+		census[1] += agent.exposed();
+		if ((agent.infected() && agent.tested_covid_positive())
+			 || (agent.symptomatic_non_covid() && agent.home_isolated()
+					 && agent.tested_false_positive())){
+			++census[2];
+		}
+		if (agent.home_isolated()){
+			++census[3];
+		}else if (agent.hospitalized()){
+			++census[4];
+		}else if (agent.hospitalized_ICU()){
+			++census[5];
+		}
+	}
+	for (int i = 0; i < 6; ++i){
+		metrics.set(census_metric + i, census[i]);
+	}
 }
 
 //
@@ -740,7 +1482,7 @@ int ABM::get_num_infected() const
 {
 	int infected_count = 0;
 	for (const auto& agent : agents){
-		if (agent.infected())
+		if (agent.infected() && is_local(agent))
 			++infected_count;
 	}
 	return infected_count;
@@ -751,7 +1493,7 @@ int ABM::get_num_exposed() const
 {
 	int exposed_count = 0;
 	for (const auto& agent : agents){
-		if (agent.exposed())
+		if (agent.exposed() && is_local(agent))
 			++exposed_count;
 	}
 	return exposed_count;
@@ -762,6 +1504,9 @@ int ABM::get_num_active_cases() const
 {
 	int active_count = 0;
 	for (const auto& agent : agents){
+		if (!is_local(agent)){
+			continue;
+		}
 		if ((agent.infected() && agent.tested_covid_positive())
 			 || (agent.symptomatic_non_covid() && agent.home_isolated()
 					 && agent.tested_false_positive())){
@@ -777,6 +1522,9 @@ std::vector<int> ABM::get_treatment_data() const
 	// IH, HN, ICU
 	std::vector<int> treatments(3,0);
 	for (const auto& agent : agents){
+		if (!is_local(agent)){
+			continue;
+		}
 		if (agent.home_isolated()){
 			++treatments.at(0);
 		}else if (agent.hospitalized()){
@@ -839,60 +1587,105 @@ void ABM::print_age_dependent_distributions(const std::string filename) const
 	}	
 }
 
+// Save summary statistics of the recorded infections
+void ABM::print_lineage_summary(const std::string& filename) const
+{
+	typedef PopulationSegment PS;
+	// Households as registered, and those of infected not in the log,
+	// by the IDs from the input files like the records
+	std::vector<int> household_sizes(households.size(), 0);
+	std::vector<int> agent_households(agents.size(), 0);
+	std::vector<bool> logged(agents.size(), false);
+	for (const auto& rec : lineage.get_records()){
+		logged.at(rec.agent_ID-1) = true;
+	}
+	std::vector<int> infected_households;
+	int place_IDs[2] = {0, 0};
+	int n_infectious = 0;
+	for (const auto& agent : agents){
+		const int agent_ID = get_external_agent_ID(agent.get_ID());
+		if (registered_places(agent, PS::households, place_IDs) > 0){
+			const int house_ID = get_external_place_ID(PS::households, place_IDs[0]);
+			++household_sizes.at(house_ID-1);
+			agent_households.at(agent_ID-1) = house_ID;
+		}
+		if (is_local(agent) && (agent.infected() || agent.removed())){
+			++n_infectious;
+			if (!logged.at(agent_ID-1) && agent_households.at(agent_ID-1) > 0){
+				infected_households.push_back(agent_households.at(agent_ID-1));
+			}
+		}
+	}
+
+	FileHandler file(filename, std::ios_base::out | std::ios_base::trunc);
+	std::fstream &out = file.get_stream();	
+	out << "setting,infections,reproduction\n";
+	const std::vector<int> counts = lineage.infections_by_setting();
+	const std::vector<double> reproduction = lineage.reproduction_by_setting(std::max(n_infectious, 1));
+	for (int is = 0; is < LineageLog::n_settings; ++is){
+		out << LineageLog::setting_name(static_cast<LineageLog::setting_type>(is)) << "," 
+			<< counts.at(is) << "," << reproduction.at(is) << "\n";
+	}
+	out << "\nhousehold size,secondary attack rate\n";
+	for (const auto& rate : lineage.household_attack_rates(household_sizes, 
+											agent_households, infected_households)){
+		out << rate.first << "," << rate.second << "\n";
+	}
+}
 
 // Save current household information to file 
 void ABM::print_households(const std::string fname) const
 {
-	print_places<Household>(households, fname);
+	print_places<Household>(with_external_IDs(households, household_external_IDs), fname);
 }	
 
 // Save current school information to file 
 void ABM::print_schools(const std::string fname) const
 {
-	print_places<School>(schools, fname);
+	print_places<School>(with_external_IDs(schools, school_external_IDs), fname);
 }
 
 
 // Save current workplaces information to file 
 void ABM::print_workplaces(const std::string fname) const
 {
-	print_places<Workplace>(workplaces, fname);
+	print_places<Workplace>(with_external_IDs(workplaces, workplace_external_IDs), fname);
 }
 
 // Save current hospital information to file 
 void ABM::print_hospitals(const std::string fname) const
 {
-	print_places<Hospital>(hospitals, fname);
+	print_places<Hospital>(with_external_IDs(hospitals, hospital_external_IDs), fname);
 }
 
 // Save current retirement home information to file 
 void ABM::print_retirement_home(const std::string fname) const
 {
-	print_places<RetirementHome>(retirement_homes, fname);
+	print_places<RetirementHome>(with_external_IDs(retirement_homes, retirement_home_external_IDs), fname);
 }
 
 // Save IDs of all agents in all households
 void ABM::print_agents_in_households(const std::string filename) const
 {
-	print_agents_in_places<Household>(households, filename);
+	print_agents_in_places<Household>(with_external_IDs(households, household_external_IDs), filename);
 }
 
 // Save IDs of all agents in all schools
 void ABM::print_agents_in_schools(const std::string filename) const
 {
-	print_agents_in_places<School>(schools, filename);
+	print_agents_in_places<School>(with_external_IDs(schools, school_external_IDs), filename);
 }
 
 // Save IDs of all agents in all workplaces 
 void ABM::print_agents_in_workplaces(const std::string filename) const
 {
-	print_agents_in_places<Workplace>(workplaces, filename);
+	print_agents_in_places<Workplace>(with_external_IDs(workplaces, workplace_external_IDs), filename);
 }
 
 // Save IDs of all agents in all hospitals 
 void ABM::print_agents_in_hospitals(const std::string filename) const
 {
-	print_agents_in_places<Hospital>(hospitals, filename);
+	print_agents_in_places<Hospital>(with_external_IDs(hospitals, hospital_external_IDs), filename);
 }
 
 // Save current agent information to file 
@@ -905,6 +1698,56 @@ void ABM::print_agents(const std::string fname) const
 
 	// Write data to file
 	AbmIO abm_io(fname, delim, sflag, dims);
-	abm_io.write_vector<Agent>(agents);	
+	if (agent_external_IDs.empty()){
+		abm_io.write_vector<Agent>(agents);	
+		return;
+	}
+
+	// IDs from the input files if reordered
+	auto external_ID = [](const std::vector<int>& external_IDs, const int ID)
+		{ return (ID > 0 && ID <= external_IDs.size()) ? external_IDs.at(ID-1) : ID; };
+	std::vector<Agent> restored(agents.size());
+	std::vector<AgentProfile> restored_profiles(agents.size());
+	for (const auto& agent : agents){
+		const int index = agent_external_IDs.at(agent.get_ID()-1) - 1;
+		Agent& ra = restored.at(index);
+		AgentProfile& profile = restored_profiles.at(index);
+		ra = agent;
+		profile = agent.get_profile();
+		ra.set_profile(&profile);
+		ra.set_ID(agent_external_IDs.at(agent.get_ID()-1));
+		if (!agent.hospital_non_covid_patient()){
+			ra.set_household_ID(external_ID(agent.retirement_home_resident() ? 
+					retirement_home_external_IDs : household_external_IDs, agent.get_household_ID()));
+		}
+		if (agent.student()){
+			profile.school_ID = external_ID(school_external_IDs, agent.get_school_ID());
+		}
+		if (agent.works()){
+			if (agent.retirement_home_employee()){
+				profile.work_ID = external_ID(retirement_home_external_IDs, agent.get_work_ID());
+			} else if (agent.school_employee()){
+				profile.work_ID = external_ID(school_external_IDs, agent.get_work_ID());
+			} else {
+				profile.work_ID = external_ID(workplace_external_IDs, agent.get_work_ID());
+			}
+		}
+		ra.set_hospital_ID(external_ID(hospital_external_IDs, agent.get_hospital_ID()));
+	}
+	abm_io.write_vector<Agent>(restored);	
 }
 
+//
+// Instantiations for the features of this build 
+//
+
+#define ABM_INSTANTIATIONS(FEATURES) \
+	template void ABM::transmit_infection<FEATURES>(); \
+	template void ABM::check_events<FEATURES>(std::vector<School>&, std::vector<Workplace>&); \
+	template void ABM::accumulate_place_contributions<FEATURES>(); \
+	template void ABM::compute_state_transitions<FEATURES>();
+
+ABM_INSTANTIATIONS(AllFeatures)
+#ifdef ABM_SPECIALIZED_FEATURES
+ABM_INSTANTIATIONS(BuildFeatures)
+#endif
@@ -14,12 +14,13 @@
 // Print Agent information 
 void Agent::print_basic(std::ostream& where) const
 {
-	where << ID << " " << is_student << " " << is_working  
-		  << " " << age << " " << x << " " << y << " "
-		  << house_ID << " " << is_non_covid_patient << " " << school_ID 
-		  << " " << work_ID << " " << works_at_hospital 
-		  << " " << hospital_ID << " " << worksRH 
-		  << " " << worksSch << " " << livesRH << " "<< is_infected;	
+	where << ID << " " << profile->student << " " << profile->works  
+		  << " " << profile->age << " " << profile->x << " " << profile->y << " "
+		  << house_ID << " " << profile->non_covid_patient << " " << profile->school_ID 
+		  << " " << profile->work_ID << " " << profile->hospital_employee 
+		  << " " << hospital_ID << " " << profile->retirement_home_employee 
+		  << " " << profile->school_employee << " " << profile->retirement_home_resident 
+		  << " "<< is_infected;	
 }
 
 //
@@ -37,4 +38,13 @@ std::ostream& operator<< (std::ostream& out, const Agent& agent)
 	return out;
 }
 
+//
+// Private
+//
 
+// Profile of default constructed agents
+const AgentProfile& Agent::empty_profile()
+{
+	static const AgentProfile empty;
+	return empty;
+}
@@ -0,0 +1,239 @@
+#include "../../include/c_api/abm_c_api.h"
+#include "../../include/abm.h"
+
+/*****************************************************
+ * C interface of the model
+ *
+ * Every function catches the exceptions of the model
+ * and reports them through abm_last_error
+ *
+ *****************************************************/
+
+/// Model behind the opaque handle
+struct abm_model{
+	ABM abm;
+};
+
+namespace {
+	// Message of the last error in this thread
+	thread_local std::string last_error;
+
+	void set_error(const std::string& message) { last_error = message; }
+
+	/// Checks a handle, false with an error message if NULL
+	bool valid(const abm_model* model)
+	{
+		if (model == nullptr){
+			set_error("Model is NULL");
+			return false;
+		}
+		return true;
+	}
+
+	/// Checks a path, throws if NULL
+	std::string path(const char* name, const std::string& what)
+	{
+		if (name == nullptr){
+			throw std::invalid_argument("No file given for " + what);
+		}
+		return std::string(name);
+	}
+
+	/// Model from a population segment, NULL on error
+	abm_model* create_from(const double dt, const PopulationSegment& segment, 
+							const int n_infected, const unsigned seed)
+	{
+		abm_model* model = new abm_model{ABM(dt, segment)};
+		try {
+			model->abm.set_random_seed(seed);
+			model->abm.create_population(segment, n_infected);
+		} catch (...) {
+			delete model;
+			throw;
+		}
+		return model;
+	}
+}
+
+// Version of the interface of the library
+int abm_api_version(void)
+{
+	return ABM_C_API_VERSION;
+}
+
+// Message of the last error in the calling thread
+const char* abm_last_error(void)
+{
+	return last_error.c_str();
+}
+
+// Create a model from the input files
+abm_model* abm_create(double dt, const abm_input_files* files, int n_infected, unsigned seed)
+{
+	try {
+		if (files == nullptr){
+			throw std::invalid_argument("No input files given");
+		}
+		const std::map<std::string, std::string> dfiles =
+			{ {"exposed never symptomatic", path(files->exposed_never_symptomatic, "exposed never symptomatic")},
+			  {"hospitalization", path(files->hospitalization, "hospitalization")},
+			  {"ICU", path(files->icu, "ICU")}, {"mortality", path(files->mortality, "mortality")} };
+		abm_model* model = new abm_model{ABM(dt, path(files->infection_parameters, "infection parameters"),
+								dfiles, path(files->testing, "testing"))};
+		try {
+			model->abm.set_random_seed(seed);
+			// First the places, then the agents
+			model->abm.create_households(path(files->households, "households"));
+			model->abm.create_schools(path(files->schools, "schools"));
+			model->abm.create_workplaces(path(files->workplaces, "workplaces"));
+			model->abm.create_hospitals(path(files->hospitals, "hospitals"));
+			model->abm.create_retirement_homes(path(files->retirement_homes, "retirement homes"));
+			model->abm.create_agents(path(files->agents, "agents"), n_infected);
+		} catch (...) {
+			delete model;
+			throw;
+		}
+		return model;
+	} catch (const std::exception& e) {
+		set_error(e.what());
+	} catch (...) {
+		set_error("Unknown error creating the model");
+	}
+	return nullptr;
+}
+
+// Create a model from a published population segment file
+abm_model* abm_create_from_segment(double dt, const char* fname, int n_infected, unsigned seed)
+{
+	try {
+		const PopulationSegment segment(path(fname, "population segment"));
+		return create_from(dt, segment, n_infected, seed);
+	} catch (const std::exception& e) {
+		set_error(e.what());
+	} catch (...) {
+		set_error("Unknown error creating the model");
+	}
+	return nullptr;
+}
+
+// Create a model from the contents of a population segment in memory
+abm_model* abm_create_from_buffer(double dt, const void* buffer, size_t size, int n_infected, unsigned seed)
+{
+	try {
+		// Models keep reading from the segment, the caller's buffer
+		// is copied so that it is not needed once the model exists
+		if (buffer == nullptr){
+			throw std::runtime_error("Not a population segment or not aligned in memory");
+		}
+		auto copy = std::make_shared<std::vector<double>>((size + sizeof(double) - 1)/sizeof(double));
+		std::memcpy(copy->data(), buffer, size);
+		const PopulationSegment segment(std::shared_ptr<const void>(copy, copy->data()), size);
+		return create_from(dt, segment, n_infected, seed);
+	} catch (const std::exception& e) {
+		set_error(e.what());
+	} catch (...) {
+		set_error("Unknown error creating the model");
+	}
+	return nullptr;
+}
+
+// Free a model
+void abm_destroy(abm_model* model)
+{
+	delete model;
+}
+
+// Seed the random number generators again
+int abm_set_random_seed(abm_model* model, unsigned seed)
+{
+	if (!valid(model)){
+		return -1;
+	}
+	model->abm.set_random_seed(seed);
+	return 0;
+}
+
+// Advance the model by a number of time steps
+int abm_step(abm_model* model, int n_steps)
+{
+	if (!valid(model)){
+		return -1;
+	}
+	try {
+		for (int ti = 0; ti < n_steps; ++ti){
+			model->abm.transmit_infection();
+		}
+		return 0;
+	} catch (const std::exception& e) {
+		set_error(e.what());
+	} catch (...) {
+		set_error("Unknown error during a time step");
+	}
+	return -1;
+}
+
+// Current simulation time
+double abm_get_time(const abm_model* model)
+{
+	if (!valid(model)){
+		return -1.0;
+	}
+	return model->abm.get_time();
+}
+
+// Value of a counter
+int abm_get_counter(const abm_model* model, abm_counter counter)
+{
+	if (!valid(model)){
+		return -1;
+	}
+	const ABM& abm = model->abm;
+	switch (counter){
+		case ABM_NUM_INFECTED: return abm.get_num_infected();
+		case ABM_NUM_EXPOSED: return abm.get_num_exposed();
+		case ABM_NUM_ACTIVE_CASES: return abm.get_num_active_cases();
+		case ABM_TOTAL_INFECTED: return abm.get_total_infected();
+		case ABM_TOTAL_DEAD: return abm.get_total_dead();
+		case ABM_TESTED_DEAD: return abm.get_tested_dead();
+		case ABM_NOT_TESTED_DEAD: return abm.get_not_tested_dead();
+		case ABM_TOTAL_RECOVERED: return abm.get_total_recovered();
+		case ABM_TOTAL_TESTED: return abm.get_total_tested();
+		case ABM_TOTAL_TESTED_POSITIVE: return abm.get_total_tested_positive();
+		case ABM_TOTAL_TESTED_NEGATIVE: return abm.get_total_tested_negative();
+		case ABM_TOTAL_TESTED_FALSE_POSITIVE: return abm.get_total_tested_false_positive();
+		case ABM_TOTAL_TESTED_FALSE_NEGATIVE: return abm.get_total_tested_false_negative();
+		case ABM_TOTAL_VACCINATED: return abm.get_total_vaccinated();
+	}
+	set_error("Wrong counter: " + std::to_string(static_cast<int>(counter)));
+	return -1;
+}
+
+// Pointer to the entries of a daily series
+const int* abm_get_series(const abm_model* model, abm_series series, size_t* length)
+{
+	if (length != nullptr){
+		*length = 0;
+	}
+	if (!valid(model)){
+		return nullptr;
+	}
+	const ABM& abm = model->abm;
+	const std::vector<int>* values = nullptr;
+	switch (series){
+		case ABM_INFECTED_DAY: values = &abm.get_infected_day(); break;
+		case ABM_TESTED_DAY: values = &abm.get_tested_day(); break;
+		case ABM_TESTED_POSITIVE_DAY: values = &abm.get_tested_positive_day(); break;
+		case ABM_TESTED_NEGATIVE_DAY: values = &abm.get_tested_negative_day(); break;
+		case ABM_TESTED_FALSE_POSITIVE_DAY: values = &abm.get_tested_false_positive_day(); break;
+		case ABM_TESTED_FALSE_NEGATIVE_DAY: values = &abm.get_tested_false_negative_day(); break;
+		case ABM_VACCINATED_DAY: values = &abm.get_vaccinated_day(); break;
+	}
+	if (values == nullptr){
+		set_error("Wrong series: " + std::to_string(static_cast<int>(series)));
+		return nullptr;
+	}
+	if (length != nullptr){
+		*length = values->size();
+	}
+	return values->empty() ? nullptr : values->data();
+}
@@ -0,0 +1,696 @@
+#include "../../include/calibration/calibration.h"
+
+/*****************************************************
+ * class: Calibration
+ *
+ * Fits infection parameters to observed data with
+ * simulations run in the same process
+ *
+ *****************************************************/
+
+namespace {
+	/// Eigenvalues and eigenvectors (columns of V) of a symmetric matrix, Jacobi method
+	void symmetric_eigen(std::vector<std::vector<double>> A, std::vector<std::vector<double>>& V, 
+							std::vector<double>& eigenvalues)
+	{
+		const int n = A.size();
+		V.assign(n, std::vector<double>(n, 0.0));
+		for (int i = 0; i < n; ++i){
+			V.at(i).at(i) = 1.0;
+		}
+		for (int sweep = 0; sweep < 100; ++sweep){
+			double off_diagonal = 0.0;
+			for (int p = 0; p < n; ++p){
+				for (int q = p + 1; q < n; ++q){
+					off_diagonal += A.at(p).at(q)*A.at(p).at(q);
+				}
+			}
+			if (off_diagonal < 1e-30){
+				break;
+			}
+			for (int p = 0; p < n; ++p){
+				for (int q = p + 1; q < n; ++q){
+					if (std::abs(A.at(p).at(q)) < 1e-300){
+						continue;
+					}
+					// Rotation that zeroes A(p,q)
+					const double theta = (A.at(q).at(q) - A.at(p).at(p))/(2.0*A.at(p).at(q));
+					const double t = ((theta >= 0.0) ? 1.0 : -1.0)/(std::abs(theta) + std::sqrt(theta*theta + 1.0));
+					const double c = 1.0/std::sqrt(t*t + 1.0), s = t*c;
+					for (int k = 0; k < n; ++k){
+						const double akp = A.at(k).at(p), akq = A.at(k).at(q);
+						A.at(k).at(p) = c*akp - s*akq;
+						A.at(k).at(q) = s*akp + c*akq;
+					}
+					for (int k = 0; k < n; ++k){
+						const double apk = A.at(p).at(k), aqk = A.at(q).at(k);
+						A.at(p).at(k) = c*apk - s*aqk;
+						A.at(q).at(k) = s*apk + c*aqk;
+					}
+					for (int k = 0; k < n; ++k){
+						const double vkp = V.at(k).at(p), vkq = V.at(k).at(q);
+						V.at(k).at(p) = c*vkp - s*vkq;
+						V.at(k).at(q) = s*vkp + c*vkq;
+					}
+				}
+			}
+		}
+		eigenvalues.resize(n);
+		for (int i = 0; i < n; ++i){
+			eigenvalues.at(i) = A.at(i).at(i);
+		}
+	}
+
+	/// Point limited to the unit hypercube
+	std::vector<double> clamp_unit(std::vector<double> point)
+	{
+		for (auto& value : point){
+			value = std::min(1.0, std::max(0.0, value));
+		}
+		return point;
+	}
+
+	/// Cumulative distribution function of the standard normal distribution
+	double normal_cdf(const double z)
+	{
+		return 0.5*std::erfc(-z/std::sqrt(2.0));
+	}
+}
+
+// Creates a calibration against a model
+Calibration::Calibration(const ABM& model) : base(model) { }
+
+// Add a parameter to calibrate
+void Calibration::add_parameter(const std::string& name, const double min_value, const double max_value)
+{
+	if (base.get_infection_parameters().count(name) == 0){
+		throw std::invalid_argument("Unknown infection parameter: " + name);
+	}
+	if (std::find(names.begin(), names.end(), name) != names.end()){
+		throw std::invalid_argument("Parameter already calibrated: " + name);
+	}
+	if (min_value >= max_value){
+		throw std::invalid_argument("Wrong range of parameter: " + name);
+	}
+	names.push_back(name);
+	ranges.push_back(std::make_pair(min_value, max_value));
+}
+
+// Add observations of a model quantity
+void Calibration::add_target(const quantity_type quantity, const std::vector<Observation>& observations, 
+								const double weight)
+{
+	if (weight < 0.0){
+		throw std::invalid_argument("Weight of a target cannot be negative");
+	}
+	for (const auto& obs : observations){
+		if (obs.time < 0.0){
+			throw std::invalid_argument("Observation before the start of the simulation");
+		}
+		WeightedObservation wobs;
+		wobs.time = obs.time;
+		wobs.value = obs.value;
+		wobs.quantity = quantity;
+		wobs.weight = weight;
+		observed.push_back(wobs);
+	}
+	std::stable_sort(observed.begin(), observed.end(), 
+		[](const WeightedObservation& a, const WeightedObservation& b){ return a.time < b.time; });
+}
+
+// Read observations from columns of a text file
+std::vector<Calibration::Observation> Calibration::load_observations(const std::string& fname, 
+			const int time_column, const int value_column, const double time_shift)
+{
+	std::ifstream input(fname);
+	if (!input.is_open()){
+		throw std::runtime_error("Error opening the file with observations: " + fname);
+	}
+	// True and the value if the whole field is a number
+	auto number = [](const std::string& field, double& value){
+		try {
+			std::size_t n_read = 0;
+			value = std::stod(field, &n_read);
+			return n_read == field.size();
+		} catch (const std::exception&) {
+			return false;
+		}
+	};
+
+	std::vector<Observation> observations;
+	std::string line;
+	while (std::getline(input, line)){
+		std::istringstream fields(line);
+		std::vector<std::string> columns{std::istream_iterator<std::string>(fields), 
+											std::istream_iterator<std::string>()};
+		Observation obs;
+		if (std::max(time_column, value_column) >= columns.size()
+				|| !number(columns.at(time_column), obs.time)
+				|| !number(columns.at(value_column), obs.value)){
+			continue;
+		}
+		obs.time += time_shift;
+		observations.push_back(obs);
+	}
+	return observations;
+}
+
+// Number of simulations per candidate
+void Calibration::set_replicates(const int n)
+{
+	if (n < 1){
+		throw std::invalid_argument("Number of replicates needs to be at least 1");
+	}
+	n_replicates = n;
+}
+
+// Number of threads for the simulations
+void Calibration::set_number_of_threads(const int n)
+{
+	if (n < 1){
+		throw std::invalid_argument("Number of threads needs to be at least 1");
+	}
+	n_threads = n;
+}
+
+// Error of one candidate
+double Calibration::evaluate(const std::vector<double>& parameters, const double bound)
+{
+	check_setup(parameters);
+	return evaluate_batch({to_unit(parameters)}, {bound}).at(0);
+}
+
+// Minimize the error with the Nelder-Mead method
+Calibration::Candidate Calibration::nelder_mead(const std::vector<double>& start, 
+									const int max_evaluations, const double tol)
+{
+	check_setup(start);
+	const double inf = std::numeric_limits<double>::infinity();
+	const int n = names.size();
+	const int evaluations_start = n_evaluations;
+	auto budget_left = [&](){ return n_evaluations - evaluations_start < max_evaluations; };
+
+	// Initial simplex
+	std::vector<std::vector<double>> simplex(n + 1, clamp_unit(to_unit(start)));
+	for (int i = 0; i < n; ++i){
+		double& value = simplex.at(i+1).at(i);
+		value += (value + 0.1 <= 1.0) ? 0.1 : -0.1;
+	}
+	std::vector<double> errors = evaluate_batch(simplex, std::vector<double>(n + 1, inf));
+
+	std::vector<int> order(n + 1);
+	while (true){
+		// Order from the best to the worst
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), 
+			[&errors](const int a, const int b){ return errors.at(a) < errors.at(b); });
+		std::vector<std::vector<double>> sorted_simplex;
+		std::vector<double> sorted_errors;
+		for (const auto& i : order){
+			sorted_simplex.push_back(simplex.at(i));
+			sorted_errors.push_back(errors.at(i));
+		}
+		simplex.swap(sorted_simplex);
+		errors.swap(sorted_errors);
+
+		double size = 0.0;
+		for (int i = 1; i <= n; ++i){
+			for (int j = 0; j < n; ++j){
+				size = std::max(size, std::abs(simplex.at(i).at(j) - simplex.at(0).at(j)));
+			}
+		}
+		if (size < tol || !budget_left()){
+			break;
+		}
+
+		// Centroid of all but the worst
+		std::vector<double> centroid(n, 0.0);
+		for (int i = 0; i < n; ++i){
+			for (int j = 0; j < n; ++j){
+				centroid.at(j) += simplex.at(i).at(j)/n;
+			}
+		}
+		auto along = [&](const double coef, const std::vector<double>& point){
+			std::vector<double> moved(n);
+			for (int j = 0; j < n; ++j){
+				moved.at(j) = centroid.at(j) + coef*(point.at(j) - centroid.at(j));
+			}
+			return clamp_unit(moved);
+		};
+		std::vector<double>& worst = simplex.at(n);
+		const double f_worst = errors.at(n);
+
+		// Reflection, abandoned if worse than the worst
+		const std::vector<double> reflected = along(-1.0, worst);
+		const double f_reflected = evaluate_batch({reflected}, {f_worst}).at(0);
+		bool shrink = false;
+		if (f_reflected < errors.at(0)){
+			// Expansion
+			const std::vector<double> expanded = along(-2.0, worst);
+			const double f_expanded = budget_left() ? evaluate_batch({expanded}, {f_reflected}).at(0) : inf;
+			if (f_expanded < f_reflected){
+				worst = expanded;
+				errors.at(n) = f_expanded;
+			} else {
+				worst = reflected;
+				errors.at(n) = f_reflected;
+			}
+		} else if (f_reflected < errors.at(n-1)){
+			worst = reflected;
+			errors.at(n) = f_reflected;
+		} else if (budget_left()){
+			// Contraction outside or inside
+			const bool outside = f_reflected < f_worst;
+			const std::vector<double> contracted = outside ? along(-0.5, worst) : along(0.5, worst);
+			const double f_limit = outside ? f_reflected : f_worst;
+			const double f_contracted = evaluate_batch({contracted}, {f_limit}).at(0);
+			if ((outside && f_contracted <= f_reflected) || (!outside && f_contracted < f_worst)){
+				worst = contracted;
+				errors.at(n) = f_contracted;
+			} else {
+				shrink = true;
+			}
+		}
+
+		// Shrink towards the best
+		if (shrink && budget_left()){
+			std::vector<std::vector<double>> shrunk;
+			for (int i = 1; i <= n; ++i){
+				for (int j = 0; j < n; ++j){
+					simplex.at(i).at(j) = simplex.at(0).at(j) + 0.5*(simplex.at(i).at(j) - simplex.at(0).at(j));
+				}
+				shrunk.push_back(simplex.at(i));
+			}
+			const std::vector<double> shrunk_errors = evaluate_batch(shrunk, std::vector<double>(n, inf));
+			std::copy(shrunk_errors.begin(), shrunk_errors.end(), errors.begin() + 1);
+		}
+	}
+
+	Candidate best;
+	best.parameters = from_unit(simplex.at(0));
+	best.error = errors.at(0);
+	return best;
+}
+
+// Minimize the error with CMA-ES
+Calibration::Candidate Calibration::cma_es(const std::vector<double>& start, const double sigma, 
+												const int max_evaluations)
+{
+	check_setup(start);
+	if (sigma <= 0.0){
+		throw std::invalid_argument("Step size of CMA-ES needs to be positive");
+	}
+	const double inf = std::numeric_limits<double>::infinity();
+	const int n = names.size();
+	std::mt19937 engine(calibration_seed);
+	std::normal_distribution<double> normal(0.0, 1.0);
+
+	// Strategy parameters
+	const int lambda = 4 + static_cast<int>(3.0*std::log(n));
+	const int mu = lambda/2;
+	std::vector<double> w(mu);
+	for (int i = 0; i < mu; ++i){
+		w.at(i) = std::log(mu + 0.5) - std::log(i + 1.0);
+	}
+	const double w_sum = std::accumulate(w.begin(), w.end(), 0.0);
+	double w_sq = 0.0;
+	for (auto& wi : w){
+		wi /= w_sum;
+		w_sq += wi*wi;
+	}
+	const double mueff = 1.0/w_sq;
+	const double cc = (4.0 + mueff/n)/(n + 4.0 + 2.0*mueff/n);
+	const double cs = (mueff + 2.0)/(n + mueff + 5.0);
+	const double c1 = 2.0/((n + 1.3)*(n + 1.3) + mueff);
+	const double cmu = std::min(1.0 - c1, 2.0*(mueff - 2.0 + 1.0/mueff)/((n + 2.0)*(n + 2.0) + mueff));
+	const double damps = 1.0 + 2.0*std::max(0.0, std::sqrt((mueff - 1.0)/(n + 1.0)) - 1.0) + cs;
+	const double chiN = std::sqrt(n)*(1.0 - 1.0/(4.0*n) + 1.0/(21.0*n*n));
+
+	// State of the search distribution
+	std::vector<double> mean = clamp_unit(to_unit(start));
+	double step = sigma;
+	std::vector<std::vector<double>> C(n, std::vector<double>(n, 0.0)), B = C;
+	for (int i = 0; i < n; ++i){
+		C.at(i).at(i) = 1.0;
+		B.at(i).at(i) = 1.0;
+	}
+	std::vector<double> D(n, 1.0), pc(n, 0.0), ps(n, 0.0);
+
+	Candidate best;
+	best.error = inf;
+	best.parameters = start;
+	int n_used = 0, generation = 0;
+	while (n_used + lambda <= max_evaluations){
+		// Sample and evaluate a generation
+		std::vector<std::vector<double>> xs(lambda), ys(lambda, std::vector<double>(n, 0.0));
+		for (int k = 0; k < lambda; ++k){
+			std::vector<double> z(n);
+			for (auto& zi : z){
+				zi = normal(engine);
+			}
+			std::vector<double> x(n);
+			for (int i = 0; i < n; ++i){
+				for (int j = 0; j < n; ++j){
+					ys.at(k).at(i) += B.at(i).at(j)*D.at(j)*z.at(j);
+				}
+				x.at(i) = mean.at(i) + step*ys.at(k).at(i);
+			}
+			xs.at(k) = clamp_unit(x);
+			for (int i = 0; i < n; ++i){
+				ys.at(k).at(i) = (xs.at(k).at(i) - mean.at(i))/step;
+			}
+		}
+		const std::vector<double> f = evaluate_batch(xs, std::vector<double>(lambda, inf));
+		n_used += lambda;
+		std::vector<int> order(lambda);
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&f](const int a, const int b){ return f.at(a) < f.at(b); });
+		if (f.at(order.at(0)) < best.error){
+			best.error = f.at(order.at(0));
+			best.parameters = from_unit(xs.at(order.at(0)));
+		}
+
+		// Mean
+		std::vector<double> y_w(n, 0.0);
+		for (int i = 0; i < mu; ++i){
+			for (int j = 0; j < n; ++j){
+				y_w.at(j) += w.at(i)*ys.at(order.at(i)).at(j);
+			}
+		}
+		for (int j = 0; j < n; ++j){
+			mean.at(j) += step*y_w.at(j);
+		}
+
+		// Evolution paths
+		std::vector<double> Bt_y(n, 0.0), invsqrtC_y(n, 0.0);
+		for (int i = 0; i < n; ++i){
+			for (int j = 0; j < n; ++j){
+				Bt_y.at(i) += B.at(j).at(i)*y_w.at(j);
+			}
+		}
+		for (int i = 0; i < n; ++i){
+			for (int j = 0; j < n; ++j){
+				invsqrtC_y.at(i) += B.at(i).at(j)*Bt_y.at(j)/D.at(j);
+			}
+		}
+		double ps_norm = 0.0;
+		for (int i = 0; i < n; ++i){
+			ps.at(i) = (1.0 - cs)*ps.at(i) + std::sqrt(cs*(2.0 - cs)*mueff)*invsqrtC_y.at(i);
+			ps_norm += ps.at(i)*ps.at(i);
+		}
+		ps_norm = std::sqrt(ps_norm);
+		++generation;
+		const bool hsig = ps_norm/std::sqrt(1.0 - std::pow(1.0 - cs, 2.0*generation))/chiN < 1.4 + 2.0/(n + 1.0);
+		for (int i = 0; i < n; ++i){
+			pc.at(i) = (1.0 - cc)*pc.at(i) + (hsig ? std::sqrt(cc*(2.0 - cc)*mueff)*y_w.at(i) : 0.0);
+		}
+
+		// Covariance and step size
+		for (int i = 0; i < n; ++i){
+			for (int j = 0; j < n; ++j){
+				double rank_mu = 0.0;
+				for (int k = 0; k < mu; ++k){
+					rank_mu += w.at(k)*ys.at(order.at(k)).at(i)*ys.at(order.at(k)).at(j);
+				}
+				C.at(i).at(j) = (1.0 - c1 - cmu)*C.at(i).at(j) 
+					+ c1*(pc.at(i)*pc.at(j) + (hsig ? 0.0 : cc*(2.0 - cc)*C.at(i).at(j)))
+					+ cmu*rank_mu;
+			}
+		}
+		step *= std::exp((cs/damps)*(ps_norm/chiN - 1.0));
+		std::vector<double> eigenvalues;
+		symmetric_eigen(C, B, eigenvalues);
+		for (int i = 0; i < n; ++i){
+			D.at(i) = std::sqrt(std::max(eigenvalues.at(i), 1e-20));
+		}
+		if (step*(*std::max_element(D.begin(), D.end())) < 1e-12){
+			break;
+		}
+	}
+	return best;
+}
+
+// Sample the approximate posterior with ABC-SMC
+std::vector<Calibration::Candidate> Calibration::abc_smc(const int n_particles, const int n_generations, 
+							const double quantile, const int max_evaluations)
+{
+	check_setup(std::vector<double>(names.size(), 0.0));
+	if (n_particles < 2 || n_generations < 0 || quantile <= 0.0 || quantile > 1.0){
+		throw std::invalid_argument("Wrong settings of ABC-SMC");
+	}
+	const double inf = std::numeric_limits<double>::infinity();
+	const int n = names.size();
+	std::mt19937 engine(calibration_seed);
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+	std::normal_distribution<double> normal(0.0, 1.0);
+	tolerances.clear();
+
+	// First generation from the prior, all accepted
+	std::vector<std::vector<double>> particles(n_particles, std::vector<double>(n));
+	for (auto& particle : particles){
+		for (auto& value : particle){
+			value = uniform(engine);
+		}
+	}
+	std::vector<double> errors = evaluate_batch(particles, std::vector<double>(n_particles, inf));
+	int n_used = n_particles;
+	std::vector<double> weights(n_particles, 1.0/n_particles);
+	tolerances.push_back(inf);
+
+	for (int gen = 0; gen < n_generations; ++gen){
+		// Tolerance from the previous errors
+		std::vector<double> sorted_errors = errors;
+		std::sort(sorted_errors.begin(), sorted_errors.end());
+		const double eps = sorted_errors.at(static_cast<int>(quantile*(n_particles - 1)));
+		tolerances.push_back(eps);
+
+		// Gaussian kernel with twice the weighted variance
+		std::vector<double> kernel_sd(n);
+		for (int j = 0; j < n; ++j){
+			double m = 0.0, var = 0.0;
+			for (int i = 0; i < n_particles; ++i){
+				m += weights.at(i)*particles.at(i).at(j);
+			}
+			for (int i = 0; i < n_particles; ++i){
+				var += weights.at(i)*std::pow(particles.at(i).at(j) - m, 2);
+			}
+			kernel_sd.at(j) = std::sqrt(std::max(2.0*var, 1e-12));
+		}
+		std::discrete_distribution<int> pick(weights.begin(), weights.end());
+
+		std::vector<std::vector<double>> accepted;
+		std::vector<double> accepted_errors;
+		while (accepted.size() < n_particles){
+			const int n_proposed = n_particles - accepted.size();
+			if (n_used + n_proposed > max_evaluations){
+				throw std::runtime_error("ABC-SMC needs more evaluations than the limit");
+			}
+			// Perturbed particles inside the prior
+			std::vector<std::vector<double>> proposals(n_proposed);
+			for (auto& proposal : proposals){
+				const std::vector<double>& origin = particles.at(pick(engine));
+				proposal.resize(n);
+				for (int j = 0; j < n; ++j){
+					do {
+						proposal.at(j) = origin.at(j) + kernel_sd.at(j)*normal(engine);
+					} while (proposal.at(j) < 0.0 || proposal.at(j) > 1.0);
+				}
+			}
+			const std::vector<double> proposal_errors = evaluate_batch(proposals, std::vector<double>(n_proposed, eps));
+			n_used += n_proposed;
+			for (int k = 0; k < n_proposed; ++k){
+				if (proposal_errors.at(k) <= eps){
+					accepted.push_back(proposals.at(k));
+					accepted_errors.push_back(proposal_errors.at(k));
+				}
+			}
+		}
+
+		// Mass of the kernel of each particle inside the prior, 
+		// proposals are redrawn until they fall inside
+		std::vector<double> kernel_mass(n_particles, 1.0);
+		for (int i = 0; i < n_particles; ++i){
+			for (int j = 0; j < n; ++j){
+				const double x = particles.at(i).at(j);
+				kernel_mass.at(i) *= normal_cdf((1.0 - x)/kernel_sd.at(j)) - normal_cdf(-x/kernel_sd.at(j));
+			}
+		}
+
+		// Importance weights for the uniform prior
+		std::vector<double> new_weights(n_particles, 0.0);
+		for (int k = 0; k < n_particles; ++k){
+			double denominator = 0.0;
+			for (int i = 0; i < n_particles; ++i){
+				double log_kernel = 0.0;
+				for (int j = 0; j < n; ++j){
+					log_kernel -= 0.5*std::pow((accepted.at(k).at(j) - particles.at(i).at(j))/kernel_sd.at(j), 2);
+				}
+				denominator += weights.at(i)*std::exp(log_kernel)/std::max(kernel_mass.at(i), 1e-300);
+			}
+			new_weights.at(k) = 1.0/std::max(denominator, 1e-300);
+		}
+		const double w_total = std::accumulate(new_weights.begin(), new_weights.end(), 0.0);
+		for (auto& wk : new_weights){
+			wk /= w_total;
+		}
+		particles.swap(accepted);
+		errors.swap(accepted_errors);
+		weights.swap(new_weights);
+	}
+
+	std::vector<Candidate> posterior(n_particles);
+	for (int i = 0; i < n_particles; ++i){
+		posterior.at(i).parameters = from_unit(particles.at(i));
+		posterior.at(i).error = errors.at(i);
+		posterior.at(i).weight = weights.at(i);
+	}
+	return posterior;
+}
+
+// Seed of replicate r, same for all the candidates
+unsigned Calibration::replicate_seed(const int r) const
+{
+	std::seed_seq seq{calibration_seed, static_cast<unsigned>(r)};
+	std::vector<unsigned> seed(1);
+	seq.generate(seed.begin(), seed.end());
+	return seed.at(0);
+}
+
+// Errors of a batch of candidates given in the unit hypercube
+std::vector<double> Calibration::evaluate_batch(const std::vector<std::vector<double>>& points, 
+						const std::vector<double>& bounds)
+{
+	std::vector<std::vector<double>> candidates;
+	for (const auto& point : points){
+		candidates.push_back(from_unit(point));
+	}
+	const std::vector<double> errors = custom_objective ? custom_objective(candidates, bounds) 
+											: simulate_batch(candidates, bounds);
+	n_evaluations += candidates.size();
+	n_abandoned += std::count(errors.begin(), errors.end(), std::numeric_limits<double>::infinity());
+	return errors;
+}
+
+// Errors from simulations, averaged over replicates
+std::vector<double> Calibration::simulate_batch(const std::vector<std::vector<double>>& candidates, 
+						const std::vector<double>& bounds)
+{
+	const int n_candidates = candidates.size();
+	std::vector<std::map<std::string, double>> values(n_candidates);
+	for (int ic = 0; ic < n_candidates; ++ic){
+		for (int ip = 0; ip < names.size(); ++ip){
+			values.at(ic)[names.at(ip)] = candidates.at(ic).at(ip);
+		}
+	}
+
+	// Sums of errors over replicates of each candidate
+	std::vector<double> sums(n_candidates, 0.0);
+	std::vector<char> abandoned(n_candidates, 0);
+	std::vector<std::mutex> locks(n_candidates);
+	WorkStealingPool pool(n_threads);
+	pool.run(n_candidates*n_replicates, [&](const int job){
+			const int ic = job/n_replicates;
+			simulate(values.at(ic), job%n_replicates, bounds.at(ic)*n_replicates, 
+						sums.at(ic), abandoned.at(ic), locks.at(ic));
+		});
+
+	std::vector<double> errors(n_candidates);
+	for (int ic = 0; ic < n_candidates; ++ic){
+		errors.at(ic) = abandoned.at(ic) ? std::numeric_limits<double>::infinity() : sums.at(ic)/n_replicates;
+	}
+	return errors;
+}
+
+// Add the squared errors of one simulation to a sum shared by the replicates
+void Calibration::simulate(const std::map<std::string, double>& values, const int replicate, 
+						const double bound, double& shared_sum, char& abandoned, std::mutex& mtx) const
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		if (abandoned){
+			return;
+		}
+	}
+	ABM abm(base);
+	abm.set_infection_parameters(values);
+	abm.set_random_seed(replicate_seed(replicate));
+
+	const double tol = 1e-6;
+	std::size_t next = 0;
+	while (next < observed.size()){
+		// Observations at the current time
+		double increment = 0.0;
+		while (next < observed.size() && observed.at(next).time <= abm.get_time() + tol){
+			const WeightedObservation& obs = observed.at(next++);
+			const double diff = model_value(abm, obs.quantity) - obs.value;
+			increment += obs.weight*diff*diff;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			shared_sum += increment;
+			if (shared_sum > bound){
+				abandoned = 1;
+			}
+			if (abandoned){
+				return;
+			}
+		}
+		if (next < observed.size()){
+			abm.transmit_infection();
+		}
+	}
+}
+
+// Current value of a model quantity
+double Calibration::model_value(const ABM& abm, const quantity_type quantity)
+{
+	switch (quantity){
+		case total_infected:
+			return abm.get_total_infected();
+		case total_dead:
+			return abm.get_total_dead();
+		case total_recovered:
+			return abm.get_total_recovered();
+		case total_tested:
+			return abm.get_total_tested();
+		case total_tested_positive:
+			return abm.get_total_tested_positive();
+		case active_infected:
+			return abm.get_num_infected();
+	}
+	return 0.0;
+}
+
+// Parameter values of a point in the unit hypercube
+std::vector<double> Calibration::from_unit(const std::vector<double>& point) const
+{
+	std::vector<double> values(point.size());
+	for (int i = 0; i < point.size(); ++i){
+		values.at(i) = ranges.at(i).first + point.at(i)*(ranges.at(i).second - ranges.at(i).first);
+	}
+	return values;
+}
+
+// Point in the unit hypercube of parameter values
+std::vector<double> Calibration::to_unit(const std::vector<double>& values) const
+{
+	std::vector<double> point(values.size());
+	for (int i = 0; i < values.size(); ++i){
+		point.at(i) = (values.at(i) - ranges.at(i).first)/(ranges.at(i).second - ranges.at(i).first);
+	}
+	return point;
+}
+
+// Check the number of values and that there are targets
+void Calibration::check_setup(const std::vector<double>& values) const
+{
+	if (names.empty()){
+		throw std::runtime_error("No parameters to calibrate");
+	}
+	if (values.size() != names.size()){
+		throw std::invalid_argument("Wrong number of parameter values");
+	}
+	if (observed.empty() && !custom_objective){
+		throw std::runtime_error("No observations to calibrate against");
+	}
+}
@@ -10,6 +10,7 @@
  ******************************************************/
 
 // Count contributions of an exposed agent
+template <typename Features>
 void Contributions::compute_exposed_contributions(const Agent& agent, const double time,	
 				std::vector<Household>& households, std::vector<School>& schools,
 				std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
@@ -25,7 +26,7 @@ void Contributions::compute_exposed_contributions(const Agent& agent, const doub
 	inf_var = agent.get_inf_variability_factor();
 
 	// If main state "tested"
-	if (agent.tested()){
+	if (Features::testing && agent.tested()){
 		if (agent.get_time_of_test() <= time && agent.tested_awaiting_test() == true){
 			// If being tested at this step 			
 			if (agent.tested_in_hospital() == true){
@@ -37,9 +38,9 @@ void Contributions::compute_exposed_contributions(const Agent& agent, const doub
 			}
 		} else if (agent.tested_awaiting_results() || agent.tested_awaiting_test()){
 			// Assuming home isolation except for hospital employees and non-covid
-			if (agent.hospital_non_covid_patient() == false && 
-					agent.hospital_employee() == false){
-				compute_home_isolated_contributions(agent, inf_var, households, retirement_homes);
+			if (!Features::hospitals || (agent.hospital_non_covid_patient() == false && 
+					agent.hospital_employee() == false)){
+				compute_home_isolated_contributions<Features>(agent, inf_var, households, retirement_homes);
 			} else if (agent.hospital_non_covid_patient()){
 				Hospital& hospital = hospitals.at(agent.get_hospital_ID()-1);
 				hospital.add_exposed_patient(inf_var);
@@ -59,7 +60,7 @@ void Contributions::compute_exposed_contributions(const Agent& agent, const doub
 	}else{
 		// If hospitalized with a different condition, 
 		// and exposed (infectious), only hospital contribution
-		if (agent.hospital_non_covid_patient() == true &&
+		if (Features::hospitals && agent.hospital_non_covid_patient() == true &&
 				agent.tested_covid_positive() == false){
 			Hospital& hospital = hospitals.at(agent.get_hospital_ID()-1);
 			hospital.add_exposed_patient(inf_var);
@@ -67,13 +68,13 @@ void Contributions::compute_exposed_contributions(const Agent& agent, const doub
 		}
 	
 		// Exposed confirmed COVID in home isolation
-		if (agent.tested_covid_positive()){
-			compute_home_isolated_contributions(agent, inf_var, households, retirement_homes);
+		if (Features::testing && agent.tested_covid_positive()){
+			compute_home_isolated_contributions<Features>(agent, inf_var, households, retirement_homes);
 			return;
 		}
 
 		// Household or retirement home
-		if (agent.retirement_home_resident()){
+		if (Features::retirement_homes && agent.retirement_home_resident()){
 			RetirementHome& rh = retirement_homes.at(agent.get_household_ID()-1);
 			rh.add_exposed(inf_var);
 		} else {
@@ -87,7 +88,7 @@ void Contributions::compute_exposed_contributions(const Agent& agent, const doub
 			school.add_exposed(inf_var);	
 		}
 		if (agent.works() == true){
-			if (agent.retirement_home_employee()){
+			if (Features::retirement_homes && agent.retirement_home_employee()){
 				RetirementHome& rh = retirement_homes.at(agent.get_work_ID()-1);
 				rh.add_exposed_employee(inf_var);
 			} else if (agent.school_employee()){
@@ -98,7 +99,7 @@ void Contributions::compute_exposed_contributions(const Agent& agent, const doub
 				workplace.add_exposed(inf_var);
 			}
 		}
-		if (agent.hospital_employee() == true){
+		if (Features::hospitals && agent.hospital_employee() == true){
 			Hospital& hospital = hospitals.at(agent.get_hospital_ID()-1);
 			hospital.add_exposed(inf_var);
 		}
@@ -106,6 +107,7 @@ void Contributions::compute_exposed_contributions(const Agent& agent, const doub
 }
 
 // Count contributions of a symptomatic agent
+template <typename Features>
 void Contributions::compute_symptomatic_contributions(const Agent& agent, const double time,	
 					std::vector<Household>& households, std::vector<School>& schools,
 					std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
@@ -116,7 +118,7 @@ void Contributions::compute_symptomatic_contributions(const Agent& agent, const
 	inf_var = agent.get_inf_variability_factor();
 
 	// If main state "tested"
-	if (agent.tested()){
+	if (Features::testing && agent.tested()){
 		// If awaiting results 
 		if (agent.get_time_of_test() <= time && agent.tested_awaiting_test() == true){
 			// If being tested at this step
@@ -130,8 +132,8 @@ void Contributions::compute_symptomatic_contributions(const Agent& agent, const
 		} else if (agent.tested_awaiting_results() || agent.tested_awaiting_test()){
 			// Assuming home isolation except for hospital patients formerly
 			// non-COVID
-			if (agent.hospital_non_covid_patient() == false){
-				compute_home_isolated_contributions(agent, inf_var, households, retirement_homes);
+			if (!Features::hospitals || agent.hospital_non_covid_patient() == false){
+				compute_home_isolated_contributions<Features>(agent, inf_var, households, retirement_homes);
 			}else{
 				compute_hospitalized_contributions(agent, inf_var, hospitals);
 			}		
@@ -139,20 +141,20 @@ void Contributions::compute_symptomatic_contributions(const Agent& agent, const
 	} else if (agent.being_treated()){ 
 		// If getting treatment
 		if (agent.home_isolated() == true){
-			compute_home_isolated_contributions(agent, inf_var, households, retirement_homes);
+			compute_home_isolated_contributions<Features>(agent, inf_var, households, retirement_homes);
 		}else if (agent.hospitalized() == true){
 			compute_hospitalized_contributions(agent, inf_var, hospitals);
 		}else if (agent.hospitalized_ICU() == true){
 			compute_hospitalized_ICU_contributions(agent, inf_var, hospitals);
 		}
 	} else {
-		if ((agent.tested_false_negative() && (agent.hospital_non_covid_patient()))
-						|| (agent.hospital_non_covid_patient())){
+		if (Features::hospitals && ((agent.tested_false_negative() && (agent.hospital_non_covid_patient()))
+						|| (agent.hospital_non_covid_patient()))){
 			Hospital& hospital = hospitals.at(agent.get_hospital_ID()-1);
 			hospital.add_symptomatic_patient(inf_var);	
 		} else {
 			// If regular symptomatic
-			compute_regular_symptomatic_contributions(agent, inf_var, households,
+			compute_regular_symptomatic_contributions<Features>(agent, inf_var, households,
 								schools, workplaces, retirement_homes);
 		}
 	}
@@ -173,13 +175,14 @@ void Contributions::total_place_contributions(std::vector<Household>& households
 }
 
 // Count contributions of a untreated and not tested symptomatic agent
+template <typename Features>
 void Contributions::compute_regular_symptomatic_contributions(const Agent& agent, 
 				const double inf_var, std::vector<Household>& households, 
 				std::vector<School>& schools, std::vector<Workplace>& workplaces,
 				std::vector<RetirementHome>& retirement_homes)
 {
 	// Household or retirement home
-	if (agent.retirement_home_resident()){
+	if (Features::retirement_homes && agent.retirement_home_resident()){
 		RetirementHome& rh = retirement_homes.at(agent.get_household_ID()-1);
 		rh.add_symptomatic(inf_var);
 	} else {
@@ -193,7 +196,7 @@ void Contributions::compute_regular_symptomatic_contributions(const Agent& agent
 		school.add_symptomatic_student(inf_var);	
 	}
 	if (agent.works() == true){
-		if (agent.retirement_home_employee()){
+		if (Features::retirement_homes && agent.retirement_home_employee()){
 			RetirementHome& rh = retirement_homes.at(agent.get_work_ID()-1);
 			rh.add_symptomatic_employee(inf_var);
 		} else if (agent.school_employee()){
@@ -223,11 +226,12 @@ void Contributions::compute_hospital_tested_contributions(const Agent& agent,
 }
 
 /// \brief Count contributions of a home-isolated agent 
+template <typename Features>
 void Contributions::compute_home_isolated_contributions(const Agent& agent, 
 				const double inf_var, std::vector<Household>& households,
 				std::vector<RetirementHome>& retirement_homes)   
 {
-	if (agent.retirement_home_resident()){
+	if (Features::retirement_homes && agent.retirement_home_resident()){
 		RetirementHome& rh = retirement_homes.at(agent.get_household_ID()-1);
 		if (agent.exposed()){
 			rh.add_exposed_home_isolated(inf_var);
@@ -274,4 +278,19 @@ void Contributions::reset_sums(std::vector<Household>& households, std::vector<S
 	std::for_each(hospitals.begin(), hospitals.end(), reset_contributions);
 }
 
+//
+// Instantiations for the features of this build 
+//
 
+#define CONTRIBUTIONS_INSTANTIATIONS(FEATURES) \
+	template void Contributions::compute_exposed_contributions<FEATURES>(const Agent&, const double, \
+				std::vector<Household>&, std::vector<School>&, std::vector<Workplace>&, \
+				std::vector<Hospital>&, std::vector<RetirementHome>&); \
+	template void Contributions::compute_symptomatic_contributions<FEATURES>(const Agent&, const double, \
+				std::vector<Household>&, std::vector<School>&, std::vector<Workplace>&, \
+				std::vector<Hospital>&, std::vector<RetirementHome>&);
+
+CONTRIBUTIONS_INSTANTIATIONS(AllFeatures)
+#ifdef ABM_SPECIALIZED_FEATURES
+CONTRIBUTIONS_INSTANTIATIONS(BuildFeatures)
+#endif
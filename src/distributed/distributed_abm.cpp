@@ -0,0 +1,305 @@
+#include "../../include/distributed/distributed_abm.h"
+#include <numeric>
+
+/*****************************************************
+ * class: DistributedABM
+ *
+ * Divides the work of the time steps of an ABM
+ * simulation between processes
+ *
+ *****************************************************/
+
+// Sets up a distributed run of an ABM
+DistributedABM::DistributedABM(ABM& model, Communicator& communicator,
+				const PopulationPartitioner& partition, const unsigned seed) :
+		abm(model), comm(communicator)
+{
+	initialize(partition, seed);
+}
+
+// Sets up a distributed run with each process on a memory node
+DistributedABM::DistributedABM(ABM& model, Communicator& communicator,
+				const PopulationPartitioner& partition, const unsigned seed,
+				const NumaTopology& topology) :
+		abm(model), comm(communicator)
+{
+	// Before any writes, so that the copies are made on the node
+	node = topology.get_rank_node(comm.rank(), comm.size());
+	pinned = topology.pin_to_node(node);
+	initialize(partition, seed);
+	touch_local_population(partition);
+}
+
+// Set up vaccination of nv random agents activated with testing
+void DistributedABM::set_random_vaccination(const int nv)
+{
+	const long long n_total = std::max(n_agents_total, 1);
+	const long long n_before = static_cast<long long>(nv)*n_agents_before/n_total;
+	const long long n_after = static_cast<long long>(nv)*(n_agents_before + n_local_agents)/n_total;
+	abm.set_random_vaccination(static_cast<int>(n_after - n_before));
+}
+
+//
+// Transmission of infection
+//
+
+// Transmit infection according to Infection model
+void DistributedABM::transmit_infection()
+{
+	abm.get_testing_object().check_switch_time(abm.get_time());
+	abm.check_events(abm.vector_of_schools(), abm.vector_of_workplaces());
+	compute_place_contributions();
+	abm.compute_state_transitions();
+	abm.reset_contributions();
+	abm.advance_in_time();
+}
+
+// Compute contributions of all places using agents of all processes
+void DistributedABM::compute_place_contributions()
+{
+	abm.accumulate_place_contributions();
+
+	// Places with all their members on this process
+	compute_local_contributions(abm.vector_of_households(), household_exchange);
+	compute_local_contributions(abm.vector_of_schools(), school_exchange);
+	compute_local_contributions(abm.vector_of_workplaces(), workplace_exchange);
+	compute_local_contributions(abm.vector_of_retirement_homes(), retirement_home_exchange);
+
+	// Sums of shared places from all processes, in one exchange
+	std::vector<Hospital>& hospitals = abm.vector_of_hospitals();
+	exchanged.clear();
+	pack_contributions(abm.get_vector_of_households(), household_exchange);
+	pack_contributions(abm.get_vector_of_schools(), school_exchange);
+	pack_contributions(abm.get_vector_of_workplaces(), workplace_exchange);
+	pack_contributions(abm.get_vector_of_hospitals(), hospital_exchange);
+	pack_contributions(abm.get_vector_of_retirement_homes(), retirement_home_exchange);
+	for (const auto& hospital : hospitals){
+		exchanged.push_back(hospital.get_n_tested());
+	}
+	comm.allreduce_sum(exchanged);
+
+	// Every process computes the same contributions from the totals
+	std::size_t iv = exchanged.size() - hospitals.size();
+	for (auto& hospital : hospitals){
+		hospital.set_n_tested(std::lround(exchanged.at(iv++)));
+	}
+	iv = 0;
+	unpack_contributions(abm.vector_of_households(), household_exchange, iv);
+	unpack_contributions(abm.vector_of_schools(), school_exchange, iv);
+	unpack_contributions(abm.vector_of_workplaces(), workplace_exchange, iv);
+	unpack_contributions(hospitals, hospital_exchange, iv);
+	unpack_contributions(abm.vector_of_retirement_homes(), retirement_home_exchange, iv);
+}
+
+//
+// Getters
+//
+
+// Number of currently infected agents of all processes
+int DistributedABM::get_num_infected()
+{
+	return sum_at_root(abm.get_num_infected());
+}
+
+// Number of currently exposed agents of all processes
+int DistributedABM::get_num_exposed()
+{
+	return sum_at_root(abm.get_num_exposed());
+}
+
+// Number of confirmed active cases of all processes
+int DistributedABM::get_num_active_cases()
+{
+	return sum_at_root(abm.get_num_active_cases());
+}
+
+// Numbers of agents in each type of treatment of all processes
+std::vector<int> DistributedABM::get_treatment_data()
+{
+	return sum_at_root(abm.get_treatment_data());
+}
+
+// Number of places with contributions exchanged between processes
+int DistributedABM::get_number_of_shared_places() const
+{
+	return household_exchange.shared.size() + school_exchange.shared.size() 
+			+ workplace_exchange.shared.size() + hospital_exchange.shared.size() 
+			+ retirement_home_exchange.shared.size();
+}
+
+//
+// Private
+//
+
+// Settings common to both constructors
+void DistributedABM::initialize(const PopulationPartitioner& partition, const unsigned seed)
+{
+	if (partition.get_number_of_ranks() != comm.size()){
+		throw std::invalid_argument("Partition has " + std::to_string(partition.get_number_of_ranks())
+						+ " ranks but there are " + std::to_string(comm.size()) + " processes");
+	}
+	if (partition.get_agent_ranks().size() != abm.get_vector_of_agents().size()){
+		throw std::invalid_argument("Partition was created for a different population");
+	}
+	if (abm.uses_spatial_transmission()){
+		throw std::invalid_argument("Distributed runs do not support spatial transmission");
+	}
+	if (abm.uses_vaccination_campaign()){
+		throw std::invalid_argument("Distributed runs do not support vaccination campaigns");
+	}
+
+	abm.set_local_agents(partition.get_local_agents(comm.rank()));
+	// Hospitals can have agents of any process
+	const std::vector<int> hospital_ranks(abm.get_vector_of_hospitals().size(), -1);
+	household_exchange = split_places(abm.vector_of_households(), partition.get_household_ranks());
+	school_exchange = split_places(abm.vector_of_schools(), partition.get_school_ranks());
+	workplace_exchange = split_places(abm.vector_of_workplaces(), partition.get_workplace_ranks());
+	hospital_exchange = split_places(abm.vector_of_hospitals(), hospital_ranks);
+	retirement_home_exchange = split_places(abm.vector_of_retirement_homes(), 
+											partition.get_retirement_home_ranks());
+
+	// Different random numbers on each process
+	std::seed_seq seq = {seed, static_cast<unsigned>(comm.rank())};
+	std::vector<unsigned> rank_seed(1);
+	seq.generate(rank_seed.begin(), rank_seed.end());
+	abm.set_random_seed(rank_seed.at(0));
+
+	const std::vector<int> n_agents = partition.get_number_of_agents_per_rank();
+	n_local_agents = n_agents.at(comm.rank());
+	n_agents_before = std::accumulate(n_agents.begin(), n_agents.begin() + comm.rank(), 0);
+	n_agents_total = std::accumulate(n_agents.begin(), n_agents.end(), 0);
+
+	initial_totals = local_totals();
+	n_initial_steps = abm.get_infected_day().size();
+}
+
+// Write to the agents of this process and their households
+void DistributedABM::touch_local_population(const PopulationPartitioner& partition)
+{
+	// A page shared with the parent process is copied on the first
+	// write, on the node of the writing thread; the values do not change
+	auto touch = [](void* object)
+		{
+			volatile char* first = static_cast<volatile char*>(object);
+			*first = *first;
+		};
+	std::vector<Household>& households = abm.vector_of_households();
+	for (auto& agent : abm.get_vector_of_agents_non_const()){
+		if (partition.get_agent_rank(agent.get_ID()) != comm.rank()){
+			continue;
+		}
+		touch(&agent);
+		const int hID = agent.get_household_ID();
+		if (!agent.retirement_home_resident() && hID > 0 && hID <= households.size()){
+			touch(&households.at(hID-1));
+		}
+	}
+}
+
+// Shared places and places of this process
+template <typename T>
+DistributedABM::PlaceExchange DistributedABM::split_places(std::vector<T>& places, 
+											const std::vector<int>& ranks)
+{
+	PlaceExchange exchange;
+	for (std::size_t ip = 0; ip < places.size(); ++ip){
+		T& place = places.at(ip);
+		const int place_rank = ranks.at(ip);
+		if (place_rank < 0){
+			exchange.shared.push_back(ip);
+			exchange.initial_sizes.push_back(place.get_agent_IDs_ref().size());
+		} else if (place_rank == comm.rank()){
+			exchange.local.push_back(ip);
+		}
+		// Sums left from registration of agents count only once,
+		// on rank 0 for the shared places
+		if (!(place_rank == comm.rank() || (place_rank < 0 && comm.rank() == 0))){
+			place.reset_contributions();
+		}
+	}
+	return exchange;
+}
+
+// Contributions of places with all members on this process
+template <typename T>
+void DistributedABM::compute_local_contributions(std::vector<T>& places, const PlaceExchange& exchange)
+{
+	for (const int ip : exchange.local){
+		places.at(ip).compute_infected_contribution();
+	}
+}
+
+// Local sums and changes in registered agents of shared places
+template <typename T>
+void DistributedABM::pack_contributions(const std::vector<T>& places, const PlaceExchange& exchange)
+{
+	for (std::size_t is = 0; is < exchange.shared.size(); ++is){
+		const T& place = places.at(exchange.shared.at(is));
+		exchanged.push_back(place.get_lambda_sum());
+		exchanged.push_back(place.get_total_infected());
+		// Change due to the agents of this process,
+		// rank 0 also adds the initial number
+		int n_registered = place.get_agent_IDs_ref().size() - exchange.initial_sizes.at(is);
+		if (comm.rank() == 0){
+			n_registered += exchange.initial_sizes.at(is);
+		}
+		exchanged.push_back(n_registered);
+	}
+}
+
+// Set the total sums and compute contributions of shared places
+template <typename T>
+void DistributedABM::unpack_contributions(std::vector<T>& places, const PlaceExchange& exchange,
+											std::size_t& iv)
+{
+	for (const int ip : exchange.shared){
+		T& place = places.at(ip);
+		// Counts are exact in double precision
+		place.set_contribution_sums(exchanged.at(iv), std::lround(exchanged.at(iv+1)));
+		place.compute_infected_contribution(std::lround(exchanged.at(iv+2)));
+		iv += 3;
+	}
+}
+
+// Sum over all processes, valid on rank 0
+int DistributedABM::sum_at_root(const int value)
+{
+	std::vector<int> values = {value};
+	comm.reduce_sum(values);
+	return values.at(0);
+}
+
+// Element-wise sum over all processes, valid on rank 0
+std::vector<int> DistributedABM::sum_at_root(std::vector<int> values)
+{
+	comm.reduce_sum(values);
+	return values;
+}
+
+// Current totals of this process
+std::vector<int> DistributedABM::local_totals()
+{
+	return {abm.get_total_infected(), abm.get_total_dead(), abm.get_tested_dead(),
+			abm.get_not_tested_dead(), abm.get_total_recovered(), abm.get_tot_recovering_exposed(),
+			abm.get_total_tested(), abm.get_total_tested_positive(), abm.get_total_tested_negative(),
+			abm.get_total_tested_false_positive(), abm.get_total_tested_false_negative()};
+}
+
+// Total of a given type of all processes, valid on rank 0
+int DistributedABM::sum_total(const total_type which)
+{
+	int value = local_totals().at(which);
+	if (comm.rank() != 0){
+		value -= initial_totals.at(which);
+	}
+	return sum_at_root(value);
+}
+
+// Daily series of all processes, valid on rank 0
+std::vector<int> DistributedABM::sum_series(std::vector<int> values)
+{
+	if (comm.rank() != 0){
+		std::fill(values.begin(), values.begin() + std::min(n_initial_steps, values.size()), 0);
+	}
+	return sum_at_root(values);
+}
@@ -0,0 +1,206 @@
+#include "../../include/distributed/local_communicator.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+/*****************************************************
+ * class: LocalCommunicator
+ *
+ * Message passing between processes on a single node
+ *
+ *****************************************************/
+
+//
+// Process management
+//
+
+// Create n_ranks processes and connect them
+std::unique_ptr<LocalCommunicator> LocalCommunicator::spawn(const int n_ranks)
+{
+	if (n_ranks < 1){
+		throw std::invalid_argument("Number of processes needs to be at least 1");
+	}
+	std::unique_ptr<LocalCommunicator> comm(new LocalCommunicator());
+	comm->n_procs = n_ranks;
+	comm->sockets.assign(n_ranks, -1);
+
+	// Avoid repeating buffered output in every process
+	std::cout.flush();
+	std::cerr.flush();
+	std::fflush(nullptr);
+
+	for (int r = 1; r < n_ranks; ++r){
+		int fds[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0){
+			throw std::runtime_error("Could not create a socket pair for rank " + std::to_string(r));
+		}
+		const pid_t pid = fork();
+		if (pid < 0){
+			throw std::runtime_error("Could not create a process for rank " + std::to_string(r));
+		}
+		if (pid == 0){
+			// New rank - keep only the connection to rank 0
+			close(fds[0]);
+			for (int k = 1; k < r; ++k){
+				close(comm->sockets.at(k));
+			}
+			comm->my_rank = r;
+			comm->sockets.assign(1, fds[1]);
+			comm->children.clear();
+			return comm;
+		}
+		close(fds[1]);
+		comm->sockets.at(r) = fds[0];
+		comm->children.push_back(pid);
+	}
+	return comm;
+}
+
+// End the distributed part of the run
+bool LocalCommunicator::finalize()
+{
+	if (my_rank != 0){
+		close(sockets.at(0));
+		std::cout.flush();
+		std::cerr.flush();
+		std::exit(0);
+	}
+
+	for (int r = 1; r < n_procs; ++r){
+		close(sockets.at(r));
+		sockets.at(r) = -1;
+	}
+	bool all_exited = true;
+	for (const auto& pid : children){
+		int status = 0;
+		if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0){
+			all_exited = false;
+		}
+	}
+	children.clear();
+	finalized = true;
+	return all_exited;
+}
+
+// Close connections and, on rank 0, collect the other processes
+LocalCommunicator::~LocalCommunicator()
+{
+	for (const auto& fd : sockets){
+		if (fd >= 0){
+			close(fd);
+		}
+	}
+	if (my_rank == 0 && !finalized){
+		for (const auto& pid : children){
+			int status = 0;
+			waitpid(pid, &status, 0);
+		}
+	}
+}
+
+//
+// Communication
+//
+
+// Element-wise sum over all processes
+void LocalCommunicator::allreduce_sum(std::vector<double>& values)
+{
+	sum_values(values, true);
+}
+
+// Element-wise sum over all processes
+void LocalCommunicator::allreduce_sum(std::vector<int>& values)
+{
+	sum_values(values, true);
+}
+
+// Element-wise sum over all processes collected at rank 0
+void LocalCommunicator::reduce_sum(std::vector<int>& values)
+{
+	sum_values(values, false);
+}
+
+// Wait until all the processes reach this point
+void LocalCommunicator::barrier()
+{
+	std::vector<int> token = {0};
+	sum_values(token, true);
+}
+
+// Element-wise sum, result on rank 0, optionally sent back to every rank
+template <typename T>
+void LocalCommunicator::sum_values(std::vector<T>& values, const bool to_all)
+{
+	if (n_procs == 1){
+		return;
+	}
+	std::uint64_t n_values = values.size();
+	const std::size_t n_bytes = values.size()*sizeof(T);
+	if (my_rank == 0){
+		// Sums in the order of ranks so that all runs add the same way
+		std::vector<T> received(values.size());
+		for (int r = 1; r < n_procs; ++r){
+			std::uint64_t n_received = 0;
+			receive_bytes(sockets.at(r), &n_received, sizeof(n_received));
+			if (n_received != n_values){
+				throw std::runtime_error("Rank " + std::to_string(r)
+								+ " sent a different number of values than rank 0");
+			}
+			receive_bytes(sockets.at(r), received.data(), n_bytes);
+			for (std::size_t i = 0; i < values.size(); ++i){
+				values[i] += received[i];
+			}
+		}
+		if (to_all){
+			for (int r = 1; r < n_procs; ++r){
+				send_bytes(sockets.at(r), values.data(), n_bytes);
+			}
+		}
+	} else {
+		send_bytes(sockets.at(0), &n_values, sizeof(n_values));
+		send_bytes(sockets.at(0), values.data(), n_bytes);
+		if (to_all){
+			receive_bytes(sockets.at(0), values.data(), n_bytes);
+		}
+	}
+}
+
+// Send size bytes from data, throws if the connection is lost
+void LocalCommunicator::send_bytes(const int fd, const void* data, const std::size_t size)
+{
+	const char* buffer = static_cast<const char*>(data);
+	std::size_t n_sent = 0;
+	while (n_sent < size){
+		const ssize_t n = send(fd, buffer + n_sent, size - n_sent, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR){
+			continue;
+		}
+		if (n <= 0){
+			throw std::runtime_error("Lost connection between ranks while sending from rank "
+								+ std::to_string(my_rank));
+		}
+		n_sent += static_cast<std::size_t>(n);
+	}
+}
+
+// Receive size bytes into data, throws if the connection is lost
+void LocalCommunicator::receive_bytes(const int fd, void* data, const std::size_t size)
+{
+	char* buffer = static_cast<char*>(data);
+	std::size_t n_received = 0;
+	while (n_received < size){
+		const ssize_t n = recv(fd, buffer + n_received, size - n_received, 0);
+		if (n < 0 && errno == EINTR){
+			continue;
+		}
+		if (n <= 0){
+			throw std::runtime_error("Lost connection between ranks while receiving on rank "
+								+ std::to_string(my_rank));
+		}
+		n_received += static_cast<std::size_t>(n);
+	}
+}
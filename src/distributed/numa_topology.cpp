@@ -0,0 +1,125 @@
+#include "../../include/distributed/numa_topology.h"
+#include <thread>
+#include <numeric>
+#include <dirent.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+/*****************************************************
+ * class: NumaTopology
+ *
+ * Memory nodes of the machine, their CPUs, and the
+ * node assigned to each process of a distributed run
+ *
+ *****************************************************/
+
+// Reads the nodes from a directory with the sysfs layout
+NumaTopology::NumaTopology(const std::string& node_dir)
+{
+	// Node numbers in the order of the directory
+	std::vector<int> node_numbers;
+	if (DIR* dir = opendir(node_dir.c_str())){
+		while (const dirent* entry = readdir(dir)){
+			const std::string name(entry->d_name);
+			if (name.size() > 4 && name.compare(0, 4, "node") == 0
+					&& name.find_first_not_of("0123456789", 4) == std::string::npos){
+				node_numbers.push_back(std::stoi(name.substr(4)));
+			}
+		}
+		closedir(dir);
+	}
+	std::sort(node_numbers.begin(), node_numbers.end());
+
+	for (const int number : node_numbers){
+		std::ifstream cpulist(node_dir + "/node" + std::to_string(number) + "/cpulist");
+		std::string list;
+		std::getline(cpulist, list);
+		// Memory without CPUs
+		std::vector<int> cpus = parse_cpu_list(list);
+		if (!cpus.empty()){
+			node_cpus.push_back(cpus);
+		}
+	}
+
+	// Not a NUMA machine or no information
+	if (node_cpus.empty()){
+		const int n_cpus = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+		node_cpus.push_back(std::vector<int>(n_cpus));
+		std::iota(node_cpus.front().begin(), node_cpus.front().end(), 0);
+	}
+}
+
+// CPUs of a list in the sysfs format
+std::vector<int> NumaTopology::parse_cpu_list(const std::string& list)
+{
+	std::vector<int> cpus;
+	std::istringstream ranges(list);
+	std::string range;
+	while (std::getline(ranges, range, ',')){
+		range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+		if (range.empty()){
+			continue;
+		}
+		const std::size_t dash = range.find('-');
+		const std::string first = range.substr(0, dash);
+		const std::string last = (dash == std::string::npos) ? first : range.substr(dash + 1);
+		if (first.empty() || last.empty() || first.find_first_not_of("0123456789") != std::string::npos
+				|| last.find_first_not_of("0123456789") != std::string::npos){
+			throw std::invalid_argument("Wrong format of CPU list: " + list);
+		}
+		const int begin = std::stoi(first), end = std::stoi(last);
+		if (end < begin){
+			throw std::invalid_argument("Wrong range in CPU list: " + list);
+		}
+		for (int cpu = begin; cpu <= end; ++cpu){
+			cpus.push_back(cpu);
+		}
+	}
+	return cpus;
+}
+
+// Assign processes to nodes
+void NumaTopology::set_rank_nodes(const std::vector<int>& nodes)
+{
+	for (const int node : nodes){
+		if (node < 0 || node >= get_number_of_nodes()){
+			throw std::invalid_argument("Node " + std::to_string(node) + " does not exist");
+		}
+	}
+	rank_nodes = nodes;
+}
+
+// Node of a process
+int NumaTopology::get_rank_node(const int rank, const int n_ranks) const
+{
+	if (rank < 0 || rank >= n_ranks){
+		throw std::invalid_argument("Rank " + std::to_string(rank) + " out of range");
+	}
+	if (rank_nodes.empty()){
+		return static_cast<long long>(rank)*get_number_of_nodes()/n_ranks;
+	}
+	if (rank_nodes.size() != n_ranks){
+		throw std::invalid_argument("Nodes were set for " + std::to_string(rank_nodes.size())
+						+ " processes, not " + std::to_string(n_ranks));
+	}
+	return rank_nodes.at(rank);
+}
+
+// Restrict the calling thread to the CPUs of a node
+bool NumaTopology::pin_to_node(const int node) const
+{
+#ifdef __linux__
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	for (const int cpu : get_cpus(node)){
+		if (cpu < CPU_SETSIZE){
+			CPU_SET(cpu, &cpu_set);
+		}
+	}
+	return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+#else
+	get_cpus(node);
+	return false;
+#endif
+}
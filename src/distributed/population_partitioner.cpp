@@ -0,0 +1,231 @@
+#include "../../include/distributed/population_partitioner.h"
+
+/*****************************************************
+ * class: PopulationPartitioner
+ *
+ * Divides agents of an ABM between processes
+ *
+ *****************************************************/
+
+// Creates a partition of the ABM population
+PopulationPartitioner::PopulationPartitioner(const ABM& abm, const int n_ranks) : n_procs(n_ranks)
+{
+	if (n_ranks < 1){
+		throw std::invalid_argument("Number of processes needs to be at least 1");
+	}
+
+	const std::vector<Agent>& agents = abm.get_vector_of_agents();
+	const std::vector<Household>& households = abm.get_vector_of_households();
+	const std::vector<RetirementHome>& retirement_homes = abm.get_vector_of_retirement_homes();
+
+	// Units that stay on one process - households,
+	// residents of each retirement home, and single
+	// non-COVID hospital patients
+	std::vector<std::vector<int>> units(households.size() + retirement_homes.size());
+	for (const auto& agent : agents){
+		if (agent.hospital_non_covid_patient()){
+			units.push_back({agent.get_ID()});
+		} else if (agent.retirement_home_resident()){
+			units.at(households.size() + agent.get_household_ID() - 1).push_back(agent.get_ID());
+		} else {
+			units.at(agent.get_household_ID() - 1).push_back(agent.get_ID());
+		}
+	}
+
+	// Order the units by the most common daytime place
+	// of their members; ties by the order of creation
+	std::vector<std::pair<std::pair<int, int>, int>> order;
+	for (int iu = 0; iu < units.size(); ++iu){
+		const std::vector<int>& unit = units.at(iu);
+		if (unit.empty()){
+			continue;
+		}
+		std::map<std::pair<int, int>, int> counts;
+		for (const auto& aID : unit){
+			++counts[daytime_place(agents.at(aID-1))];
+		}
+		std::pair<int, int> key = counts.begin()->first;
+		int max_count = 0;
+		for (const auto& cnt : counts){
+			if (cnt.second > max_count){
+				key = cnt.first;
+				max_count = cnt.second;
+			}
+		}
+		// Retirement home residents spend the day where they live
+		if (iu >= households.size() && iu < households.size() + retirement_homes.size()){
+			key = std::make_pair(static_cast<int>(retirement_home), static_cast<int>(iu - households.size() + 1));
+		}
+		order.push_back(std::make_pair(key, iu));
+	}
+	std::sort(order.begin(), order.end());
+
+	// Split into contiguous parts with similar number of agents
+	const double n_agents = static_cast<double>(agents.size());
+	agent_ranks.assign(agents.size(), 0);
+	int n_assigned = 0;
+	for (const auto& ou : order){
+		const std::vector<int>& unit = units.at(ou.second);
+		const int rank = std::min(n_procs - 1,
+						static_cast<int>(std::floor(n_assigned*n_procs/n_agents)));
+		for (const auto& aID : unit){
+			agent_ranks.at(aID-1) = rank;
+		}
+		n_assigned += unit.size();
+	}
+
+	// Owners of shared places
+	school_owners = find_owners(abm.get_vector_of_schools());
+	workplace_owners = find_owners(abm.get_vector_of_workplaces());
+	hospital_owners = find_owners(abm.get_vector_of_hospitals());
+	retirement_home_owners = find_owners(retirement_homes);
+
+	// Places with members on a single process
+	household_ranks = find_member_ranks(agents, household, std::vector<int>(households.size(), 0));
+	school_ranks = find_member_ranks(agents, school, school_owners);
+	workplace_ranks = find_member_ranks(agents, workplace, workplace_owners);
+	retirement_home_ranks = find_member_ranks(agents, retirement_home, retirement_home_owners);
+}
+
+//
+// Getters
+//
+
+// Flags of agents processed by a given process, in ID order
+std::vector<bool> PopulationPartitioner::get_local_agents(const int rank) const
+{
+	if (rank < 0 || rank >= n_procs){
+		throw std::invalid_argument("Rank " + std::to_string(rank) + " is not part of the partition");
+	}
+	std::vector<bool> local_flags(agent_ranks.size(), false);
+	for (int i = 0; i < agent_ranks.size(); ++i){
+		local_flags.at(i) = (agent_ranks.at(i) == rank);
+	}
+	return local_flags;
+}
+
+// Number of agents processed by each process
+std::vector<int> PopulationPartitioner::get_number_of_agents_per_rank() const
+{
+	std::vector<int> n_agents(n_procs, 0);
+	for (const auto& rank : agent_ranks){
+		++n_agents.at(rank);
+	}
+	return n_agents;
+}
+
+//
+// Private
+//
+
+// Place an agent attends during the day, household if none
+std::pair<int, int> PopulationPartitioner::daytime_place(const Agent& agent) const
+{
+	if (agent.hospital_employee() || agent.hospital_non_covid_patient()){
+		return std::make_pair(static_cast<int>(hospital), agent.get_hospital_ID());
+	}
+	if (agent.works()){
+		if (agent.retirement_home_employee()){
+			return std::make_pair(static_cast<int>(retirement_home), agent.get_work_ID());
+		} else if (agent.school_employee()){
+			return std::make_pair(static_cast<int>(school), agent.get_work_ID());
+		}
+		return std::make_pair(static_cast<int>(workplace), agent.get_work_ID());
+	}
+	if (agent.student()){
+		return std::make_pair(static_cast<int>(school), agent.get_school_ID());
+	}
+	return std::make_pair(static_cast<int>(household), agent.get_household_ID());
+}
+
+// Rank with most registered agents in a place
+template <typename T>
+std::vector<int> PopulationPartitioner::find_owners(const std::vector<T>& places) const
+{
+	std::vector<int> owners;
+	std::vector<int> n_members(n_procs, 0);
+	for (const auto& place : places){
+		std::fill(n_members.begin(), n_members.end(), 0);
+		for (const auto& aID : place.get_agent_IDs_ref()){
+			++n_members.at(agent_ranks.at(aID-1));
+		}
+		// Ties and empty places - lowest rank,
+		// empty places distributed evenly
+		int owner = (place.get_ID() - 1) % n_procs;
+		int max_members = 0;
+		for (int r = 0; r < n_procs; ++r){
+			if (n_members.at(r) > max_members){
+				owner = r;
+				max_members = n_members.at(r);
+			}
+		}
+		owners.push_back(owner);
+	}
+	return owners;
+}
+
+// Process of the agents that can be registered in each place
+std::vector<int> PopulationPartitioner::find_member_ranks(const std::vector<Agent>& agents, 
+									const place_type type, const std::vector<int>& owners) const
+{
+	// -2 until the first member is found, -1 once shared
+	std::vector<int> ranks(owners.size(), -2);
+	auto add_member = [&ranks](const int place_ID, const int rank)
+		{
+			if (place_ID < 1 || place_ID > ranks.size()){
+				return;
+			}
+			int& place_rank = ranks.at(place_ID-1);
+			if (place_rank == -2){
+				place_rank = rank;
+			} else if (place_rank != rank){
+				place_rank = -1;
+			}
+		};
+
+	for (const auto& agent : agents){
+		const int rank = agent_ranks.at(agent.get_ID()-1);
+		const bool works_in_school = agent.works() && !agent.retirement_home_employee() 
+										&& agent.school_employee();
+		const bool works_in_workplace = agent.works() && !agent.retirement_home_employee() 
+										&& !agent.school_employee();
+		switch (type){
+			case household:
+				if (!agent.retirement_home_resident()){
+					add_member(agent.get_household_ID(), rank);
+				}
+				break;
+			case retirement_home:
+				if (agent.retirement_home_resident()){
+					add_member(agent.get_household_ID(), rank);
+				}
+				if (agent.works() && agent.retirement_home_employee()){
+					add_member(agent.get_work_ID(), rank);
+				}
+				break;
+			case school:
+				if (agent.student()){
+					add_member(agent.get_school_ID(), rank);
+				}
+				if (works_in_school){
+					add_member(agent.get_work_ID(), rank);
+				}
+				break;
+			case workplace:
+				if (works_in_workplace){
+					add_member(agent.get_work_ID(), rank);
+				}
+				break;
+			case hospital:
+				throw std::invalid_argument("Hospitals are always shared between processes");
+		}
+	}
+
+	// Places without members are left to their owners
+	for (std::size_t ip = 0; ip < ranks.size(); ++ip){
+		if (ranks.at(ip) == -2){
+			ranks.at(ip) = owners.at(ip);
+		}
+	}
+	return ranks;
+}
@@ -0,0 +1,189 @@
+#include "../../include/ensemble/splitting_ensemble.h"
+
+/*****************************************************
+ * class: SplittingEnsemble
+ *
+ * Ensemble of weighted replicates that concentrates
+ * on rare outcomes by splitting and pruning
+ *
+ *****************************************************/
+
+// Creates an ensemble from a model
+SplittingEnsemble::SplittingEnsemble(const ABM& model, const int replicates, const int steps) 
+	: base(model), n_replicates(replicates), n_steps(steps)
+{
+	if (replicates < 1){
+		throw std::invalid_argument("Number of replicates needs to be at least 1");
+	}
+	if (steps < 1){
+		throw std::invalid_argument("Number of steps of an ensemble needs to be at least 1");
+	}
+}
+
+// Score and selection of the replicates
+void SplittingEnsemble::set_selection(const score_function& score_fun, const int steps_between, 
+										const double selection_strength)
+{
+	if (steps_between < 1){
+		throw std::invalid_argument("Number of steps between checkpoints needs to be at least 1");
+	}
+	if (selection_strength < 0.0){
+		throw std::invalid_argument("Selection strength cannot be negative");
+	}
+	score = score_fun;
+	interval = steps_between;
+	strength = selection_strength;
+}
+
+// Run all the replicates
+void SplittingEnsemble::run(const int n_threads)
+{
+	WorkStealingPool pool(n_threads);
+	std::mt19937 engine(ensemble_seed);
+	checkpoints.clear();
+
+	// Initial replicates with equal weights
+	replicates.assign(n_replicates, Replicate());
+	pool.run(n_replicates, [this](const int ir){
+			Replicate& rep = replicates.at(ir);
+			rep.abm = base;
+			rep.abm.set_random_seed(replicate_seed(0, ir));
+			rep.weight = 1.0/n_replicates;
+			rep.origin = ir;
+			if (score){
+				rep.max_score = score(rep.abm);
+			}
+		});
+
+	int step = 0;
+	while (step < n_steps){
+		// Run one segment
+		const int segment = score ? std::min(interval, n_steps - step) : n_steps;
+		std::vector<double> scores(n_replicates, 0.0);
+		pool.run(n_replicates, [&](const int ir){
+				Replicate& rep = replicates.at(ir);
+				for (int ti = 0; ti < segment; ++ti){
+					rep.abm.transmit_infection();
+				}
+				if (score){
+					scores.at(ir) = score(rep.abm);
+					rep.max_score = std::max(rep.max_score, scores.at(ir));
+				}
+			});
+		step += segment;
+
+		if (score && step < n_steps){
+			select(pool, engine, scores);
+			checkpoints.back().step = step;
+		}
+	}
+}
+
+// Replace the replicates with the selected ones
+void SplittingEnsemble::select(WorkStealingPool& pool, std::mt19937& engine, const std::vector<double>& scores)
+{
+	Checkpoint checkpoint;
+	checkpoint.max_score = *std::max_element(scores.begin(), scores.end());
+	double w_sum = 0.0, w_sq = 0.0;
+	for (const auto& rep : replicates){
+		w_sum += rep.weight;
+		w_sq += rep.weight*rep.weight;
+	}
+	checkpoint.ess = w_sum*w_sum/w_sq;
+
+	// Selection probabilities, relative to the highest score
+	// to avoid overflow
+	std::vector<double> probabilities(n_replicates);
+	for (int ir = 0; ir < n_replicates; ++ir){
+		probabilities.at(ir) = replicates.at(ir).weight*std::exp(strength*(scores.at(ir) - checkpoint.max_score));
+	}
+	const double p_sum = std::accumulate(probabilities.begin(), probabilities.end(), 0.0);
+	for (auto& p : probabilities){
+		p /= p_sum;
+	}
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+	const std::vector<int> n_copies = copies(probabilities, uniform(engine));
+
+	// Parent and new weight of each new replicate; the first
+	// copy of a parent keeps its state and seed
+	std::vector<int> parents, first_copies;
+	std::vector<double> weights;
+	for (int ir = 0; ir < n_replicates; ++ir){
+		if (n_copies.at(ir) == 0){
+			++checkpoint.n_removed;
+			continue;
+		}
+		checkpoint.n_split += n_copies.at(ir) - 1;
+		first_copies.push_back(parents.size());
+		for (int ic = 0; ic < n_copies.at(ir); ++ic){
+			parents.push_back(ir);
+			weights.push_back(replicates.at(ir).weight/(n_replicates*probabilities.at(ir)));
+		}
+	}
+	checkpoints.push_back(checkpoint);
+	const int checkpoint_number = checkpoints.size();
+
+	// Clones are copied in parallel before the parents are moved
+	std::vector<Replicate> selected(n_replicates);
+	std::vector<char> is_first(n_replicates, 0);
+	for (const auto& ip : first_copies){
+		is_first.at(ip) = 1;
+	}
+	pool.run(n_replicates, [&](const int ip){
+			if (is_first.at(ip)){
+				return;
+			}
+			selected.at(ip) = replicates.at(parents.at(ip));
+			selected.at(ip).abm.set_random_seed(replicate_seed(checkpoint_number, ip));
+		});
+	for (const auto& ip : first_copies){
+		selected.at(ip) = std::move(replicates.at(parents.at(ip)));
+	}
+	for (int ip = 0; ip < n_replicates; ++ip){
+		selected.at(ip).weight = weights.at(ip);
+	}
+	replicates.swap(selected);
+}
+
+// Number of copies of each replicate from systematic resampling
+std::vector<int> SplittingEnsemble::copies(const std::vector<double>& probabilities, const double u) const
+{
+	std::vector<int> n_copies(probabilities.size(), 0);
+	double cumulative = 0.0;
+	int next = 0;
+	for (int ir = 0; ir < probabilities.size(); ++ir){
+		cumulative += probabilities.at(ir)*n_replicates;
+		while (next < n_replicates && next + u < cumulative){
+			++n_copies.at(ir);
+			++next;
+		}
+	}
+	// Rounding in the last cumulative sum
+	n_copies.at(std::max_element(probabilities.begin(), probabilities.end()) - probabilities.begin()) += n_replicates - next;
+	return n_copies;
+}
+
+// Weighted sum of a quantity over the final replicates
+double SplittingEnsemble::estimate(const std::function<double(const Replicate&)>& quantity) const
+{
+	double sum = 0.0;
+	for (const auto& rep : replicates){
+		sum += rep.weight*quantity(rep);
+	}
+	return sum;
+}
+
+// Estimated probability that the score reached the threshold
+double SplittingEnsemble::exceedance_probability(const double threshold) const
+{
+	return estimate([threshold](const Replicate& rep){ return (rep.max_score >= threshold) ? 1.0 : 0.0; });
+}
+
+// Seed of a replicate started or cloned at a checkpoint
+unsigned SplittingEnsemble::replicate_seed(const int checkpoint, const int replicate) const
+{
+	std::seed_seq seq{ensemble_seed, static_cast<unsigned>(checkpoint), static_cast<unsigned>(replicate)};
+	std::vector<unsigned> seed(1);
+	seq.generate(seed.begin(), seed.end());
+	return seed.at(0);
+}
@@ -11,19 +11,15 @@
 // Remove a susceptible agent 
 void Flu::remove_susceptible_agent(const int index)
 {
-	std::vector<int> new_agent_IDs = {};
-	std::remove_copy(susceptible_agent_IDs.begin(), susceptible_agent_IDs.end(),
-					std::back_insert_iterator<std::vector<int>>(new_agent_IDs), index);
-	std::swap(new_agent_IDs, susceptible_agent_IDs);	
+	// In place, keeps the order of the remaining agents
+	susceptible_agent_IDs.erase(std::remove(susceptible_agent_IDs.begin(), susceptible_agent_IDs.end(), index), susceptible_agent_IDs.end());
 }
 
 // Remove a flu agent 
 void Flu::remove_flu_agent(const int index)
 {
-	std::vector<int> new_agent_IDs = {};
-	std::remove_copy(flu_agent_IDs.begin(), flu_agent_IDs.end(),
-					std::back_insert_iterator<std::vector<int>>(new_agent_IDs), index);
-	std::swap(new_agent_IDs, flu_agent_IDs);	
+	// In place, keeps the order of the remaining agents
+	flu_agent_IDs.erase(std::remove(flu_agent_IDs.begin(), flu_agent_IDs.end(), index), flu_agent_IDs.end());
 }
 
 // Remove recovered from flu, add new chosen randomly
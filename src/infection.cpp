@@ -27,6 +27,82 @@ void Infection::print_basic(std::ostream& where) const
 // Infection transmission
 //
 
+// Sample members of a place exposed to its infection contribution 
+void Infection::sample_place_exposures(const double lambda, const int n_members, std::vector<int>& exposed)
+{
+	exposed.clear();
+	if (lambda <= 0.0 || n_members <= 0){
+		return;
+	}
+	// Logarithm of the probability of not being exposed
+	const double log_not_exposed = -dt*lambda;
+	// Number of members skipped before the next exposed 
+	// is geometrically distributed
+	double pos = -1.0;
+	while (true){
+		pos += 1.0 + std::floor(std::log(1.0 - rng.get_random(0.0, 1.0))/log_not_exposed);
+		if (pos >= static_cast<double>(n_members)){
+			break;
+		}
+		exposed.push_back(static_cast<int>(pos));
+	}
+}
+
+// Confirm an exposure when only part of the contribution applies
+bool Infection::confirm_exposure(const double lambda, const double fraction)
+{
+	if (fraction >= 1.0){
+		return true;
+	}
+	// Ratio of infection probabilities with reduced and full lambda
+	const double prob = std::expm1(-dt*lambda*fraction)/std::expm1(-dt*lambda);
+	return rng.get_random(0.0, 1.0) < prob;
+}
+
+// Time until the next exposure in continuous time
+double Infection::time_to_exposure(const double total_rate)
+{
+	if (total_rate <= 0.0){
+		return std::numeric_limits<double>::infinity();
+	}
+	return -std::log(1.0 - rng.get_random(0.0, 1.0))/total_rate;
+}
+
+// Select an entry with probability proportional to its rate
+int Infection::select_by_rate(const std::vector<double>& rates, const double total_rate)
+{
+	if (rates.empty()){
+		throw std::invalid_argument("No rates to select from");
+	}
+	const double target = rng.get_random(0.0, 1.0)*total_rate;
+	double cumulative = 0.0;
+	int last_positive = -1;
+	for (int i = 0; i < rates.size(); ++i){
+		if (rates.at(i) <= 0.0){
+			continue;
+		}
+		cumulative += rates.at(i);
+		last_positive = i;
+		if (target < cumulative){
+			return i;
+		}
+	}
+	// Round-off in the total
+	if (last_positive < 0){
+		throw std::invalid_argument("No positive rates to select from");
+	}
+	return last_positive;
+}
+
+// Accept an exposure when only part of the rate applies
+bool Infection::accept_exposure(const double fraction)
+{
+	if (fraction >= 1.0){
+		return true;
+	}
+	return rng.get_random(0.0, 1.0) < fraction;
+}
+
 // Get latency period from a distribution
 double Infection::latency()
 {
@@ -309,6 +385,33 @@ bool Infection::infected(const double lambda)
 		return false; 
 }
 
+// Compute which agents in a batch got infected
+void Infection::infected_batch(const std::vector<double>& lambdas, std::vector<int>& infected_indices)
+{
+	const std::size_t n_batch = lambdas.size();
+	infected_indices.clear();
+	batch_uniforms.resize(n_batch);
+	batch_probs.resize(n_batch);
+	rng.fill_random(batch_uniforms, 0.0, 1.0);
+
+	// Probabilities of infection - no branches or library
+	// calls so that this loop can be vectorized
+	const double* lambda = lambdas.data();
+	double* prob = batch_probs.data();
+	for (std::size_t i = 0; i < n_batch; ++i){
+		prob[i] = 1.0 - exp_non_positive(-dt*lambda[i]);
+	}
+
+	// Collect the infected; probability is 1.0 in double 
+	// precision outside of the valid exponential range
+	const double* rnd = batch_uniforms.data();
+	for (std::size_t i = 0; i < n_batch; ++i){
+		if (rnd[i] <= prob[i] || dt*lambda[i] > 708.0){
+			infected_indices.push_back(static_cast<int>(i));
+		}
+	}
+}
+
 //
 // Supporting functions
 //
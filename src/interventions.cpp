@@ -0,0 +1,103 @@
+#include "../include/interventions.h"
+
+/*****************************************************
+ * class: Interventions
+ *
+ * Timeline of interventions sorted by time
+ *
+ *****************************************************/
+
+// Add an intervention to the timeline
+void Interventions::add(const Intervention& intervention)
+{
+	// After all the interventions with the same time
+	auto pos = std::upper_bound(events.begin() + next_event, events.end(), intervention,
+					[](const Intervention& a, const Intervention& b){ return a.time < b.time; });
+	events.insert(pos, intervention);
+}
+
+// Add interventions from a file
+void Interventions::load(const std::string& fname)
+{
+	std::ifstream input(fname);
+	if (!input.is_open()){
+		throw std::runtime_error("Error opening the file with interventions: " + fname);
+	}
+
+	const std::map<std::string, target_type> targets = {{"households", households},
+		{"schools", schools}, {"workplaces", workplaces}, {"population", population}};
+	const std::map<std::string, action_type> actions = {{"transmission", transmission},
+		{"employee_transmission", employee_transmission}, {"absenteeism", absenteeism},
+		{"closure", closure}, {"vaccination", vaccination}};
+
+	std::string line;
+	while (std::getline(input, line)){
+		std::istringstream entry(line);
+		std::string time_str, target_str, action_str;
+		if (!(entry >> time_str) || time_str.compare(0, 2, "//") == 0){
+			continue;
+		}
+		Intervention intervention;
+		double value = 0.0;
+		if (!(entry >> target_str >> action_str >> value)){
+			throw std::invalid_argument("Wrong format of intervention: " + line);
+		}
+		intervention.time = std::stod(time_str);
+		intervention.value = value;
+		if (targets.count(target_str) == 0){
+			throw std::invalid_argument("Wrong intervention target: " + target_str);
+		}
+		if (actions.count(action_str) == 0){
+			throw std::invalid_argument("Wrong intervention action: " + action_str);
+		}
+		intervention.target = targets.at(target_str);
+		intervention.action = actions.at(action_str);
+
+		// Optional range of place IDs
+		int first_ID = 0, last_ID = 0;
+		if (entry >> first_ID){
+			if (!(entry >> last_ID) || first_ID < 1 || last_ID < first_ID){
+				throw std::invalid_argument("Wrong range of places in intervention: " + line);
+			}
+			intervention.first = first_ID - 1;
+			intervention.last = last_ID;
+		}
+
+		// Valid combinations
+		const target_type target = intervention.target;
+		const action_type action = intervention.action;
+		if ((action == vaccination) != (target == population)
+				|| (action == employee_transmission && target != schools)
+				|| (action == absenteeism && target != workplaces)){
+			throw std::invalid_argument("Action " + action_str + " does not apply to " + target_str);
+		}
+		if (value < 0.0 || (action == vaccination && value != std::floor(value))){
+			throw std::invalid_argument("Wrong value of intervention: " + line);
+		}
+		if (target == population && intervention.last > 0){
+			throw std::invalid_argument("Range of places given for the population: " + line);
+		}
+		add(intervention);
+	}
+}
+
+// Next intervention due at this time
+bool Interventions::next_due(const double time, Intervention& intervention)
+{
+	const double tol = 1e-3;
+	while (next_event < events.size()){
+		const Intervention& next = events.at(next_event);
+		if (event_at_time(next.time, time, tol)){
+			intervention = next;
+			++next_event;
+			return true;
+		}
+		// Not at any step
+		if (next.time < time){
+			++next_event;
+			continue;
+		}
+		break;
+	}
+	return false;
+}
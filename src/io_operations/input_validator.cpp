@@ -0,0 +1,254 @@
+#include "../../include/io_operations/input_validator.h"
+#include <cmath>
+#include <sstream>
+
+/*****************************************************
+ * Input validation
+ *
+ * Consistency checks of a population
+ *
+ *****************************************************/
+
+namespace {
+	typedef PopulationSegment PS;
+
+	const char* place_names[] = {"households", "retirement homes", "schools", "workplaces", "hospitals"};
+
+	// Names of the flag columns, in the order of the checks
+	const PS::agent_column flag_columns[] = {PS::student, PS::works, PS::non_covid_patient,
+		PS::retirement_home_resident, PS::retirement_home_employee, PS::school_employee,
+		PS::hospital_employee, PS::infected};
+	const char* flag_names[] = {"student", "works", "non-COVID patient",
+		"retirement home resident", "retirement home employee", "school employee",
+		"hospital employee", "infected"};
+}
+
+//
+// InputReport
+//
+
+// Number of inconsistencies of one category
+int InputReport::count(const check_type check) const
+{
+	return std::count_if(errors.begin(), errors.end(),
+		[check](const Error& error){ return error.check == check; });
+}
+
+// Readable summary
+std::string InputReport::summary(const int max_errors) const
+{
+	std::ostringstream out;
+	if (passed()){
+		out << "Input consistent\n";
+		return out.str();
+	}
+	out << "Inconsistent input, " << errors.size() << " errors\n";
+	for (int ic = 0; ic < n_checks; ++ic){
+		const int n = count(static_cast<check_type>(ic));
+		if (n > 0){
+			out << "\t" << check_name(static_cast<check_type>(ic)) << ": " << n << "\n";
+		}
+	}
+	for (int ie = 0; ie < errors.size() && ie < max_errors; ++ie){
+		const Error& error = errors.at(ie);
+		out << error.input << " " << error.ID << ": " << error.message << "\n";
+	}
+	if (errors.size() > max_errors){
+		out << "...\n";
+	}
+	return out.str();
+}
+
+// Name of a category
+std::string InputReport::check_name(const check_type check)
+{
+	switch (check){
+		case value_range: return "value range";
+		case place_reference: return "place reference";
+		case role_flags: return "role flags";
+		case coordinates: return "coordinates";
+		default: throw std::invalid_argument("Wrong type of check");
+	}
+}
+
+//
+// InputValidator
+//
+
+// Number of agents checked by one task
+void InputValidator::set_chunk_size(const int n)
+{
+	if (n < 1){
+		throw std::invalid_argument("Chunk size needs to be at least 1");
+	}
+	chunk_size = n;
+}
+
+// Limits of the coordinates
+void InputValidator::set_bounds(const double xmin, const double xmax, const double ymin, const double ymax)
+{
+	if (xmin > xmax || ymin > ymax){
+		throw std::invalid_argument("Lower bound of the coordinates above the upper bound");
+	}
+	with_bounds = true;
+	x_min = xmin;
+	x_max = xmax;
+	y_min = ymin;
+	y_max = ymax;
+}
+
+// Places of one type
+void InputValidator::set_places(const PS::place_type type, const std::vector<int>& IDs,
+								const std::vector<double>& x, const std::vector<double>& y)
+{
+	if (x.size() != IDs.size() || y.size() != IDs.size()){
+		throw std::invalid_argument("Different number of place IDs and coordinates");
+	}
+	place_IDs.at(type) = IDs;
+	place_x.at(type) = x;
+	place_y.at(type) = y;
+}
+
+// Check the agents and all the places
+InputReport InputValidator::validate(const int n_agents, const std::int32_t* values,
+										const double* x, const double* y) const
+{
+	InputReport report;
+	for (int it = PS::households; it <= PS::hospitals; ++it){
+		check_places(static_cast<PS::place_type>(it), report);
+	}
+
+	// Each chunk has its own report, merged in order
+	const int n_chunks = (n_agents + chunk_size - 1)/chunk_size;
+	std::vector<InputReport> chunks(n_chunks);
+	const std::function<void(int)> task = [&](int ic){
+			check_agents(ic*chunk_size, std::min(n_agents, (ic + 1)*chunk_size), n_agents,
+							values, x, y, chunks.at(ic));
+		};
+	if (run_tasks){
+		run_tasks(n_chunks, task);
+	} else {
+		for (int ic = 0; ic < n_chunks; ++ic){
+			task(ic);
+		}
+	}
+	for (const auto& chunk : chunks){
+		report.errors.insert(report.errors.end(), chunk.errors.begin(), chunk.errors.end());
+		report.n_students += chunk.n_students;
+		report.n_workers += chunk.n_workers;
+		report.n_infected += chunk.n_infected;
+	}
+	return report;
+}
+
+// Checks of the places of one type
+void InputValidator::check_places(const PS::place_type type, InputReport& report) const
+{
+	const std::vector<int>& IDs = place_IDs.at(type);
+	for (int i = 0; i < IDs.size(); ++i){
+		if (IDs.at(i) != i + 1){
+			report.errors.push_back({InputReport::place_reference, place_names[type], i + 1,
+				"ID " + std::to_string(IDs.at(i)) + " out of order, IDs need to be continuous from 1"});
+		}
+		if (!valid_location(place_x.at(type).at(i), place_y.at(type).at(i))){
+			report.errors.push_back({InputReport::coordinates, place_names[type], i + 1,
+				"coordinates not finite or outside of the bounds"});
+		}
+	}
+}
+
+// Checks of the agents with IDs first+1 to last
+void InputValidator::check_agents(const int first, const int last, const int n_agents,
+									const std::int32_t* values, const double* x, const double* y,
+									InputReport& report) const
+{
+	auto value = [values, n_agents](const PS::agent_column col, const int i)
+		{ return values[static_cast<std::size_t>(col)*n_agents + i]; };
+	auto add_error = [&report](const InputReport::check_type check, const int i, const std::string& message)
+		{ report.errors.push_back({check, "agents", i + 1, message}); };
+	// Place ID needs to be within the number of places
+	auto check_reference = [&](const PS::agent_column col, const PS::place_type type, const int i)
+		{
+			const int ID = value(col, i);
+			const int n_places = place_IDs.at(type).size();
+			if (ID < 1 || ID > n_places){
+				add_error(InputReport::place_reference, i, "ID " + std::to_string(ID) + " of "
+					+ place_names[type] + " not in the range 1 to " + std::to_string(n_places));
+			}
+		};
+
+	for (int i = first; i < last; ++i){
+		// Flags and age
+		for (int jf = 0; jf < sizeof(flag_columns)/sizeof(flag_columns[0]); ++jf){
+			const int flag = value(flag_columns[jf], i);
+			if (flag != 0 && flag != 1){
+				add_error(InputReport::value_range, i, std::string(flag_names[jf])
+					+ " flag " + std::to_string(flag) + " not 0 or 1");
+			}
+		}
+		if (value(PS::age, i) < 0){
+			add_error(InputReport::value_range, i, "negative age " + std::to_string(value(PS::age, i)));
+		}
+
+		// Roles as interpreted by the model
+		const bool patient = (value(PS::non_covid_patient, i) == 1);
+		const bool hospital_staff = (value(PS::hospital_employee, i) == 1) && !patient;
+		const bool student = (value(PS::student, i) == 1) && !patient;
+		const bool works = (value(PS::works, i) == 1) && !(patient || hospital_staff);
+		report.n_students += (value(PS::student, i) == 1);
+		report.n_workers += (value(PS::works, i) == 1);
+		report.n_infected += (value(PS::infected, i) == 1);
+
+		// Places
+		if (!patient){
+			check_reference(PS::household_ID, (value(PS::retirement_home_resident, i) == 1) ?
+								PS::retirement_homes : PS::households, i);
+		}
+		if (student){
+			check_reference(PS::school_ID, PS::schools, i);
+		}
+		if (works){
+			if (value(PS::retirement_home_employee, i) == 1){
+				check_reference(PS::work_ID, PS::retirement_homes, i);
+			} else if (value(PS::school_employee, i) == 1){
+				check_reference(PS::work_ID, PS::schools, i);
+			} else {
+				check_reference(PS::work_ID, PS::workplaces, i);
+			}
+		}
+		if (hospital_staff || patient){
+			check_reference(PS::hospital_ID, PS::hospitals, i);
+		}
+
+		// Role flags
+		if (value(PS::student, i) == 0 && value(PS::school_ID, i) != 0){
+			add_error(InputReport::role_flags, i, "school ID set but not a student");
+		}
+		if (value(PS::works, i) == 0 && value(PS::work_ID, i) != 0){
+			add_error(InputReport::role_flags, i, "work ID set but does not work");
+		}
+		if (value(PS::hospital_employee, i) == 0 && !patient && value(PS::hospital_ID, i) != 0){
+			add_error(InputReport::role_flags, i, "hospital ID set but neither a hospital employee nor a patient");
+		}
+		if ((value(PS::retirement_home_employee, i) == 1 || value(PS::school_employee, i) == 1)
+				&& value(PS::works, i) == 0){
+			add_error(InputReport::role_flags, i, "retirement home or school employee but does not work");
+		}
+		if (value(PS::retirement_home_employee, i) == 1 && value(PS::school_employee, i) == 1){
+			add_error(InputReport::role_flags, i, "both retirement home and school employee");
+		}
+
+		if (!valid_location(x[i], y[i])){
+			add_error(InputReport::coordinates, i, "coordinates not finite or outside of the bounds");
+		}
+	}
+}
+
+// True if coordinates are finite and within the bounds
+bool InputValidator::valid_location(const double x, const double y) const
+{
+	if (!std::isfinite(x) || !std::isfinite(y)){
+		return false;
+	}
+	return !with_bounds || (x >= x_min && x <= x_max && y >= y_min && y <= y_max);
+}
@@ -0,0 +1,237 @@
+#include "../../include/io_operations/state_snapshots.h"
+#include "../../include/abm.h"
+
+/*****************************************************
+ * State snapshots
+ *
+ * Stream of the states of all agents at every
+ * recorded step
+ *
+ *****************************************************/
+
+namespace {
+	const char snapshot_magic[] = "ABMSNAP1";
+	enum frame_type { keyframe_frame, changes_frame };
+
+	void write_int(std::ofstream& out, const std::uint32_t value)
+	{
+		out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	std::uint32_t read_int(std::ifstream& in)
+	{
+		std::uint32_t value = 0;
+		in.read(reinterpret_cast<char*>(&value), sizeof(value));
+		return value;
+	}
+}
+
+// Packed state flags of an agent
+std::uint32_t StateSnapshots::pack(const Agent& agent)
+{
+	// Same order as state_flag
+	const bool flags[] = {agent.infected(), agent.exposed(), agent.recovering_exposed(),
+		agent.symptomatic(), agent.symptomatic_non_covid(), agent.tested_covid_negative(),
+		agent.tested_false_negative(), agent.tested_false_positive(), agent.tested_covid_positive(),
+		agent.tested(), agent.tested_exposed(), agent.tested_in_car(), agent.tested_in_hospital(),
+		agent.tested_awaiting_results(), agent.tested_awaiting_test(), agent.being_treated(),
+		agent.home_isolated(), agent.hospitalized(), agent.hospitalized_ICU(),
+		agent.get_will_be_hospitalized(), agent.get_will_be_hospitalized_ICU(),
+		agent.get_will_be_home_isolated(), agent.dying(), agent.recovering(),
+		agent.removed(), agent.vaccinated()};
+	std::uint32_t state = 0;
+	for (int i = 0; i < n_flags; ++i){
+		state |= static_cast<std::uint32_t>(flags[i]) << i;
+	}
+	return state;
+}
+
+//
+// SnapshotWriter
+//
+
+// Creates a stream in a new file
+SnapshotWriter::SnapshotWriter(const std::string& fname, const int keyframe_interval) :
+	out(fname, std::ios::binary), interval(keyframe_interval)
+{
+	if (!out.is_open()){
+		throw std::runtime_error("Error opening the file with snapshots: " + fname);
+	}
+	if (interval < 1){
+		throw std::invalid_argument("Interval between keyframes needs to be at least 1");
+	}
+}
+
+// Record the states of the agents at a step
+void SnapshotWriter::record(const int step, const std::vector<Agent>& agents)
+{
+	record_states(step, agents, [](const Agent& agent){ return agent.get_ID(); });
+}
+
+// Record the states of the agents of a model at a step
+void SnapshotWriter::record(const int step, const ABM& abm)
+{
+	record_states(step, abm.get_vector_of_agents(),
+		[&abm](const Agent& agent){ return abm.get_external_agent_ID(agent.get_ID()); });
+}
+
+// Record the agents, external_ID gives the ID written for each
+template <typename F>
+void SnapshotWriter::record_states(const int step, const std::vector<Agent>& agents, F external_ID)
+{
+	if (step <= last_step){
+		throw std::invalid_argument("Snapshot step needs to be after the previous one");
+	}
+	if (last_step >= 0 && agents.size() != previous.size()){
+		throw std::invalid_argument("Number of agents changed between snapshots");
+	}
+
+	// Header with the first snapshot
+	if (last_step < 0){
+		out.write(snapshot_magic, sizeof(snapshot_magic) - 1);
+		write_int(out, agents.size());
+		write_int(out, StateSnapshots::n_flags);
+		previous.resize(agents.size());
+		changes.reserve(2*agents.size());
+	}
+
+	const bool is_keyframe = (last_step < 0 || since_keyframe == interval);
+	changes.clear();
+	// States are kept in order of the written IDs
+	for (const auto& agent : agents){
+		const std::uint32_t state = StateSnapshots::pack(agent);
+		const int ID = external_ID(agent);
+		if (!is_keyframe && state != previous.at(ID-1)){
+			changes.push_back(ID);
+			changes.push_back(state);
+		}
+		previous.at(ID-1) = state;
+	}
+
+	write_int(out, step);
+	if (is_keyframe){
+		write_int(out, keyframe_frame);
+		write_int(out, previous.size());
+		out.write(reinterpret_cast<const char*>(previous.data()), previous.size()*sizeof(std::uint32_t));
+		n_entries += previous.size();
+		since_keyframe = 1;
+	} else {
+		write_int(out, changes_frame);
+		write_int(out, changes.size()/2);
+		out.write(reinterpret_cast<const char*>(changes.data()), changes.size()*sizeof(std::uint32_t));
+		n_entries += changes.size()/2;
+		++since_keyframe;
+	}
+	if (!out){
+		throw std::runtime_error("Error writing a snapshot");
+	}
+	last_step = step;
+}
+
+//
+// SnapshotReader
+//
+
+// Opens and indexes a stream
+SnapshotReader::SnapshotReader(const std::string& fname) : in(fname, std::ios::binary)
+{
+	if (!in.is_open()){
+		throw std::runtime_error("Error opening the file with snapshots: " + fname);
+	}
+	std::string magic(sizeof(snapshot_magic) - 1, ' ');
+	in.read(&magic[0], magic.size());
+	n_agents = read_int(in);
+	const std::uint32_t n_flags = read_int(in);
+	if (!in || magic != snapshot_magic || n_agents < 0 || n_flags != StateSnapshots::n_flags){
+		throw std::runtime_error("Not a snapshot stream: " + fname);
+	}
+
+	// Index of the frames
+	const std::streamoff data_start = in.tellg();
+	in.seekg(0, std::ios::end);
+	const std::streamoff file_size = in.tellg();
+	in.seekg(data_start);
+	while (true){
+		const std::streamoff offset = in.tellg();
+		const int step = read_int(in);
+		const std::uint32_t type = read_int(in);
+		const std::uint32_t count = read_int(in);
+		if (in.eof()){
+			break;
+		}
+		const std::streamoff frame_size = count*((type == keyframe_frame) ? 1 : 2)*sizeof(std::uint32_t);
+		if (!in || type > changes_frame || (type == keyframe_frame && count != n_agents)
+				|| (steps.empty() && type != keyframe_frame) || (!steps.empty() && step <= steps.back())
+				|| in.tellg() + frame_size > file_size){
+			throw std::runtime_error("Not a snapshot stream or incomplete: " + fname);
+		}
+		if (type == keyframe_frame){
+			keyframes.push_back(steps.size());
+		} else {
+			keyframes.push_back(keyframes.back());
+		}
+		steps.push_back(step);
+		offsets.push_back(offset);
+		in.seekg(frame_size, std::ios::cur);
+	}
+	in.clear();
+}
+
+// Packed states of all agents at a step
+std::vector<std::uint32_t> SnapshotReader::states_at(const int step)
+{
+	const int is = find_step(step);
+	std::vector<std::uint32_t> states(n_agents, 0);
+	for (int js = keyframes.at(is); js <= is; ++js){
+		read_frame(js, states);
+	}
+	return states;
+}
+
+// Agents whose state changed at a step
+std::vector<std::pair<int, std::uint32_t>> SnapshotReader::changes_at(const int step)
+{
+	const int is = find_step(step);
+	std::vector<std::pair<int, std::uint32_t>> changed;
+	if (is == 0){
+		return changed;
+	}
+	const std::vector<std::uint32_t> before = states_at(steps.at(is-1));
+	const std::vector<std::uint32_t> after = states_at(step);
+	for (int i = 0; i < n_agents; ++i){
+		if (after.at(i) != before.at(i)){
+			changed.push_back(std::make_pair(i + 1, after.at(i)));
+		}
+	}
+	return changed;
+}
+
+// Position in steps
+int SnapshotReader::find_step(const int step) const
+{
+	const auto pos = std::lower_bound(steps.begin(), steps.end(), step);
+	if (pos == steps.end() || *pos != step){
+		throw std::invalid_argument("Step " + std::to_string(step) + " was not recorded");
+	}
+	return pos - steps.begin();
+}
+
+// Apply one frame to the states
+void SnapshotReader::read_frame(const int is, std::vector<std::uint32_t>& states)
+{
+	in.seekg(offsets.at(is) + sizeof(std::uint32_t));
+	const std::uint32_t type = read_int(in);
+	const std::uint32_t count = read_int(in);
+	if (type == keyframe_frame){
+		in.read(reinterpret_cast<char*>(states.data()), count*sizeof(std::uint32_t));
+	} else {
+		std::vector<std::uint32_t> entries(2*count);
+		in.read(reinterpret_cast<char*>(entries.data()), entries.size()*sizeof(std::uint32_t));
+		for (std::size_t i = 0; i < count; ++i){
+			states.at(entries.at(2*i) - 1) = entries.at(2*i + 1);
+		}
+	}
+	if (!in){
+		throw std::runtime_error("Error reading a snapshot");
+	}
+}
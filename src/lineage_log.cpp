@@ -0,0 +1,202 @@
+#include "../include/lineage_log.h"
+
+/*****************************************************
+ * class: LineageLog
+ *
+ * Record of where each infection happened
+ *
+ *****************************************************/
+
+namespace {
+	const char lineage_magic[] = "ABMLINE1";
+
+	void write_int(std::ofstream& out, const std::int32_t value)
+	{
+		out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	std::int32_t read_int(std::ifstream& in)
+	{
+		std::int32_t value = 0;
+		in.read(reinterpret_cast<char*>(&value), sizeof(value));
+		return value;
+	}
+}
+
+// Read a log saved with print_binary
+LineageLog LineageLog::read_binary(const std::string& fname)
+{
+	std::ifstream in(fname, std::ios::binary);
+	if (!in.is_open()){
+		throw std::runtime_error("Error opening the lineage file: " + fname);
+	}
+	std::string magic(sizeof(lineage_magic) - 1, ' ');
+	in.read(&magic[0], magic.size());
+	const std::int32_t n = read_int(in);
+	if (!in || magic != lineage_magic || n < 0){
+		throw std::runtime_error("Not a lineage file: " + fname);
+	}
+	// All the records need to be in the file
+	const std::streampos start = in.tellg();
+	in.seekg(0, std::ios::end);
+	if (in.tellg() - start < static_cast<std::streamoff>(n)*4*sizeof(std::int32_t)){
+		throw std::runtime_error("Lineage file incomplete: " + fname);
+	}
+	in.seekg(start);
+
+	LineageLog log;
+	log.records.resize(n);
+	for (auto& rec : log.records){
+		rec.step = read_int(in);
+		rec.agent_ID = read_int(in);
+		rec.setting = read_int(in);
+		rec.place_ID = read_int(in);
+		if (rec.setting < 0 || rec.setting >= n_settings){
+			throw std::runtime_error("Not a lineage file: " + fname);
+		}
+	}
+	if (!in){
+		throw std::runtime_error("Lineage file incomplete: " + fname);
+	}
+	return log;
+}
+
+// Merge logs
+LineageLog LineageLog::merge(const std::vector<const LineageLog*>& logs)
+{
+	LineageLog merged;
+	std::size_t n_total = 0;
+	for (const auto log : logs){
+		n_total += log->size();
+	}
+	merged.reserve(n_total);
+	for (const auto log : logs){
+		merged.records.insert(merged.records.end(), log->records.begin(), log->records.end());
+	}
+	std::stable_sort(merged.records.begin(), merged.records.end(),
+		[](const Record& a, const Record& b){ return a.step < b.step; });
+	return merged;
+}
+
+// Record an infection attributed to one of its sources
+void LineageLog::record(const int step, const int agent_ID, const Source* sources, const int n_sources)
+{
+	double lambda_tot = 0.0;
+	for (int is = 0; is < n_sources; ++is){
+		lambda_tot += sources[is].lambda;
+	}
+	if (lambda_tot <= 0.0){
+		records.push_back({step, agent_ID, unknown, 0});
+		return;
+	}
+
+	// Last source with a positive lambda if round-off leaves the target above the sum
+	const double target = rng.get_random(0.0, lambda_tot);
+	double cumulative = 0.0;
+	int chosen = -1;
+	for (int is = 0; is < n_sources; ++is){
+		if (sources[is].lambda <= 0.0){
+			continue;
+		}
+		chosen = is;
+		cumulative += sources[is].lambda;
+		if (target < cumulative){
+			break;
+		}
+	}
+	records.push_back({step, agent_ID, sources[chosen].setting, sources[chosen].place_ID});
+}
+
+// Number of infections in each setting
+std::vector<int> LineageLog::infections_by_setting() const
+{
+	std::vector<int> counts(n_settings, 0);
+	for (const auto& rec : records){
+		++counts.at(rec.setting);
+	}
+	return counts;
+}
+
+// Reproduction number split by setting
+std::vector<double> LineageLog::reproduction_by_setting(const int n_infectious) const
+{
+	if (n_infectious <= 0){
+		throw std::invalid_argument("Number of potential sources needs to be positive");
+	}
+	std::vector<double> reproduction(n_settings, 0.0);
+	const std::vector<int> counts = infections_by_setting();
+	for (int is = 0; is < n_settings; ++is){
+		reproduction.at(is) = static_cast<double>(counts.at(is))/n_infectious;
+	}
+	return reproduction;
+}
+
+// Secondary attack rate in households by household size
+std::map<int, double> LineageLog::household_attack_rates(const std::vector<int>& household_sizes,
+						const std::vector<int>& agent_households,
+						const std::vector<int>& infected_households) const
+{
+	// Households with an infected member and infections in each
+	std::vector<bool> affected(household_sizes.size(), false);
+	std::vector<int> secondary(household_sizes.size(), 0);
+	for (const int hID : infected_households){
+		affected.at(hID - 1) = true;
+	}
+	for (const auto& rec : records){
+		const int hID = agent_households.at(rec.agent_ID - 1);
+		if (hID > 0){
+			affected.at(hID - 1) = true;
+		}
+		if (rec.setting == households){
+			affected.at(rec.place_ID - 1) = true;
+			++secondary.at(rec.place_ID - 1);
+		}
+	}
+
+	// Infected over contacts, by size
+	std::map<int, std::pair<int, int>> by_size;
+	for (std::size_t ih = 0; ih < household_sizes.size(); ++ih){
+		const int size = household_sizes.at(ih);
+		if (affected.at(ih) && size > 1){
+			by_size[size].first += secondary.at(ih);
+			by_size[size].second += size - 1;
+		}
+	}
+	std::map<int, double> rates;
+	for (const auto& entry : by_size){
+		rates[entry.first] = static_cast<double>(entry.second.first)/entry.second.second;
+	}
+	return rates;
+}
+
+// Name of a setting
+std::string LineageLog::setting_name(const setting_type setting)
+{
+	switch (setting){
+		case households: return "households";
+		case retirement_homes: return "retirement homes";
+		case schools: return "schools";
+		case workplaces: return "workplaces";
+		case hospitals: return "hospitals";
+		case spatial: return "spatial";
+		case unknown: return "unknown";
+		default: throw std::invalid_argument("Wrong setting");
+	}
+}
+
+// Save in the binary format
+void LineageLog::print_binary(const std::string& fname) const
+{
+	std::ofstream out(fname, std::ios::binary);
+	if (!out.is_open()){
+		throw std::runtime_error("Error opening the lineage file: " + fname);
+	}
+	out.write(lineage_magic, sizeof(lineage_magic) - 1);
+	write_int(out, records.size());
+	for (const auto& rec : records){
+		write_int(out, rec.step);
+		write_int(out, rec.agent_ID);
+		write_int(out, rec.setting);
+		write_int(out, rec.place_ID);
+	}
+}
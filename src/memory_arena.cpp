@@ -0,0 +1,165 @@
+#include "../include/memory_arena.h"
+#include <cstdlib>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+/*****************************************************
+ * class: MemoryArena
+ *
+ * Monotonic memory for short-lived objects
+ *
+ *****************************************************/
+
+// Creates an arena without any memory
+MemoryArena::MemoryArena(const std::size_t block_bytes, const bool huge_pages) :
+	block_bytes(std::max(block_bytes, static_cast<std::size_t>(1))), huge_pages(huge_pages)
+{ }
+
+// Copy assignment, the arena becomes empty
+MemoryArena& MemoryArena::operator=(const MemoryArena& other)
+{
+	if (this != &other){
+		*this = MemoryArena(other.block_bytes, other.huge_pages);
+	}
+	return *this;
+}
+
+// Move, other is left without memory
+MemoryArena::MemoryArena(MemoryArena&& other) noexcept :
+	block_bytes(other.block_bytes), huge_pages(other.huge_pages),
+	blocks(std::move(other.blocks)), current(other.current), offset(other.offset),
+	n_allocations(other.n_allocations), n_system_allocations(other.n_system_allocations),
+	bytes_used(other.bytes_used), peak_bytes(other.peak_bytes)
+{
+	other.blocks.clear();
+	other.current = 0;
+	other.offset = 0;
+	other.bytes_used = 0;
+}
+
+MemoryArena& MemoryArena::operator=(MemoryArena&& other) noexcept
+{
+	if (this != &other){
+		release();
+		block_bytes = other.block_bytes;
+		huge_pages = other.huge_pages;
+		blocks = std::move(other.blocks);
+		current = other.current;
+		offset = other.offset;
+		n_allocations = other.n_allocations;
+		n_system_allocations = other.n_system_allocations;
+		bytes_used = other.bytes_used;
+		peak_bytes = other.peak_bytes;
+		other.blocks.clear();
+		other.current = 0;
+		other.offset = 0;
+		other.bytes_used = 0;
+	}
+	return *this;
+}
+
+// Memory for bytes with a given alignment
+void* MemoryArena::allocate(std::size_t bytes, const std::size_t alignment)
+{
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0
+			|| alignment > alignof(std::max_align_t)){
+		throw std::invalid_argument("Wrong alignment for the arena: " + std::to_string(alignment));
+	}
+	++n_allocations;
+	bytes = std::max(bytes, static_cast<std::size_t>(1));
+
+	// First block with enough space left, including the ones kept by reset
+	for ( ; current < blocks.size(); ++current, offset = 0){
+		const std::size_t start = (offset + alignment - 1) & ~(alignment - 1);
+		if (start <= blocks[current].size && bytes <= blocks[current].size - start){
+			bytes_used += start + bytes - offset;
+			peak_bytes = std::max(peak_bytes, bytes_used);
+			offset = start + bytes;
+			return blocks[current].data + start;
+		}
+	}
+
+	// Blocks start at the strictest alignment
+	blocks.push_back(new_block(std::max(block_bytes, bytes)));
+	current = blocks.size() - 1;
+	offset = bytes;
+	bytes_used += bytes;
+	peak_bytes = std::max(peak_bytes, bytes_used);
+	return blocks[current].data;
+}
+
+// Make all the memory available again
+void MemoryArena::reset()
+{
+	current = 0;
+	offset = 0;
+	bytes_used = 0;
+}
+
+// Return all the blocks to the system
+void MemoryArena::release()
+{
+	for (const auto& block : blocks){
+#ifdef __linux__
+		if (block.mapped){
+			munmap(block.data, block.size);
+			continue;
+		}
+#endif
+		std::free(block.data);
+	}
+	blocks.clear();
+	reset();
+}
+
+// Total size of the blocks held
+std::size_t MemoryArena::get_capacity() const
+{
+	std::size_t capacity = 0;
+	for (const auto& block : blocks){
+		capacity += block.size;
+	}
+	return capacity;
+}
+
+// True if at least one block is mapped with reserved huge pages or advised to use transparent ones
+bool MemoryArena::huge_pages_advised() const
+{
+	return std::any_of(blocks.begin(), blocks.end(), [](const Block& block){ return block.huge_advised; });
+}
+
+// Take a block of at least size bytes from the system
+MemoryArena::Block MemoryArena::new_block(const std::size_t size)
+{
+	++n_system_allocations;
+#ifdef __linux__
+	if (huge_pages){
+		// Whole huge pages of 2 MiB
+		const std::size_t huge_size = 1 << 21;
+		const std::size_t n_bytes = (size + huge_size - 1)/huge_size*huge_size;
+		void* data = mmap(nullptr, n_bytes, PROT_READ | PROT_WRITE,
+							MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (data != MAP_FAILED){
+			return {static_cast<char*>(data), n_bytes, true, true};
+		}
+		// No reserved huge pages, transparent ones if enabled;
+		// madvise only accepts the advice, the pages can still be regular
+		data = mmap(nullptr, n_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (data == MAP_FAILED){
+			throw std::bad_alloc();
+		}
+		bool advised = false;
+#ifdef MADV_HUGEPAGE
+		advised = (madvise(data, n_bytes, MADV_HUGEPAGE) == 0);
+#endif
+		return {static_cast<char*>(data), n_bytes, true, advised};
+	}
+#endif
+	void* data = std::malloc(size);
+	if (data == nullptr){
+		throw std::bad_alloc();
+	}
+	return {static_cast<char*>(data), size, false, false};
+}
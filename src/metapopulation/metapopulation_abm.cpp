@@ -0,0 +1,298 @@
+#include "../../include/metapopulation/metapopulation_abm.h"
+#include <tuple>
+
+/*****************************************************
+ * class: MetapopulationABM
+ *
+ * Communities coupled by commuters
+ *
+ *****************************************************/
+
+typedef PopulationSegment PS;
+
+//
+// Setup
+//
+
+// Add a community
+int MetapopulationABM::add_community(const std::string& name, ABM&& model)
+{
+	if (name.empty() || std::find(names.begin(), names.end(), name) != names.end()){
+		throw std::invalid_argument("Community name empty or already used: " + name);
+	}
+	if (model.uses_spatial_transmission()){
+		throw std::invalid_argument("Communities do not support spatial transmission");
+	}
+	if (!communities.empty()){
+		const ABM& first = communities.front();
+		if (!equal_floats<double>(model.get_time_step(), first.get_time_step(), 1e-9)
+				|| !equal_floats<double>(model.get_time(), first.get_time(), 1e-9)){
+			throw std::invalid_argument("Community " + name
+							+ " has a different time step or time than the others");
+		}
+	}
+	communities.push_back(std::move(model));
+	names.push_back(name);
+	return communities.size() - 1;
+}
+
+// Link a place to the place it mirrors in another community
+void MetapopulationABM::link_places(const std::string& community, const PS::place_type type,
+						const int place_ID, const std::string& owner_community, const int owner_ID)
+{
+	if (type != PS::schools && type != PS::workplaces){
+		throw std::invalid_argument("Only schools and workplaces can be linked");
+	}
+	Link link = {type, get_community_index(community), place_ID,
+					get_community_index(owner_community), owner_ID};
+	if (link.community == link.owner_community){
+		throw std::invalid_argument("Place linked to a place of its own community");
+	}
+	if (place_ID < 1 || place_ID > number_of_places(link.community, type)
+			|| owner_ID < 1 || owner_ID > number_of_places(link.owner_community, type)){
+		throw std::out_of_range("Linked place does not exist");
+	}
+	for (const auto& other : links){
+		if (other.type != type){
+			continue;
+		}
+		if ((other.community == link.community && other.place_ID == place_ID)
+				|| (other.owner_community == link.community && other.owner_ID == place_ID)){
+			throw std::invalid_argument("Place " + std::to_string(place_ID) + " of "
+							+ community + " is already linked");
+		}
+		if (other.community == link.owner_community && other.place_ID == owner_ID){
+			throw std::invalid_argument("Place " + std::to_string(owner_ID) + " of "
+							+ owner_community + " is a mirror and cannot be an owner");
+		}
+	}
+
+	// After all the mirrors of the same owner
+	auto by_owner = [](const Link& a, const Link& b)
+		{
+			return std::tie(a.type, a.owner_community, a.owner_ID)
+						< std::tie(b.type, b.owner_community, b.owner_ID);
+		};
+	links.insert(std::upper_bound(links.begin(), links.end(), link, by_owner), link);
+}
+
+// Load links from a file
+void MetapopulationABM::load_links(const std::string& fname)
+{
+	std::ifstream input(fname);
+	if (!input.is_open()){
+		throw std::runtime_error("Error opening the file with links: " + fname);
+	}
+
+	const std::map<std::string, PS::place_type> types = {{"schools", PS::schools},
+															{"workplaces", PS::workplaces}};
+	std::string line;
+	while (std::getline(input, line)){
+		std::istringstream entry(line);
+		std::string community, type, owner_community;
+		int place_ID = 0, owner_ID = 0;
+		if (!(entry >> community) || community.compare(0, 2, "//") == 0){
+			continue;
+		}
+		if (!(entry >> type >> place_ID >> owner_community >> owner_ID)){
+			throw std::invalid_argument("Wrong format of link: " + line);
+		}
+		if (types.count(type) == 0){
+			throw std::invalid_argument("Wrong type of linked places: " + type);
+		}
+		link_places(community, types.at(type), place_ID, owner_community, owner_ID);
+	}
+}
+
+//
+// Transmission of infection
+//
+
+// Transmit infection in all communities
+void MetapopulationABM::transmit_infection()
+{
+	for_each_community([this](int ic){
+			ABM& abm = communities[ic];
+			abm.get_testing_object().check_switch_time(abm.get_time());
+			abm.check_events(abm.vector_of_schools(), abm.vector_of_workplaces());
+			abm.accumulate_place_contributions();
+			abm.finalize_place_contributions();
+		});
+	exchange_contributions();
+	for_each_community([this](int ic){
+			ABM& abm = communities[ic];
+			abm.compute_state_transitions();
+			abm.reset_contributions();
+			abm.advance_in_time();
+		});
+}
+
+// Compute contributions of all places, including the commuters
+void MetapopulationABM::compute_place_contributions()
+{
+	for_each_community([this](int ic){
+			communities[ic].accumulate_place_contributions();
+			communities[ic].finalize_place_contributions();
+		});
+	exchange_contributions();
+}
+
+//
+// Getters
+//
+
+// Index of a community
+int MetapopulationABM::get_community_index(const std::string& name) const
+{
+	const auto it = std::find(names.begin(), names.end(), name);
+	if (it == names.end()){
+		throw std::out_of_range("No community named " + name);
+	}
+	return it - names.begin();
+}
+
+// Metrics of all the communities and of the region
+Metrics MetapopulationABM::get_metrics() const
+{
+	Metrics all;
+	if (communities.empty()){
+		return all;
+	}
+	const int n_steps = communities.front().get_metrics().get_n_steps();
+	all.reserve(n_steps);
+
+	// Sources of each column, community and handle
+	std::vector<std::vector<std::pair<int, int>>> sources;
+	const Metrics& first = communities.front().get_metrics();
+	for (int im = 0; im < first.size(); ++im){
+		std::vector<std::pair<int, int>> found;
+		for (int ic = 0; ic < communities.size(); ++ic){
+			const int id = communities[ic].get_metrics().find(first.get_name(im));
+			if (id >= 0){
+				found.emplace_back(ic, id);
+			}
+		}
+		if (found.size() == communities.size()){
+			all.add("region/" + first.get_name(im), first.get_kind(im));
+			sources.push_back(found);
+		}
+	}
+	for (int ic = 0; ic < communities.size(); ++ic){
+		const Metrics& metrics = communities[ic].get_metrics();
+		for (int im = 0; im < metrics.size(); ++im){
+			all.add(names[ic] + "/" + metrics.get_name(im), metrics.get_kind(im));
+			sources.push_back({{ic, im}});
+		}
+	}
+
+	for (int ti = 0; ti < n_steps; ++ti){
+		all.start_step();
+		for (int im = 0; im < sources.size(); ++im){
+			int value = 0;
+			for (const auto& source : sources[im]){
+				const std::vector<int>& values
+					= communities[source.first].get_metrics().get_values(source.second);
+				value += ti < values.size() ? values[ti] : 0;
+			}
+			all.set(im, value);
+		}
+	}
+	return all;
+}
+
+//
+// Private
+//
+
+// Add the sums of owners and their mirrors, owners compute the contributions
+void MetapopulationABM::exchange_contributions()
+{
+	for (std::size_t first = 0; first < links.size(); ){
+		// Mirrors of one owner
+		const Link& owner_link = links[first];
+		std::size_t last = first + 1;
+		while (last < links.size() && links[last].type == owner_link.type
+				&& links[last].owner_community == owner_link.owner_community
+				&& links[last].owner_ID == owner_link.owner_ID){
+			++last;
+		}
+
+		Place& owner = place(owner_link.owner_community, owner_link.type, owner_link.owner_ID);
+		double lambda_sum = owner.get_lambda_sum();
+		int n_infected = owner.get_total_infected();
+		int n_agents = owner.get_agent_IDs_ref().size();
+		for (std::size_t il = first; il < last; ++il){
+			const Place& mirror = place(links[il].community, links[il].type, links[il].place_ID);
+			lambda_sum += mirror.get_lambda_sum();
+			n_infected += mirror.get_total_infected();
+			n_agents += mirror.get_agent_IDs_ref().size();
+		}
+
+		owner.set_contribution_sums(lambda_sum, n_infected);
+		owner.compute_infected_contribution(n_agents);
+		for (std::size_t il = first; il < last; ++il){
+			Place& mirror = place(links[il].community, links[il].type, links[il].place_ID);
+			mirror.set_contribution_sums(lambda_sum, n_infected);
+			mirror.set_infected_contribution(owner.get_infected_contribution());
+		}
+		first = last;
+	}
+}
+
+// Run task(i) for each community
+void MetapopulationABM::for_each_community(const std::function<void(int)>& task)
+{
+	const int n_tasks = communities.size();
+	if (run_tasks){
+		run_tasks(n_tasks, task);
+		return;
+	}
+	if (!pool || pool->get_number_of_threads() != n_tasks){
+		pool.reset(new WorkStealingPool(std::max(n_tasks, 1)));
+	}
+	pool->run(n_tasks, task);
+}
+
+// Place of a community
+Place& MetapopulationABM::place(const int community, const PS::place_type type, const int ID)
+{
+	ABM& abm = communities.at(community);
+	if (type == PS::schools){
+		return abm.vector_of_schools().at(ID - 1);
+	}
+	return abm.vector_of_workplaces().at(ID - 1);
+}
+
+// Number of places of a type in a community
+int MetapopulationABM::number_of_places(const int community, const PS::place_type type) const
+{
+	const ABM& abm = communities.at(community);
+	return (type == PS::schools) ? abm.get_vector_of_schools().size()
+									: abm.get_vector_of_workplaces().size();
+}
+
+// Sum of a total over the communities
+int MetapopulationABM::regional_sum(int (ABM::*total)() const) const
+{
+	int sum = 0;
+	for (const auto& abm : communities){
+		sum += (abm.*total)();
+	}
+	return sum;
+}
+
+// Element-wise sum of a series over the communities
+std::vector<int> MetapopulationABM::regional_series(const std::vector<int>& (ABM::*series)() const) const
+{
+	std::vector<int> sum;
+	for (const auto& abm : communities){
+		const std::vector<int>& values = (abm.*series)();
+		if (values.size() > sum.size()){
+			sum.resize(values.size(), 0);
+		}
+		for (std::size_t i = 0; i < values.size(); ++i){
+			sum[i] += values[i];
+		}
+	}
+	return sum;
+}
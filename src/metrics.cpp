@@ -0,0 +1,159 @@
+#include "../include/metrics.h"
+#include <cstdint>
+
+/*****************************************************
+ * class: Metrics
+ *
+ * Registry of named per-step metrics
+ *
+ *****************************************************/
+
+namespace {
+	const char metrics_magic[] = "ABMMETR1";
+
+	void write_int(std::ofstream& out, const std::int32_t value)
+	{
+		out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	std::int32_t read_int(std::ifstream& in)
+	{
+		std::int32_t value = 0;
+		in.read(reinterpret_cast<char*>(&value), sizeof(value));
+		return value;
+	}
+}
+
+// Declare a metric
+int Metrics::add(const std::string& name, const kind_type kind)
+{
+	if (name.empty() || name.find_first_of(",\n") != std::string::npos){
+		throw std::invalid_argument("Wrong name of a metric: " + name);
+	}
+	if (find(name) >= 0){
+		throw std::invalid_argument("Metric already declared: " + name);
+	}
+	names.push_back(name);
+	kinds.push_back(kind);
+	columns.push_back(std::vector<int>(n_steps, 0));
+	columns.back().reserve(capacity);
+	return names.size() - 1;
+}
+
+// Preallocate all the columns
+void Metrics::reserve(const int n)
+{
+	capacity = std::max(capacity, n);
+	for (auto& column : columns){
+		column.reserve(capacity);
+	}
+}
+
+// Remove the values of all steps
+void Metrics::clear()
+{
+	for (auto& column : columns){
+		column.clear();
+	}
+	n_steps = 0;
+}
+
+// New step with all the values 0
+void Metrics::start_step()
+{
+	for (auto& column : columns){
+		column.push_back(0);
+	}
+	++n_steps;
+}
+
+// Handle of a metric
+int Metrics::find(const std::string& name) const
+{
+	const auto pos = std::find(names.begin(), names.end(), name);
+	return (pos == names.end()) ? -1 : static_cast<int>(pos - names.begin());
+}
+
+// Save as comma-separated values
+void Metrics::print_csv(const std::string& fname) const
+{
+	std::ofstream out(fname);
+	if (!out.is_open()){
+		throw std::runtime_error("Error opening the file with metrics: " + fname);
+	}
+	out << "step";
+	for (const auto& name : names){
+		out << "," << name;
+	}
+	out << "\n";
+	for (int step = 0; step < n_steps; ++step){
+		out << step;
+		for (const auto& column : columns){
+			out << "," << column[step];
+		}
+		out << "\n";
+	}
+}
+
+// Save in the binary format
+void Metrics::print_binary(const std::string& fname) const
+{
+	std::ofstream out(fname, std::ios::binary);
+	if (!out.is_open()){
+		throw std::runtime_error("Error opening the file with metrics: " + fname);
+	}
+	out.write(metrics_magic, sizeof(metrics_magic) - 1);
+	write_int(out, names.size());
+	write_int(out, n_steps);
+	for (int id = 0; id < names.size(); ++id){
+		write_int(out, kinds.at(id));
+		write_int(out, names.at(id).size());
+		out.write(names.at(id).data(), names.at(id).size());
+	}
+	for (const auto& column : columns){
+		for (const int value : column){
+			write_int(out, value);
+		}
+	}
+}
+
+// Read a registry saved with print_binary
+Metrics Metrics::read_binary(const std::string& fname)
+{
+	std::ifstream in(fname, std::ios::binary);
+	if (!in.is_open()){
+		throw std::runtime_error("Error opening the file with metrics: " + fname);
+	}
+	std::string magic(sizeof(metrics_magic) - 1, ' ');
+	in.read(&magic[0], magic.size());
+	const std::int32_t n_metrics = read_int(in);
+	const std::int32_t n = read_int(in);
+	if (!in || magic != metrics_magic || n_metrics < 0 || n < 0){
+		throw std::runtime_error("Not a metrics file: " + fname);
+	}
+
+	Metrics metrics;
+	for (int id = 0; id < n_metrics; ++id){
+		const std::int32_t kind = read_int(in);
+		const std::int32_t length = read_int(in);
+		if (!in || (kind != counter && kind != gauge) || length <= 0){
+			throw std::runtime_error("Not a metrics file or incomplete: " + fname);
+		}
+		std::string name(length, ' ');
+		in.read(&name[0], length);
+		metrics.add(name, static_cast<kind_type>(kind));
+	}
+	metrics.reserve(n);
+	for (int step = 0; step < n; ++step){
+		metrics.start_step();
+	}
+	for (auto& column : metrics.columns){
+		for (auto& value : column){
+			value = read_int(in);
+		}
+	}
+	if (!in){
+		throw std::runtime_error("Not a metrics file or incomplete: " + fname);
+	}
+	return metrics;
+}
@@ -0,0 +1,554 @@
+#include "../../include/next_reaction/next_reaction_abm.h"
+#include <numeric>
+
+/*****************************************************
+ * class: NextReactionABM
+ *
+ * Runs an ABM simulation in continuous time
+ *
+ *****************************************************/
+
+// Sets up a continuous time run of an ABM
+NextReactionABM::NextReactionABM(ABM& model) : abm(model)
+{
+	if (abm.uses_spatial_transmission()){
+		throw std::invalid_argument("Continuous time runs do not support spatial transmission");
+	}
+	dt = abm.get_time_step();
+	infection_parameters = abm.get_infection_parameters();
+}
+
+//
+// Transmission of infection
+//
+
+// Process all the events in one time step of the ABM
+void NextReactionABM::transmit_infection()
+{
+	const double t_start = abm.get_time();
+	const double t_end = t_start + dt;
+	if (initialized == false){
+		initialize();
+	}
+	start_step(t_start);
+
+	Infection& infection = abm.get_infection_object();
+	std::vector<Agent>& agents = abm.vector_of_agents();
+	double time = t_start;
+	while (true){
+		// Exposures are memoryless so the waiting time
+		// is drawn again after every event
+		const double t_exposure = time + infection.time_to_exposure(total_rate);
+
+		// Skip the outdated events
+		while (!events.empty()
+				&& events.top().version != event_versions.at(events.top().agent_ID-1)){
+			events.pop();
+		}
+		const double t_agent = events.empty() ?
+					std::numeric_limits<double>::infinity() : events.top().time;
+
+		if (std::min(t_exposure, t_agent) >= t_end){
+			break;
+		}
+		if (t_agent <= t_exposure){
+			const AgentEvent event = events.top();
+			events.pop();
+			time = std::max(time, event.time);
+			process_agent(agents.at(event.agent_ID-1), state_time(time, t_start));
+		} else {
+			time = t_exposure;
+			process_exposure(state_time(time, t_start));
+		}
+		++n_events;
+	}
+	abm.finish_step_metrics();
+	abm.advance_in_time();
+}
+
+//
+// Private
+//
+
+// Time at which the agent states are evaluated
+double NextReactionABM::state_time(const double time, const double t_start) const
+{
+#ifdef ABM_STEP_TIMES
+	// Agent times are resolved only to steps
+	return t_start;
+#else
+	return time;
+#endif
+}
+
+// Find all infected agents and schedule their first events
+void NextReactionABM::initialize()
+{
+	const std::vector<Agent>& agents = abm.get_vector_of_agents();
+	event_versions.assign(agents.size(), 0);
+	active_positions.assign(agents.size(), -1);
+	agent_shares.assign(agents.size(), {});
+
+	// Sums left from the registration of agents
+	abm.reset_contributions();
+
+	const double time = abm.get_time();
+	for (const auto& agent : agents){
+		if (agent.infected() && !agent.removed()){
+			active_positions.at(agent.get_ID()-1) = active_agents.size();
+			active_agents.push_back(agent.get_ID());
+			schedule(agent, time);
+		}
+	}
+	initialized = true;
+}
+
+// Events that happen at the beginning of a step and agents with flu
+void NextReactionABM::start_step(const double time)
+{
+	abm.get_testing_object().check_switch_time(time);
+	abm.check_events(abm.vector_of_schools(), abm.vector_of_workplaces());
+
+	// Susceptible agents tested in hospitals at this step
+	std::vector<Hospital>& hospitals = abm.vector_of_hospitals();
+	for (auto& hospital : hospitals){
+		hospital.set_n_tested(0);
+	}
+	const std::vector<Agent>& agents = abm.get_vector_of_agents();
+	for (const auto& agent_ID : abm.get_flu_object().get_flu_IDs()){
+		const Agent& agent = agents.at(agent_ID-1);
+		if (!agent.infected() && !agent.removed() && !agent.vaccinated()
+				&& agent.tested() && agent.tested_in_hospital()
+				&& agent.get_time_of_test() <= time && agent.tested_awaiting_test()){
+			hospitals.at(agent.get_hospital_ID()-1).increase_total_tested();
+		}
+	}
+
+	// Shares include the transmission rates of places; other changes
+	// of contributions are events of the agents that cause them
+	if (abm.get_number_of_place_changes() != place_changes){
+		place_changes = abm.get_number_of_place_changes();
+		rebuild_contributions(time);
+	} else {
+		refresh_rates();
+	}
+	flu_transitions(time);
+}
+
+// Process agents with flu with the ABM rules
+void NextReactionABM::flu_transitions(const double time)
+{
+	std::vector<Agent>& agents = abm.vector_of_agents();
+	Infection& infection = abm.get_infection_object();
+	Flu& flu = abm.get_flu_object();
+
+	std::vector<int> flu_IDs = flu.get_flu_IDs();
+	std::sort(flu_IDs.begin(), flu_IDs.end());
+	for (const auto& agent_ID : flu_IDs){
+		Agent& agent = agents.at(agent_ID-1);
+		if (!agent.symptomatic_non_covid() || agent.infected()
+				|| agent.removed() || agent.vaccinated()){
+			continue;
+		}
+		touched_places.clear();
+		agent_places(agent, touched_places);
+		const StateChanges state_changes = transitions.susceptible_transitions(agent, time,
+						dt, infection, abm.vector_of_households(), abm.vector_of_schools(),
+						abm.vector_of_workplaces(), abm.vector_of_hospitals(),
+						abm.vector_of_retirement_homes(), infection_parameters, agents,
+						flu, abm.get_testing_object());
+		if (state_changes.infected == 1){
+			abm.count_event(ABM::infected_event);
+		}
+		if (time >= infection_parameters.at("time to start data collection")
+				&& !agent.exposed() && !agent.symptomatic()){
+			if (state_changes.tested == 1){
+				abm.count_event(ABM::tested_event);
+			}
+			if (state_changes.tested_negative == 1){
+				abm.count_event(ABM::tested_negative_event);
+			}
+			if (state_changes.tested_false_positive == 1){
+				abm.count_event(ABM::tested_false_positive_event);
+			}
+		}
+		agent_places(agent, touched_places);
+		if (state_changes.infected == 1){
+			activate(agent, time);
+		}
+		update_places(touched_places);
+	}
+}
+
+// Process the due events of an agent
+void NextReactionABM::process_agent(Agent& agent, const double time)
+{
+	Infection& infection = abm.get_infection_object();
+	touched_places.clear();
+	agent_places(agent, touched_places);
+	remove_shares(agent);
+
+	// Transitions that become due with the changes
+	// in state are processed at the same time
+	const int max_passes = 8;
+	StateChanges state_changes = {};
+	for (int ip = 0; ip < max_passes; ++ip){
+		const unsigned int status = agent_status(agent);
+		const bool was_exposed = agent.exposed();
+		if (agent.exposed()){
+			state_changes = transitions.exposed_transitions(agent, infection, time, dt,
+								abm.vector_of_households(), abm.vector_of_schools(),
+								abm.vector_of_workplaces(), abm.vector_of_hospitals(),
+								abm.vector_of_retirement_homes(), infection_parameters,
+								abm.get_testing_object());
+		} else if (agent.symptomatic()){
+			state_changes = transitions.symptomatic_transitions(agent, time, dt, infection,
+								abm.vector_of_households(), abm.vector_of_schools(),
+								abm.vector_of_workplaces(), abm.vector_of_hospitals(),
+								abm.vector_of_retirement_homes(), infection_parameters);
+		} else {
+			throw std::runtime_error("Agent does not have any infection-related state");
+		}
+		record_transitions(agent, state_changes, was_exposed, time);
+		if (agent.removed() || (agent_status(agent) == status && state_changes.none())){
+			break;
+		}
+	}
+
+	agent_places(agent, touched_places);
+	if (agent.removed()){
+		deactivate(agent);
+	} else {
+		add_shares(agent, time);
+		schedule(agent, next_event_time(agent, time));
+	}
+	update_places(touched_places);
+}
+
+// Infect a member of a place selected by its exposure rate
+void NextReactionABM::process_exposure(const double time)
+{
+	Infection& infection = abm.get_infection_object();
+	const PlaceRef ref = active_places.at(infection.select_by_rate(place_rates, total_rate));
+	const Roster& members = ref.place->get_agent_IDs_ref();
+	if (members.empty()){
+		return;
+	}
+
+	// Thinning - only susceptible members without flu
+	// that are exposed to this place get infected
+	const int agent_ID = members.at(infection.get_random_member(members.size()));
+	Agent& agent = abm.vector_of_agents().at(agent_ID-1);
+	if (agent.infected() || agent.removed() || agent.vaccinated()
+			|| agent.symptomatic_non_covid()){
+		return;
+	}
+	const int n_exposures = susceptible_exposures(agent, ref);
+	if (n_exposures == 0){
+		return;
+	}
+	const int n_registered = members.multiplicity(agent_ID);
+	if (!infection.accept_exposure(static_cast<double>(n_exposures)/n_registered)){
+		return;
+	}
+
+	touched_places.clear();
+	agent_places(agent, touched_places);
+	transitions.process_new_infection(agent, time, infection,
+					abm.vector_of_schools(), abm.vector_of_workplaces(),
+					abm.vector_of_hospitals(), abm.vector_of_retirement_homes(),
+					infection_parameters, abm.get_flu_object(), abm.get_testing_object());
+	abm.count_event(ABM::infected_event);
+	agent_places(agent, touched_places);
+	activate(agent, time);
+	update_places(touched_places);
+}
+
+// Count the changes in state of an infected agent
+void NextReactionABM::record_transitions(const Agent& agent, const StateChanges& state_changes,
+								const bool was_exposed, const double time)
+{
+	const bool collect = (time >= infection_parameters.at("time to start data collection"));
+	if (state_changes.recovered == 1){
+		abm.count_event(was_exposed ? ABM::recovered_exposed_event : ABM::recovered_event);
+	}
+	if (!was_exposed && collect){
+		if (state_changes.dead_tested == 1){
+			// Dead after testing
+			abm.count_event(ABM::dead_tested_event);
+		} else if (state_changes.dead_not_tested == 1){
+			// Dead with no testing
+			abm.count_event(ABM::dead_not_tested_event);
+		}
+	}
+
+	if (collect && (agent.exposed() || agent.symptomatic())){
+		if (state_changes.tested == 1){
+			abm.count_event(ABM::tested_event);
+		}
+		if (state_changes.tested_positive == 1){
+			abm.count_event(ABM::tested_positive_event);
+		}
+		if (state_changes.tested_false_negative == 1){
+			abm.count_event(ABM::tested_false_negative_event);
+		}
+	}
+}
+
+// Start following a newly infected agent
+void NextReactionABM::activate(Agent& agent, const double time)
+{
+	active_positions.at(agent.get_ID()-1) = active_agents.size();
+	active_agents.push_back(agent.get_ID());
+	add_shares(agent, time);
+	schedule(agent, time);
+}
+
+// Stop following a removed agent
+void NextReactionABM::deactivate(const Agent& agent)
+{
+	const int pos = active_positions.at(agent.get_ID()-1);
+	const int last_ID = active_agents.back();
+	active_agents.at(pos) = last_ID;
+	active_positions.at(last_ID-1) = pos;
+	active_agents.pop_back();
+	active_positions.at(agent.get_ID()-1) = -1;
+	++event_versions.at(agent.get_ID()-1);
+}
+
+// Schedule the next event of an agent at a given time
+void NextReactionABM::schedule(const Agent& agent, const double time)
+{
+	int& version = event_versions.at(agent.get_ID()-1);
+	++version;
+	if (time < std::numeric_limits<double>::infinity()){
+		events.push({time, agent.get_ID(), version});
+	}
+}
+
+// Earliest time of an agent event later than time
+double NextReactionABM::next_event_time(const Agent& agent, const double time) const
+{
+	// Times that are no longer relevant only
+	// cause events without any transitions
+	const double event_times[] = {
+		static_cast<double>(agent.get_infectiousness_start_time()),
+		static_cast<double>(agent.get_latency_end_time()),
+		static_cast<double>(agent.get_time_of_death()),
+		static_cast<double>(agent.get_recovery_time()),
+		static_cast<double>(agent.get_time_of_test()),
+		static_cast<double>(agent.get_time_of_results()),
+		static_cast<double>(agent.get_time_hsp_to_icu()),
+		static_cast<double>(agent.get_time_icu_to_hsp()),
+		static_cast<double>(agent.get_time_hsp_to_ih()),
+		static_cast<double>(agent.get_time_ih_to_icu()),
+		static_cast<double>(agent.get_time_ih_to_hsp()) };
+	double t_next = std::numeric_limits<double>::infinity();
+	for (const auto& t_event : event_times){
+		if (t_event > time){
+			t_next = std::min(t_next, t_event);
+		}
+	}
+	return t_next;
+}
+
+// Bit mask of agent states that the transitions change
+unsigned int NextReactionABM::agent_status(const Agent& agent) const
+{
+	const bool states[] = { agent.exposed(), agent.symptomatic(), agent.removed(),
+				agent.tested(), agent.tested_awaiting_test(), agent.tested_awaiting_results(),
+				agent.tested_covid_positive(), agent.tested_false_negative(),
+				agent.being_treated(), agent.home_isolated(), agent.hospitalized(),
+				agent.hospitalized_ICU(), agent.dying(), agent.recovering() };
+	unsigned int status = 0;
+	for (std::size_t i = 0; i < sizeof(states)/sizeof(states[0]); ++i){
+		if (states[i]){
+			status |= (1u << i);
+		}
+	}
+	return status;
+}
+
+// Add all places an agent is associated with to a list
+void NextReactionABM::agent_places(const Agent& agent, std::vector<PlaceRef>& places)
+{
+	if (agent.retirement_home_resident()){
+		places.push_back({&abm.vector_of_retirement_homes().at(agent.get_household_ID()-1), retirement_home});
+	} else if (agent.get_household_ID() > 0){
+		places.push_back({&abm.vector_of_households().at(agent.get_household_ID()-1), household});
+	}
+	if (agent.student() && agent.get_school_ID() > 0){
+		places.push_back({&abm.vector_of_schools().at(agent.get_school_ID()-1), school});
+	}
+	if (agent.works() && agent.get_work_ID() > 0){
+		if (agent.retirement_home_employee()){
+			places.push_back({&abm.vector_of_retirement_homes().at(agent.get_work_ID()-1), retirement_home});
+		} else if (agent.school_employee()){
+			places.push_back({&abm.vector_of_schools().at(agent.get_work_ID()-1), school});
+		} else {
+			places.push_back({&abm.vector_of_workplaces().at(agent.get_work_ID()-1), workplace});
+		}
+	}
+	if (agent.get_hospital_ID() > 0){
+		places.push_back({&abm.vector_of_hospitals().at(agent.get_hospital_ID()-1), hospital});
+	}
+}
+
+// Add the current contributions of an agent to places
+void NextReactionABM::add_shares(Agent& agent, const double time)
+{
+	candidate_places.clear();
+	agent_places(agent, candidate_places);
+	std::sort(candidate_places.begin(), candidate_places.end());
+	candidate_places.erase(std::unique(candidate_places.begin(), candidate_places.end()),
+						candidate_places.end());
+
+	// Shares are the changes in sums of the places
+	sums_before.clear();
+	for (const auto& ref : candidate_places){
+		sums_before.push_back(std::make_pair(ref.place->get_lambda_sum(),
+								ref.place->get_total_infected()));
+	}
+	if (agent.exposed()){
+		contributions.compute_exposed_contributions(agent, time, abm.vector_of_households(),
+						abm.vector_of_schools(), abm.vector_of_workplaces(),
+						abm.vector_of_hospitals(), abm.vector_of_retirement_homes());
+	} else if (agent.symptomatic()){
+		contributions.compute_symptomatic_contributions(agent, time, abm.vector_of_households(),
+						abm.vector_of_schools(), abm.vector_of_workplaces(),
+						abm.vector_of_hospitals(), abm.vector_of_retirement_homes());
+	}
+
+	std::vector<PlaceShare>& shares = agent_shares.at(agent.get_ID()-1);
+	for (std::size_t ip = 0; ip < candidate_places.size(); ++ip){
+		const PlaceRef& ref = candidate_places.at(ip);
+		const double d_sum = ref.place->get_lambda_sum() - sums_before.at(ip).first;
+		const int d_infected = ref.place->get_total_infected() - sums_before.at(ip).second;
+		if (d_infected == 0 && d_sum == 0.0){
+			continue;
+		}
+		shares.push_back({ref, d_sum, d_infected});
+		touched_places.push_back(ref);
+		auto ind = active_place_index.find(ref.place);
+		if (ind == active_place_index.end()){
+			active_place_index[ref.place] = active_places.size();
+			active_places.push_back(ref);
+			place_rates.push_back(0.0);
+			place_contributors.push_back(1);
+		} else {
+			++place_contributors.at(ind->second);
+		}
+	}
+}
+
+// Remove the contributions of an agent from places
+void NextReactionABM::remove_shares(const Agent& agent)
+{
+	std::vector<PlaceShare>& shares = agent_shares.at(agent.get_ID()-1);
+	for (const auto& share : shares){
+		Place* place = share.ref.place;
+		place->set_contribution_sums(place->get_lambda_sum() - share.lambda_sum,
+								place->get_total_infected() - share.n_infected);
+		touched_places.push_back(share.ref);
+
+		const int ind = active_place_index.at(place);
+		if (--place_contributors.at(ind) > 0){
+			continue;
+		}
+		// No round-off left when nobody contributes
+		place->set_contribution_sums(0.0, 0);
+		total_rate -= place_rates.at(ind);
+		const int last = active_places.size() - 1;
+		active_places.at(ind) = active_places.at(last);
+		place_rates.at(ind) = place_rates.at(last);
+		place_contributors.at(ind) = place_contributors.at(last);
+		active_place_index.at(active_places.at(ind).place) = ind;
+		active_places.pop_back();
+		place_rates.pop_back();
+		place_contributors.pop_back();
+		active_place_index.erase(place);
+	}
+	shares.clear();
+	if (active_places.empty()){
+		total_rate = 0.0;
+	}
+}
+
+// Recompute all contributions from the active agents
+void NextReactionABM::rebuild_contributions(const double time)
+{
+	touched_places = active_places;
+	for (auto& ref : active_places){
+		ref.place->set_contribution_sums(0.0, 0);
+	}
+	active_places.clear();
+	place_rates.clear();
+	place_contributors.clear();
+	active_place_index.clear();
+	total_rate = 0.0;
+
+	std::vector<Agent>& agents = abm.vector_of_agents();
+	for (const auto& agent_ID : active_agents){
+		agent_shares.at(agent_ID-1).clear();
+		add_shares(agents.at(agent_ID-1), time);
+	}
+	// Numbers of tested change every step
+	for (auto& hsp : abm.vector_of_hospitals()){
+		touched_places.push_back({&hsp, hospital});
+	}
+	update_places(touched_places);
+
+	// Sum without accumulated round-off
+	total_rate = std::accumulate(place_rates.begin(), place_rates.end(), 0.0);
+}
+
+// Recompute the exposure rates of all places with contributing agents
+void NextReactionABM::refresh_rates()
+{
+	// Numbers of tested change every step and flu 
+	// isolation changes the numbers of agents present
+	touched_places = active_places;
+	for (auto& hsp : abm.vector_of_hospitals()){
+		touched_places.push_back({&hsp, hospital});
+	}
+	update_places(touched_places);
+
+	// Sum without accumulated round-off
+	total_rate = std::accumulate(place_rates.begin(), place_rates.end(), 0.0);
+}
+
+// Recompute contributions and exposure rates of places
+void NextReactionABM::update_places(std::vector<PlaceRef>& places)
+{
+	std::sort(places.begin(), places.end());
+	places.erase(std::unique(places.begin(), places.end()), places.end());
+	for (const auto& ref : places){
+		ref.place->compute_infected_contribution();
+		auto ind = active_place_index.find(ref.place);
+		if (ind == active_place_index.end()){
+			continue;
+		}
+		const double rate = ref.place->get_infected_contribution()*ref.place->get_agent_IDs_ref().size();
+		total_rate += rate - place_rates.at(ind->second);
+		place_rates.at(ind->second) = rate;
+	}
+	places.clear();
+}
+
+// Registrations in a place that count towards the agent's lambda
+int NextReactionABM::susceptible_exposures(const Agent& agent, const PlaceRef& ref) const
+{
+	switch (ref.type){
+		case household:
+			return transitions.susceptible_exposures(agent, static_cast<const Household&>(*ref.place));
+		case school:
+			return transitions.susceptible_exposures(agent, static_cast<const School&>(*ref.place));
+		case workplace:
+			return transitions.susceptible_exposures(agent, static_cast<const Workplace&>(*ref.place));
+		case hospital:
+			return transitions.susceptible_exposures(agent, static_cast<const Hospital&>(*ref.place));
+		case retirement_home:
+			return transitions.susceptible_exposures(agent, static_cast<const RetirementHome&>(*ref.place));
+	}
+	return 0;
+}
@@ -0,0 +1,310 @@
+#include "../../include/parameter_sweep/parameter_sweep.h"
+
+/*****************************************************
+ * class: ParameterSweep
+ *
+ * Runs simulations for many sets of infection
+ * parameters in one process
+ *
+ *****************************************************/
+
+// Creates a sweep over a model
+ParameterSweep::ParameterSweep(const ABM& model, const int steps) : base(model), n_steps(steps)
+{
+	if (steps < 1){
+		throw std::invalid_argument("Number of steps of a sweep needs to be at least 1");
+	}
+}
+
+// Add a parameter to vary
+void ParameterSweep::add_range(const std::string& name, const double min_value, const double max_value)
+{
+	if (base.get_infection_parameters().count(name) == 0){
+		throw std::invalid_argument("Unknown infection parameter: " + name);
+	}
+	if (std::find(names.begin(), names.end(), name) != names.end()){
+		throw std::invalid_argument("Parameter already varied: " + name);
+	}
+	if (min_value > max_value){
+		throw std::invalid_argument("Wrong range of parameter: " + name);
+	}
+	names.push_back(name);
+	ranges.push_back(std::make_pair(min_value, max_value));
+}
+
+// Generate the parameter sets from the ranges
+void ParameterSweep::generate(const design_type design, const int n)
+{
+	if (names.empty()){
+		throw std::runtime_error("No parameters to vary");
+	}
+	if (n < 1){
+		throw std::invalid_argument("Number of values or sets needs to be at least 1");
+	}
+
+	std::vector<std::vector<double>> points;
+	if (design == grid){
+		points = grid_points(n);
+	} else if (design == latin_hypercube){
+		points = latin_hypercube_points(n);
+	} else {
+		points = sobol_points(n);
+	}
+
+	// Scale to the ranges
+	for (auto& point : points){
+		for (int ip = 0; ip < point.size(); ++ip){
+			const double lo = ranges.at(ip).first, hi = ranges.at(ip).second;
+			point.at(ip) = lo + point.at(ip)*(hi - lo);
+		}
+	}
+	parameter_sets.swap(points);
+	results.clear();
+}
+
+// Number of simulations with each parameter set
+void ParameterSweep::set_replicates(const int n)
+{
+	if (n < 1){
+		throw std::invalid_argument("Number of replicates needs to be at least 1");
+	}
+	n_replicates = n;
+}
+
+// Run all the jobs
+void ParameterSweep::run(const int n_threads)
+{
+	if (parameter_sets.empty()){
+		throw std::runtime_error("No parameter sets to run");
+	}
+	const int n_jobs = parameter_sets.size()*n_replicates;
+	std::vector<Result> job_results(n_jobs);
+	WorkStealingPool pool(n_threads);
+	pool.run(n_jobs, [this, &job_results](const int job)
+		{ job_results.at(job) = run_job(job/n_replicates, job%n_replicates); });
+	results.swap(job_results);
+}
+
+// Run one simulation
+ParameterSweep::Result ParameterSweep::run_job(const int set, const int replicate) const
+{
+	Result result;
+	result.set = set;
+	result.replicate = replicate;
+	result.seed = replicate_seed(replicate);
+	result.parameters = parameter_sets.at(set);
+
+	ABM abm(base);
+	abm.set_infection_parameters(parameter_values(set));
+	abm.set_random_seed(result.seed);
+
+	int peak_infected = abm.get_num_infected();
+	double peak_time = abm.get_time();
+	for (int ti = 0; ti < n_steps; ++ti){
+		abm.transmit_infection();
+		const int n_infected = abm.get_num_infected();
+		if (n_infected > peak_infected){
+			peak_infected = n_infected;
+			peak_time = abm.get_time();
+		}
+	}
+
+	result.metrics = {static_cast<double>(abm.get_total_infected()), 
+		static_cast<double>(abm.get_total_dead()), 
+		static_cast<double>(abm.get_total_recovered()), 
+		static_cast<double>(abm.get_total_tested()), 
+		static_cast<double>(abm.get_total_tested_positive()),
+		static_cast<double>(abm.get_num_infected()), 
+		static_cast<double>(peak_infected), peak_time};
+	if (collect_series){
+		result.series = {abm.get_infected_day(), abm.get_dead_day(), abm.get_recovered_day(),
+			abm.get_tested_day(), abm.get_tested_positive_day(), abm.get_vaccinated_day()};
+	}
+	return result;
+}
+
+// Seed of replicate r, same for all the parameter sets
+unsigned ParameterSweep::replicate_seed(const int r) const
+{
+	std::seed_seq seq{sweep_seed, static_cast<unsigned>(r)};
+	std::vector<unsigned> seed(1);
+	seq.generate(seed.begin(), seed.end());
+	return seed.at(0);
+}
+
+// New parameter values of a set as used by the ABM
+std::map<std::string, double> ParameterSweep::parameter_values(const int set) const
+{
+	std::map<std::string, double> values;
+	const std::vector<double>& point = parameter_sets.at(set);
+	for (int ip = 0; ip < names.size(); ++ip){
+		values[names.at(ip)] = point.at(ip);
+	}
+	return values;
+}
+
+// Names of the summary metrics
+const std::vector<std::string>& ParameterSweep::get_metric_names()
+{
+	static const std::vector<std::string> metric_names = {"total infected", 
+		"total dead", "total recovered", "total tested", "total tested positive",
+		"final infected", "peak infected", "time of peak"};
+	return metric_names;
+}
+
+// Names of the daily series
+const std::vector<std::string>& ParameterSweep::get_series_names()
+{
+	static const std::vector<std::string> series_names = {"infected", 
+		"dead", "recovered", "tested", "tested positive", "vaccinated"};
+	return series_names;
+}
+
+// Save results of all the jobs as one table
+void ParameterSweep::print_results(const std::string& fname) const
+{
+	std::ofstream out(fname);
+	if (!out.is_open()){
+		throw std::runtime_error("Error opening the file with sweep results: " + fname);
+	}
+	// Header with spaces in names replaced 
+	auto column = [](std::string name)
+		{ std::replace(name.begin(), name.end(), ' ', '_'); return name; };
+	out << "set replicate seed";
+	for (const auto& name : names){
+		out << " " << column(name);
+	}
+	for (const auto& name : get_metric_names()){
+		out << " " << column(name);
+	}
+	out << "\n";
+
+	for (const auto& result : results){
+		out << result.set << " " << result.replicate << " " << result.seed;
+		for (const auto& value : result.parameters){
+			out << " " << value;
+		}
+		for (const auto& value : result.metrics){
+			out << " " << value;
+		}
+		out << "\n";
+	}
+}
+
+// Save the daily series of all the jobs
+void ParameterSweep::print_series(const std::string& fname) const
+{
+	std::ofstream out(fname);
+	if (!out.is_open()){
+		throw std::runtime_error("Error opening the file with sweep series: " + fname);
+	}
+	for (const auto& result : results){
+		for (int is = 0; is < result.series.size(); ++is){
+			std::string name = get_series_names().at(is);
+			std::replace(name.begin(), name.end(), ' ', '_');
+			out << result.set << " " << result.replicate << " " << name;
+			for (const auto& value : result.series.at(is)){
+				out << " " << value;
+			}
+			out << "\n";
+		}
+	}
+}
+
+// Grid with n values per parameter, last parameter varies fastest
+std::vector<std::vector<double>> ParameterSweep::grid_points(const int n) const
+{
+	const int n_dim = names.size();
+	std::vector<double> values(n, 0.5);
+	for (int i = 0; i < n && n > 1; ++i){
+		values.at(i) = static_cast<double>(i)/(n - 1);
+	}
+	std::vector<std::vector<double>> points = {{}};
+	for (int id = 0; id < n_dim; ++id){
+		std::vector<std::vector<double>> extended;
+		for (const auto& point : points){
+			for (const auto& value : values){
+				extended.push_back(point);
+				extended.back().push_back(value);
+			}
+		}
+		points.swap(extended);
+	}
+	return points;
+}
+
+// Latin hypercube - each parameter has one point in 
+// each of n equal intervals, at a random position
+std::vector<std::vector<double>> ParameterSweep::latin_hypercube_points(const int n) const
+{
+	const int n_dim = names.size();
+	std::mt19937 engine(sweep_seed);
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+	std::vector<std::vector<double>> points(n, std::vector<double>(n_dim, 0.0));
+	std::vector<int> strata(n);
+	for (int id = 0; id < n_dim; ++id){
+		std::iota(strata.begin(), strata.end(), 0);
+		std::shuffle(strata.begin(), strata.end(), engine);
+		for (int i = 0; i < n; ++i){
+			points.at(i).at(id) = (strata.at(i) + uniform(engine))/n;
+		}
+	}
+	return points;
+}
+
+// First n points of a Sobol sequence, starting with 
+// the origin; direction numbers of Joe and Kuo (2008) 
+std::vector<std::vector<double>> ParameterSweep::sobol_points(const int n) const
+{
+	// Degree s, coefficients a, and initial m of the
+	// primitive polynomials of dimensions 2 and higher
+	const std::vector<std::pair<std::pair<int, unsigned>, std::vector<unsigned>>> polynomials = 
+		{{{1, 0}, {1}}, {{2, 1}, {1, 3}}, {{3, 1}, {1, 3, 1}}, {{3, 2}, {1, 1, 1}}, 
+		 {{4, 1}, {1, 1, 3, 3}}, {{4, 4}, {1, 3, 5, 13}}, {{5, 2}, {1, 1, 5, 5, 17}}, 
+		 {{5, 4}, {1, 1, 5, 5, 5}}, {{5, 7}, {1, 1, 7, 11, 19}}};
+	const int n_dim = names.size();
+	if (n_dim > polynomials.size() + 1){
+		throw std::invalid_argument("Sobol sequence supports at most " 
+						+ std::to_string(polynomials.size() + 1) + " parameters");
+	}
+
+	// Direction numbers scaled by 2^32
+	const int n_bits = 32;
+	std::vector<std::vector<std::uint32_t>> directions(n_dim, std::vector<std::uint32_t>(n_bits + 1, 0));
+	for (int k = 1; k <= n_bits; ++k){
+		directions.at(0).at(k) = std::uint32_t(1) << (n_bits - k);
+	}
+	for (int id = 1; id < n_dim; ++id){
+		const int s = polynomials.at(id-1).first.first;
+		const unsigned a = polynomials.at(id-1).first.second;
+		const std::vector<unsigned>& m = polynomials.at(id-1).second;
+		std::vector<std::uint32_t>& v = directions.at(id);
+		for (int k = 1; k <= std::min(s, n_bits); ++k){
+			v.at(k) = m.at(k-1) << (n_bits - k);
+		}
+		for (int k = s + 1; k <= n_bits; ++k){
+			v.at(k) = v.at(k-s) ^ (v.at(k-s) >> s);
+			for (int i = 1; i < s; ++i){
+				if ((a >> (s - 1 - i)) & 1){
+					v.at(k) ^= v.at(k-i);
+				}
+			}
+		}
+	}
+
+	// Gray code order
+	std::vector<std::vector<double>> points(n, std::vector<double>(n_dim, 0.0));
+	std::vector<std::uint32_t> x(n_dim, 0);
+	for (int i = 1; i < n; ++i){
+		// Position of the lowest zero bit of i-1
+		int c = 1;
+		for (unsigned value = i - 1; value & 1; value >>= 1){
+			++c;
+		}
+		for (int id = 0; id < n_dim; ++id){
+			x.at(id) ^= directions.at(id).at(c);
+			points.at(i).at(id) = x.at(id)/4294967296.0;
+		}
+	}
+	return points;
+}
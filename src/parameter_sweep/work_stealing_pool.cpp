@@ -0,0 +1,97 @@
+#include "../../include/parameter_sweep/work_stealing_pool.h"
+
+/*****************************************************
+ * class: WorkStealingPool
+ *
+ * Runs independent tasks on a fixed number of threads
+ *
+ *****************************************************/
+
+// Creates a pool with a given number of threads
+WorkStealingPool::WorkStealingPool(const int n_threads) : n_workers(n_threads)
+{
+	if (n_threads < 1){
+		throw std::invalid_argument("Number of threads needs to be at least 1");
+	}
+}
+
+// Run task(i) for every i from 0 to n_tasks-1
+void WorkStealingPool::run(const int n_tasks, const std::function<void(int)>& task)
+{
+	// Initial contiguous blocks
+	std::vector<TaskQueue> queues(n_workers);
+	for (int iw = 0; iw < n_workers; ++iw){
+		const int first = static_cast<long>(n_tasks)*iw/n_workers;
+		const int last = static_cast<long>(n_tasks)*(iw+1)/n_workers;
+		for (int it = first; it < last; ++it){
+			queues.at(iw).tasks.push_back(it);
+		}
+	}
+
+	std::atomic<bool> failed(false);
+	std::atomic<int> steals(0);
+	std::exception_ptr error = nullptr;
+	std::mutex error_mtx;
+
+	auto work = [&](const int worker){
+		int task_index = 0;
+		bool stolen = false;
+		while (!failed && next_task(queues, worker, task_index, stolen)){
+			if (stolen){
+				++steals;
+			}
+			try {
+				task(task_index);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(error_mtx);
+				if (!failed){
+					error = std::current_exception();
+					failed = true;
+				}
+			}
+		}
+	};
+
+	// The calling thread is the first worker
+	std::vector<std::thread> threads;
+	for (int iw = 1; iw < n_workers; ++iw){
+		threads.emplace_back(work, iw);
+	}
+	work(0);
+	for (auto& thread : threads){
+		thread.join();
+	}
+
+	n_steals = steals;
+	if (error){
+		std::rethrow_exception(error);
+	}
+}
+
+// Take the next task of a thread, from its own queue or stolen
+bool WorkStealingPool::next_task(std::vector<TaskQueue>& queues, const int worker, 
+									int& task_index, bool& stolen)
+{
+	{
+		TaskQueue& own = queues.at(worker);
+		std::lock_guard<std::mutex> lock(own.mtx);
+		if (!own.tasks.empty()){
+			task_index = own.tasks.back();
+			own.tasks.pop_back();
+			stolen = false;
+			return true;
+		}
+	}
+	// Other threads starting with the next one
+	for (int i = 1; i < n_workers; ++i){
+		TaskQueue& other = queues.at((worker + i) % n_workers);
+		std::lock_guard<std::mutex> lock(other.mtx);
+		if (!other.tasks.empty()){
+			task_index = other.tasks.front();
+			other.tasks.pop_front();
+			stolen = true;
+			return true;
+		}
+	}
+	return false;
+}
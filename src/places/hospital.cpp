@@ -13,9 +13,9 @@
 
 // Calculates and stores probability contribution 
 // from exposedi and symptoamtic agents if any 
-void Hospital::compute_infected_contribution()
+void Hospital::compute_infected_contribution(const int n_agents)
 {
-	num_tot = agent_IDs.size() + n_tested;
+	num_tot = n_agents + n_tested;
 	if (num_tot == 0){
 		lambda_tot = 0.0;
 	}else{
@@ -19,9 +19,9 @@ void Household::print_basic(std::ostream& where) const
 }
 
 // Calculates and stores fraction of infected agents if any 
-void Household::compute_infected_contribution()
+void Household::compute_infected_contribution(const int n_agents)
 {
-	num_tot = agent_IDs.size();
+	num_tot = n_agents;
 	
 	if (num_tot == 0)
 		lambda_tot = 0.0;
@@ -30,9 +30,9 @@ void Place::register_agent(const int agent_ID, const bool is_infected)
 
 // Calculates and stores probability contribution 
 // from exposed and symptoamtic agents if any 
-void Place::compute_infected_contribution()
+void Place::compute_infected_contribution(const int n_agents)
 {
-	num_tot = agent_IDs.size();
+	num_tot = n_agents;
 	
 	if (num_tot == 0){
 		lambda_tot = 0.0;
@@ -60,10 +60,8 @@ void Place::print_basic(std::ostream& where) const
 // Remove an agent from this place
 void Place::remove_agent(const int index)
 {
-	std::vector<int> new_agent_IDs = {};
-	std::remove_copy(agent_IDs.begin(), agent_IDs.end(),
-					std::back_insert_iterator<std::vector<int>>(new_agent_IDs), index);
-	std::swap(new_agent_IDs, agent_IDs);	
+	// Keeps the order of the remaining agents
+	agent_IDs.remove(index);
 }
 
 //
@@ -0,0 +1,218 @@
+#include "../../include/places/roster.h"
+
+/*****************************************************
+ * class: Roster
+ *
+ * IDs of the agents registered in a place
+ *
+ *****************************************************/
+
+// Copies share the span until one of them changes
+Roster::Roster(const Roster& other) :
+	buffer(other.buffer), span(other.span), first(other.first), 
+	count(other.count), capacity(other.capacity), own(other.own)
+{
+	if (buffer && !buffer->read_only){
+		buffer->users[span].fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+Roster& Roster::operator=(const Roster& other)
+{
+	if (this != &other){
+		Roster copy(other);
+		*this = std::move(copy);
+	}
+	return *this;
+}
+
+// Moves take over the span
+Roster::Roster(Roster&& other) noexcept :
+	buffer(std::move(other.buffer)), span(other.span), first(other.first),
+	count(other.count), capacity(other.capacity), own(std::move(other.own)),
+	repeated(std::move(other.repeated))
+{
+	other.buffer.reset();
+}
+
+Roster& Roster::operator=(Roster&& other) noexcept
+{
+	if (this != &other){
+		release();
+		buffer = std::move(other.buffer);
+		other.buffer.reset();
+		span = other.span;
+		first = other.first;
+		count = other.count;
+		capacity = other.capacity;
+		own = std::move(other.own);
+		repeated = std::move(other.repeated);
+	}
+	return *this;
+}
+
+// Rosters as spans of one buffer
+std::vector<Roster> Roster::split(std::vector<int>&& IDs, const std::vector<int>& offsets)
+{
+	if (offsets.empty() || offsets.front() != 0 || offsets.back() != IDs.size()
+			|| !std::is_sorted(offsets.begin(), offsets.end())){
+		throw std::invalid_argument("Offsets of the rosters do not split the buffer");
+	}
+	const int n_spans = offsets.size() - 1;
+	auto shared = std::make_shared<Buffer>(n_spans);
+	shared->IDs = std::move(IDs);
+	std::vector<Roster> rosters(n_spans);
+	for (int is = 0; is < n_spans; ++is){
+		Roster& roster = rosters[is];
+		roster.buffer = shared;
+		roster.span = is;
+		roster.first = offsets[is];
+		roster.count = offsets[is+1] - offsets[is];
+		roster.capacity = roster.count;
+		shared->users[is].store(1, std::memory_order_relaxed);
+	}
+	return rosters;
+}
+
+// Rosters as spans of read-only memory
+std::vector<Roster> Roster::view(const int* IDs, const int* offsets, const int n_rosters,
+									std::shared_ptr<const void> owner)
+{
+	if (n_rosters < 0 || (n_rosters > 0 && offsets[0] != 0) 
+			|| !std::is_sorted(offsets, offsets + n_rosters + 1)){
+		throw std::invalid_argument("Offsets of the rosters are not ordered");
+	}
+	auto shared = std::make_shared<Buffer>(0);
+	shared->read_only = IDs;
+	shared->owner = std::move(owner);
+	std::vector<Roster> rosters(n_rosters);
+	for (int is = 0; is < n_rosters; ++is){
+		Roster& roster = rosters[is];
+		roster.buffer = shared;
+		roster.first = offsets[is];
+		roster.count = offsets[is+1] - offsets[is];
+		roster.capacity = roster.count;
+	}
+	return rosters;
+}
+
+// Lay out rosters in one buffer
+void Roster::pack(std::vector<Roster>& rosters)
+{
+	std::vector<int> offsets(1, 0);
+	for (const auto& roster : rosters){
+		offsets.push_back(offsets.back() + roster.size());
+	}
+	std::vector<int> IDs;
+	IDs.reserve(offsets.back());
+	for (const auto& roster : rosters){
+		IDs.insert(IDs.end(), roster.begin(), roster.end());
+	}
+	std::vector<Roster> packed = split(std::move(IDs), offsets);
+	for (std::size_t ir = 0; ir < rosters.size(); ++ir){
+		rosters[ir] = std::move(packed[ir]);
+	}
+}
+
+// Number of entries of an ID that is in the roster
+int Roster::multiplicity(const int ID) const
+{
+	// Every entry after the first one of each ID
+	if (!repeated){
+		std::vector<int> IDs = to_vector();
+		std::sort(IDs.begin(), IDs.end());
+		repeated.reset(new std::vector<int>());
+		for (std::size_t i = 1; i < IDs.size(); ++i){
+			if (IDs[i] == IDs[i-1]){
+				repeated->push_back(IDs[i]);
+			}
+		}
+	}
+	const auto range = std::equal_range(repeated->begin(), repeated->end(), ID);
+	return 1 + (range.second - range.first);
+}
+
+// ID at a position
+int Roster::at(const int i) const
+{
+	if (i < 0 || i >= size()){
+		throw std::out_of_range("No agent at position " + std::to_string(i) + " of the roster");
+	}
+	return begin()[i];
+}
+
+// Add an ID at the end
+void Roster::push_back(const int ID)
+{
+	repeated.reset();
+	if (count < capacity){
+		int* IDs = writable();
+		if (IDs){
+			IDs[count++] = ID;
+			return;
+		}
+	}
+	detach();
+	own.push_back(ID);
+}
+
+// Remove all entries of an ID
+void Roster::remove(const int ID)
+{
+	repeated.reset();
+	int* IDs = writable();
+	if (IDs){
+		count = std::remove(IDs, IDs + count, ID) - IDs;
+	} else {
+		own.erase(std::remove(own.begin(), own.end(), ID), own.end());
+	}
+}
+
+// Change all the IDs
+void Roster::remap(const std::vector<int>& new_IDs)
+{
+	repeated.reset();
+	int* IDs = writable();
+	if (!IDs){
+		IDs = own.data();
+	}
+	const int n = size();
+	for (int i = 0; i < n; ++i){
+		IDs[i] = new_IDs.at(IDs[i]-1);
+	}
+	std::sort(IDs, IDs + n);
+}
+
+// IDs that can be changed in place, null if in own storage
+int* Roster::writable()
+{
+	if (buffer && (buffer->read_only || buffer->users[span].load(std::memory_order_acquire) > 1)){
+		detach();
+	}
+	return buffer ? buffer->IDs.data() + first : nullptr;
+}
+
+// Copy the span into own storage
+void Roster::detach()
+{
+	if (buffer){
+		// Room for agents that come back or arrive later
+		own.reserve(count + count/2 + 2);
+		own.assign(begin(), end());
+		release();
+	}
+}
+
+// Stop using the span
+void Roster::release()
+{
+	if (buffer){
+		if (!buffer->read_only){
+			buffer->users[span].fetch_sub(1, std::memory_order_acq_rel);
+		}
+		buffer.reset();
+		first = 0;
+		count = 0;
+		capacity = 0;
+	}
+}
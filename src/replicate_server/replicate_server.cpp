@@ -0,0 +1,358 @@
+#include "../../include/replicate_server/replicate_server.h"
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+/*****************************************************
+ * class: ReplicateServer
+ *
+ * Long-lived process that runs replicates of one
+ * loaded model on request
+ *
+ *****************************************************/
+
+namespace {
+	/// Name in the protocol, spaces as underscores
+	std::string protocol_name(std::string name)
+	{
+		std::replace(name.begin(), name.end(), ' ', '_');
+		return name;
+	}
+
+	/// Name used by the model, underscores as spaces
+	std::string model_name(std::string name)
+	{
+		std::replace(name.begin(), name.end(), '_', ' ');
+		return name;
+	}
+
+	/// Write all of the text, false if the client is gone
+	bool write_all(const int fd, const std::string& text)
+	{
+		std::size_t written = 0;
+		while (written < text.size()){
+			const ssize_t n = send(fd, text.data() + written, text.size() - written, MSG_NOSIGNAL);
+			if (n < 0 && errno == EINTR){
+				continue;
+			}
+			if (n <= 0){
+				return false;
+			}
+			written += n;
+		}
+		return true;
+	}
+}
+
+// Buffered reading of lines from a socket
+class ReplicateServer::LineReader{
+public:
+	explicit LineReader(const int socket_fd) : fd(socket_fd) { }
+
+	/// Next line without the newline, false at the end of input
+	bool next(std::string& line)
+	{
+		while (true){
+			const std::size_t pos = buffer.find('\n');
+			if (pos != std::string::npos){
+				line = buffer.substr(0, pos);
+				buffer.erase(0, pos + 1);
+				if (!line.empty() && line.back() == '\r'){
+					line.pop_back();
+				}
+				return true;
+			}
+			char chunk[4096];
+			const ssize_t n = read(fd, chunk, sizeof(chunk));
+			if (n < 0 && errno == EINTR){
+				continue;
+			}
+			if (n <= 0){
+				return false;
+			}
+			buffer.append(chunk, n);
+		}
+	}
+
+	/// Next line that is not blank
+	bool next_command(std::string& line)
+	{
+		while (next(line)){
+			if (line.find_first_not_of(" \t") != std::string::npos){
+				return true;
+			}
+		}
+		return false;
+	}
+
+private:
+	int fd = -1;
+	std::string buffer;
+};
+
+// Creates a server of a model listening on a socket
+ReplicateServer::ReplicateServer(const ABM& model, const std::string& socket_path) :
+	base(model), path(socket_path)
+{
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.empty() || path.size() >= sizeof(address.sun_path)){
+		throw std::runtime_error("Wrong length of the socket path: " + path);
+	}
+	std::strcpy(address.sun_path, path.c_str());
+
+	listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listen_fd < 0){
+		throw std::runtime_error("Error creating the socket: " + std::string(std::strerror(errno)));
+	}
+	unlink(path.c_str());
+	if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+			|| listen(listen_fd, 64) != 0){
+		const std::string error(std::strerror(errno));
+		close(listen_fd);
+		throw std::runtime_error("Error listening on the socket " + path + ": " + error);
+	}
+}
+
+// Closes and removes the socket
+ReplicateServer::~ReplicateServer()
+{
+	close(listen_fd);
+	unlink(path.c_str());
+}
+
+// Maximum number of children running at the same time
+void ReplicateServer::set_max_children(const int n)
+{
+	if (n < 1){
+		throw std::invalid_argument("Number of children needs to be at least 1");
+	}
+	max_children = n;
+}
+
+// Serve connections until a shutdown request
+void ReplicateServer::serve()
+{
+	// Children that receive a shutdown request tell the server
+	// here, the connections are only read by whoever serves them
+	int shutdown_pipe[2];
+	if (pipe(shutdown_pipe) != 0){
+		throw std::runtime_error("Error creating a pipe: " + std::string(std::strerror(errno)));
+	}
+	int n_children = 0;
+	while (true){
+		// Finished children, waiting for one if at the limit
+		while (n_children > 0 && waitpid(-1, nullptr, WNOHANG) > 0){
+			--n_children;
+		}
+		if (n_children >= max_children){
+			if (waitpid(-1, nullptr, 0) > 0){
+				--n_children;
+			}
+			continue;
+		}
+
+		pollfd fds[2] = {{shutdown_pipe[0], POLLIN, 0}, {listen_fd, POLLIN, 0}};
+		if (poll(fds, 2, -1) < 0){
+			if (errno == EINTR){
+				continue;
+			}
+			close(shutdown_pipe[0]);
+			close(shutdown_pipe[1]);
+			throw std::runtime_error("Error waiting for connections: " + std::string(std::strerror(errno)));
+		}
+		if (fds[0].revents != 0){
+			break;
+		}
+		const int fd = accept(listen_fd, nullptr, nullptr);
+		if (fd < 0){
+			if (errno == EINTR){
+				continue;
+			}
+			close(shutdown_pipe[0]);
+			close(shutdown_pipe[1]);
+			throw std::runtime_error("Error accepting a connection: " + std::string(std::strerror(errno)));
+		}
+
+		if (mode == in_process){
+			const bool shutdown = serve_connection(fd);
+			if (shutdown){
+				write_all(fd, "end\n");
+			}
+			close(fd);
+			if (shutdown){
+				break;
+			}
+			continue;
+		}
+		const pid_t pid = fork();
+		if (pid < 0){
+			close(fd);
+			close(shutdown_pipe[0]);
+			close(shutdown_pipe[1]);
+			throw std::runtime_error("Error forking a child: " + std::string(std::strerror(errno)));
+		}
+		if (pid == 0){
+			// Child only serves this connection and
+			// leaves without touching the socket file
+			close(listen_fd);
+			close(shutdown_pipe[0]);
+			int status = 0;
+			try {
+				if (serve_connection(fd)){
+					// Server stops accepting before the client is answered
+					const char request = 's';
+					if (write(shutdown_pipe[1], &request, 1) != 1){
+						status = 1;
+					}
+					write_all(fd, "end\n");
+				}
+			} catch (...) {
+				status = 1;
+			}
+			close(fd);
+			_exit(status);
+		}
+		close(fd);
+		++n_children;
+	}
+
+	close(shutdown_pipe[0]);
+	close(shutdown_pipe[1]);
+	while (n_children > 0 && waitpid(-1, nullptr, 0) > 0){
+		--n_children;
+	}
+}
+
+// Serve all the requests of one connection
+bool ReplicateServer::serve_connection(const int fd) const
+{
+	LineReader reader(fd);
+	std::string command;
+	if (!reader.next_command(command)){
+		return false;
+	}
+	if (command == "shutdown"){
+		return true;
+	}
+	do {
+		std::string response;
+		if (command == "run"){
+			std::vector<std::string> lines;
+			std::string line;
+			bool complete = false;
+			while (reader.next(line)){
+				if (line == "end"){
+					complete = true;
+					break;
+				}
+				lines.push_back(line);
+			}
+			if (!complete){
+				return false;
+			}
+			try {
+				response = run(parse_request(lines));
+			} catch (const std::exception& e) {
+				response = "error " + std::string(e.what()) + "\n";
+			}
+		} else {
+			response = "error Wrong command: " + command + "\n";
+		}
+		if (!write_all(fd, response + "end\n")){
+			return false;
+		}
+	} while (reader.next_command(command));
+	return false;
+}
+
+// Run one request on a copy of the model
+std::string ReplicateServer::run(const Request& request) const
+{
+	const std::vector<std::string>& names = get_series_names();
+	for (const auto& output : request.outputs){
+		if (std::find(names.begin(), names.end(), output) == names.end()){
+			throw std::invalid_argument("Wrong output: " + protocol_name(output));
+		}
+	}
+
+	ABM abm(base);
+	if (!request.parameters.empty()){
+		abm.set_infection_parameters(request.parameters);
+	}
+	abm.set_random_seed(request.seed);
+	for (int ti = 0; ti < request.steps; ++ti){
+		abm.transmit_infection();
+	}
+
+	std::ostringstream response;
+	response << "metric time " << abm.get_time() << "\n"
+			 << "metric total_infected " << abm.get_total_infected() << "\n"
+			 << "metric total_dead " << abm.get_total_dead() << "\n"
+			 << "metric total_recovered " << abm.get_total_recovered() << "\n"
+			 << "metric total_tested " << abm.get_total_tested() << "\n"
+			 << "metric total_tested_positive " << abm.get_total_tested_positive() << "\n"
+			 << "metric total_vaccinated " << abm.get_total_vaccinated() << "\n"
+			 << "metric final_infected " << abm.get_num_infected() << "\n";
+	// Getters in order of the series names
+	typedef const std::vector<int>& (ABM::*series_getter)() const;
+	const series_getter getters[] = {&ABM::get_infected_day, &ABM::get_tested_day, 
+		&ABM::get_tested_positive_day, &ABM::get_tested_negative_day,
+		&ABM::get_tested_false_positive_day, &ABM::get_tested_false_negative_day,
+		&ABM::get_vaccinated_day};
+	for (const auto& output : request.outputs){
+		const std::size_t is = std::find(names.begin(), names.end(), output) - names.begin();
+		const std::vector<int>& values = (abm.*getters[is])();
+		response << "series " << protocol_name(output);
+		for (const int value : values){
+			response << " " << value;
+		}
+		response << "\n";
+	}
+	return response.str();
+}
+
+// Request from its lines
+ReplicateServer::Request ReplicateServer::parse_request(const std::vector<std::string>& lines)
+{
+	Request request;
+	for (const auto& line : lines){
+		std::istringstream fields(line);
+		std::string key, name, rest;
+		if (!(fields >> key)){
+			continue;
+		}
+		bool valid = false;
+		if (key == "seed"){
+			long long seed = -1;
+			valid = (fields >> seed) && seed >= 0 && seed <= 4294967295LL;
+			request.seed = static_cast<unsigned>(seed);
+		} else if (key == "steps"){
+			valid = (fields >> request.steps) && request.steps >= 0;
+		} else if (key == "parameter"){
+			double value = 0.0;
+			valid = (fields >> name >> value) && std::isfinite(value);
+			request.parameters[model_name(name)] = value;
+		} else if (key == "output"){
+			valid = static_cast<bool>(fields >> name);
+			request.outputs.push_back(model_name(name));
+		}
+		if (!valid || (fields >> rest)){
+			throw std::invalid_argument("Wrong line of request: " + line);
+		}
+	}
+	return request;
+}
+
+// Names of the series that can be requested
+const std::vector<std::string>& ReplicateServer::get_series_names()
+{
+	static const std::vector<std::string> series_names = {"infected", "tested",
+		"tested positive", "tested negative", "tested false positive",
+		"tested false negative", "vaccinated"};
+	return series_names;
+}
@@ -0,0 +1,326 @@
+#include "../../include/shared_population/population_segment.h"
+#include "../../include/abm.h"
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*****************************************************
+ * class: PopulationSegment
+ *
+ * Read-only view of a population published to a file
+ *
+ *****************************************************/
+
+namespace {
+	/// Append raw values to a buffer, padded to 8 bytes
+	template <typename T>
+	std::uint64_t append_section(std::vector<char>& buffer, const std::vector<T>& values)
+	{
+		const std::uint64_t offset = buffer.size();
+		const char* bytes = reinterpret_cast<const char*>(values.data());
+		buffer.insert(buffer.end(), bytes, bytes + values.size()*sizeof(T));
+		buffer.resize((buffer.size() + 7)/8*8, 0);
+		return offset;
+	}
+
+	/// Append the rosters of places of one type, offsets start from 0 
+	template <typename T>
+	void append_rosters(const std::vector<T>& places, std::vector<std::int32_t>& offsets, 
+							std::vector<std::int32_t>& IDs)
+	{
+		const std::size_t start = IDs.size();
+		offsets.push_back(0);
+		for (const auto& place : places){
+			const Roster& roster = place.get_agent_IDs_ref();
+			IDs.insert(IDs.end(), roster.begin(), roster.end());
+			offsets.push_back(IDs.size() - start);
+		}
+	}
+}
+
+// Map a published population read-only
+PopulationSegment::PopulationSegment(const std::string& fname)
+{
+	const int fd = open(fname.c_str(), O_RDONLY);
+	if (fd < 0){
+		throw std::runtime_error("Error opening the population segment " + fname + ": " + std::strerror(errno));
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header))){
+		close(fd);
+		throw std::runtime_error("Not a population segment: " + fname);
+	}
+	size = info.st_size;
+	void* file_data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (file_data == MAP_FAILED){
+		throw std::runtime_error("Error mapping the population segment " + fname + ": " + std::strerror(errno));
+	}
+	data = static_cast<const char*>(file_data);
+	const std::size_t mapped_size = size;
+	storage = std::shared_ptr<const char>(data, 
+				[mapped_size](const char* mapped){ munmap(const_cast<char*>(mapped), mapped_size); });
+	if (!set_sections()){
+		throw std::runtime_error("Not a population segment or incomplete: " + fname);
+	}
+}
+
+// View of a published population already in memory
+PopulationSegment::PopulationSegment(const void* buffer, const std::size_t buffer_size)
+{
+	if (buffer == nullptr || buffer_size < sizeof(Header) 
+			|| reinterpret_cast<std::uintptr_t>(buffer) % alignof(Header) != 0){
+		throw std::runtime_error("Not a population segment or not aligned in memory");
+	}
+	data = static_cast<const char*>(buffer);
+	size = buffer_size;
+	if (!set_sections()){
+		throw std::runtime_error("Not a population segment or incomplete in memory");
+	}
+}
+
+// View of a published population in memory owned with models
+PopulationSegment::PopulationSegment(std::shared_ptr<const void> buffer, const std::size_t buffer_size) :
+	PopulationSegment(buffer.get(), buffer_size)
+{
+	storage = std::shared_ptr<const char>(buffer, data);
+}
+
+// Check the header and locate the sections
+bool PopulationSegment::set_sections()
+{
+	header = reinterpret_cast<const Header*>(data);
+	if (std::memcmp(header->magic, magic(), sizeof(header->magic)) != 0 || header->size != size){
+		return false;
+	}
+	agent_ints = reinterpret_cast<const std::int32_t*>(data + header->agent_ints);
+	agent_xy = reinterpret_cast<const double*>(data + header->agent_xy);
+	place_ints = reinterpret_cast<const std::int32_t*>(data + header->place_ints);
+	place_xy = reinterpret_cast<const double*>(data + header->place_xy);
+	agent_profiles = reinterpret_cast<const AgentProfile*>(data + header->agent_profiles);
+	roster_offsets = reinterpret_cast<const std::int32_t*>(data + header->roster_offsets);
+	roster_IDs = reinterpret_cast<const std::int32_t*>(data + header->roster_IDs);
+	return true;
+}
+
+// Publish the population of a model to a file
+void PopulationSegment::publish(const ABM& abm, const std::string& fname)
+{
+	if (abm.get_time() > 0.0){
+		throw std::runtime_error("Only a model at the initial time can be published");
+	}
+
+	// Agents, one column per attribute
+	const std::vector<Agent>& agents = abm.get_vector_of_agents();
+	const std::size_t n_agents = agents.size();
+	std::vector<std::int32_t> agent_columns((infected + 1)*n_agents, 0);
+	std::vector<double> agent_coordinates(2*n_agents, 0.0);
+	std::vector<AgentProfile> profiles;
+	profiles.reserve(n_agents);
+	for (std::size_t i = 0; i < n_agents; ++i){
+		const Agent& agent = agents.at(i);
+		profiles.push_back(agent.get_profile());
+		const std::vector<std::int32_t> values = {agent.student(), agent.works(), agent.get_age(),
+			agent.get_household_ID(), agent.hospital_non_covid_patient(), agent.get_school_ID(),
+			agent.retirement_home_resident(), agent.retirement_home_employee(), 
+			agent.school_employee(), agent.get_work_ID(), agent.hospital_employee(), 
+			agent.get_hospital_ID(), agent.infected()};
+		for (int ic = 0; ic < values.size(); ++ic){
+			agent_columns.at(ic*n_agents + i) = values.at(ic);
+		}
+		agent_coordinates.at(i) = agent.get_x_location();
+		agent_coordinates.at(n_agents + i) = agent.get_y_location();
+	}
+
+	// Places - ID and school type code, and location
+	std::vector<std::int32_t> place_values;
+	std::vector<double> place_coordinates;
+	auto add_place = [&place_values, &place_coordinates](const Place& place, const int code){
+		place_values.push_back(place.get_ID());
+		place_values.push_back(code);
+		place_coordinates.push_back(place.get_x_location());
+		place_coordinates.push_back(place.get_y_location());
+	};
+	for (const auto& place : abm.get_vector_of_households()){
+		add_place(place, 0);
+	}
+	for (const auto& place : abm.get_vector_of_retirement_homes()){
+		add_place(place, 0);
+	}
+	for (const auto& place : abm.get_vector_of_schools()){
+		const std::vector<std::string>& types = school_types();
+		const auto iter = std::find(types.begin(), types.end(), place.get_type());
+		if (iter == types.end()){
+			throw std::invalid_argument("Wrong school type: " + place.get_type());
+		}
+		add_place(place, iter - types.begin());
+	}
+	for (const auto& place : abm.get_vector_of_workplaces()){
+		add_place(place, 0);
+	}
+	for (const auto& place : abm.get_vector_of_hospitals()){
+		add_place(place, 0);
+	}
+
+	// Rosters in the order of the places, offsets restart for each type
+	std::vector<std::int32_t> offsets;
+	std::vector<std::int32_t> IDs;
+	append_rosters(abm.get_vector_of_households(), offsets, IDs);
+	append_rosters(abm.get_vector_of_retirement_homes(), offsets, IDs);
+	append_rosters(abm.get_vector_of_schools(), offsets, IDs);
+	append_rosters(abm.get_vector_of_workplaces(), offsets, IDs);
+	append_rosters(abm.get_vector_of_hospitals(), offsets, IDs);
+
+	// Tables and their names
+	std::string names;
+	std::vector<double> parameter_values;
+	for (const auto& parameter : abm.get_infection_parameters()){
+		names += parameter.first + '\0';
+		parameter_values.push_back(parameter.second);
+	}
+	std::vector<double> distribution_values;
+	for (const auto& distribution : abm.get_age_dependent_distributions()){
+		for (const auto& entry : distribution.second){
+			names += distribution.first + '\0' + entry.first + '\0';
+			distribution_values.push_back(entry.second);
+		}
+	}
+	std::vector<double> testing_values;
+	const std::vector<std::vector<double>> testing_changes = abm.get_testing_object().get_time_varying();
+	for (const auto& change : testing_changes){
+		testing_values.insert(testing_values.end(), change.begin(), change.end());
+	}
+
+	Header segment_header;
+	std::memset(&segment_header, 0, sizeof(Header));
+	std::memcpy(segment_header.magic, magic(), sizeof(segment_header.magic));
+	segment_header.n_agents = n_agents;
+	segment_header.n_places[households] = abm.get_vector_of_households().size();
+	segment_header.n_places[retirement_homes] = abm.get_vector_of_retirement_homes().size();
+	segment_header.n_places[schools] = abm.get_vector_of_schools().size();
+	segment_header.n_places[workplaces] = abm.get_vector_of_workplaces().size();
+	segment_header.n_places[hospitals] = abm.get_vector_of_hospitals().size();
+	segment_header.n_parameters = parameter_values.size();
+	segment_header.n_distribution_entries = distribution_values.size();
+	segment_header.n_testing_changes = testing_changes.size();
+
+	std::vector<char> buffer(sizeof(Header), 0);
+	buffer.resize((buffer.size() + 7)/8*8, 0);
+	segment_header.agent_ints = append_section(buffer, agent_columns);
+	segment_header.agent_xy = append_section(buffer, agent_coordinates);
+	segment_header.place_ints = append_section(buffer, place_values);
+	segment_header.place_xy = append_section(buffer, place_coordinates);
+	segment_header.parameter_values = append_section(buffer, parameter_values);
+	segment_header.distribution_values = append_section(buffer, distribution_values);
+	segment_header.testing_changes = append_section(buffer, testing_values);
+	segment_header.agent_profiles = append_section(buffer, profiles);
+	segment_header.roster_offsets = append_section(buffer, offsets);
+	segment_header.roster_IDs = append_section(buffer, IDs);
+	segment_header.names = append_section(buffer, std::vector<char>(names.begin(), names.end()));
+	segment_header.names_size = names.size();
+	segment_header.size = buffer.size();
+	std::memcpy(buffer.data(), &segment_header, sizeof(Header));
+
+	// Complete file under the final name
+	const std::string tmp_name = fname + ".tmp";
+	std::ofstream out(tmp_name, std::ios::binary);
+	if (!out.is_open()){
+		throw std::runtime_error("Error opening the file for the population segment: " + tmp_name);
+	}
+	out.write(buffer.data(), buffer.size());
+	out.close();
+	if (!out || std::rename(tmp_name.c_str(), fname.c_str()) != 0){
+		std::remove(tmp_name.c_str());
+		throw std::runtime_error("Error writing the population segment: " + fname);
+	}
+}
+
+// Type of a school as in the input file
+std::string PopulationSegment::get_school_type(const int index) const
+{
+	return school_types().at(place_ints[2*(place_start(schools) + index) + 1]);
+}
+
+// Agents registered in places of a type at the initial time
+std::vector<Roster> PopulationSegment::get_rosters(const place_type type) const
+{
+	// One more offset per type before this one
+	const int first_offset = place_start(type) + type;
+	const std::int32_t* offsets = roster_offsets + first_offset;
+	// IDs of the previous types
+	int first_ID = 0;
+	for (int it = 0, io = 0; it < type; ++it){
+		io += header->n_places[it];
+		first_ID += roster_offsets[io + it];
+	}
+	return Roster::view(roster_IDs + first_ID, offsets, header->n_places[type], storage);
+}
+
+// Infection parameters
+std::map<std::string, double> PopulationSegment::get_infection_parameters() const
+{
+	const std::vector<std::string> names = stored_names();
+	const double* values = reinterpret_cast<const double*>(data + header->parameter_values);
+	std::map<std::string, double> parameters;
+	for (int i = 0; i < header->n_parameters; ++i){
+		parameters[names.at(i)] = values[i];
+	}
+	return parameters;
+}
+
+// Age-dependent distributions by tag and age group 
+std::map<std::string, std::map<std::string, double>> PopulationSegment::get_age_dependent_distributions() const
+{
+	const std::vector<std::string> names = stored_names();
+	const double* values = reinterpret_cast<const double*>(data + header->distribution_values);
+	std::map<std::string, std::map<std::string, double>> distributions;
+	for (int i = 0; i < header->n_distribution_entries; ++i){
+		const int in = header->n_parameters + 2*i;
+		distributions[names.at(in)][names.at(in + 1)] = values[i];
+	}
+	return distributions;
+}
+
+// Testing changes in the format of Testing::set_time_varying
+std::vector<std::vector<double>> PopulationSegment::get_testing_changes() const
+{
+	const double* values = reinterpret_cast<const double*>(data + header->testing_changes);
+	std::vector<std::vector<double>> changes;
+	for (int i = 0; i < header->n_testing_changes; ++i){
+		changes.push_back({values[3*i], values[3*i + 1], values[3*i + 2]});
+	}
+	return changes;
+}
+
+// Index of the first place of a type
+int PopulationSegment::place_start(const place_type type) const
+{
+	int start = 0;
+	for (int it = 0; it < type; ++it){
+		start += header->n_places[it];
+	}
+	return start;
+}
+
+// Names stored after the numeric sections
+std::vector<std::string> PopulationSegment::stored_names() const
+{
+	std::vector<std::string> names;
+	const char* first = data + header->names;
+	const char* last = first + header->names_size;
+	while (first < last){
+		names.push_back(std::string(first));
+		first += names.back().size() + 1;
+	}
+	return names;
+}
+
+// School types and their codes
+const std::vector<std::string>& PopulationSegment::school_types()
+{
+	static const std::vector<std::string> types = {"daycare", "primary", "middle", "high", "college"};
+	return types;
+}
@@ -0,0 +1,252 @@
+#include "../include/spatial_transmission.h"
+
+/*****************************************************
+ * class: SpatialTransmission
+ *
+ * Community transmission that decays with the 
+ * distance between agents
+ *
+ *****************************************************/
+
+// Kernel and its evaluation
+void SpatialTransmission::set_parameters(const double rate, const double scale, const double exponent, 
+											const double cutoff, const bool far_field)
+{
+	if (rate < 0.0 || scale <= 0.0 || exponent <= 0.0 || cutoff <= 0.0){
+		throw std::invalid_argument("Wrong parameters of spatial transmission");
+	}
+	transmission_rate = rate;
+	kernel_scale = scale;
+	kernel_exponent = exponent;
+	with_far_field = far_field;
+	if (cutoff != cutoff_radius){
+		cutoff_radius = cutoff;
+		agent_cells.clear();
+	}
+}
+
+// Set the spatial contribution of every susceptible agent
+void SpatialTransmission::compute(std::vector<Agent>& agents, const double time, MemoryArena& scratch)
+{
+	if (agent_cells.size() != agents.size()){
+		build_grid(agents);
+	}
+
+	// Sources and receivers, reserved as the arena does not reuse freed memory
+	ArenaVector<int> sources{ArenaAllocator<int>(scratch)};
+	ArenaVector<int> receivers{ArenaAllocator<int>(scratch)};
+	sources.reserve(agents.size());
+	receivers.reserve(agents.size());
+	for (int ia = 0; ia < agents.size(); ++ia){
+		Agent& agent = agents.at(ia);
+		agent.set_spatial_lambda(0.0);
+		if (agent.hospital_non_covid_patient() || agent.removed() || agent.vaccinated()){
+			continue;
+		}
+		if (!agent.infected()){
+			receivers.push_back(ia);
+		} else if (is_source(agent, time)){
+			sources.push_back(ia);
+		}
+	}
+	sort_by_cell(sources, source_start, source_IDs, scratch);
+	sort_by_cell(receivers, receiver_start, receiver_IDs, scratch);
+
+	// Strength of the sources
+	const int n_cells = nx*ny;
+	source_strength.resize(source_IDs.size());
+	for (int is = 0; is < source_IDs.size(); ++is){
+		source_strength.at(is) = agents.at(source_IDs.at(is)).get_inf_variability_factor();
+	}
+	if (with_far_field){
+		build_levels(agents);
+	}
+	if (source_IDs.empty()){
+		return;
+	}
+
+	// Each cell with receivers
+	ArenaVector<int> occupied{ArenaAllocator<int>(scratch)};
+	occupied.reserve(n_cells);
+	for (int cell = 0; cell < n_cells; ++cell){
+		if (receiver_start.at(cell+1) > receiver_start.at(cell)){
+			occupied.push_back(cell);
+		}
+	}
+	auto task = [&](const int i){ compute_cell(agents, occupied.at(i)); };
+	if (run_tasks){
+		run_tasks(occupied.size(), task);
+	} else {
+		for (int i = 0; i < occupied.size(); ++i){
+			task(i);
+		}
+	}
+}
+
+// Spatial contributions to the receivers in one cell
+void SpatialTransmission::compute_cell(std::vector<Agent>& agents, const int cell) const
+{
+	const int cx = cell%nx, cy = cell/nx;
+	const double cutoff_sq = cutoff_radius*cutoff_radius;
+
+	// Far field at the center of this cell
+	const double far = with_far_field ? far_field(cx, cy) : 0.0;
+
+	// Sources within the cutoff, all in the neighboring cells
+	for (int ir = receiver_start.at(cell); ir < receiver_start.at(cell+1); ++ir){
+		Agent& agent = agents.at(receiver_IDs.at(ir));
+		const double x = agent.get_x_location(), y = agent.get_y_location();
+		double near = 0.0;
+		for (int jy = std::max(cy - 1, 0); jy <= std::min(cy + 1, ny - 1); ++jy){
+			for (int jx = std::max(cx - 1, 0); jx <= std::min(cx + 1, nx - 1); ++jx){
+				const int other = jy*nx + jx;
+				for (int is = source_start.at(other); is < source_start.at(other+1); ++is){
+					const Agent& source = agents.at(source_IDs.at(is));
+					const double dx = source.get_x_location() - x, dy = source.get_y_location() - y;
+					const double d_sq = dx*dx + dy*dy;
+					// With the far field all the neighboring cells are
+					// exact, so that no sources are left out
+					if (with_far_field || d_sq <= cutoff_sq){
+						near += source_strength.at(is)*kernel(std::sqrt(d_sq));
+					}
+				}
+			}
+		}
+		agent.set_spatial_lambda(transmission_rate*(near + far));
+	}
+}
+
+// Strength of the cells on all the levels of the far field
+void SpatialTransmission::build_levels(const std::vector<Agent>& agents)
+{
+	// Number of levels depends only on the grid, so that 
+	// the levels keep their memory from step to step
+	int n_levels = 1;
+	for (int lx = nx, ly = ny; lx > 2 || ly > 2; lx = (lx + 1)/2, ly = (ly + 1)/2){
+		++n_levels;
+	}
+	levels.resize(n_levels);
+	for (int il = 0; il < n_levels; ++il){
+		Level& level = levels.at(il);
+		level.nx = (il == 0) ? nx : (levels.at(il-1).nx + 1)/2;
+		level.ny = (il == 0) ? ny : (levels.at(il-1).ny + 1)/2;
+		level.strength.assign(level.nx*level.ny, 0.0);
+		level.x.assign(level.nx*level.ny, 0.0);
+		level.y.assign(level.nx*level.ny, 0.0);
+	}
+
+	// Sources in the cells of the grid, then each cell
+	// in its parent; centers weighted by the strength
+	Level& base = levels.front();
+	for (int cell = 0; cell < nx*ny; ++cell){
+		for (int is = source_start.at(cell); is < source_start.at(cell+1); ++is){
+			const Agent& agent = agents.at(source_IDs.at(is));
+			base.strength.at(cell) += source_strength.at(is);
+			base.x.at(cell) += source_strength.at(is)*agent.get_x_location();
+			base.y.at(cell) += source_strength.at(is)*agent.get_y_location();
+		}
+	}
+	for (int il = 1; il < n_levels; ++il){
+		const Level& fine = levels.at(il-1);
+		Level& coarse = levels.at(il);
+		for (int cell = 0; cell < fine.nx*fine.ny; ++cell){
+			const int parent = (cell/fine.nx/2)*coarse.nx + (cell%fine.nx)/2;
+			coarse.strength.at(parent) += fine.strength.at(cell);
+			coarse.x.at(parent) += fine.x.at(cell);
+			coarse.y.at(parent) += fine.y.at(cell);
+		}
+	}
+	for (auto& level : levels){
+		for (int cell = 0; cell < level.nx*level.ny; ++cell){
+			if (level.strength.at(cell) > 0.0){
+				level.x.at(cell) /= level.strength.at(cell);
+				level.y.at(cell) /= level.strength.at(cell);
+			}
+		}
+	}
+}
+
+// Far field at the center of a cell from sources outside of its neighbors
+double SpatialTransmission::far_field(const int cx, const int cy) const
+{
+	const double x_center = x_min + (cx + 0.5)*cutoff_radius;
+	const double y_center = y_min + (cy + 0.5)*cutoff_radius;
+	double far = 0.0;
+	// All the cells of the last level are neighbors
+	for (int il = static_cast<int>(levels.size()) - 2; il >= 0; --il){
+		const Level& level = levels.at(il);
+		// The cell and its parent on this level
+		const int lx = cx >> il, ly = cy >> il;
+		const int px = lx/2, py = ly/2;
+		// Children of the neighbors of the parent, except the neighbors
+		for (int jy = std::max(2*py - 2, 0); jy <= std::min(2*py + 3, level.ny - 1); ++jy){
+			for (int jx = std::max(2*px - 2, 0); jx <= std::min(2*px + 3, level.nx - 1); ++jx){
+				const int other = jy*level.nx + jx;
+				if ((std::abs(jx - lx) <= 1 && std::abs(jy - ly) <= 1) || level.strength.at(other) == 0.0){
+					continue;
+				}
+				const double d = std::hypot(level.x.at(other) - x_center, level.y.at(other) - y_center);
+				far += level.strength.at(other)*kernel(d);
+			}
+		}
+	}
+	return far;
+}
+
+// Bin the agents into the grid
+void SpatialTransmission::build_grid(const std::vector<Agent>& agents)
+{
+	double x_max = 0.0, y_max = 0.0;
+	x_min = y_min = 0.0;
+	if (!agents.empty()){
+		x_min = x_max = agents.front().get_x_location();
+		y_min = y_max = agents.front().get_y_location();
+	}
+	for (const auto& agent : agents){
+		x_min = std::min(x_min, agent.get_x_location());
+		x_max = std::max(x_max, agent.get_x_location());
+		y_min = std::min(y_min, agent.get_y_location());
+		y_max = std::max(y_max, agent.get_y_location());
+	}
+	nx = static_cast<int>((x_max - x_min)/cutoff_radius) + 1;
+	ny = static_cast<int>((y_max - y_min)/cutoff_radius) + 1;
+
+	agent_cells.resize(agents.size());
+	for (int ia = 0; ia < agents.size(); ++ia){
+		const int ix = std::min(static_cast<int>((agents.at(ia).get_x_location() - x_min)/cutoff_radius), nx - 1);
+		const int iy = std::min(static_cast<int>((agents.at(ia).get_y_location() - y_min)/cutoff_radius), ny - 1);
+		agent_cells.at(ia) = iy*nx + ix;
+	}
+}
+
+// Sort agent positions by cell with counting sort
+void SpatialTransmission::sort_by_cell(const ArenaVector<int>& positions, std::vector<int>& start, 
+										std::vector<int>& sorted, MemoryArena& scratch) const
+{
+	start.assign(nx*ny + 1, 0);
+	for (const auto& ia : positions){
+		++start.at(agent_cells.at(ia) + 1);
+	}
+	for (int cell = 0; cell < nx*ny; ++cell){
+		start.at(cell+1) += start.at(cell);
+	}
+	sorted.resize(positions.size());
+	ArenaVector<int> next(start.begin(), start.end() - 1, ArenaAllocator<int>(scratch));
+	for (const auto& ia : positions){
+		sorted.at(next.at(agent_cells.at(ia))++) = ia;
+	}
+}
+
+// True if the agent contributes at this time
+bool SpatialTransmission::is_source(const Agent& agent, const double time) const
+{
+	// Not yet infectious
+	if (agent.exposed() && time < agent.get_infectiousness_start_time()){
+		return false;
+	}
+	// Isolated while tested, or treated
+	if (agent.tested() || agent.being_treated()){
+		return false;
+	}
+	return agent.exposed() || agent.symptomatic();
+}
@@ -48,14 +48,13 @@ void Testing::set_flu_testing()
 bool Testing::check_switch_time(const double time)
 {
 	double tol = 1e-3;
-	std::vector<double> temp(3,0.0);
-	if (equal_floats<double>(time_of_next_change, time, tol)){
+	if (event_at_time(time_of_next_change, time, tol)){
 		// New probabilities/fractions
 		exposed_fraction_to_get_tested = next_testing_fractions.at(0);
 		sy_fraction_to_get_tested = next_testing_fractions.at(1);
 		// Next values if exist
 		if (!testing_change_times.empty()){
-			temp = testing_change_times.front();
+			const std::vector<double>& temp = testing_change_times.front();
 			time_of_next_change = temp.at(0);
 			for (int i=1; i<3; ++i){
 				next_testing_fractions.at(i-1) = temp.at(i);
@@ -69,3 +68,12 @@ bool Testing::check_switch_time(const double time)
 	}
 	return false;
 }
+
+// Changes of testing not applied yet
+std::vector<std::vector<double>> Testing::get_time_varying() const
+{
+	std::vector<std::vector<double>> changes = {{time_of_next_change, 
+			next_testing_fractions.at(0), next_testing_fractions.at(1)}};
+	changes.insert(changes.end(), testing_change_times.begin(), testing_change_times.end());
+	return changes;
+}
@@ -10,7 +10,7 @@
  ******************************************************/
 
 // Implement transitions relevant to susceptible
-std::vector<int> FluTransitions::susceptible_transitions(Agent& agent, const double time, Infection& infection,	
+StateChanges FluTransitions::susceptible_transitions(Agent& agent, const double time, Infection& infection,	
 				std::vector<Household>& households, std::vector<School>& schools,
 				std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
 				std::vector<RetirementHome>& retirement_homes,
@@ -18,12 +18,12 @@ std::vector<int> FluTransitions::susceptible_transitions(Agent& agent, const dou
 				std::vector<Agent>& agents, Flu& flu, const Testing& testing, const double dt)
 {
 	double lambda_tot = 0.0;
-	// Infected, tested, negative, false positive
-	std::vector<int> state_changes(4,0);
+	StateChanges state_changes = {};
 
-	lambda_tot = compute_susceptible_lambda(agent, time, households, schools, workplaces, hospitals, retirement_homes);
+	lambda_tot = compute_susceptible_lambda(agent, time, households, schools, workplaces, hospitals, retirement_homes)
+					+ agent.get_spatial_lambda();
 	if (infection.infected(lambda_tot) == true){
-		state_changes.at(0) = 1;
+		state_changes.infected = 1;
 		int new_flu = flu.swap_flu_agent(agent.get_ID());
 		// If still available
 		if (new_flu != -1){
@@ -52,7 +52,7 @@ std::vector<int> FluTransitions::susceptible_transitions(Agent& agent, const dou
 		if ((agent.tested()) && (agent.get_time_of_test() <= time)
 				&& (agent.tested_awaiting_test() == true)){
 			testing_transitions_flu(agent, time, infection_parameters);
-			state_changes.at(1) = 1;
+			state_changes.tested = 1;
 		}
 		// If getting test results (this may in principle happen in a
 		// single step)
@@ -61,10 +61,10 @@ std::vector<int> FluTransitions::susceptible_transitions(Agent& agent, const dou
 			testing_results_transitions_flu(agent, agents, flu, time, infection, households, 
 						schools, workplaces, hospitals, retirement_homes, infection_parameters, testing);
 			if (agent.tested_covid_negative()){
-				state_changes.at(2) = 1;
+				state_changes.tested_negative = 1;
 			}
 			if (agent.tested_false_positive()){
-				state_changes.at(3) = 1;
+				state_changes.tested_false_positive = 1;
 			}
 		}
 		// If recovering and leaving home isolation - reset all flags, swap with 
@@ -96,7 +96,7 @@ void FluTransitions::process_new_flu(Agent& agent, const int n_hospitals, const
 	agent.set_symptomatic_non_covid(true);
 	// Testing properties
 	if (flu.getting_tested(testing)){
-		if (infection.tested_in_hospital(infection_parameters.at("fraction tested in hospitals"))){
+		if (infection.tested_in_hospital(infection_parameters.at(ParameterKeys::fraction_tested_in_hospitals))){
 			states_manager.set_waiting_for_test_in_hospital(agent);
 			int hsp_ID = infection.get_random_hospital_ID(n_hospitals);
 			// Registration will happen only upon testing time step
@@ -105,13 +105,13 @@ void FluTransitions::process_new_flu(Agent& agent, const int n_hospitals, const
 			states_manager.set_waiting_for_test_in_car(agent);
 		}
 		// Set testing times
-		test_time = infection.wait_time_for_test(infection_parameters.at("flu testing duration"));
+		test_time = infection.wait_time_for_test(infection_parameters.at(ParameterKeys::flu_testing_duration));
 		agent.set_time_to_test(test_time);
 		agent.set_time_of_test(time);
 		// Delay home isolation until fixed number of days before test
 		agent.set_home_isolated(false);
 		// Time to start isolation 
-		agent.set_flu_isolation(infection_parameters.at("time from decision to test"));
+		agent.set_flu_isolation(infection_parameters.at(ParameterKeys::time_decision_to_test));
 	}
 }
 
@@ -201,12 +201,12 @@ void FluTransitions::recovery_and_incubation(Agent& agent, Infection& infection,
 	// Total latency period
 	double latency = infection.latency();
 	// Portion of latency when the agent is not infectious
-	double dt_ninf = std::min(infection_parameters.at("time from exposed to infectiousness"), latency);
+	double dt_ninf = std::min(infection_parameters.at(ParameterKeys::time_exposed_to_infectiousness), latency);
 
 	if (never_sy){
 		states_manager.set_susceptible_to_exposed_never_symptomatic(agent);
 		// Set to total latency + infectiousness duration
-		double rec_time = infection_parameters.at("recovery time");
+		double rec_time = infection_parameters.at(ParameterKeys::recovery_time);
 		agent.set_latency_duration(latency + rec_time);
 		agent.set_latency_end_time(time);
 		agent.set_infectiousness_start_time(time, dt_ninf);
@@ -234,7 +234,7 @@ void FluTransitions::set_testing_status(Agent& agent, Infection& infection, cons
  		will_be_tested = infection.will_be_tested(testing.get_exp_tested_prob());
 		if (will_be_tested == true){
 			// Determine type of testing
-			if (infection.tested_in_hospital(infection_parameters.at("fraction tested in hospitals"))){
+			if (infection.tested_in_hospital(infection_parameters.at(ParameterKeys::fraction_tested_in_hospitals))){
 				states_manager.set_exposed_waiting_for_test_in_hospital(agent);
 				int hsp_ID = infection.get_random_hospital_ID(n_hospitals);
 				// Registration will happen only upon testing time step
@@ -245,7 +245,7 @@ void FluTransitions::set_testing_status(Agent& agent, Infection& infection, cons
 			// Home isolation - removal from all public places 
 			remove_from_all_workplaces_and_schools(agent, schools, workplaces, retirement_homes);
 			// Time to test
-			agent.set_time_to_test(infection_parameters.at("time from decision to test"));
+			agent.set_time_to_test(infection_parameters.at(ParameterKeys::time_decision_to_test));
 			agent.set_time_of_test(time);
 		}
 	} 
@@ -256,7 +256,7 @@ void FluTransitions::testing_transitions_flu(Agent& agent, const double time,
 										const std::map<std::string, double>& infection_parameters)
 {
 	// Determine the time agent gets results
-	agent.set_time_until_results(infection_parameters.at("time from test to results"));
+	agent.set_time_until_results(infection_parameters.at(ParameterKeys::time_test_to_results));
 	agent.set_time_of_results(time);
 	states_manager.set_tested_to_awaiting_results(agent);
 }
@@ -271,10 +271,10 @@ void FluTransitions::testing_results_transitions_flu(Agent& agent,
 			const std::map<std::string, double>& infection_parameters, const Testing& testing)
 {
 	// If false positive, put under home isolation 
-	double fneg_prob = infection_parameters.at("fraction false positive");
+	double fneg_prob = infection_parameters.at(ParameterKeys::fraction_false_positive);
 	if (infection.false_positive_test_result(fneg_prob) == true){
 		states_manager.set_tested_false_positive(agent);
-		agent.set_recovery_duration(infection_parameters.at("recovery time"));
+		agent.set_recovery_duration(infection_parameters.at(ParameterKeys::recovery_time));
 		agent.set_recovery_time(time);	
 	} else { 		
 		// If confirmed negative, release the isolation	
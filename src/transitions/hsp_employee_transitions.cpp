@@ -18,23 +18,33 @@ int HspEmployeeTransitions::susceptible_transitions(Agent& agent, const double t
 	double lambda_tot = 0.0;
 	int got_infected = 0;
 
-	lambda_tot = compute_susceptible_lambda(agent, time, households, schools, hospitals);
+	lambda_tot = compute_susceptible_lambda(agent, time, households, schools, hospitals)
+					+ agent.get_spatial_lambda();
 	if (infection.infected(lambda_tot) == true){
 		got_infected = 1;
-		agent.set_inf_variability_factor(infection.inf_variability());
-		// Infectiousness, latency, and possibility of never developing 
-		// symptoms 
-		recovery_and_incubation(agent, infection, time, infection_parameters);
-		// Determine if getting tested, how, and when
-		// Remove agent from places if under home isolation
-		if (testing.started(time)){
-			set_testing_status(agent, infection, time, schools, 
-							hospitals, infection_parameters, testing);
-		}
+		process_new_infection(agent, time, infection, schools, 
+						hospitals, infection_parameters, testing);
 	} 
 	return got_infected;	
 }
 
+// Set properties of an agent that just got infected
+void HspEmployeeTransitions::process_new_infection(Agent& agent, const double time, Infection& infection,	
+				std::vector<School>& schools, std::vector<Hospital>& hospitals, 
+				const std::map<std::string, double>& infection_parameters, const Testing& testing)
+{
+	agent.set_inf_variability_factor(infection.inf_variability());
+	// Infectiousness, latency, and possibility of never developing 
+	// symptoms 
+	recovery_and_incubation(agent, infection, time, infection_parameters);
+	// Determine if getting tested, how, and when
+	// Remove agent from places if under home isolation
+	if (testing.started(time)){
+		set_testing_status(agent, infection, time, schools, 
+						hospitals, infection_parameters, testing);
+	}
+}
+
 // Return total lambda of susceptible agent 
 double HspEmployeeTransitions::compute_susceptible_lambda(const Agent& agent, const double time, 
 					const std::vector<Household>& households, const std::vector<School>& schools,
@@ -68,12 +78,12 @@ void HspEmployeeTransitions::recovery_and_incubation(Agent& agent, Infection& in
 	// Total latency period
 	double latency = infection.latency();
 	// Portion of latency when the agent is not infectious
-	double dt_ninf = std::min(infection_parameters.at("time from exposed to infectiousness"), latency);
+	double dt_ninf = std::min(infection_parameters.at(ParameterKeys::time_exposed_to_infectiousness), latency);
 
 	if (never_sy){
 		states_manager.set_susceptible_to_exposed_never_symptomatic(agent);
 		// Set to total latency + infectiousness duration
-		double rec_time = infection_parameters.at("recovery time");
+		double rec_time = infection_parameters.at(ParameterKeys::recovery_time);
 		agent.set_latency_duration(latency + rec_time);
 		agent.set_latency_end_time(time);
 		agent.set_infectiousness_start_time(time, dt_ninf);
@@ -87,11 +97,11 @@ void HspEmployeeTransitions::recovery_and_incubation(Agent& agent, Infection& in
 }
 
 // Implement transitions relevant to exposed 
-std::vector<int> HspEmployeeTransitions::exposed_transitions(Agent& agent, Infection& infection, const double time, const double dt, 
+StateChanges HspEmployeeTransitions::exposed_transitions(Agent& agent, Infection& infection, const double time, const double dt, 
 										std::vector<Household>& households, std::vector<School>& schools, std::vector<Hospital>& hospitals,
 										const std::map<std::string, double>& infection_parameters, const Testing& testing)
 {
-	std::vector<int> state_changes(5,0);
+	StateChanges state_changes = {};
 	// Modified mortality for hospital emloyees
 	const bool is_hsp = true; 
 
@@ -100,7 +110,7 @@ std::vector<int> HspEmployeeTransitions::exposed_transitions(Agent& agent, Infec
 	if ((agent.tested()) && (agent.get_time_of_test() <= time)
 			&& (agent.tested_awaiting_test() == true)){
 		testing_transitions(agent, time, infection_parameters);
-		state_changes.at(2) = 1;
+		state_changes.tested = 1;
 	}
 
 	// If getting test results (this may in principle happen in a
@@ -110,10 +120,10 @@ std::vector<int> HspEmployeeTransitions::exposed_transitions(Agent& agent, Infec
 		testing_results_transitions(agent, time, dt, infection, households, 
 						schools, hospitals, infection_parameters);
 		if (agent.tested_covid_positive()){
-			state_changes.at(3) = 1;
+			state_changes.tested_positive = 1;
 		}
 		if (agent.tested_false_negative()){
-			state_changes.at(4) = 1;	
+			state_changes.tested_false_negative = 1;	
 		}
 	}
 
@@ -142,7 +152,7 @@ std::vector<int> HspEmployeeTransitions::exposed_transitions(Agent& agent, Infec
 			} else {
 				states_manager.set_recovering_symptomatic(agent);			
 				// This may change if treatment is ICU
-				agent.set_recovery_duration(infection_parameters.at("recovery time"));
+				agent.set_recovery_duration(infection_parameters.at(ParameterKeys::recovery_time));
 				agent.set_recovery_time(time);		
 			}
 
@@ -166,7 +176,7 @@ std::vector<int> HspEmployeeTransitions::exposed_transitions(Agent& agent, Infec
 			}
 		}
 	}
-	state_changes.at(0) = agent_recovered;
+	state_changes.recovered = agent_recovered;
 	return state_changes;
 }
 
@@ -187,7 +197,7 @@ void HspEmployeeTransitions::set_testing_status(Agent& agent, Infection& infecti
 			// Also - no home isolation until symptoms
 			states_manager.set_exposed_waiting_for_test_in_hospital(agent);
 			// Time to test
-			agent.set_time_to_test(infection_parameters.at("time from decision to test"));
+			agent.set_time_to_test(infection_parameters.at(ParameterKeys::time_decision_to_test));
 			agent.set_time_of_test(time);
 		}
 	} else if (agent.symptomatic()) {
@@ -195,33 +205,21 @@ void HspEmployeeTransitions::set_testing_status(Agent& agent, Infection& infecti
 		// with home isolation set elsewhere
 		states_manager.set_waiting_for_test_in_hospital(agent);
 		// Testing-related events - will be adjusted based on other time-dependent scenarios
-		agent.set_time_to_test(infection_parameters.at("time from decision to test"));
+		agent.set_time_to_test(infection_parameters.at(ParameterKeys::time_decision_to_test));
 		agent.set_time_of_test(time);
 	}
 }
 
 // Transitions of a symptomatic agent 
-std::vector<int> HspEmployeeTransitions::symptomatic_transitions(Agent& agent, const double time, 
+StateChanges HspEmployeeTransitions::symptomatic_transitions(Agent& agent, const double time, 
 				   	const double dt, Infection& infection,
 					std::vector<Household>& households, std::vector<School>& schools,
 					std::vector<Hospital>& hospitals,
 					const std::map<std::string, double>& infection_parameters)
 {
-	std::vector<int> state_changes(5,0);
-	int tested_pos = 0;
-	// First entry is one if agent recovered, second if agent died
-	std::vector<int> removed = {0,0};
-	removed = check_agent_removal(agent, time, households, schools, hospitals);
-	state_changes.at(0) = removed.at(0);
-	state_changes.at(1) = removed.at(1);
+	// Recovered or dead
+	StateChanges state_changes = check_agent_removal(agent, time, households, schools, hospitals);
 	if (agent.removed() == true){
-		if (state_changes.at(1) == 1){
-			// Correct for not tested or false negative and not treated
-			// The not treated is equal to not confirmed positive
-			if (agent.tested_covid_positive() == false){
-				state_changes.at(1) = 2;		
-			}
-		}
 		return state_changes;
 	}
 
@@ -229,7 +227,7 @@ std::vector<int> HspEmployeeTransitions::symptomatic_transitions(Agent& agent, c
 	if ((agent.tested()) && (agent.get_time_of_test() <= time)
 			&& (agent.tested_awaiting_test() == true)){
 		testing_transitions(agent, time, infection_parameters);
-		state_changes.at(2) = 1;
+		state_changes.tested = 1;
 		return state_changes;
 	}
 
@@ -237,9 +235,8 @@ std::vector<int> HspEmployeeTransitions::symptomatic_transitions(Agent& agent, c
 	// single step)
 	if ((agent.tested()) && (agent.get_time_of_results() <= time)
 			&& (agent.tested_awaiting_results() == true)){
-		tested_pos = testing_results_transitions(agent, time, dt, infection, households, 
+		state_changes.tested_positive = testing_results_transitions(agent, time, dt, infection, households, 
 						schools, hospitals, infection_parameters);
-		state_changes.at(3) = tested_pos;
 		return state_changes;
 	}
 
@@ -252,24 +249,29 @@ std::vector<int> HspEmployeeTransitions::symptomatic_transitions(Agent& agent, c
 }
 
 // Verify if agent is to be removed at this step
-std::vector<int> HspEmployeeTransitions::check_agent_removal(Agent& agent, const double time,
+StateChanges HspEmployeeTransitions::check_agent_removal(Agent& agent, const double time,
 					std::vector<Household>& households, std::vector<School>& schools,
 					std::vector<Hospital>& hospitals)
 {
-	// First entry is one if agent recovered, second if agent died
-	std::vector<int> removed = {0,0};
+	StateChanges removed = {};
 	// If dying
 	if (agent.dying() == true){
 		if (agent.get_time_of_death() <= time){
-			removed.at(1) = 1;
 			remove_agent_from_all_places(agent, households, schools, hospitals);
 			states_manager.set_any_to_removed(agent);
+			// Not tested or false negative and not treated
+			// The not treated is equal to not confirmed positive
+			if (agent.tested_covid_positive() == true){
+				removed.dead_tested = 1;
+			} else {
+				removed.dead_not_tested = 1;
+			}
 		}
 	}
 	// If recovering
 	if (agent.recovering() == true){
 		if (agent.get_recovery_time() <= time){
-			removed.at(0) = 1;
+			removed.recovered = 1;
 			if (agent.tested_false_negative() == false){
 				add_agent_to_all_places(agent, households, schools, hospitals);
 			}
@@ -284,7 +286,7 @@ void HspEmployeeTransitions::testing_transitions(Agent& agent, const double time
 										const std::map<std::string, double>& infection_parameters)
 {
 	// Determine the time agent gets results
-	agent.set_time_until_results(infection_parameters.at("time from test to results"));
+	agent.set_time_until_results(infection_parameters.at(ParameterKeys::time_test_to_results));
 	agent.set_time_of_results(time);
 	states_manager.set_tested_to_awaiting_results(agent);
 }
@@ -298,7 +300,7 @@ int HspEmployeeTransitions::testing_results_transitions(Agent& agent,
 {
 	// If false negative, remove testing, put back to exposed
 	// No false negative symptomatic
-	double fneg_prob = infection_parameters.at("fraction false negative");
+	double fneg_prob = infection_parameters.at(ParameterKeys::fraction_false_negative);
 	int tested_pos = 0;
 	if (infection.false_negative_test_result(fneg_prob) == true
 				&& agent.exposed() == true){
@@ -349,8 +351,8 @@ void HspEmployeeTransitions::select_initial_treatment(Agent& agent,
 				// If recovering - set times and transitions
 				states_manager.set_icu_recovering(agent);
 				// Reset the recovery time to > ICU + hospitalization
-				double t_icu = infection_parameters.at("time in ICU");
-				double t_hsp_icu = infection_parameters.at("time in hospital after ICU");
+				double t_icu = infection_parameters.at(ParameterKeys::time_in_ICU);
+				double t_hsp_icu = infection_parameters.at(ParameterKeys::time_in_hospital_after_ICU);
 				agent.set_time_icu_to_hsp(time + t_icu);
 			   	agent.set_time_hsp_to_ih(time + t_icu + t_hsp_icu);	
 				agent.set_recovery_duration(t_icu + t_hsp_icu);
@@ -361,13 +363,13 @@ void HspEmployeeTransitions::select_initial_treatment(Agent& agent,
 			states_manager.set_hospitalized(agent);
 			// If dying, set transition to ICU
 			if (agent.dying() == true){
-				double dt_icu = infection_parameters.at("time before death to ICU");
+				double dt_icu = infection_parameters.at(ParameterKeys::time_before_death_to_ICU);
 				double t_icu = std::max(agent.get_time_of_death() - dt_icu, time + dt_icu);
 				agent.set_time_hsp_to_icu(t_icu);	
 			}else{
 				// If recovering, set transition to home
 				double t_rh = agent.get_recovery_time();
-				double del_t_hsp = infection_parameters.at("time in hospital");
+				double del_t_hsp = infection_parameters.at(ParameterKeys::time_in_hospital);
 				double t_hsp = time + del_t_hsp; 
 				if (t_rh > t_hsp){
 					agent.set_time_hsp_to_ih(t_hsp);
@@ -383,7 +385,7 @@ void HspEmployeeTransitions::select_initial_treatment(Agent& agent,
 		states_manager.set_home_isolation(agent);
 		// If dying, set transition to ICU
 		if (agent.dying() == true){
-			double dt_icu = infection_parameters.at("time before death to ICU");
+			double dt_icu = infection_parameters.at(ParameterKeys::time_before_death_to_ICU);
 			double t_icu = std::max(agent.get_time_of_death() - dt_icu, time + dt_icu);
 			agent.set_time_ih_to_icu(t_icu);	
 		}else{
@@ -465,7 +467,7 @@ void HspEmployeeTransitions::treatment_transitions(Agent& agent, const double ti
 				households.at(agent.get_household_ID()-1).remove_agent(agent.get_ID());
 				// Set transition back
 				double t_rh = agent.get_recovery_time();
-				double del_t_hsp = infection_parameters.at("time in hospital");
+				double del_t_hsp = infection_parameters.at(ParameterKeys::time_in_hospital);
 				double t_hsp = time + del_t_hsp; 
 				if (t_rh > t_hsp){
 					agent.set_time_hsp_to_ih(t_hsp);
@@ -19,24 +19,36 @@ int RegularTransitions::susceptible_transitions(Agent& agent, const double time,
 {
 	double lambda_tot = 0.0;
 	int got_infected = 0;
-	lambda_tot = compute_susceptible_lambda(agent, time, households, schools, workplaces, retirement_homes);
+	lambda_tot = compute_susceptible_lambda(agent, time, households, schools, workplaces, retirement_homes)
+					+ agent.get_spatial_lambda();
 	if (infection.infected(lambda_tot) == true){
-		// Remove agent from potential flu population
-		flu.remove_susceptible_agent(agent.get_ID());
 		got_infected = 1;
-		agent.set_inf_variability_factor(infection.inf_variability());
-		// Infectiousness, latency, and possibility of never developing symptoms 
-		recovery_and_incubation(agent, infection, time, infection_parameters);
-		// Determine if getting tested, how, and when
-		// Remove agent from places if under home isolation
-		if (testing.started(time)){
-			set_testing_status(agent, infection, time, schools, 
-							workplaces, hospitals, retirement_homes, infection_parameters, testing);
-		}
+		process_new_infection(agent, time, infection, schools, workplaces, 
+						hospitals, retirement_homes, infection_parameters, flu, testing);
 	}	
 	return got_infected;	
 }
 
+// Set properties of an agent that just got infected
+void RegularTransitions::process_new_infection(Agent& agent, const double time, Infection& infection,	
+				std::vector<School>& schools, std::vector<Workplace>& workplaces, 
+				std::vector<Hospital>& hospitals, std::vector<RetirementHome>& retirement_homes,	
+				const std::map<std::string, double>& infection_parameters, 
+				Flu& flu, const Testing& testing)
+{
+	// Remove agent from potential flu population
+	flu.remove_susceptible_agent(agent.get_ID());
+	agent.set_inf_variability_factor(infection.inf_variability());
+	// Infectiousness, latency, and possibility of never developing symptoms 
+	recovery_and_incubation(agent, infection, time, infection_parameters);
+	// Determine if getting tested, how, and when
+	// Remove agent from places if under home isolation
+	if (testing.started(time)){
+		set_testing_status(agent, infection, time, schools, 
+						workplaces, hospitals, retirement_homes, infection_parameters, testing);
+	}
+}
+
 // Return total lambda of susceptible agent 
 double RegularTransitions::compute_susceptible_lambda(const Agent& agent, const double time, 
 					const std::vector<Household>& households, const std::vector<School>& schools,
@@ -107,11 +119,11 @@ void RegularTransitions::recovery_and_incubation(Agent& agent, Infection& infect
 	// Total latency period
 	double latency = infection.latency();
 	// Portion of latency when the agent is not infectious
-	double dt_ninf = std::min(infection_parameters.at("time from exposed to infectiousness"), latency);
+	double dt_ninf = std::min(infection_parameters.at(ParameterKeys::time_exposed_to_infectiousness), latency);
 	if (never_sy){
 		states_manager.set_susceptible_to_exposed_never_symptomatic(agent);
 		// Set to total latency + infectiousness duration
-		double rec_time = infection_parameters.at("recovery time");
+		double rec_time = infection_parameters.at(ParameterKeys::recovery_time);
 		agent.set_latency_duration(latency + rec_time);
 		agent.set_latency_end_time(time);
 		agent.set_infectiousness_start_time(time, dt_ninf);
@@ -125,21 +137,20 @@ void RegularTransitions::recovery_and_incubation(Agent& agent, Infection& infect
 }
 
 // Implement transitions relevant to exposed 
-std::vector<int> RegularTransitions::exposed_transitions(Agent& agent, Infection& infection, const double time, const double dt, 
+StateChanges RegularTransitions::exposed_transitions(Agent& agent, Infection& infection, const double time, const double dt, 
 										std::vector<Household>& households, std::vector<School>& schools,
 										std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
 										std::vector<RetirementHome>& retirement_homes,
 										const std::map<std::string, double>& infection_parameters, const Testing& testing)
 {
-	// Recovered, dead (not applicable), tested, tested positive, tested false negative
-	std::vector<int> state_changes(5,0);
+	StateChanges state_changes = {};
 
 	// First check for testing because that holds for transition changes too
 	// If being tested
 	if ((agent.tested()) && (agent.get_time_of_test() <= time)
 			&& (agent.tested_awaiting_test() == true)){
 		testing_transitions(agent, time, infection_parameters);
-		state_changes.at(2) = 1;
+		state_changes.tested = 1;
 	}
 	// If getting test results (this may in principle happen in a
 	// single step)
@@ -148,10 +159,10 @@ std::vector<int> RegularTransitions::exposed_transitions(Agent& agent, Infection
 		testing_results_transitions(agent, time, dt, infection, households, 
 					schools, workplaces, hospitals, retirement_homes, infection_parameters);
 		if (agent.tested_covid_positive()){
-			state_changes.at(3) = 1;
+			state_changes.tested_positive = 1;
 		}
 		if (agent.tested_false_negative()){
-			state_changes.at(4) = 1;
+			state_changes.tested_false_negative = 1;
 		}
 	}
 
@@ -188,7 +199,7 @@ std::vector<int> RegularTransitions::exposed_transitions(Agent& agent, Infection
 			}
 		}
 	}
-	state_changes.at(0) = agent_recovered;
+	state_changes.recovered = agent_recovered;
 	return state_changes;
 }
 
@@ -256,7 +267,7 @@ void RegularTransitions::recovery_status(Agent& agent, Infection& infection, con
 		agent.set_death_time(time);
 	} else {
 		states_manager.set_recovering_symptomatic(agent);			
-		agent.set_recovery_duration(infection_parameters.at("recovery time"));
+		agent.set_recovery_duration(infection_parameters.at(ParameterKeys::recovery_time));
 		agent.set_recovery_time(time);		
 	}
 }
@@ -271,7 +282,7 @@ void RegularTransitions::recovery_status_ICU(Agent& agent, Infection& infection,
 		agent.set_death_time(time);
 	} else {
 		states_manager.set_recovering_symptomatic(agent);			
-		agent.set_recovery_duration(infection_parameters.at("recovery time"));
+		agent.set_recovery_duration(infection_parameters.at(ParameterKeys::recovery_time));
 		agent.set_recovery_time(time);		
 	}
 }
@@ -292,7 +303,7 @@ bool RegularTransitions::set_testing_status(Agent& agent, Infection& infection,
  		will_be_tested = infection.will_be_tested(testing.get_exp_tested_prob());
 		if (will_be_tested == true){
 			// Determine type of testing
-			if (infection.tested_in_hospital(infection_parameters.at("fraction tested in hospitals"))){
+			if (infection.tested_in_hospital(infection_parameters.at(ParameterKeys::fraction_tested_in_hospitals))){
 				states_manager.set_exposed_waiting_for_test_in_hospital(agent);
 				int hsp_ID = infection.get_random_hospital_ID(n_hospitals);
 				// Registration will happen only upon testing time step
@@ -303,14 +314,14 @@ bool RegularTransitions::set_testing_status(Agent& agent, Infection& infection,
 			// Home isolation - removal from all public places 
 			remove_from_all_workplaces_and_schools(agent, schools, workplaces, retirement_homes);
 			// Time to test
-			agent.set_time_to_test(infection_parameters.at("time from decision to test"));
+			agent.set_time_to_test(infection_parameters.at(ParameterKeys::time_decision_to_test));
 			agent.set_time_of_test(time);
 		}
 	} else if (agent.symptomatic()) {
  		will_be_tested = infection.will_be_tested(testing.get_sy_tested_prob());
 		if (will_be_tested == true){
 			// If agent is getting tested - determine type and properties of testing
-			if (infection.tested_in_hospital(infection_parameters.at("fraction tested in hospitals"))){
+			if (infection.tested_in_hospital(infection_parameters.at(ParameterKeys::fraction_tested_in_hospitals))){
 				states_manager.set_waiting_for_test_in_hospital(agent);
 				int hsp_ID = infection.get_random_hospital_ID(n_hospitals);
 				// Registration will happen only upon testing time step
@@ -320,7 +331,7 @@ bool RegularTransitions::set_testing_status(Agent& agent, Infection& infection,
 			}
 	
 			// Testing-related events - will be adjusted based on other time-dependent scenarios
-			agent.set_time_to_test(infection_parameters.at("time from decision to test"));
+			agent.set_time_to_test(infection_parameters.at(ParameterKeys::time_decision_to_test));
 			agent.set_time_of_test(time);
 	
 			// Home isolation - removal from all public places except hospitals for former
@@ -332,28 +343,16 @@ bool RegularTransitions::set_testing_status(Agent& agent, Infection& infection,
 }
 
 // Transitions of a symptomatic agent 
-std::vector<int> RegularTransitions::symptomatic_transitions(Agent& agent, const double time, 
+StateChanges RegularTransitions::symptomatic_transitions(Agent& agent, const double time, 
 				   	const double dt, Infection& infection,
 					std::vector<Household>& households, std::vector<School>& schools,
 					std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
 					std::vector<RetirementHome>& retirement_homes,
 					const std::map<std::string, double>& infection_parameters)
 {
-	std::vector<int> state_changes(5,0);
-	int tested_pos = 0;
-	// First entry is one if agent recovered, second if agent died
-	std::vector<int> removed = {0,0};
-	removed = check_agent_removal(agent, time, households, schools, workplaces, hospitals, retirement_homes);
-	state_changes.at(0) = removed.at(0);
-	state_changes.at(1) = removed.at(1);
+	// Recovered or dead
+	StateChanges state_changes = check_agent_removal(agent, time, households, schools, workplaces, hospitals, retirement_homes);
 	if (agent.removed() == true){
-		if (state_changes.at(1) == 1){
-			// Correct for not tested or false negative and not treated
-			// The not treated is equal to not confirmed positive
-			if (agent.tested_covid_positive() == false){
-				state_changes.at(1) = 2;		
-			}
-		}	
 		return state_changes;
 	}
 	if (agent.tested_false_negative() == true){
@@ -364,16 +363,15 @@ std::vector<int> RegularTransitions::symptomatic_transitions(Agent& agent, const
 	if ((agent.tested()) && (agent.get_time_of_test() <= time)
 			&& (agent.tested_awaiting_test() == true)){
 		testing_transitions(agent, time, infection_parameters);
-		state_changes.at(2) = 1;
+		state_changes.tested = 1;
 		return state_changes;
 	}
 
 	// If getting test results 	
 	if ((agent.tested()) && (agent.get_time_of_results() <= time)
 			&& (agent.tested_awaiting_results() == true)){
-		tested_pos = testing_results_transitions(agent, time, dt, infection, households, 
+		state_changes.tested_positive = testing_results_transitions(agent, time, dt, infection, households, 
 						schools, workplaces, hospitals, retirement_homes, infection_parameters);
-		state_changes.at(3) = tested_pos;
 		return state_changes;
 	}
 
@@ -387,25 +385,30 @@ std::vector<int> RegularTransitions::symptomatic_transitions(Agent& agent, const
 }
 
 // Verify if agent is to be removed at this step
-std::vector<int> RegularTransitions::check_agent_removal(Agent& agent, const double time,
+StateChanges RegularTransitions::check_agent_removal(Agent& agent, const double time,
 					std::vector<Household>& households, std::vector<School>& schools,
 					std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
 					std::vector<RetirementHome>& retirement_homes)
 {
-	// First entry is one if agent recovered, second if agent died
-	std::vector<int> removed = {0,0};
+	StateChanges removed = {};
 	// If dying
 	if (agent.dying() == true){
 		if (agent.get_time_of_death() <= time){
-			removed.at(1) = 1;
 			remove_agent_from_all_places(agent, households, schools, workplaces, hospitals, retirement_homes);
 			states_manager.set_any_to_removed(agent);
+			// Not tested or false negative and not treated
+			// The not treated is equal to not confirmed positive
+			if (agent.tested_covid_positive() == true){
+				removed.dead_tested = 1;
+			} else {
+				removed.dead_not_tested = 1;
+			}
 		}
 	}
 	// If recovering
 	if (agent.recovering() == true){
 		if (agent.get_recovery_time() <= time){
-			removed.at(0) = 1;
+			removed.recovered = 1;
 			// If any of these categories - return to regular public places/households
 			if (agent.tested() || agent.being_treated()){
 				add_agent_to_all_places(agent, households, schools, workplaces, hospitals, retirement_homes);
@@ -421,7 +424,7 @@ void RegularTransitions::testing_transitions(Agent& agent, const double time,
 										const std::map<std::string, double>& infection_parameters)
 {
 	// Determine the time agent gets results
-	agent.set_time_until_results(infection_parameters.at("time from test to results"));
+	agent.set_time_until_results(infection_parameters.at(ParameterKeys::time_test_to_results));
 	agent.set_time_of_results(time);
 	states_manager.set_tested_to_awaiting_results(agent);
 }
@@ -436,7 +439,7 @@ int RegularTransitions::testing_results_transitions(Agent& agent,
 {
 	// If false negative, remove testing, put back to exposed
 	// No false negative symptomatic 
-	double fneg_prob = infection_parameters.at("fraction false negative");
+	double fneg_prob = infection_parameters.at(ParameterKeys::fraction_false_negative);
 	int tested_pos = 0;	
 	if (infection.false_negative_test_result(fneg_prob) == true
 		 && agent.exposed() == true){
@@ -497,8 +500,8 @@ void RegularTransitions::select_initial_treatment(Agent& agent,
 				// If recovering - set times and transitions
 				states_manager.set_icu_recovering(agent);
 				// Reset the recovery time to > ICU + hospitalization
-				double t_icu = infection_parameters.at("time in ICU");
-				double t_hsp_icu = infection_parameters.at("time in hospital after ICU");
+				double t_icu = infection_parameters.at(ParameterKeys::time_in_ICU);
+				double t_hsp_icu = infection_parameters.at(ParameterKeys::time_in_hospital_after_ICU);
 				agent.set_time_icu_to_hsp(time + t_icu);
 			   	agent.set_time_hsp_to_ih(time + t_icu + t_hsp_icu);	
 				agent.set_recovery_duration(t_icu + t_hsp_icu);
@@ -509,13 +512,13 @@ void RegularTransitions::select_initial_treatment(Agent& agent,
 			states_manager.set_hospitalized(agent);
 			// If dying, set transition to ICU
 			if (agent.dying() == true){
-				double dt_icu = infection_parameters.at("time before death to ICU");
+				double dt_icu = infection_parameters.at(ParameterKeys::time_before_death_to_ICU);
 				double t_icu = std::max(agent.get_time_of_death() - dt_icu, time + dt_icu);
 				agent.set_time_hsp_to_icu(t_icu);	
 			}else{
 				// If recovering, set transition to home
 				double t_rh = agent.get_recovery_time();
-				double del_t_hsp = infection_parameters.at("time in hospital");
+				double del_t_hsp = infection_parameters.at(ParameterKeys::time_in_hospital);
 				double t_hsp = time + del_t_hsp; 
 				if (t_rh > t_hsp){
 					agent.set_time_hsp_to_ih(t_hsp);
@@ -531,7 +534,7 @@ void RegularTransitions::select_initial_treatment(Agent& agent,
 		states_manager.set_home_isolation(agent);
 		// If dying, set transition to ICU
 		if (agent.dying() == true){
-			double dt_icu = infection_parameters.at("time before death to ICU");
+			double dt_icu = infection_parameters.at(ParameterKeys::time_before_death_to_ICU);
 			double t_icu = std::max(agent.get_time_of_death() - dt_icu, time + dt_icu);
 			agent.set_time_ih_to_icu(t_icu);	
 		}else{
@@ -575,8 +578,8 @@ void RegularTransitions::setup_initial_treatment(Agent& agent,
 				// If recovering - set times and transitions
 				states_manager.set_icu_recovering(agent);
 				// Reset the recovery time to > ICU + hospitalization
-				double t_icu = infection_parameters.at("time in ICU");
-				double t_hsp_icu = infection_parameters.at("time in hospital after ICU");
+				double t_icu = infection_parameters.at(ParameterKeys::time_in_ICU);
+				double t_hsp_icu = infection_parameters.at(ParameterKeys::time_in_hospital_after_ICU);
 				agent.set_time_icu_to_hsp(time + t_icu);
 				agent.set_time_hsp_to_ih(time + t_icu + t_hsp_icu);	
 				agent.set_recovery_duration(t_icu + t_hsp_icu);
@@ -587,13 +590,13 @@ void RegularTransitions::setup_initial_treatment(Agent& agent,
 			states_manager.set_hospitalized(agent);
 			// If dying, set transition to ICU
 			if (agent.dying() == true){
-				double dt_icu = infection_parameters.at("time before death to ICU");
+				double dt_icu = infection_parameters.at(ParameterKeys::time_before_death_to_ICU);
 				double t_icu = std::max(agent.get_time_of_death() - dt_icu, time + dt_icu);
 				agent.set_time_hsp_to_icu(t_icu);	
 			}else{
 				// If recovering, set transition to home
 				double t_rh = agent.get_recovery_time();
-				double del_t_hsp = infection_parameters.at("time in hospital");
+				double del_t_hsp = infection_parameters.at(ParameterKeys::time_in_hospital);
 				double t_hsp = time + del_t_hsp; 
 				if (t_rh > t_hsp){
 					agent.set_time_hsp_to_ih(t_hsp);
@@ -609,7 +612,7 @@ void RegularTransitions::setup_initial_treatment(Agent& agent,
 		states_manager.set_home_isolation(agent);
 		// If dying, set transition to ICU
 		if (agent.dying() == true){
-			double dt_icu = infection_parameters.at("time before death to ICU");
+			double dt_icu = infection_parameters.at(ParameterKeys::time_before_death_to_ICU);
 			double t_icu = std::max(agent.get_time_of_death() - dt_icu, time + dt_icu);
 			agent.set_time_ih_to_icu(t_icu);	
 		}else{
@@ -705,7 +708,7 @@ void RegularTransitions::treatment_transitions(Agent& agent, const double time,
 				}
 				// Set transition back
 				double t_rh = agent.get_recovery_time();
-				double del_t_hsp = infection_parameters.at("time in hospital");
+				double del_t_hsp = infection_parameters.at(ParameterKeys::time_in_hospital);
 				double t_hsp = time + del_t_hsp; 
 				if (t_rh > t_hsp){
 					agent.set_time_hsp_to_ih(t_hsp);
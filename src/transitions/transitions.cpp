@@ -9,7 +9,8 @@
  ******************************************************/
 
 // Implement transitions relevant to susceptible
-std::vector<int> Transitions::susceptible_transitions(Agent& agent, const double time, 
+template <typename Features>
+StateChanges Transitions::susceptible_transitions(Agent& agent, const double time, 
 				const double dt, Infection& infection,	
 				std::vector<Household>& households, std::vector<School>& schools,
 				std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
@@ -17,44 +18,153 @@ std::vector<int> Transitions::susceptible_transitions(Agent& agent, const double
 				const std::map<std::string, double>& infection_parameters, 
 				std::vector<Agent>& agents, Flu& flu, const Testing& testing)
 {
-	// Ingected, tested, negative, false positive 
-	std::vector<int> state_changes(4,0);
-	int got_infected = 0;
-	if (agent.symptomatic_non_covid()){
-		// Currently only symptomatic non-COVID can reach all 4 states
+	StateChanges state_changes = {};
+	if (Features::flu && agent.symptomatic_non_covid()){
+		// Currently only symptomatic non-COVID can be tested
 		state_changes = flu_tr.susceptible_transitions(agent, time, infection,
 				households, schools, workplaces, hospitals, retirement_homes, 
 				infection_parameters, agents, flu, testing, dt);
-	} else if (agent.hospital_employee()){
-		got_infected = hsp_emp_tr.susceptible_transitions(agent, time, infection,
+	} else if (Features::hospitals && agent.hospital_employee()){
+		state_changes.infected = hsp_emp_tr.susceptible_transitions(agent, time, infection,
 				households, schools, hospitals,	infection_parameters, agents, testing);
-		state_changes.at(0) = got_infected;
-	} else if (agent.hospital_non_covid_patient()){
-		got_infected = hsp_pt_tr.susceptible_transitions(agent, time, infection,
+	} else if (Features::hospitals && agent.hospital_non_covid_patient()){
+		state_changes.infected = hsp_pt_tr.susceptible_transitions(agent, time, infection,
 				hospitals, infection_parameters, agents, testing);
-		state_changes.at(0) = got_infected;
 	} else {
-		got_infected = regular_tr.susceptible_transitions(agent, time, infection,
+		state_changes.infected = regular_tr.susceptible_transitions(agent, time, infection,
 				households, schools, workplaces, hospitals, retirement_homes,
 				infection_parameters, agents, flu, testing);
-		state_changes.at(0) = got_infected;
 	}
 	return state_changes;	
 }
 
+// Total lambda of a susceptible agent without flu
+double Transitions::susceptible_lambda(const Agent& agent, const double time, 
+				const std::vector<Household>& households, const std::vector<School>& schools,
+				const std::vector<Workplace>& workplaces, const std::vector<Hospital>& hospitals,
+				const std::vector<RetirementHome>& retirement_homes)
+{
+	if (agent.symptomatic_non_covid()){
+		throw std::invalid_argument("Agent with flu is not handled by susceptible_lambda");
+	}
+	if (agent.hospital_employee()){
+		return hsp_emp_tr.compute_susceptible_lambda(agent, time, households, schools, hospitals)
+					+ agent.get_spatial_lambda();
+	} else if (agent.hospital_non_covid_patient()){
+		return hsp_pt_tr.compute_susceptible_lambda(agent, time, hospitals);
+	} 
+	return regular_tr.compute_susceptible_lambda(agent, time, households, schools, 
+					workplaces, retirement_homes) + agent.get_spatial_lambda();
+}
+
+// 
+// Places counting towards the lambda of a susceptible agent without flu,
+// these follow compute_susceptible_lambda of each transition class
+//
+
+// Household
+int Transitions::susceptible_exposures(const Agent& agent, const Household& house) const
+{
+	if (agent.hospital_non_covid_patient() || 
+			(!agent.hospital_employee() && agent.retirement_home_resident())){
+		return 0;
+	}
+	return (agent.get_household_ID() == house.get_ID()) ? 1 : 0;
+}
+
+// School - as a student and as an employee
+int Transitions::susceptible_exposures(const Agent& agent, const School& school) const
+{
+	int n_exposures = 0;
+	if (agent.hospital_employee()){
+		if (agent.student() && agent.get_school_ID() == school.get_ID()){
+			++n_exposures;
+		}
+	} else if (!agent.hospital_non_covid_patient() && !agent.retirement_home_resident()){
+		if (agent.student() && agent.get_school_ID() == school.get_ID()){
+			++n_exposures;
+		}
+		if (agent.works() && !agent.retirement_home_employee() && agent.school_employee() 
+				&& agent.get_work_ID() == school.get_ID()){
+			++n_exposures;
+		}
+	}
+	return n_exposures;
+}
+
+// Workplace
+int Transitions::susceptible_exposures(const Agent& agent, const Workplace& workplace) const
+{
+	if (agent.hospital_employee() || agent.hospital_non_covid_patient() 
+			|| agent.retirement_home_resident()){
+		return 0;
+	}
+	if (agent.works() && !agent.retirement_home_employee() && !agent.school_employee()
+			&& agent.get_work_ID() == workplace.get_ID()){
+		return 1;
+	}
+	return 0;
+}
+
+// Hospital
+int Transitions::susceptible_exposures(const Agent& agent, const Hospital& hospital) const
+{
+	if (agent.hospital_employee() || agent.hospital_non_covid_patient()){
+		return (agent.get_hospital_ID() == hospital.get_ID()) ? 1 : 0;
+	}
+	return 0;
+}
+
+// Retirement home - as a resident or as an employee
+int Transitions::susceptible_exposures(const Agent& agent, const RetirementHome& rh) const
+{
+	if (agent.hospital_employee() || agent.hospital_non_covid_patient()){
+		return 0;
+	}
+	if (agent.retirement_home_resident()){
+		return (agent.get_household_ID() == rh.get_ID()) ? 1 : 0;
+	}
+	if (agent.works() && agent.retirement_home_employee() && agent.get_work_ID() == rh.get_ID()){
+		return 1;
+	}
+	return 0;
+}
+
+// Set properties of a newly infected agent without flu 
+void Transitions::process_new_infection(Agent& agent, const double time, Infection& infection,	
+				std::vector<School>& schools, std::vector<Workplace>& workplaces, 
+				std::vector<Hospital>& hospitals, std::vector<RetirementHome>& retirement_homes,
+				const std::map<std::string, double>& infection_parameters, 
+				Flu& flu, const Testing& testing)
+{
+	if (agent.symptomatic_non_covid()){
+		throw std::invalid_argument("Agent with flu is not handled by process_new_infection");
+	}
+	if (agent.hospital_employee()){
+		hsp_emp_tr.process_new_infection(agent, time, infection, schools, 
+						hospitals, infection_parameters, testing);
+	} else if (agent.hospital_non_covid_patient()){
+		hsp_pt_tr.process_new_infection(agent, time, infection, hospitals, 
+						infection_parameters, testing);
+	} else {
+		regular_tr.process_new_infection(agent, time, infection, schools, workplaces, 
+						hospitals, retirement_homes, infection_parameters, flu, testing);
+	}
+}
+
 // Implement transitions relevant to exposed 
-std::vector<int> Transitions::exposed_transitions(Agent& agent, Infection& infection, const double time, const double dt, 
+template <typename Features>
+StateChanges Transitions::exposed_transitions(Agent& agent, Infection& infection, const double time, const double dt, 
 										std::vector<Household>& households, std::vector<School>& schools,
 										std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
 										std::vector<RetirementHome>& retirement_homes,
 										const std::map<std::string, double>& infection_parameters, const Testing& testing)
 {
-	// Recovered, dead, tested, tested positive, tested false negative
-	std::vector<int> state_changes(5,0);
-	if (agent.hospital_employee()){
+	StateChanges state_changes = {};
+	if (Features::hospitals && agent.hospital_employee()){
 		state_changes = hsp_emp_tr.exposed_transitions(agent, infection, time, dt, 
 					households, schools, hospitals,	infection_parameters, testing);
-	} else if (agent.hospital_non_covid_patient()){
+	} else if (Features::hospitals && agent.hospital_non_covid_patient()){
 		state_changes = hsp_pt_tr.exposed_transitions(agent, infection, time, dt, 
 					households, hospitals, infection_parameters, testing);
 	} else {
@@ -66,19 +176,19 @@ std::vector<int> Transitions::exposed_transitions(Agent& agent, Infection& infec
 }
 
 // Transitions of a symptomatic agent 
-std::vector<int> Transitions::symptomatic_transitions(Agent& agent, const double time, 
+template <typename Features>
+StateChanges Transitions::symptomatic_transitions(Agent& agent, const double time, 
 				   	const double dt, Infection& infection,
 					std::vector<Household>& households, std::vector<School>& schools,
 					std::vector<Workplace>& workplaces, std::vector<Hospital>& hospitals,
 					std::vector<RetirementHome>& retirement_homes,
 					const std::map<std::string, double>& infection_parameters)
 {
-	// Recovered, dead, tested, tested positive, false negative
-	std::vector<int> state_changes(5,0);
-	if (agent.hospital_employee()){
+	StateChanges state_changes = {};
+	if (Features::hospitals && agent.hospital_employee()){
 		state_changes = hsp_emp_tr.symptomatic_transitions(agent, time, dt, infection,  
 					households, schools, hospitals, infection_parameters);
-	} else if (agent.hospital_non_covid_patient()){
+	} else if (Features::hospitals && agent.hospital_non_covid_patient()){
 		state_changes = hsp_pt_tr.symptomatic_transitions(agent, time, dt, 
 					infection, households, hospitals, infection_parameters);
 	} else {
@@ -89,4 +199,25 @@ std::vector<int> Transitions::symptomatic_transitions(Agent& agent, const double
 	return state_changes; 
 }
 
+//
+// Instantiations for the features of this build 
+//
+
+#define TRANSITIONS_INSTANTIATIONS(FEATURES) \
+	template StateChanges Transitions::susceptible_transitions<FEATURES>(Agent&, const double, \
+				const double, Infection&, std::vector<Household>&, std::vector<School>&, \
+				std::vector<Workplace>&, std::vector<Hospital>&, std::vector<RetirementHome>&, \
+				const std::map<std::string, double>&, std::vector<Agent>&, Flu&, const Testing&); \
+	template StateChanges Transitions::exposed_transitions<FEATURES>(Agent&, Infection&, \
+				const double, const double, std::vector<Household>&, std::vector<School>&, \
+				std::vector<Workplace>&, std::vector<Hospital>&, std::vector<RetirementHome>&, \
+				const std::map<std::string, double>&, const Testing&); \
+	template StateChanges Transitions::symptomatic_transitions<FEATURES>(Agent&, const double, \
+				const double, Infection&, std::vector<Household>&, std::vector<School>&, \
+				std::vector<Workplace>&, std::vector<Hospital>&, std::vector<RetirementHome>&, \
+				const std::map<std::string, double>&);
 
+TRANSITIONS_INSTANTIATIONS(AllFeatures)
+#ifdef ABM_SPECIALIZED_FEATURES
+TRANSITIONS_INSTANTIATIONS(BuildFeatures)
+#endif
@@ -7,3 +7,23 @@ std::string str_to_lower(std::string s)
                   [](unsigned char c){ return std::tolower(c); } );
     return s;
 }
+
+// Position of a point along a Hilbert curve
+std::uint64_t hilbert_curve_index(std::uint32_t x, std::uint32_t y, const int order)
+{
+	std::uint64_t index = 0;
+	for (std::uint64_t s = (std::uint64_t(1) << order) >> 1; s > 0; s >>= 1){
+		const std::uint32_t rx = (x & s) > 0 ? 1 : 0;
+		const std::uint32_t ry = (y & s) > 0 ? 1 : 0;
+		index += s*s*((3*rx)^ry);
+		// Rotate the quadrant 
+		if (ry == 0){
+			if (rx == 1){
+				x = static_cast<std::uint32_t>(s - 1 - x);
+				y = static_cast<std::uint32_t>(s - 1 - y);
+			}
+			std::swap(x, y);
+		}
+	}
+	return index;
+}
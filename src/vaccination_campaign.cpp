@@ -0,0 +1,175 @@
+#include "../include/vaccination_campaign.h"
+
+/*****************************************************
+ * class: VaccinationCampaign
+ *
+ * Daily dose schedules for prioritized groups of
+ * agents
+ *
+ *****************************************************/
+
+// Add a group, after all the groups with higher priority
+void VaccinationCampaign::add_group(const std::string& name, const group_type type, 
+										const int min_age, const int max_age)
+{
+	if (min_age < 0 || max_age < min_age){
+		throw std::invalid_argument("Wrong age range of vaccination group: " + name);
+	}
+	if (!phases.empty()){
+		throw std::invalid_argument("Vaccination groups need to be added before the phases");
+	}
+	Group group;
+	group.name = name;
+	group.type = type;
+	group.min_age = min_age;
+	group.max_age = max_age;
+	groups.push_back(group);
+	n_vaccinated.push_back(0);
+}
+
+// Add a phase of the campaign
+void VaccinationCampaign::add_phase(const double start, const double end, const double daily_doses, 
+										const std::vector<double>& quotas)
+{
+	if (end <= start || daily_doses < 0.0){
+		throw std::invalid_argument("Wrong interval or number of doses of a vaccination phase");
+	}
+	if (quotas.size() != groups.size()){
+		throw std::invalid_argument("Vaccination phase needs one quota per group");
+	}
+	double total = 0.0;
+	for (const auto& quota : quotas){
+		if (quota < 0.0){
+			throw std::invalid_argument("Quota of a vaccination group cannot be negative");
+		}
+		total += quota;
+	}
+	if (total > 1.0 + 1e-10){
+		throw std::invalid_argument("Quotas of a vaccination phase sum to more than 1");
+	}
+	Phase phase;
+	phase.start = start;
+	phase.end = end;
+	phase.daily_doses = daily_doses;
+	phase.quotas = quotas;
+	phases.push_back(phase);
+}
+
+// Vaccinate the agents of this step
+int VaccinationCampaign::vaccinate(std::vector<Agent>& agents, const std::vector<bool>& local, 
+									const double time, const double dt)
+{
+	if (!pools_created){
+		create_pools(agents, local);
+	}
+
+	// Doses of all the phases active at this time
+	const double tol = 1e-10;
+	std::vector<int> group_doses(groups.size(), 0);
+	double doses = carried_doses;
+	std::vector<double> quota_doses(groups.size(), 0.0);
+	for (const auto& phase : phases){
+		if (time + tol < phase.start || time + tol >= phase.end){
+			continue;
+		}
+		doses += phase.daily_doses*dt;
+		for (int ig = 0; ig < groups.size(); ++ig){
+			quota_doses.at(ig) += phase.quotas.at(ig)*phase.daily_doses*dt;
+		}
+	}
+	const int n_doses = static_cast<int>(doses + tol);
+	if (n_doses == 0){
+		carried_doses = doses;
+		return 0;
+	}
+
+	// Quotas first, then the remaining doses by priority
+	int n_given = 0;
+	const double scale = n_doses/doses;
+	for (int ig = 0; ig < groups.size(); ++ig){
+		const int n_quota = std::min(static_cast<int>(quota_doses.at(ig)*scale + tol), n_doses - n_given);
+		n_given += vaccinate_group(agents, ig, n_quota);
+	}
+	for (int ig = 0; ig < groups.size() && n_given < n_doses; ++ig){
+		n_given += vaccinate_group(agents, ig, n_doses - n_given);
+	}
+
+	// Doses that could not be given are not carried over
+	carried_doses = doses - n_doses;
+	return n_given;
+}
+
+// Vaccinate up to n members of a group
+int VaccinationCampaign::vaccinate_group(std::vector<Agent>& agents, const int group, const int n)
+{
+	std::vector<int>& pool = pools.at(group);
+	// Members with flu are moved past the end for this step
+	std::size_t end = pool.size();
+	int n_given = 0;
+	while (n_given < n && end > 0){
+		const int pick = rng.get_random_int(0, end - 1);
+		Agent& agent = agents.at(pool.at(pick) - 1);
+		if (agent.symptomatic_non_covid() && !agent.infected() && !agent.removed() && !agent.vaccinated()){
+			std::swap(pool.at(pick), pool.at(--end));
+			continue;
+		}
+		if (!agent.infected() && !agent.removed() && !agent.vaccinated()){
+			agent.set_vaccinated(true);
+			++n_given;
+		}
+		// Drawn without replacement, not eligible later 
+		std::swap(pool.at(pick), pool.at(--end));
+		std::swap(pool.at(end), pool.back());
+		pool.pop_back();
+	}
+	n_vaccinated.at(group) += n_given;
+	return n_given;
+}
+
+// Create the pools of all the groups
+void VaccinationCampaign::create_pools(const std::vector<Agent>& agents, const std::vector<bool>& local)
+{
+	pools.assign(groups.size(), {});
+	for (const auto& agent : agents){
+		if (!local.empty() && !local.at(agent.get_ID()-1)){
+			continue;
+		}
+		for (int ig = 0; ig < groups.size(); ++ig){
+			if (in_group(agent, groups.at(ig))){
+				pools.at(ig).push_back(agent.get_ID());
+			}
+		}
+	}
+	pools_created = true;
+}
+
+// True if the agent belongs to the group
+bool VaccinationCampaign::in_group(const Agent& agent, const Group& group) const
+{
+	if (agent.get_age() < group.min_age || agent.get_age() > group.max_age){
+		return false;
+	}
+	switch (group.type){
+		case population:
+			return true;
+		case hospital_employees:
+			return agent.hospital_employee();
+		case school_employees:
+			return agent.school_employee();
+		case retirement_home_employees:
+			return agent.retirement_home_employee();
+		case retirement_home_residents:
+			return agent.retirement_home_resident();
+	}
+	return false;
+}
+
+// Number of agents left in the pool of each group
+std::vector<int> VaccinationCampaign::get_pool_sizes() const
+{
+	std::vector<int> sizes;
+	for (const auto& pool : pools){
+		sizes.push_back(pool.size());
+	}
+	return sizes;
+}
@@ -0,0 +1,246 @@
+#include "abm_tests.h"
+#include <new>
+#include <cstdlib>
+#include <type_traits>
+
+/*****************************************************
+ *
+ * Test suite for the memory allocations of the 
+ * time step
+ *
+ * Replaces the global operator new to count the
+ * allocations, needs its own executable
+ *
+******************************************************/
+
+// Number of calls to operator new
+static long n_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+	++n_allocations;
+	void* ptr = std::malloc(size > 0 ? size : 1);
+	if (ptr == nullptr){
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+// Tests
+bool allocations_per_step_test();
+bool scratch_memory_test();
+bool spatial_scratch_test();
+
+// Supporting functions
+ABM create_abm(const double dt, int i0);
+
+int main()
+{
+	test_pass(allocations_per_step_test(), "Allocations independent of the number of agents");
+	test_pass(scratch_memory_test(), "Memory for temporaries of a time step");
+	test_pass(spatial_scratch_test(), "Temporaries of the spatial transmission");
+}
+
+/// Transitions report their results without allocations, so 
+/// a step allocates only a few times however many agents change 
+/// their state; the step when testing starts is not checked 
+bool allocations_per_step_test()
+{
+	static_assert(std::is_pod<StateChanges>::value, "Results of the transitions need to be POD");
+
+	const int n_steps = 120;
+	// At most per step, independent of the number of agents
+	const long max_per_step = 32;
+	ABM abm = create_abm(0.25, 200);
+	abm.set_random_seed(2021);
+	const double start_testing = abm.get_infection_parameters().at("start testing");
+
+	int max_infected = 0, max_tested = 0;
+	for (int ti = 0; ti < n_steps; ++ti){
+		const bool testing_starts = float_equality<double>(abm.get_time(), start_testing, 1e-3);
+		const int n_tested = abm.get_total_tested();
+		const long n_before = n_allocations;
+		abm.transmit_infection();
+		const long n_step = n_allocations - n_before;
+		if (!testing_starts && n_step > max_per_step){
+			std::cerr << "Number of allocations at step " << ti << ": " << n_step
+					  << " with " << abm.get_num_infected() << " infected" << std::endl;
+			return false;
+		}
+		max_infected = std::max(max_infected, abm.get_num_infected());
+		max_tested = std::max(max_tested, abm.get_total_tested() - n_tested);
+	}
+
+	// The steps need to have many agents changing their state
+	if (max_infected < 1000 || max_tested < 10){
+		std::cerr << "Too few infected or tested agents for a meaningful test" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Arena memory is reused after a reset without allocating, and
+/// the temporaries of the vaccination come from the arena of the model
+bool scratch_memory_test()
+{
+	MemoryArena arena(256);
+	std::vector<char*> chunks;
+	chunks.reserve(21);
+	auto fill = [&arena, &chunks]()
+		{
+			chunks.clear();
+			for (int i = 1; i <= 20; ++i){
+				chunks.push_back(static_cast<char*>(arena.allocate(8*i + 1, alignof(double))));
+			}
+			chunks.push_back(static_cast<char*>(arena.allocate(1000)));
+			ArenaVector<int> values{ArenaAllocator<int>(arena)};
+			for (int i = 0; i < 100; ++i){
+				values.push_back(i);
+			}
+		};
+	fill();
+	for (std::size_t i = 0; i < chunks.size(); ++i){
+		if (reinterpret_cast<std::uintptr_t>(chunks.at(i)) % alignof(double) != 0){
+			std::cerr << "Misaligned arena memory" << std::endl;
+			return false;
+		}
+		// Memory of the other chunks not overwritten
+		std::memset(chunks.at(i), static_cast<int>(i), i < 20 ? 8*(i + 1) + 1 : 1000);
+	}
+	for (std::size_t i = 0; i < 20; ++i){
+		if (chunks.at(i)[8*i] != static_cast<char>(i)){
+			std::cerr << "Overlapping arena memory" << std::endl;
+			return false;
+		}
+	}
+	const std::size_t peak = arena.get_peak_bytes();
+	const long n_blocks = arena.get_number_of_blocks_allocated();
+	if (peak < 1000 + 400 || arena.get_bytes_used() != peak || arena.get_capacity() < peak){
+		std::cerr << "Wrong arena usage" << std::endl;
+		return false;
+	}
+
+	// Same requests after a reset
+	arena.reset();
+	const long n_before = n_allocations;
+	fill();
+	if (n_allocations != n_before || arena.get_number_of_blocks_allocated() != n_blocks 
+			|| arena.get_peak_bytes() != peak){
+		std::cerr << "Arena allocated again after a reset" << std::endl;
+		return false;
+	}
+
+	const MemoryArena copy(arena);
+	MemoryArena moved(std::move(arena));
+	if (copy.get_capacity() != 0 || moved.get_capacity() < peak || arena.get_capacity() != 0){
+		std::cerr << "Wrong copy or move of an arena" << std::endl;
+		return false;
+	}
+	const std::invalid_argument err("Wrong alignment");
+	if (!exception_test(false, &err, [&moved](){ moved.allocate(4, 3); })){
+		std::cerr << "Wrong alignment accepted" << std::endl;
+		return false;
+	}
+
+	// Huge pages if available, regular memory otherwise
+	MemoryArena huge(1 << 10, true);
+	int* value = static_cast<int*>(huge.allocate(sizeof(int), alignof(int)));
+	*value = 7;
+	if (*value != 7 || !huge.requests_huge_pages() || moved.huge_pages_advised()){
+		std::cerr << "Wrong arena with huge pages" << std::endl;
+		return false;
+	}
+
+	// Candidates for vaccination
+	ABM abm = create_abm(0.25, 200);
+	abm.set_random_seed(2021);
+	abm.set_random_vaccination(500);
+	const double start_testing = abm.get_infection_parameters().at("start testing");
+	while (abm.get_time() <= start_testing){
+		abm.transmit_infection();
+	}
+	const MemoryArena& scratch = abm.get_scratch_memory();
+	if (scratch.get_peak_bytes() < abm.get_vector_of_agents().size()*sizeof(int) 
+			|| scratch.get_bytes_used() != 0 || scratch.get_number_of_allocations() != 1){
+		std::cerr << "Vaccination temporaries not in the arena of the model" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Temporaries of the spatial transmission, of the size of the
+/// population, come from the arena of the model and a step 
+/// allocates only a few times
+bool spatial_scratch_test()
+{
+	const int n_steps = 40;
+	const long max_per_step = 32;
+	ABM abm = create_abm(0.25, 200);
+	abm.set_random_seed(2021);
+	abm.set_spatial_transmission(0.05, 0.002, 2.0, 0.005, true);
+	const double start_testing = abm.get_infection_parameters().at("start testing");
+
+	std::size_t max_peak = 0;
+	for (int ti = 0; ti < n_steps; ++ti){
+		const bool testing_starts = float_equality<double>(abm.get_time(), start_testing, 1e-3);
+		const long n_before = n_allocations;
+		abm.transmit_infection();
+		const long n_step = n_allocations - n_before;
+		if (!testing_starts && ti > 0 && n_step > max_per_step){
+			std::cerr << "Number of allocations at step " << ti << " with spatial transmission: " 
+					  << n_step << std::endl;
+			return false;
+		}
+		max_peak = std::max(max_peak, abm.get_scratch_memory().get_peak_bytes());
+	}
+	if (max_peak < 2*abm.get_vector_of_agents().size()*sizeof(int) 
+			|| abm.get_scratch_memory().get_bytes_used() != 0){
+		std::cerr << "Spatial temporaries not in the arena of the model" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+ABM create_abm(const double dt, int inf0)
+{
+	// Input files
+	std::string fin("test_data/NR_agents.txt");
+	std::string hfile("test_data/NR_households.txt");
+	std::string sfile("test_data/NR_schools.txt");
+	std::string wfile("test_data/NR_workplaces.txt");
+	std::string hsp_file("test_data/NR_hospitals.txt");
+	std::string rh_file("test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles =
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name},
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with testing changes
+	std::string tfname("test_data/tests_with_time.txt");
+
+	ABM abm(dt, pfname, dfiles, tfname);
+
+	// First the places
+	abm.create_households(hfile);
+	abm.create_schools(sfile);
+	abm.create_workplaces(wfile);
+	abm.create_hospitals(hsp_file);
+	abm.create_retirement_homes(rh_file);
+
+	// Then the agents
+	abm.create_agents(fin, inf0);
+
+	return abm;
+}
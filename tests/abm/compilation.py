@@ -10,11 +10,21 @@ path = '../../src/'
 cx = 'g++'
 std = '-std=c++11'
 opt = '-O0'
+threads = '-pthread'
 # Common source files
 src_files = path + 'abm.cpp' 
 src_files += ' ' + path + 'agent.cpp' 
 src_files += ' ' + path + 'infection.cpp'
 src_files += ' ' + path + 'testing.cpp'
+src_files += ' ' + path + 'interventions.cpp'
+src_files += ' ' + path + 'spatial_transmission.cpp'
+src_files += ' ' + path + 'vaccination_campaign.cpp'
+src_files += ' ' + path + 'metrics.cpp'
+src_files += ' ' + path + 'lineage_log.cpp'
+src_files += ' ' + path + 'memory_arena.cpp'
+src_files += ' ' + path + 'io_operations/state_snapshots.cpp'
+src_files += ' ' + path + 'io_operations/input_validator.cpp'
+src_files += ' ' + path + 'shared_population/population_segment.cpp'
 src_files += ' ' + path + 'contributions.cpp'
 src_files += ' ' + path + 'transitions/transitions.cpp'
 src_files += ' ' + path + 'transitions/regular_transitions.cpp'
@@ -27,6 +37,7 @@ src_files += ' ' + path + 'states_manager/hsp_employee_states_manager.cpp'
 src_files += ' ' + path + 'flu.cpp'
 src_files += ' ' + path + 'utils.cpp'
 src_files += ' ' + path + 'places/place.cpp'
+src_files += ' ' + path + 'places/roster.cpp'
 src_files += ' ' + path + 'places/household.cpp'
 src_files += ' ' + path + 'places/workplace.cpp'
 src_files += ' ' + path + 'places/school.cpp'
@@ -58,8 +69,8 @@ for file_rm in const_files:
 # Name of the executable
 exe_name = 'con_test'
 # Files needed only for this build
-spec_files = 'construction_test.cpp '
-compile_com = ' '.join([cx, std, opt, '-o', exe_name, spec_files, tst_files, src_files])
+spec_files = 'construction_test.cpp ' + path + 'parameter_sweep/work_stealing_pool.cpp '
+compile_com = ' '.join([cx, std, opt, threads, '-o', exe_name, spec_files, tst_files, src_files])
 subprocess.call([compile_com], shell=True)
 
 # Test 2
@@ -70,3 +81,41 @@ exe_name = 'trans_inf_test'
 spec_files = 'infection_transmission.cpp '
 compile_com = ' '.join([cx, std, opt, '-o', exe_name, spec_files, tst_files, src_files])
 subprocess.call([compile_com], shell=True)
+
+# Test 3
+# Build specialized with the compile-time model features
+# Name of the executable
+exe_name = 'features_test'
+# Files needed only for this build
+spec_files = 'model_features_test.cpp '
+compile_com = ' '.join([cx, std, opt, '-DABM_TOTALS_ONLY', '-o', exe_name, spec_files, tst_files, src_files])
+subprocess.call([compile_com], shell=True)
+
+# Test 4
+# Memory allocations of the time step
+# Name of the executable
+exe_name = 'alloc_test'
+# Files needed only for this build
+spec_files = 'allocation_test.cpp '
+compile_com = ' '.join([cx, std, opt, '-o', exe_name, spec_files, tst_files, src_files])
+subprocess.call([compile_com], shell=True)
+
+# Test 5
+# Stream of agent state snapshots
+# Name of the executable
+exe_name = 'snapshot_test'
+# Files needed only for this build
+spec_files = 'snapshot_test.cpp '
+compile_com = ' '.join([cx, std, opt, '-o', exe_name, spec_files, tst_files, src_files])
+subprocess.call([compile_com], shell=True)
+
+# Test 6
+# Construction and transmission with event times stored as time steps
+exe_name = 'con_steps_test'
+spec_files = 'construction_test.cpp ' + path + 'parameter_sweep/work_stealing_pool.cpp '
+compile_com = ' '.join([cx, std, opt, threads, '-DABM_STEP_TIMES', '-o', exe_name, spec_files, tst_files, src_files])
+subprocess.call([compile_com], shell=True)
+exe_name = 'trans_inf_steps_test'
+spec_files = 'infection_transmission.cpp '
+compile_com = ' '.join([cx, std, opt, '-DABM_STEP_TIMES', '-o', exe_name, spec_files, tst_files, src_files])
+subprocess.call([compile_com], shell=True)
@@ -1,4 +1,5 @@
 #include "abm_tests.h"
+#include "../../include/parameter_sweep/work_stealing_pool.h"
 
 /***************************************************** 
  *
@@ -15,6 +16,11 @@ bool create_hospitals_test();
 bool create_retirement_homes_test();
 bool create_agents_test();
 bool create_agents_file_test();
+bool reorder_for_locality_test();
+bool input_validation_test();
+bool input_validator_chunks_test();
+bool roster_layout_test();
+bool step_length_test();
 
 // Supporting functions
 bool compare_places_files(std::string fname_in, std::string fname_out, 
@@ -26,6 +32,7 @@ bool correctly_registered(const ABM, const std::vector<std::vector<int>>,
 bool check_initially_infected(const Agent& agent, const Flu& flu, int& n_exposed_never_sy,
 								const std::map<std::string, double> infection_parameters);
 bool check_fractions(int, int, double, std::string);
+bool same_file_contents(const std::string fname_1, const std::string fname_2);
 
 int main()
 {
@@ -37,6 +44,11 @@ int main()
 	test_pass(create_retirement_homes_test(), "Retirement homes creation");
 	test_pass(create_agents_test(), "Agent creation");
 	test_pass(create_agents_file_test(), "Agent creation - file test");
+	test_pass(reorder_for_locality_test(), "Reordering of agents and places");
+	test_pass(input_validation_test(), "Validation of the input");
+	test_pass(input_validator_chunks_test(), "Input validation in chunks");
+	test_pass(roster_layout_test(), "Rosters of places in one buffer per type");
+	test_pass(step_length_test(), "Time step held by the models");
 }
 
 // Checks household creation from file
@@ -276,6 +288,457 @@ bool create_retirement_homes_test()
 	return true;
 }
 
+// Checks consistency of references and outputs after reordering
+bool reorder_for_locality_test()
+{
+	double dt = 0.25;
+	int inf0 = 100;
+	// Input files
+	std::string fin("test_data/NR_agents.txt");
+	std::string hfile("test_data/NR_households.txt");
+	std::string sfile("test_data/NR_schools.txt");
+	std::string wfile("test_data/NR_workplaces.txt");
+	std::string hsp_file("test_data/NR_hospitals.txt");
+	std::string rh_file("test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles = 
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name}, 
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with 	
+	std::string tfname("test_data/tests_with_time.txt");
+
+	ABM abm(dt, pfname, dfiles, tfname);
+	abm.create_households(hfile);
+	abm.create_schools(sfile);
+	abm.create_workplaces(wfile);
+	abm.create_hospitals(hsp_file);
+	abm.create_retirement_homes(rh_file);
+	abm.create_agents(fin, inf0);
+
+	// Reference in the input order
+	ABM reference(abm);
+	abm.reorder_for_locality();
+
+	const std::vector<Agent>& agents = abm.get_vector_of_agents();
+	const std::vector<Agent>& ref_agents = reference.get_vector_of_agents();
+	const std::vector<Household>& households = abm.get_vector_of_households();
+	const std::vector<School>& schools = abm.get_vector_of_schools();
+	const std::vector<Workplace>& workplaces = abm.get_vector_of_workplaces();
+	const std::vector<Hospital>& hospitals = abm.get_vector_of_hospitals();
+	const std::vector<RetirementHome>& retirement_homes = abm.get_vector_of_retirement_homes();
+
+	if (agents.size() != ref_agents.size()){
+		std::cerr << "Wrong number of agents after reordering" << std::endl;
+		return false;
+	}
+	std::vector<bool> found(agents.size(), false);
+	for (const auto& agent : agents){
+		const int aID = agent.get_ID();
+		const Agent& ref_agent = ref_agents.at(abm.get_external_agent_ID(aID)-1);
+		found.at(ref_agent.get_ID()-1) = true;
+		if (agent.get_age() != ref_agent.get_age() || agent.infected() != ref_agent.infected()
+				|| !float_equality<double>(agent.get_x_location(), ref_agent.get_x_location(), 1e-10)){
+			std::cerr << "Agent " << aID << " does not correspond to its input agent" << std::endl;
+			return false;
+		}
+		// Registered where the agent refers to
+		if (agent.hospital_non_covid_patient() || agent.hospital_employee()){
+			if (!find_in_place<Hospital>(hospitals, aID, agent.get_hospital_ID())){
+				std::cerr << "Agent not registered in a hospital after reordering" << std::endl;
+				return false;
+			}
+		}
+		if (agent.retirement_home_resident()){
+			if (!find_in_place<RetirementHome>(retirement_homes, aID, agent.get_household_ID())){
+				std::cerr << "Agent not registered in a retirement home after reordering" << std::endl;
+				return false;
+			}
+		} else if (!agent.hospital_non_covid_patient()){
+			if (!find_in_place<Household>(households, aID, agent.get_household_ID())){
+				std::cerr << "Agent not registered in a household after reordering" << std::endl;
+				return false;
+			}
+		}
+		if (agent.student() && !find_in_place<School>(schools, aID, agent.get_school_ID())){
+			std::cerr << "Agent not registered in a school after reordering" << std::endl;
+			return false;
+		}
+		if (agent.works() && !agent.retirement_home_employee() && !agent.school_employee()
+				&& !find_in_place<Workplace>(workplaces, aID, agent.get_work_ID())){
+			std::cerr << "Agent not registered in a workplace after reordering" << std::endl;
+			return false;
+		}
+	}
+	if (std::find(found.begin(), found.end(), false) != found.end()){
+		std::cerr << "Input agents missing after reordering" << std::endl;
+		return false;
+	}
+
+	// Members of a household are next to each other
+	for (const auto& house : households){
+		const Roster& members = house.get_agent_IDs_ref();
+		if (!members.empty() && members.back() - members.front() + 1 != members.size()){
+			std::cerr << "Household " << house.get_ID() << " members not contiguous" << std::endl;
+			return false;
+		}
+	}
+
+	// Outputs identical to those without reordering
+	std::vector<std::string> out_files = {"test_data/reordered_out.txt", "test_data/reference_out.txt"};
+	abm.print_households(out_files.at(0));
+	reference.print_households(out_files.at(1));
+	bool same_output = same_file_contents(out_files.at(0), out_files.at(1));
+	abm.print_agents_in_schools(out_files.at(0));
+	reference.print_agents_in_schools(out_files.at(1));
+	same_output = same_output && same_file_contents(out_files.at(0), out_files.at(1));
+	abm.print_agents(out_files.at(0));
+	reference.print_agents(out_files.at(1));
+	same_output = same_output && same_file_contents(out_files.at(0), out_files.at(1));
+	for (const auto& fname : out_files){
+		std::remove(fname.c_str());
+	}
+	if (!same_output){
+		std::cerr << "Printed outputs differ after reordering" << std::endl;
+		return false;
+	}
+
+	// Not allowed once the simulation started
+	abm.transmit_infection();
+	if (!exception_test(false, new std::runtime_error("Reordering after start"), 
+			[&abm](){ abm.reorder_for_locality(); })){
+		std::cerr << "Failed to throw when reordering during the simulation" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// True if two files have identical contents
+// Rosters are contiguous, the same with any order of registration tasks, 
+// and still contiguous after reordering
+bool roster_layout_test()
+{
+	double dt = 0.25;
+	// Input files
+	std::string fin("test_data/NR_agents.txt");
+	std::string hfile("test_data/NR_households.txt");
+	std::string sfile("test_data/NR_schools.txt");
+	std::string wfile("test_data/NR_workplaces.txt");
+	std::string hsp_file("test_data/NR_hospitals.txt");
+	std::string rh_file("test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles = 
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name}, 
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with 	
+	std::string tfname("test_data/tests_with_time.txt");
+
+	std::vector<ABM> models;
+	for (const bool reversed : {false, true}){
+		ABM abm(dt, pfname, dfiles, tfname);
+		abm.create_households(hfile);
+		abm.create_schools(sfile);
+		abm.create_workplaces(wfile);
+		abm.create_hospitals(hsp_file);
+		abm.create_retirement_homes(rh_file);
+		if (reversed){
+			abm.set_registration_executor([](int n_tasks, const std::function<void(int)>& task){
+					for (int i = n_tasks - 1; i >= 0; --i){
+						task(i);
+					}
+				});
+		}
+		abm.create_agents(fin, 10);
+		models.push_back(abm);
+	}
+
+	// One buffer with an entry per registration
+	auto contiguous = [](const std::vector<Household>& places){
+			for (int i = 0; i < places.size(); ++i){
+				const Roster& roster = places.at(i).get_agent_IDs_ref();
+				if (!roster.shares_buffer() 
+						|| (i > 0 && roster.begin() != places.at(i-1).get_agent_IDs_ref().end())){
+					return false;
+				}
+			}
+			return true;
+		};
+	const std::vector<Household>& households = models.at(0).get_vector_of_households();
+	int n_registered = 0;
+	for (const auto& house : households){
+		n_registered += house.get_agent_IDs_ref().size();
+	}
+	if (!contiguous(households) || n_registered != households.back().get_agent_IDs_ref().end() 
+			- households.front().get_agent_IDs_ref().begin()){
+		std::cerr << "Household rosters not in one buffer" << std::endl;
+		return false;
+	}
+	const std::vector<School>& schools = models.at(0).get_vector_of_schools();
+	const std::vector<School>& rev_schools = models.at(1).get_vector_of_schools();
+	for (int i = 0; i < schools.size(); ++i){
+		if (schools.at(i).get_agent_IDs_ref() != rev_schools.at(i).get_agent_IDs_ref()){
+			std::cerr << "Rosters depend on the order of registration" << std::endl;
+			return false;
+		}
+	}
+
+	models.at(1).reorder_for_locality();
+	if (!contiguous(models.at(1).get_vector_of_households())){
+		std::cerr << "Household rosters not in one buffer after reordering" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Consistent input passes, all inconsistencies are reported at once
+bool input_validation_test()
+{
+	double dt = 0.25;
+	// Input files
+	std::string fin("test_data/NR_agents.txt");
+	std::string fin_wrong("test_data/NR_agents_inconsistent.txt");
+	std::string hfile("test_data/NR_households.txt");
+	std::string sfile("test_data/NR_schools.txt");
+	std::string wfile("test_data/NR_workplaces.txt");
+	std::string hsp_file("test_data/NR_hospitals.txt");
+	std::string rh_file("test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles = 
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name}, 
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with 	
+	std::string tfname("test_data/tests_with_time.txt");
+
+	// Input with inconsistent lines - line number and its new columns
+	std::map<int, std::map<int, std::string>> changes = 
+		{ {100, {{7, "3"}}}, {902, {{7, "500"}}}, {5000, {{1, "2"}}}, 
+		  {20000, {{5, "0"}}}, {40000, {{2, "-3"}, {3, "nan"}}} };
+	{
+		std::ifstream in(fin);
+		std::ofstream out(fin_wrong);
+		std::string line;
+		int line_num = 0;
+		while (std::getline(in, line)){
+			++line_num;
+			if (changes.find(line_num) != changes.end()){
+				std::istringstream fields(line);
+				std::vector<std::string> columns{std::istream_iterator<std::string>(fields), 
+											std::istream_iterator<std::string>()};
+				for (const auto& change : changes.at(line_num)){
+					columns.at(change.first) = change.second;
+				}
+				line.clear();
+				for (const auto& col : columns){
+					line += col + " ";
+				}
+			}
+			out << line << "\n";
+		}
+	}
+
+	for (const bool consistent : {true, false}){
+		ABM abm(dt, pfname, dfiles, tfname);
+		abm.create_households(hfile);
+		abm.create_schools(sfile);
+		abm.create_workplaces(wfile);
+		abm.create_hospitals(hsp_file);
+		abm.create_retirement_homes(rh_file);
+		// Chunks in reverse order
+		abm.set_input_validation(true, [](int n_tasks, const std::function<void(int)>& task){
+				for (int i = n_tasks - 1; i >= 0; --i){
+					task(i);
+				}
+			});
+
+		if (consistent){
+			abm.create_agents(fin);
+			const InputReport& report = abm.get_input_report();
+			if (!report.passed() || abm.get_vector_of_agents().size() != 79205){
+				std::cerr << "Consistent input not accepted:\n" << report.summary() << std::endl;
+				return false;
+			}
+			if (report.get_students() != 18255 || report.get_workers() != 39389 
+					|| report.get_infected() != 1){
+				std::cerr << "Wrong numbers of students, workers, or infected" << std::endl;
+				return false;
+			}
+			continue;
+		}
+
+		const std::invalid_argument invarg("Inconsistent input");
+		if (!exception_test(false, &invarg, &ABM::create_agents, abm, fin_wrong, 0)){
+			std::cerr << "Inconsistent input not recognized as an error" << std::endl;
+			return false;
+		}
+		const InputReport& report = abm.get_input_report();
+		const std::vector<int> expected_IDs = {100, 902, 5000, 20000, 40000, 40000};
+		std::vector<int> IDs;
+		for (const auto& error : report.get_errors()){
+			IDs.push_back(error.ID);
+		}
+		if (IDs != expected_IDs || report.count(InputReport::value_range) != 2 
+				|| report.count(InputReport::place_reference) != 2
+				|| report.count(InputReport::role_flags) != 1
+				|| report.count(InputReport::coordinates) != 1){
+			std::cerr << "Wrong inconsistencies reported:\n" << report.summary() << std::endl;
+			return false;
+		}
+		if (!abm.get_vector_of_agents().empty()){
+			std::cerr << "Agents created from inconsistent input" << std::endl;
+			return false;
+		}
+	}
+	std::remove(fin_wrong.c_str());
+	return true;
+}
+
+// Places, bounds, and the same report for any chunks, their order, 
+// and chunks checked at the same time on threads
+bool input_validator_chunks_test()
+{
+	typedef PopulationSegment PS;
+	const int n_agents = 7;
+	// Columns in order of PopulationSegment::agent_column
+	std::vector<std::vector<std::int32_t>> columns = {
+		{0, 1, 0, 0, 0, 1, 0},				// student
+		{1, 0, 0, 1, 1, 0, 1},				// works
+		{30, 10, 80, 45, 50, 12, 33},		// age
+		{1, 2, 1, 3, 2, 1, 2},				// household ID
+		{0, 0, 0, 0, 0, 0, 0},				// non-COVID patient
+		{0, 1, 0, 0, 0, 2, 0},				// school ID
+		{0, 0, 1, 0, 0, 0, 0},				// retirement home resident
+		{0, 0, 0, 0, 1, 0, 0},				// retirement home employee
+		{0, 0, 0, 0, 0, 0, 0},				// school employee
+		{1, 0, 0, 1, 2, 0, 1},				// work ID
+		{0, 0, 0, 0, 0, 0, 1},				// hospital employee
+		{0, 0, 0, 0, 0, 0, 1},				// hospital ID
+		{0, 0, 0, 1, 0, 0, 0}};				// infected
+	std::vector<std::int32_t> values;
+	for (const auto& col : columns){
+		values.insert(values.end(), col.begin(), col.end());
+	}
+	const std::vector<double> x = {0.5, 0.5, 1.5, 2.5, 0.5, 3.5, 0.5};
+	const std::vector<double> y = {0.5, 0.5, 1.5, 2.5, 0.5, 0.5, 0.5};
+
+	InputValidator validator;
+	validator.set_places(PS::households, {1, 2, 4}, {0.5, 0.5, 2.5}, {0.5, 0.5, 2.5});
+	validator.set_places(PS::retirement_homes, {1}, {1.5}, {1.5});
+	validator.set_places(PS::schools, {1}, {0.0}, {5.0});
+	validator.set_places(PS::workplaces, {1}, {1.0}, {1.0});
+	validator.set_places(PS::hospitals, {1}, {0.0}, {0.0});
+	validator.set_bounds(0.0, 3.0, 0.0, 3.0);
+
+	// Household 3 out of order, school outside of the bounds,
+	// agent 5 works in a missing retirement home, agent 6 goes 
+	// to a missing school and is outside of the bounds
+	const std::vector<int> expected_IDs = {3, 1, 5, 6, 6};
+	const InputReport serial = validator.validate(n_agents, values.data(), x.data(), y.data());
+	std::vector<int> IDs;
+	for (const auto& error : serial.get_errors()){
+		IDs.push_back(error.ID);
+	}
+	if (IDs != expected_IDs || serial.get_students() != 2 || serial.get_workers() != 4 
+			|| serial.get_infected() != 1){
+		std::cerr << "Wrong report of the validator:\n" << serial.summary() << std::endl;
+		return false;
+	}
+
+	for (const int chunk : {1, 2, 3, 100}){
+		validator.set_chunk_size(chunk);
+		validator.set_executor([](int n_tasks, const std::function<void(int)>& task){
+				for (int i = n_tasks - 1; i >= 0; --i){
+					task(i);
+				}
+			});
+		const InputReport report = validator.validate(n_agents, values.data(), x.data(), y.data());
+		if (report.summary(100) != serial.summary(100) || report.get_workers() != serial.get_workers()){
+			std::cerr << "Report depends on the chunks" << std::endl;
+			return false;
+		}
+	}
+
+	// Many copies of the agents, checked in chunks on threads
+	const int n_copies = 2000;
+	std::vector<std::int32_t> copies;
+	for (const auto& col : columns){
+		for (int ic = 0; ic < n_copies; ++ic){
+			copies.insert(copies.end(), col.begin(), col.end());
+		}
+	}
+	std::vector<double> x_copies, y_copies;
+	for (int ic = 0; ic < n_copies; ++ic){
+		x_copies.insert(x_copies.end(), x.begin(), x.end());
+		y_copies.insert(y_copies.end(), y.begin(), y.end());
+	}
+	const int n_copied = n_agents*n_copies;
+	validator.set_chunk_size(50);
+	validator.set_executor(InputValidator::executor());
+	const InputReport serial_copies = validator.validate(n_copied, copies.data(), 
+											x_copies.data(), y_copies.data());
+	WorkStealingPool pool(4);
+	validator.set_executor([&pool](int n_tasks, const std::function<void(int)>& task){
+			pool.run(n_tasks, task);
+		});
+	const InputReport threaded = validator.validate(n_copied, copies.data(), 
+											x_copies.data(), y_copies.data());
+	const int n_errors = 2 + 3*n_copies;
+	if (threaded.get_errors().size() != n_errors || threaded.summary(n_errors) != serial_copies.summary(n_errors)
+			|| threaded.get_students() != n_copies*serial.get_students()
+			|| threaded.get_workers() != n_copies*serial.get_workers()
+			|| threaded.get_infected() != n_copies*serial.get_infected()){
+		std::cerr << "Different report when checked on threads" << std::endl;
+		return false;
+	}
+	for (std::size_t i = 1; i < threaded.get_errors().size(); ++i){
+		if (threaded.get_errors().at(i).input == "agents" && threaded.get_errors().at(i-1).input == "agents" 
+				&& threaded.get_errors().at(i).ID < threaded.get_errors().at(i-1).ID){
+			std::cerr << "Errors from threads not in order of agent IDs" << std::endl;
+			return false;
+		}
+	}
+
+	const std::invalid_argument invarg("Wrong input");
+	if (!exception_test(false, &invarg, &InputValidator::set_chunk_size, validator, 0)
+			|| !exception_test(false, &invarg, &InputValidator::set_bounds, validator, 1.0, 0.0, 0.0, 1.0)){
+		std::cerr << "Wrong validator settings not recognized as errors" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool same_file_contents(const std::string fname_1, const std::string fname_2)
+{
+	std::ifstream file_1(fname_1);
+	std::ifstream file_2(fname_2);
+	std::stringstream contents_1, contents_2;
+	contents_1 << file_1.rdbuf();
+	contents_2 << file_2.rdbuf();
+	return !contents_1.str().empty() && contents_1.str() == contents_2.str();
+}
+
 // Checks agents creation from file including proper 
 // distribution into places 
 bool create_agents_test()
@@ -870,4 +1333,38 @@ bool check_fractions(int num1, int num2, double fr_expected, std::string msg)
 	return true;
 }
 
+// With times stored as steps models with a different 
+// time step cannot exist at the same time
+bool step_length_test()
+{
+	std::string pfname("test_data/infection_parameters.txt");
+	std::map<std::string, std::string> dfiles = 
+		{ {"exposed never symptomatic", "test_data/age_dist_exposed_never_sy.txt"}, 
+		  {"hospitalization", "test_data/age_dist_hospitalization.txt"}, 
+		  {"ICU", "test_data/age_dist_hosp_ICU.txt"}, {"mortality", "test_data/age_dist_mortality.txt"} };
+	std::string tfname("test_data/tests_with_time.txt");
 
+	{
+		ABM abm(0.25, pfname, dfiles, tfname);
+		ABM copy(abm);
+		ABM same_step(0.25, pfname, dfiles, tfname);
+#ifdef ABM_STEP_TIMES
+		if (StepTime::get_number_of_holders() != 3){
+			std::cerr << "Models do not hold the time step" << std::endl;
+			return false;
+		}
+		if (!exception_test(false, new std::runtime_error("Different time step"), 
+				[&](){ ABM other(1.0, pfname, dfiles, tfname); })){
+			std::cerr << "Model with a different time step created" << std::endl;
+			return false;
+		}
+#endif
+	}
+	if (StepTime::get_number_of_holders() != 0){
+		std::cerr << "Time step still held without models" << std::endl;
+		return false;
+	}
+	// Allowed once the others are gone
+	ABM other(1.0, pfname, dfiles, tfname);
+	return true;
+}
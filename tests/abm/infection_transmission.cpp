@@ -9,19 +9,38 @@
 // Tests
 bool abm_contributions_test();
 bool abm_events_test();
+bool abm_interventions_test();
+bool abm_reordered_interventions_test();
 bool abm_time_dependent_testing();
 bool abm_vaccination();
+bool abm_spatial_transmission_test();
+bool abm_metrics_test();
+bool abm_lineage_test();
+bool abm_place_sampling_statistics_test();
+bool abm_batched_draws_test();
 
 // Supporting functions
 bool abm_vaccination_random();
 bool abm_vaccination_group();
+bool abm_vaccination_campaign();
 ABM create_abm(const double dt, int i0);
+void new_infection_statistics(const ABM& base, const bool by_place, const bool batched, 
+								const int n_seeds, double& mean, double& variance);
+bool equal_statistics(const double mean_1, const double var_1, const double mean_2, 
+								const double var_2, const int n_seeds);
 
 int main()
 {
 	test_pass(abm_events_test(), "Testing and lockdown events");
+	test_pass(abm_interventions_test(), "Timeline of interventions");
+	test_pass(abm_reordered_interventions_test(), "Interventions on reordered places");
 	test_pass(abm_time_dependent_testing(), "Time dependent testing");
 	test_pass(abm_vaccination(), "Vaccination");
+	test_pass(abm_spatial_transmission_test(), "Spatial transmission");
+	test_pass(abm_metrics_test(), "Registry of per-step metrics");
+	test_pass(abm_lineage_test(), "Lineage of infections");
+	test_pass(abm_place_sampling_statistics_test(), "Statistics of place-centric sampling");
+	test_pass(abm_batched_draws_test(), "Batched infection draws");
 }
 
 bool abm_events_test()
@@ -162,6 +181,160 @@ bool abm_events_test()
 	return true;
 }
 
+/// Interventions from a file applied to the places 
+/// in their ranges at their times
+bool abm_interventions_test()
+{
+	const double dt = 0.25;
+	const double tol = 1e-5;
+	ABM abm = create_abm(dt, 1);
+	abm.load_interventions("test_data/interventions.txt");
+	const std::map<std::string, double> infection_parameters = abm.get_infection_parameters(); 
+
+	// Sorted by time
+	const std::vector<Interventions::Intervention>& timeline = abm.get_interventions().get_interventions();
+	if (timeline.size() != 7 || !std::is_sorted(timeline.begin(), timeline.end(), 
+			[](const Interventions::Intervention& a, const Interventions::Intervention& b)
+				{ return a.time < b.time; })){
+		std::cerr << "Interventions not sorted by time" << std::endl;
+		return false;
+	}
+
+	auto n_vaccinated = [&abm](){ 
+		const std::vector<Agent>& agents = abm.get_vector_of_agents(); 
+		return std::count_if(agents.begin(), agents.end(), [](const Agent& agent){ return agent.vaccinated(); }); };
+	int n_vac_before = 0;
+	while (abm.get_time() < 6.0 + dt/2.0){
+		if (float_equality<double>(abm.get_time(), 6.0, tol)){
+			n_vac_before = n_vaccinated();
+		}
+		abm.transmit_infection();
+	}
+
+	// Schools in the range closed, employees of all at half the rate 
+	const std::vector<School>& schools = abm.get_vector_of_schools();
+	const double school_beta = infection_parameters.at("school transmission rate");
+	const double school_emp_beta = 0.5*infection_parameters.at("school employee transmission rate");
+	for (int i = 0; i < schools.size(); ++i){
+		const double beta = (i < 10) ? 0.0 : school_beta;
+		if (!float_equality<double>(schools.at(i).get_transmission_rate(), beta, tol)
+				|| !float_equality<double>(schools.at(i).get_employee_transmission_rate(), school_emp_beta, tol)){
+			std::cerr << "Wrong transmission rates of school " << schools.at(i).get_ID() << std::endl;
+			return false;
+		}
+	}
+
+	// Workplaces at half the rate, absenteeism changed in the range
+	const std::vector<Workplace>& workplaces = abm.get_vector_of_workplaces();
+	const double work_beta = 0.5*infection_parameters.at("workplace transmission rate");
+	for (int i = 0; i < workplaces.size(); ++i){
+		const double psi = (i >= 4 && i < 20) ? 0.7 : infection_parameters.at("work absenteeism correction");
+		if (!float_equality<double>(workplaces.at(i).get_transmission_rate(), work_beta, tol)
+				|| !float_equality<double>(workplaces.at(i).get_absenteeism_correction(), psi, tol)){
+			std::cerr << "Wrong properties of workplace " << workplaces.at(i).get_ID() << std::endl;
+			return false;
+		}
+	}
+
+	// Households in the range at twice the rate
+	const std::vector<Household>& households = abm.get_vector_of_households();
+	const double house_beta = infection_parameters.at("household transmission rate");
+	for (int i = 0; i < households.size(); ++i){
+		const double beta = (i < 100) ? 2.0*house_beta : house_beta;
+		if (!float_equality<double>(households.at(i).get_transmission_rate(), beta, tol)){
+			std::cerr << "Wrong transmission rate of household " << households.at(i).get_ID() << std::endl;
+			return false;
+		}
+	}
+
+	// Vaccinated at their time
+	if (n_vaccinated() - n_vac_before != 1000){
+		std::cerr << "Wrong number of vaccinated" << std::endl;
+		return false;
+	}
+	if (abm.get_interventions().get_number_remaining() != 0){
+		std::cerr << "Not all the interventions applied" << std::endl;
+		return false;
+	}
+
+	// Wrong input
+	const std::string wrong_file("test_data/wrong_interventions.txt");
+	const std::vector<std::string> wrong_entries = {"1.0 schools lockdown 0", 
+		"1.0 households absenteeism 0.5", "1.0 population closure 0", 
+		"1.0 schools closure 0 10 5", "1.0 schools closure 0 1 100000", "1.1 schools closure 0"};
+	for (const auto& entry : wrong_entries){
+		std::ofstream out(wrong_file);
+		out << entry << std::endl;
+		out.close();
+		if (!exception_test(false, new std::invalid_argument("Wrong intervention"),
+				[&abm, &wrong_file](){ abm.load_interventions(wrong_file); })){
+			std::cerr << "Failed to throw for intervention: " << entry << std::endl;
+			return false;
+		}
+	}
+	std::remove(wrong_file.c_str());
+	return true;
+}
+
+/// Ranges of interventions are IDs from the input files
+/// also when the places are reordered, before or after loading
+bool abm_reordered_interventions_test()
+{
+	typedef PopulationSegment PS;
+	const double dt = 0.25;
+	const double tol = 1e-5;
+	for (const bool load_first : {true, false}){
+		ABM abm = create_abm(dt, 1);
+		if (load_first){
+			abm.load_interventions("test_data/interventions.txt");
+			abm.reorder_for_locality();
+		} else {
+			abm.reorder_for_locality();
+			abm.load_interventions("test_data/interventions.txt");
+		}
+		const std::map<std::string, double> infection_parameters = abm.get_infection_parameters(); 
+		while (abm.get_time() < 4.0 + dt/2.0){
+			abm.transmit_infection();
+		}
+
+		int n_reordered = 0;
+		const double school_beta = infection_parameters.at("school transmission rate");
+		for (const auto& school : abm.get_vector_of_schools()){
+			const int ID = abm.get_external_place_ID(PS::schools, school.get_ID());
+			n_reordered += (ID != school.get_ID());
+			const double beta = (ID <= 10) ? 0.0 : school_beta;
+			if (!float_equality<double>(school.get_transmission_rate(), beta, tol)){
+				std::cerr << "Wrong transmission rate of school " << ID << std::endl;
+				return false;
+			}
+		}
+		for (const auto& work : abm.get_vector_of_workplaces()){
+			const int ID = abm.get_external_place_ID(PS::workplaces, work.get_ID());
+			n_reordered += (ID != work.get_ID());
+			const double psi = (ID >= 5 && ID <= 20) ? 0.7 : infection_parameters.at("work absenteeism correction");
+			if (!float_equality<double>(work.get_absenteeism_correction(), psi, tol)){
+				std::cerr << "Wrong absenteeism of workplace " << ID << std::endl;
+				return false;
+			}
+		}
+		const double house_beta = infection_parameters.at("household transmission rate");
+		for (const auto& house : abm.get_vector_of_households()){
+			const int ID = abm.get_external_place_ID(PS::households, house.get_ID());
+			n_reordered += (ID != house.get_ID());
+			const double beta = (ID <= 100) ? 2.0*house_beta : house_beta;
+			if (!float_equality<double>(house.get_transmission_rate(), beta, tol)){
+				std::cerr << "Wrong transmission rate of household " << ID << std::endl;
+				return false;
+			}
+		}
+		if (n_reordered == 0){
+			std::cerr << "Places were not reordered" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
 bool abm_time_dependent_testing()
 {
 	// Agents 
@@ -276,6 +449,100 @@ bool abm_vaccination()
 		std::cerr << "Error in group vaccination functionality" << std::endl;
 		return false;
 	}
+	if (!abm_vaccination_campaign()){
+		std::cerr << "Error in vaccination campaign functionality" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Daily doses of a campaign follow the quotas
+/// and priorities of the groups
+bool abm_vaccination_campaign()
+{
+	const double dt = 0.25;
+	const int n_steps = 40;
+	ABM abm = create_abm(dt, 100);
+
+	// Residents and agents over 65 first, then everyone
+	VaccinationCampaign campaign;
+	campaign.add_group("residents", VaccinationCampaign::retirement_home_residents);
+	campaign.add_group("over 65", VaccinationCampaign::population, 65);
+	campaign.add_group("everyone", VaccinationCampaign::population);
+	campaign.add_phase(0.0, 5.0, 400.0, {0.5, 0.3, 0.2});
+	campaign.add_phase(5.0, 10.0, 1000.0, {0.0, 0.0, 1.0});
+	abm.set_vaccination_campaign(campaign);
+	abm.set_random_seed(2021);
+	for (int ti = 0; ti < n_steps; ++ti){
+		abm.transmit_infection();
+	}
+
+	const std::vector<int> vaccinated_day = abm.get_vaccinated_day();
+	if (vaccinated_day.size() != n_steps){
+		std::cerr << "Wrong number of entries of vaccinated per step" << std::endl;
+		return false;
+	}
+	for (int ti = 0; ti < n_steps; ++ti){
+		if (vaccinated_day.at(ti) != ((ti < 20) ? 100 : 250)){
+			std::cerr << "Wrong number of doses at step " << ti << std::endl;
+			return false;
+		}
+	}
+	int n_vaccinated = 0, n_residents = 0;
+	for (const auto& agent : abm.get_vector_of_agents()){
+		if (agent.vaccinated()){
+			++n_vaccinated;
+			if (agent.retirement_home_resident()){
+				++n_residents;
+			}
+		}
+	}
+	const std::vector<int> per_group = abm.get_vaccination_campaign().get_vaccinated_per_group();
+	if (n_vaccinated != abm.get_total_vaccinated() || n_vaccinated != 7000
+			|| per_group != std::vector<int>({1000, 600, 5400}) || n_residents < 1000){
+		std::cerr << "Wrong number of vaccinated in the groups" << std::endl;
+		return false;
+	}
+
+	// Doses that a group cannot use are not given
+	ABM abm_small = create_abm(dt, 100);
+	VaccinationCampaign small;
+	small.add_group("residents", VaccinationCampaign::retirement_home_residents);
+	small.add_phase(0.0, 2.0, 2000.0, {1.0});
+	abm_small.set_vaccination_campaign(small);
+	int n_eligible = 0;
+	for (const auto& agent : abm_small.get_vector_of_agents()){
+		if (agent.retirement_home_resident() && !agent.infected()){
+			++n_eligible;
+		}
+	}
+	for (int ti = 0; ti < 8; ++ti){
+		abm_small.transmit_infection();
+	}
+	const std::vector<int> small_day = abm_small.get_vaccinated_day();
+	if (small_day.at(0) != 500 || small_day.back() != 0 || abm_small.get_total_vaccinated() > n_eligible
+			|| abm_small.get_vaccination_campaign().get_pool_sizes().at(0) != 0){
+		std::cerr << "Wrong vaccination after the group ran out" << std::endl;
+		return false;
+	}
+
+	// Wrong input
+	bool verbose = false;
+	if (!exception_test(verbose, new std::invalid_argument("Quotas above 1"), 
+			[&campaign](){ campaign.add_phase(10.0, 20.0, 100.0, {0.5, 0.5, 0.5}); })){
+		std::cerr << "Quotas above 1 accepted" << std::endl;
+		return false;
+	}
+	if (!exception_test(verbose, new std::invalid_argument("Wrong number of quotas"), 
+			[&campaign](){ campaign.add_phase(10.0, 20.0, 100.0, {0.5}); })){
+		std::cerr << "Wrong number of quotas accepted" << std::endl;
+		return false;
+	}
+	if (!exception_test(verbose, new std::invalid_argument("Group after phases"), 
+			[&campaign](){ campaign.add_group("children", VaccinationCampaign::population, 0, 17); })){
+		std::cerr << "Group added after the phases" << std::endl;
+		return false;
+	}
 	return true;
 }
 
@@ -615,6 +882,548 @@ bool abm_vaccination_group()
 
 
 // Common operations for creating the ABM interface
+/// Spatial contributions from the grid agree with
+/// sums over all pairs of agents
+bool abm_spatial_transmission_test()
+{
+	const double rate = 0.05, scale = 0.002, exponent = 2.0, cutoff = 0.005;
+	const int n_steps = 40;
+	ABM abm = create_abm(0.25, 50);
+	ABM abm_spatial(abm), abm_zero(abm);
+	abm.set_random_seed(2021);
+	abm_spatial.set_random_seed(2021);
+	abm_zero.set_random_seed(2021);
+	abm_spatial.set_spatial_transmission(rate, scale, exponent, cutoff, true);
+	abm_zero.set_spatial_transmission(0.0, scale, exponent, cutoff, true);
+	for (int ti = 0; ti < n_steps; ++ti){
+		abm.transmit_infection();
+		abm_spatial.transmit_infection();
+		abm_zero.transmit_infection();
+	}
+
+	// No spatial contribution gives the same simulation
+	if (abm_zero.get_total_infected() != abm.get_total_infected()
+			|| abm_zero.get_num_infected() != abm.get_num_infected()){
+		std::cerr << "Zero spatial transmission changes the simulation" << std::endl;
+		return false;
+	}
+	if (abm_spatial.get_total_infected() <= abm.get_total_infected()){
+		std::cerr << "Spatial transmission did not add infections" << std::endl;
+		return false;
+	}
+
+	// Sources and every 50th receiver
+	std::vector<Agent> agents = abm.get_vector_of_agents();
+	const double time = abm.get_time();
+	SpatialTransmission spatial;
+	std::vector<int> sources, receivers;
+	for (const auto& agent : agents){
+		if (agent.hospital_non_covid_patient() || agent.removed() || agent.vaccinated()){
+			continue;
+		}
+		if (!agent.infected() && agent.get_ID()%50 == 0){
+			receivers.push_back(agent.get_ID() - 1);
+		} else if (agent.infected() && !agent.tested() && !agent.being_treated()
+				&& (agent.symptomatic() || time >= agent.get_infectiousness_start_time())){
+			sources.push_back(agent.get_ID() - 1);
+		}
+	}
+	if (sources.empty()){
+		std::cerr << "No infectious agents" << std::endl;
+		return false;
+	}
+	auto exact = [&](const int ir, const double max_distance){
+			double sum = 0.0;
+			for (const auto& is : sources){
+				const double d = std::hypot(agents.at(is).get_x_location() - agents.at(ir).get_x_location(),
+											agents.at(is).get_y_location() - agents.at(ir).get_y_location());
+				if (d <= max_distance){
+					sum += agents.at(is).get_inf_variability_factor()*spatial.kernel(d);
+				}
+			}
+			return rate*sum;
+		};
+
+	// Within the cutoff, serial and with cells in another order
+	spatial.set_parameters(rate, scale, exponent, cutoff, false);
+	spatial.compute(agents, time);
+	std::vector<double> serial_values;
+	for (const auto& ir : receivers){
+		serial_values.push_back(agents.at(ir).get_spatial_lambda());
+		if (!float_equality<double>(agents.at(ir).get_spatial_lambda(), exact(ir, cutoff), 1e-10)){
+			std::cerr << "Wrong contribution within the cutoff" << std::endl;
+			return false;
+		}
+	}
+	spatial.set_executor([](int n_tasks, const std::function<void(int)>& task){
+			for (int i = n_tasks - 1; i >= 0; --i){
+				task(i);
+			}
+		});
+	spatial.compute(agents, time);
+	for (int i = 0; i < receivers.size(); ++i){
+		if (agents.at(receivers.at(i)).get_spatial_lambda() != serial_values.at(i)){
+			std::cerr << "Contributions depend on the order of cells" << std::endl;
+			return false;
+		}
+	}
+
+	// Far field close to all the pairs
+	spatial.set_parameters(rate, scale, exponent, cutoff, true);
+	spatial.compute(agents, time);
+	double sum_grid = 0.0, sum_exact = 0.0;
+	for (const auto& ir : receivers){
+		sum_grid += agents.at(ir).get_spatial_lambda();
+		sum_exact += exact(ir, std::numeric_limits<double>::max());
+	}
+	if (std::abs(sum_grid - sum_exact) > 0.05*sum_exact){
+		std::cerr << "Far field differs from all the pairs: " << sum_grid << " " << sum_exact << std::endl;
+		return false;
+	}
+
+	// Not with the place-centric sampling
+	bool verbose = false;
+	if (!exception_test(verbose, new std::invalid_argument("Spatial with place sampling"), 
+			[&abm_spatial](){ abm_spatial.set_place_infection_sampling(); })){
+		std::cerr << "Place-centric sampling with spatial transmission accepted" << std::endl;
+		return false;
+	}
+	abm.set_place_infection_sampling();
+	if (!exception_test(verbose, new std::invalid_argument("Place sampling with spatial"), 
+			[&](){ abm.set_spatial_transmission(rate, scale, exponent, cutoff); })){
+		std::cerr << "Spatial transmission with place-centric sampling accepted" << std::endl;
+		return false;
+	}
+	if (!exception_test(verbose, new std::invalid_argument("Wrong cutoff"), 
+			[&spatial](){ spatial.set_parameters(1.0, 1.0, 1.0, 0.0, false); })){
+		std::cerr << "Zero cutoff accepted" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Built-in metrics agree with the totals and the 
+/// states of agents, saved files have all of them
+bool abm_metrics_test()
+{
+	const int n_steps = 120;
+	ABM abm = create_abm(0.25, 50);
+	abm.set_random_seed(2021);
+	abm.set_census_metrics();
+	abm.reserve_steps(n_steps);
+	const int active_check = abm.add_metric("active check", Metrics::gauge);
+	const int initially_infected = abm.get_total_infected();
+
+	const Metrics& metrics = abm.get_metrics();
+	for (int ti = 0; ti < n_steps; ++ti){
+		abm.transmit_infection();
+		abm.set_metric(active_check, abm.get_num_active_cases());
+
+		// Census at the end of each step
+		const std::vector<int> treatment = abm.get_treatment_data();
+		const std::vector<int> expected = {abm.get_num_infected(), abm.get_num_exposed(), 
+			abm.get_num_active_cases(), treatment.at(0), treatment.at(1), treatment.at(2)};
+		const std::vector<std::string> names = {"infected", "exposed", "active", 
+			"home isolated", "hospitalized", "ICU"};
+		for (int i = 0; i < names.size(); ++i){
+			if (metrics.get_values(metrics.find(names.at(i))).at(ti) != expected.at(i)){
+				std::cerr << "Wrong census metric " << names.at(i) << " at step " << ti << std::endl;
+				return false;
+			}
+		}
+	}
+	if (metrics.get_n_steps() != n_steps 
+			|| metrics.get_values(metrics.find("new infected")).capacity() < n_steps){
+		std::cerr << "Wrong number of steps or columns not preallocated" << std::endl;
+		return false;
+	}
+
+	// Counters add up to the totals, last gauges are the totals
+	auto sum = [&metrics](const std::string& name){ 
+			const std::vector<int>& values = metrics.get_values(metrics.find(name));
+			return std::accumulate(values.begin(), values.end(), 0); };
+	auto last = [&metrics](const std::string& name){ 
+			return metrics.get_values(metrics.find(name)).back(); };
+	if (sum("new infected") + initially_infected != abm.get_total_infected()
+			|| sum("new dead") != abm.get_total_dead() || sum("new recovered") != abm.get_total_recovered()
+			|| sum("new tested") != abm.get_total_tested()
+			|| sum("new tested positive") != abm.get_total_tested_positive()
+			|| sum("new tested false negative") != abm.get_total_tested_false_negative()){
+		std::cerr << "Counters do not add up to the totals" << std::endl;
+		return false;
+	}
+	if (last("total infected") != abm.get_total_infected() || last("total dead") != abm.get_total_dead()
+			|| last("tested dead") + last("not tested dead") != abm.get_total_dead()
+			|| last("total recovered") != abm.get_total_recovered() 
+			|| last("total tested") != abm.get_total_tested()
+			|| last("active check") != abm.get_num_active_cases()){
+		std::cerr << "Wrong totals" << std::endl;
+		return false;
+	}
+	if (sum("new recovered") == 0 || sum("new tested") == 0 || abm.get_recovered_day() 
+			!= metrics.get_values(metrics.find("new recovered"))){
+		std::cerr << "No recoveries or tests recorded" << std::endl;
+		return false;
+	}
+
+	// Files
+	const std::string csv_file("test_data/metrics.csv"), bin_file("test_data/metrics.bin");
+	abm.print_metrics(csv_file);
+	abm.print_metrics(bin_file, true);
+	std::ifstream csv(csv_file);
+	std::string header, line;
+	std::getline(csv, header);
+	int n_lines = 0;
+	while (std::getline(csv, line)){
+		++n_lines;
+	}
+	const Metrics loaded = Metrics::read_binary(bin_file);
+	std::remove(csv_file.c_str());
+	std::remove(bin_file.c_str());
+	if (header.compare(0, 17, "step,new infected") != 0 || n_lines != n_steps){
+		std::cerr << "Wrong file of comma-separated metrics" << std::endl;
+		return false;
+	}
+	if (loaded.size() != metrics.size() || loaded.get_n_steps() != n_steps){
+		std::cerr << "Wrong size of the binary metrics" << std::endl;
+		return false;
+	}
+	for (int id = 0; id < metrics.size(); ++id){
+		if (loaded.get_name(id) != metrics.get_name(id) || loaded.get_kind(id) != metrics.get_kind(id)
+				|| loaded.get_values(id) != metrics.get_values(id)){
+			std::cerr << "Binary metrics differ from the model" << std::endl;
+			return false;
+		}
+	}
+
+	// Wrong names
+	bool verbose = false;
+	Metrics registry;
+	registry.add("new cases", Metrics::counter);
+	if (!exception_test(verbose, new std::invalid_argument("Duplicate"), 
+			[&registry](){ registry.add("new cases", Metrics::gauge); })
+		|| !exception_test(verbose, new std::invalid_argument("Comma"), 
+			[&registry](){ registry.add("cases, new", Metrics::gauge); })
+		|| !exception_test(verbose, new std::runtime_error("Not a metrics file"), 
+			[](){ Metrics::read_binary("test_data/NR_agents.txt"); })){
+		return false;
+	}
+	return true;
+}
+
+/// Recording does not change the simulation, every infection
+/// is attributed to a place of the infected agent, and sources
+/// are sampled in proportion to their lambdas
+bool abm_lineage_test()
+{
+	typedef LineageLog LL;
+	const int n_steps = 100;
+	ABM abm = create_abm(0.25, 50);
+	ABM reference(abm);
+	abm.set_random_seed(2021);
+	reference.set_random_seed(2021);
+	abm.set_lineage_recording(true, 10000);
+	const int initially_infected = abm.get_total_infected();
+	for (int ti = 0; ti < n_steps; ++ti){
+		abm.transmit_infection();
+		reference.transmit_infection();
+		if (abm.get_num_infected() != reference.get_num_infected() 
+				|| abm.get_total_tested() != reference.get_total_tested()){
+			std::cerr << "Recording changed the simulation at step " << ti << std::endl;
+			return false;
+		}
+	}
+	const LineageLog& lineage = abm.get_lineage_log();
+	if (lineage.size() != abm.get_total_infected() - initially_infected || reference.get_lineage_log().size() != 0){
+		std::cerr << "Wrong number of recorded infections" << std::endl;
+		return false;
+	}
+
+	// Places of the infected agents, in order of steps
+	int previous_step = 0;
+	for (const auto& rec : lineage.get_records()){
+		const Agent& agent = abm.get_vector_of_agents().at(rec.agent_ID - 1);
+		bool member = false;
+		switch (rec.setting){
+			case LL::households: 
+			case LL::retirement_homes: 
+				member = (agent.get_household_ID() == rec.place_ID || agent.get_work_ID() == rec.place_ID);
+				break;
+			case LL::schools: 
+				member = (agent.get_school_ID() == rec.place_ID || agent.get_work_ID() == rec.place_ID);
+				break;
+			case LL::workplaces: 
+				member = (agent.get_work_ID() == rec.place_ID);
+				break;
+			case LL::hospitals: 
+				// Hospital of an agent changes with testing and treatment
+				member = (rec.place_ID >= 1 && rec.place_ID <= abm.get_vector_of_hospitals().size());
+				break;
+			default:
+				// E.g. agents with flu, not in a place
+				member = (rec.place_ID == 0);
+		}
+		if (!member || rec.step < previous_step || rec.step >= n_steps){
+			std::cerr << "Infection of agent " << rec.agent_ID << " attributed to a wrong place or step" << std::endl;
+			return false;
+		}
+		previous_step = rec.step;
+	}
+	const std::vector<int> counts = lineage.infections_by_setting();
+	if (counts.at(LL::households) == 0 || counts.at(LL::households) == lineage.size()){
+		std::cerr << "Infections only in households or none there" << std::endl;
+		return false;
+	}
+
+	// Binary file and merging
+	const std::string bin_file("test_data/lineage.bin"), summary_file("test_data/lineage_summary.csv");
+	lineage.print_binary(bin_file);
+	const LineageLog loaded = LineageLog::read_binary(bin_file);
+	std::remove(bin_file.c_str());
+	const LineageLog merged = LineageLog::merge({&lineage, &loaded});
+	if (loaded.size() != lineage.size() || !std::equal(loaded.get_records().begin(), loaded.get_records().end(),
+			lineage.get_records().begin(), [](const LL::Record& a, const LL::Record& b)
+				{ return a.step == b.step && a.agent_ID == b.agent_ID && a.setting == b.setting 
+							&& a.place_ID == b.place_ID; })){
+		std::cerr << "Binary lineage differs from the model" << std::endl;
+		return false;
+	}
+	// Loaded copy of the first record follows all the others of its step
+	const int first_step = lineage.get_records().front().step;
+	const int n_first = std::count_if(lineage.get_records().begin(), lineage.get_records().end(), 
+							[first_step](const LL::Record& rec){ return rec.step == first_step; });
+	if (merged.size() != 2*lineage.size() || merged.get_records().at(n_first).agent_ID 
+			!= lineage.get_records().front().agent_ID){
+		std::cerr << "Wrong merged lineage" << std::endl;
+		return false;
+	}
+
+	// Summary
+	abm.print_lineage_summary(summary_file);
+	std::ifstream summary(summary_file);
+	std::string line;
+	std::vector<std::string> lines;
+	while (std::getline(summary, line)){
+		lines.push_back(line);
+	}
+	std::remove(summary_file.c_str());
+	if (lines.size() < LL::n_settings + 4 || lines.at(1).compare(0, 11, "households,") != 0 
+			|| lines.at(LL::n_settings + 2) != "household size,secondary attack rate"){
+		std::cerr << "Wrong lineage summary" << std::endl;
+		return false;
+	}
+	for (const auto& rate : lineage.household_attack_rates(std::vector<int>(abm.get_vector_of_households().size(), 2),
+							std::vector<int>(abm.get_vector_of_agents().size(), 0), {})){
+		if (rate.first != 2 || rate.second <= 0.0){
+			std::cerr << "Wrong household attack rate" << std::endl;
+			return false;
+		}
+	}
+
+	// Records of a reordered model use the IDs of the input files
+	typedef PopulationSegment PS;
+	ABM reordered = create_abm(0.25, 50);
+	reordered.reorder_for_locality();
+	reordered.set_lineage_recording(true, 10000);
+	for (int ti = 0; ti < n_steps; ++ti){
+		reordered.transmit_infection();
+	}
+	const std::vector<Agent>& reordered_agents = reordered.get_vector_of_agents();
+	std::vector<int> internal_IDs(reordered_agents.size(), 0);
+	int n_moved = 0;
+	for (const auto& agent : reordered_agents){
+		const int external_ID = reordered.get_external_agent_ID(agent.get_ID());
+		internal_IDs.at(external_ID-1) = agent.get_ID();
+		n_moved += (external_ID != agent.get_ID());
+	}
+	int n_checked = 0;
+	for (const auto& rec : reordered.get_lineage_log().get_records()){
+		const Agent& agent = reordered_agents.at(internal_IDs.at(rec.agent_ID-1)-1);
+		bool member = true;
+		if (rec.setting == LL::households){
+			member = (reordered.get_external_place_ID(PS::households, agent.get_household_ID()) == rec.place_ID);
+			++n_checked;
+		} else if (rec.setting == LL::workplaces){
+			member = (reordered.get_external_place_ID(PS::workplaces, agent.get_work_ID()) == rec.place_ID);
+			++n_checked;
+		}
+		if (!member || !(agent.infected() || agent.removed())){
+			std::cerr << "Record of the reordered agent " << rec.agent_ID << " with a wrong place or agent" << std::endl;
+			return false;
+		}
+	}
+	if (n_moved == 0 || n_checked == 0){
+		std::cerr << "Nothing to check in the reordered model" << std::endl;
+		return false;
+	}
+	reordered.print_lineage_summary(summary_file);
+	std::remove(summary_file.c_str());
+
+	// Sampling of the sources
+	LineageLog log;
+	log.set_rng_seed(5);
+	const LL::Source sources[] = {{LL::households, 1, 1.0}, {LL::schools, 4, 0.0}, {LL::workplaces, 2, 3.0}};
+	const int n_samples = 20000;
+	for (int i = 0; i < n_samples; ++i){
+		log.record(0, 1, sources, 3);
+	}
+	const LL::Source none[] = {{LL::households, 1, 0.0}};
+	log.record(1, 2, none, 1);
+	const std::vector<int> sampled = log.infections_by_setting();
+	if (!float_equality<double>(sampled.at(LL::workplaces)/static_cast<double>(n_samples), 0.75, 0.02)
+			|| sampled.at(LL::schools) != 0 || sampled.at(LL::unknown) != 1){
+		std::cerr << "Sources not sampled in proportion to their lambdas" << std::endl;
+		return false;
+	}
+
+	const std::runtime_error run_err("Wrong file");
+	if (!exception_test(false, &run_err, [](){ LineageLog::read_binary("test_data/infection_parameters.txt"); })){
+		std::cerr << "Wrong lineage file not recognized" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Place-centric sampling and per-agent draws give the same new infections
+bool abm_place_sampling_statistics_test()
+{
+	const int n_seeds = 200;
+	// After testing starts, so that some agents have flu
+	ABM base = create_abm(0.25, 500);
+	base.set_random_seed(2021);
+	for (int ti = 0; ti < 28; ++ti){
+		base.transmit_infection();
+	}
+
+	double mean_agent = 0.0, var_agent = 0.0;
+	double mean_place = 0.0, var_place = 0.0;
+	new_infection_statistics(base, false, false, n_seeds, mean_agent, var_agent);
+	new_infection_statistics(base, true, false, n_seeds, mean_place, var_place);
+	if (mean_agent < 1.0){
+		std::cerr << "Too few new infections to compare: " << mean_agent << std::endl;
+		return false;
+	}
+	if (!equal_statistics(mean_agent, var_agent, mean_place, var_place, n_seeds)){
+		std::cerr << "Place-centric sampling - mean " << mean_place << " variance " << var_place
+				  << ", per agent - mean " << mean_agent << " variance " << var_agent << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Batched draws give the same new infections as the per-agent draws
+// and leave agents with flu and agents of other processes to the main loop
+bool abm_batched_draws_test()
+{
+	const int n_seeds = 200;
+	ABM base = create_abm(0.25, 500);
+	base.set_random_seed(2021);
+	for (int ti = 0; ti < 28; ++ti){
+		base.transmit_infection();
+	}
+
+	// Statistics
+	double mean_agent = 0.0, var_agent = 0.0;
+	double mean_batched = 0.0, var_batched = 0.0;
+	new_infection_statistics(base, false, false, n_seeds, mean_agent, var_agent);
+	new_infection_statistics(base, false, true, n_seeds, mean_batched, var_batched);
+	if (mean_agent < 1.0){
+		std::cerr << "Too few new infections to compare: " << mean_agent << std::endl;
+		return false;
+	}
+	if (!equal_statistics(mean_agent, var_agent, mean_batched, var_batched, n_seeds)){
+		std::cerr << "Batched draws - mean " << mean_batched << " variance " << var_batched
+				  << ", per agent - mean " << mean_agent << " variance " << var_agent << std::endl;
+		return false;
+	}
+
+	// Every other agent is processed elsewhere, set before testing 
+	// starts so that only local agents get flu
+	ABM abm = create_abm(0.25, 500);
+	abm.set_random_seed(2021);
+	abm.set_batched_infection_draws(true);
+	const std::vector<Agent>& agents = abm.get_vector_of_agents();
+	std::vector<bool> local(agents.size());
+	for (std::size_t i = 0; i < local.size(); ++i){
+		local.at(i) = (i%2 == 0);
+	}
+	abm.set_local_agents(local);
+
+	// Agents with flu due for a test have to be tested by the main loop
+	int n_flu_tested = 0;
+	for (int ti = 0; ti < 48; ++ti){
+		const double time = abm.get_time();
+		std::vector<int> due_IDs;
+		for (const auto& agent : agents){
+			if (local.at(agent.get_ID()-1) && !agent.infected() && agent.symptomatic_non_covid() 
+					&& agent.tested() && agent.tested_awaiting_test() && agent.get_time_of_test() <= time){
+				due_IDs.push_back(agent.get_ID());
+			}
+		}
+		const std::vector<Agent> before = agents;
+		abm.transmit_infection();
+		for (const int ID : due_IDs){
+			const Agent& agent = agents.at(ID-1);
+			if (!agent.infected() && agent.tested_awaiting_test()){
+				std::cerr << "Agent with flu " << ID << " was not tested at time " << time << std::endl;
+				return false;
+			}
+		}
+		n_flu_tested += due_IDs.size();
+		for (std::size_t i = 0; i < agents.size(); ++i){
+			if (local.at(i)){
+				continue;
+			}
+			const Agent& agent = agents.at(i);
+			if (agent.infected() != before.at(i).infected() || agent.exposed() != before.at(i).exposed() 
+					|| agent.symptomatic() != before.at(i).symptomatic() 
+					|| agent.removed() != before.at(i).removed()
+					|| agent.tested() != before.at(i).tested()){
+				std::cerr << "Agent " << agent.get_ID() << " of another process changed state" << std::endl;
+				return false;
+			}
+		}
+	}
+	if (n_flu_tested == 0){
+		std::cerr << "No agents with flu were due for a test" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Mean and variance of the new infections in one step over different seeds
+void new_infection_statistics(const ABM& base, const bool by_place, const bool batched, 
+								const int n_seeds, double& mean, double& variance)
+{
+	std::vector<double> counts;
+	for (int seed = 1; seed <= n_seeds; ++seed){
+		ABM abm(base);
+		abm.set_random_seed(seed);
+		abm.set_place_infection_sampling(by_place);
+		abm.set_batched_infection_draws(batched);
+		const int infected_before = abm.get_total_infected();
+		abm.transmit_infection();
+		counts.push_back(abm.get_total_infected() - infected_before);
+	}
+	mean = std::accumulate(counts.begin(), counts.end(), 0.0)/n_seeds;
+	variance = 0.0;
+	for (const double count : counts){
+		variance += (count - mean)*(count - mean);
+	}
+	variance /= (n_seeds - 1);
+}
+
+// Means within 4 standard errors and variances within a broad ratio
+bool equal_statistics(const double mean_1, const double var_1, const double mean_2, 
+								const double var_2, const int n_seeds)
+{
+	if (std::fabs(mean_1 - mean_2) > 4.0*std::sqrt(var_1/n_seeds + var_2/n_seeds)){
+		return false;
+	}
+	const double ratio = var_2/std::max(var_1, 1e-12);
+	return ratio > 0.6 && ratio < 1.6;
+}
+
 ABM create_abm(const double dt, int inf0)
 {
 	// Input files
@@ -0,0 +1,111 @@
+#include "abm_tests.h"
+
+/*****************************************************
+ *
+ * Test suite for the compile-time model features
+ *
+ * Needs to be compiled with -DABM_TOTALS_ONLY
+ *
+******************************************************/
+
+#ifndef ABM_TOTALS_ONLY
+	#error "Model features test needs to be compiled with -DABM_TOTALS_ONLY"
+#endif
+
+// Tests
+bool features_same_totals_test();
+
+// Supporting functions
+ABM create_abm(const double dt, int i0);
+
+int main()
+{
+	test_pass(features_same_totals_test(), "Totals from a specialized build");
+}
+
+/// Build without daily data gives the same simulation
+/// as all the features, but collects only the totals
+bool features_same_totals_test()
+{
+	const int n_steps = 60;
+	ABM abm = create_abm(0.25, 100);
+	ABM abm_all(abm);
+	abm.set_random_seed(2021);
+	abm_all.set_random_seed(2021);
+
+	for (int ti = 0; ti < n_steps; ++ti){
+		abm.transmit_infection();
+		abm_all.transmit_infection<AllFeatures>();
+		if (abm.get_num_infected() != abm_all.get_num_infected()){
+			std::cerr << "Different number of infected at step " << ti << std::endl;
+			return false;
+		}
+	}
+
+	const std::vector<int> totals = {abm.get_total_infected(), abm.get_total_dead(),
+		abm.get_total_recovered(), abm.get_total_tested(), abm.get_total_tested_positive(),
+		abm.get_total_tested_negative(), abm.get_total_tested_false_positive(),
+		abm.get_total_tested_false_negative()};
+	const std::vector<int> totals_all = {abm_all.get_total_infected(), abm_all.get_total_dead(),
+		abm_all.get_total_recovered(), abm_all.get_total_tested(), abm_all.get_total_tested_positive(),
+		abm_all.get_total_tested_negative(), abm_all.get_total_tested_false_positive(),
+		abm_all.get_total_tested_false_negative()};
+	if (totals != totals_all){
+		std::cerr << "Different totals" << std::endl;
+		return false;
+	}
+	if (abm_all.get_total_tested() == 0){
+		std::cerr << "No testing during the simulation" << std::endl;
+		return false;
+	}
+
+	// Only the totals
+	if (!abm.get_infected_day().empty() || !abm.get_tested_day().empty()){
+		std::cerr << "Daily data collected in a build with totals only" << std::endl;
+		return false;
+	}
+	if (abm_all.get_infected_day().size() != n_steps){
+		std::cerr << "Wrong number of daily entries with all the features" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+ABM create_abm(const double dt, int inf0)
+{
+	// Input files
+	std::string fin("test_data/NR_agents.txt");
+	std::string hfile("test_data/NR_households.txt");
+	std::string sfile("test_data/NR_schools.txt");
+	std::string wfile("test_data/NR_workplaces.txt");
+	std::string hsp_file("test_data/NR_hospitals.txt");
+	std::string rh_file("test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles =
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name},
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with testing changes
+	std::string tfname("test_data/tests_with_time.txt");
+
+	ABM abm(dt, pfname, dfiles, tfname);
+
+	// First the places
+	abm.create_households(hfile);
+	abm.create_schools(sfile);
+	abm.create_workplaces(wfile);
+	abm.create_hospitals(hsp_file);
+	abm.create_retirement_homes(rh_file);
+
+	// Then the agents
+	abm.create_agents(fin, inf0);
+
+	return abm;
+}
@@ -21,3 +21,20 @@ subprocess.call(['./con_test'], shell=True)
 # Test suite 2
 ut.msg('ABM interface - infection transmission test', CYAN)
 subprocess.call(['./trans_inf_test'], shell=True)
+
+# Test suite 3
+ut.msg('ABM interface - compile-time model features test', CYAN)
+subprocess.call(['./features_test'], shell=True)
+
+# Test suite 4
+ut.msg('ABM interface - memory allocations test', CYAN)
+subprocess.call(['./alloc_test'], shell=True)
+
+# Test suite 5
+ut.msg('ABM interface - state snapshots test', CYAN)
+subprocess.call(['./snapshot_test'], shell=True)
+
+# Test suite 6
+ut.msg('ABM interface - event times stored as time steps', CYAN)
+subprocess.call(['./con_steps_test'], shell=True)
+subprocess.call(['./trans_inf_steps_test'], shell=True)
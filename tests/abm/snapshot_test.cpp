@@ -0,0 +1,261 @@
+#include "abm_tests.h"
+
+/*****************************************************
+ *
+ * Test suite for the stream of agent state snapshots
+ *
+******************************************************/
+
+// Tests
+bool snapshot_reconstruction_test();
+bool snapshot_errors_test();
+bool snapshot_external_IDs_test();
+
+// Supporting functions
+ABM create_abm(const double dt, int i0);
+std::vector<std::uint32_t> current_states(const ABM& abm);
+
+int main()
+{
+	test_pass(snapshot_reconstruction_test(), "States rebuilt from keyframes and changes");
+	test_pass(snapshot_errors_test(), "Snapshot exceptions");
+	test_pass(snapshot_external_IDs_test(), "Snapshots with IDs from the input files");
+}
+
+/// States at every recorded step are the same as those of
+/// the model at that step, and the stream stores far fewer
+/// entries than the agents times the steps
+bool snapshot_reconstruction_test()
+{
+	const std::string fname("test_data/snapshots.bin");
+	const int n_steps = 120;
+	const int interval = 25;
+	ABM abm = create_abm(0.25, 200);
+	abm.set_random_seed(2021);
+	const int n_agents = abm.get_vector_of_agents().size();
+
+	// Reference states at some of the steps
+	std::map<int, std::vector<std::uint32_t>> expected;
+	std::vector<std::uint32_t> before_last;
+	{
+		SnapshotWriter writer(fname, interval);
+		for (int ti = 0; ti < n_steps; ++ti){
+			abm.transmit_infection();
+			writer.record(ti, abm.get_vector_of_agents());
+			if (ti % 17 == 0 || ti % interval == 0 || ti == n_steps - 1){
+				expected[ti] = current_states(abm);
+			}
+			if (ti == n_steps - 2){
+				before_last = current_states(abm);
+			}
+		}
+		const std::size_t all_entries = static_cast<std::size_t>(n_agents)*n_steps;
+		if (writer.get_entries_written() > all_entries/4){
+			std::cerr << "Too many entries written: " << writer.get_entries_written()
+					  << " of " << all_entries << std::endl;
+			return false;
+		}
+	}
+
+	SnapshotReader reader(fname);
+	if (reader.get_n_agents() != n_agents || reader.get_steps().size() != n_steps){
+		std::cerr << "Wrong number of agents or steps in the stream" << std::endl;
+		return false;
+	}
+	for (const auto& step_states : expected){
+		if (reader.states_at(step_states.first) != step_states.second){
+			std::cerr << "Wrong states at step " << step_states.first << std::endl;
+			return false;
+		}
+	}
+
+	// Changes at the last step
+	const std::vector<std::uint32_t>& last = expected.at(n_steps - 1);
+	const auto changed = reader.changes_at(n_steps - 1);
+	int n_changed = 0;
+	for (int i = 0; i < n_agents; ++i){
+		if (last.at(i) != before_last.at(i)){
+			++n_changed;
+		}
+	}
+	if (changed.size() != n_changed || changed.empty()){
+		std::cerr << "Wrong number of changed agents at the last step" << std::endl;
+		return false;
+	}
+	for (const auto& change : changed){
+		if (last.at(change.first - 1) != change.second){
+			std::cerr << "Wrong change of agent " << change.first << std::endl;
+			return false;
+		}
+	}
+	if (!reader.changes_at(0).empty()){
+		std::cerr << "Changes at the first step" << std::endl;
+		return false;
+	}
+
+	// Flags of an infected agent
+	const Agent& agent = *std::find_if(abm.get_vector_of_agents().begin(),
+			abm.get_vector_of_agents().end(), [](const Agent& ag){ return ag.infected(); });
+	const std::uint32_t state = last.at(agent.get_ID() - 1);
+	if (!StateSnapshots::has(state, StateSnapshots::infected)
+			|| StateSnapshots::has(state, StateSnapshots::removed)
+			|| StateSnapshots::has(state, StateSnapshots::exposed) != agent.exposed()){
+		std::cerr << "Wrong flags of an infected agent" << std::endl;
+		return false;
+	}
+
+	std::remove(fname.c_str());
+	return true;
+}
+
+/// Wrong steps, intervals, and files
+bool snapshot_errors_test()
+{
+	const std::string fname("test_data/snapshots_err.bin");
+	const std::invalid_argument arg_err("Wrong argument");
+	const std::runtime_error run_err("Wrong file");
+	ABM abm = create_abm(0.25, 10);
+
+	bool verbose = false;
+	if (!exception_test(verbose, &arg_err, [&fname](){ SnapshotWriter writer(fname, 0); })){
+		return false;
+	}
+	if (!exception_test(verbose, &run_err,
+			[](){ SnapshotWriter writer("test_data/no_such_dir/snapshots.bin", 10); })){
+		return false;
+	}
+	{
+		SnapshotWriter writer(fname, 10);
+		writer.record(0, abm.get_vector_of_agents());
+		writer.record(2, abm.get_vector_of_agents());
+		if (!exception_test(verbose, &arg_err,
+				[&writer, &abm](){ writer.record(2, abm.get_vector_of_agents()); })){
+			return false;
+		}
+		std::vector<Agent> fewer(abm.get_vector_of_agents().begin(), abm.get_vector_of_agents().end() - 1);
+		if (!exception_test(verbose, &arg_err, [&writer, &fewer](){ writer.record(3, fewer); })){
+			return false;
+		}
+	}
+
+	SnapshotReader reader(fname);
+	if (!exception_test(verbose, &arg_err, [&reader](){ reader.states_at(1); })){
+		return false;
+	}
+	if (!exception_test(verbose, &run_err,
+			[](){ SnapshotReader rd("test_data/no_such_file.bin"); })){
+		return false;
+	}
+	if (!exception_test(verbose, &run_err,
+			[](){ SnapshotReader rd("test_data/infection_parameters.txt"); })){
+		return false;
+	}
+	std::remove(fname.c_str());
+	return true;
+}
+
+/// Agents of a model reordered for locality are
+/// written with their IDs from the input files
+bool snapshot_external_IDs_test()
+{
+	const std::string fname("test_data/snapshots_ext.bin");
+	const int n_steps = 40;
+	ABM abm = create_abm(0.25, 200);
+	abm.reorder_for_locality();
+	abm.set_random_seed(2021);
+	const std::vector<Agent>& agents = abm.get_vector_of_agents();
+
+	bool reordered = false;
+	for (const auto& agent : agents){
+		if (abm.get_external_agent_ID(agent.get_ID()) != agent.get_ID()){
+			reordered = true;
+			break;
+		}
+	}
+	if (!reordered){
+		std::cerr << "Agents were not reordered" << std::endl;
+		return false;
+	}
+
+	// States in order of the input IDs at every step
+	std::vector<std::vector<std::uint32_t>> expected;
+	{
+		SnapshotWriter writer(fname, 10);
+		for (int ti = 0; ti < n_steps; ++ti){
+			abm.transmit_infection();
+			writer.record(ti, abm);
+			std::vector<std::uint32_t> states(agents.size(), 0);
+			for (const auto& agent : agents){
+				states.at(abm.get_external_agent_ID(agent.get_ID()) - 1) = StateSnapshots::pack(agent);
+			}
+			expected.push_back(states);
+		}
+	}
+
+	SnapshotReader reader(fname);
+	for (int ti = 0; ti < n_steps; ++ti){
+		if (reader.states_at(ti) != expected.at(ti)){
+			std::cerr << "Wrong states at step " << ti << std::endl;
+			return false;
+		}
+	}
+	const auto changed = reader.changes_at(n_steps - 1);
+	for (const auto& change : changed){
+		if (expected.back().at(change.first - 1) != change.second){
+			std::cerr << "Wrong change of agent " << change.first << std::endl;
+			return false;
+		}
+	}
+
+	std::remove(fname.c_str());
+	return true;
+}
+
+/// Packed states of all the agents of a model
+std::vector<std::uint32_t> current_states(const ABM& abm)
+{
+	std::vector<std::uint32_t> states;
+	for (const auto& agent : abm.get_vector_of_agents()){
+		states.push_back(StateSnapshots::pack(agent));
+	}
+	return states;
+}
+
+ABM create_abm(const double dt, int inf0)
+{
+	// Input files
+	std::string fin("test_data/NR_agents.txt");
+	std::string hfile("test_data/NR_households.txt");
+	std::string sfile("test_data/NR_schools.txt");
+	std::string wfile("test_data/NR_workplaces.txt");
+	std::string hsp_file("test_data/NR_hospitals.txt");
+	std::string rh_file("test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles =
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name},
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with testing changes
+	std::string tfname("test_data/tests_with_time.txt");
+
+	ABM abm(dt, pfname, dfiles, tfname);
+
+	// First the places
+	abm.create_households(hfile);
+	abm.create_schools(sfile);
+	abm.create_workplaces(wfile);
+	abm.create_hospitals(hsp_file);
+	abm.create_retirement_homes(rh_file);
+
+	// Then the agents
+	abm.create_agents(fin, inf0);
+
+	return abm;
+}
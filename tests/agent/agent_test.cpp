@@ -10,12 +10,14 @@
 bool agent_constructor_getters_test();
 bool agent_events_test();
 bool agent_out_test();
+bool step_time_test();
 
 int main()
 {
 	test_pass(agent_constructor_getters_test(), "Agent class constructor and getters");
 	test_pass(agent_events_test(), "Agent class event scheduling and handling functionality");
 	test_pass(agent_out_test(), "Agent class ostream operator");
+	test_pass(step_time_test(), "Event times stored as time steps");
 }
 
 /// Tests Agent class constructor and most of existing getters 
@@ -33,7 +35,8 @@ bool agent_constructor_getters_test()
 	double inf_var = 0.2009;
 	double cur_time = 4.0;
 
-	Agent agent(student, works, age, xi, yi, hID, is_hospital_patient, sID, res_rh, works_rh, works_school, wID, works_at_hospital, hspID, infected);
+	AgentProfile profile(student, works, age, xi, yi, is_hospital_patient, sID, res_rh, works_rh, works_school, wID, works_at_hospital);
+	Agent agent(&profile, hID, hspID, infected);
 	agent.set_ID(aID);
 	agent.set_inf_variability_factor(inf_var);
 	
@@ -96,7 +99,8 @@ bool agent_events_test()
 	double t_hsp_icu = cur_time + 2, t_hsp_ih = cur_time + 0.3, t_icu_hsp = cur_time + 11;
 	double t_ih_icu = cur_time + 1, t_ih_hsp = cur_time + 3.1;  
 
-	Agent agent(student, works, age, xi, yi, hID, is_hospital_patient, sID, res_rh, works_rh, works_school, wID, works_at_hospital, hspID, infected);
+	AgentProfile profile(student, works, age, xi, yi, is_hospital_patient, sID, res_rh, works_rh, works_school, wID, works_at_hospital);
+	Agent agent(&profile, hID, hspID, infected);
 	agent.set_ID(aID);
 	agent.set_inf_variability_factor(inf_var);
 	
@@ -171,7 +175,8 @@ bool agent_out_test()
 	int aID = 1;
 	double inf_var = 0.2009;
 
-	Agent agent(student, works, age, xi, yi, hID, is_hospital_patient, sID, res_rh, works_rh, works_school, wID, works_at_hospital, hspID, infected);
+	AgentProfile profile(student, works, age, xi, yi, is_hospital_patient, sID, res_rh, works_rh, works_school, wID, works_at_hospital);
+	Agent agent(&profile, hID, hspID, infected);
 	agent.set_ID(aID);
 
 	// Get directly from the stream and compare
@@ -208,3 +213,69 @@ bool agent_out_test()
 }
 
 
+
+/// Tests rounding and comparisons of times stored as steps
+bool step_time_test()
+{
+	StepTime::set_step_length(0.25);
+	bool passed = true;
+
+	// Rounded up to the next step, except for round-off
+	StepTime t_event(1.1);
+	if (t_event.get_steps() != 5 || !float_equality<double>(t_event, 1.25, 1e-10)){
+		std::cerr << "Wrong rounding of a scheduled time" << std::endl;
+		passed = false;
+	}
+	if (StepTime(1.0 + 1e-9).get_steps() != 4 || StepTime(1.0 - 1e-9).get_steps() != 4){
+		std::cerr << "Round-off moved an event to another step" << std::endl;
+		passed = false;
+	}
+	if (StepTime::current_step(10.0) != 40){
+		std::cerr << "Wrong step of the simulation time" << std::endl;
+		passed = false;
+	}
+
+	// Due at the first step not earlier than the scheduled time
+	if ((t_event <= 1.0) || !(t_event <= 1.25) || !(1.0 < t_event) || (1.25 < t_event)
+			|| (1.5 < t_event) || !(1.5 >= t_event) || (t_event > 2.0)){
+		std::cerr << "Wrong comparison of an event and simulation time" << std::endl;
+		passed = false;
+	}
+
+	// Wrong step length
+	if (!exception_test(false, new std::invalid_argument("Zero step"), 
+			[](){ StepTime::set_step_length(0.0); })){
+		std::cerr << "Failed to throw for a zero step length" << std::endl;
+		passed = false;
+	}
+
+	// Held step length cannot change
+	{
+		StepLengthHold hold(0.25);
+		StepLengthHold copy(hold);
+		StepLengthHold same(0.25);
+		if (StepTime::get_number_of_holders() != 3){
+			std::cerr << "Wrong number of holders of the step length" << std::endl;
+			passed = false;
+		}
+		if (!exception_test(false, new std::runtime_error("Held step"), 
+					[](){ StepTime::set_step_length(0.5); })
+				|| !exception_test(false, new std::runtime_error("Held step"), 
+					[](){ StepLengthHold other(0.5); })){
+			std::cerr << "Failed to throw for a change of a held step length" << std::endl;
+			passed = false;
+		}
+		copy = StepLengthHold();
+		if (StepTime::get_number_of_holders() != 2 || !float_equality<double>(StepTime(1.1), 1.25, 1e-10)){
+			std::cerr << "Wrong step length after releasing a holder" << std::endl;
+			passed = false;
+		}
+	}
+	if (StepTime::get_number_of_holders() != 0){
+		std::cerr << "Step length still held" << std::endl;
+		passed = false;
+	}
+
+	StepTime::set_step_length(1.0);
+	return passed;
+}
@@ -0,0 +1,271 @@
+#include "../../include/c_api/abm_c_api.h"
+#include "../../include/abm.h"
+#include "../common/test_utils.h"
+
+/*****************************************************
+ *
+ * Test suite for the C interface of the model
+ *
+ * Uses the interface through the shared library
+ * when built with compilation.py
+ *
+******************************************************/
+
+// Tests
+bool c_api_same_results_test();
+bool c_api_files_test();
+bool c_api_errors_test();
+
+// Supporting functions
+ABM create_abm(const double dt, int i0);
+abm_input_files input_files();
+
+const std::string segment_file("c_api_segment.bin");
+
+int main()
+{
+	test_pass(c_api_same_results_test(), "Same results as the model, series without copies");
+	test_pass(c_api_files_test(), "Model created from the input files");
+	test_pass(c_api_errors_test(), "Errors reported without exceptions");
+	std::remove(segment_file.c_str());
+}
+
+/// Models created from a segment file and from the
+/// same segment in memory give the results of the model
+/// created from that segment with the same seed
+bool c_api_same_results_test()
+{
+	const double dt = 0.25;
+	const int n_steps = 80;
+	const unsigned seed = 2021;
+
+	// Reference
+	PopulationSegment::publish(create_abm(dt, 100), segment_file);
+	const PopulationSegment segment(segment_file);
+	ABM abm(dt, segment);
+	abm.set_random_seed(seed);
+	abm.create_population(segment);
+	for (int ti = 0; ti < n_steps; ++ti){
+		abm.transmit_infection();
+	}
+
+	// Segment contents in memory, aligned to 8 bytes
+	std::ifstream input(segment_file, std::ios::binary);
+	const std::vector<char> bytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+	std::vector<double> buffer((bytes.size() + sizeof(double) - 1)/sizeof(double));
+	std::memcpy(buffer.data(), bytes.data(), bytes.size());
+
+	abm_model* from_file = abm_create_from_segment(dt, segment_file.c_str(), 0, seed);
+	abm_model* from_buffer = abm_create_from_buffer(dt, buffer.data(), bytes.size(), 0, seed);
+	// Not needed by the model once created
+	std::fill(buffer.begin(), buffer.end(), 0.0);
+	if (from_file == nullptr || from_buffer == nullptr){
+		std::cerr << "Model not created: " << abm_last_error() << std::endl;
+		return false;
+	}
+
+	bool passed = true;
+	for (abm_model* model : {from_file, from_buffer}){
+		if (abm_step(model, n_steps/2) != 0){
+			std::cerr << "Error during the simulation: " << abm_last_error() << std::endl;
+			passed = false;
+			break;
+		}
+		// Series are read in place
+		std::size_t length = 0;
+		const int* infected_half = abm_get_series(model, ABM_INFECTED_DAY, &length);
+		if (length != n_steps/2 || abm_get_series(model, ABM_INFECTED_DAY, &length) != infected_half){
+			std::cerr << "Series copied or with a wrong length" << std::endl;
+			passed = false;
+		}
+		abm_step(model, n_steps/2);
+
+		if (!float_equality<double>(abm_get_time(model), abm.get_time(), 1e-10)){
+			std::cerr << "Wrong time" << std::endl;
+			passed = false;
+		}
+		const std::vector<int> counters = {abm_get_counter(model, ABM_NUM_INFECTED),
+			abm_get_counter(model, ABM_NUM_EXPOSED), abm_get_counter(model, ABM_NUM_ACTIVE_CASES),
+			abm_get_counter(model, ABM_TOTAL_INFECTED), abm_get_counter(model, ABM_TOTAL_DEAD),
+			abm_get_counter(model, ABM_TESTED_DEAD), abm_get_counter(model, ABM_NOT_TESTED_DEAD),
+			abm_get_counter(model, ABM_TOTAL_RECOVERED), abm_get_counter(model, ABM_TOTAL_TESTED),
+			abm_get_counter(model, ABM_TOTAL_TESTED_POSITIVE), abm_get_counter(model, ABM_TOTAL_TESTED_NEGATIVE),
+			abm_get_counter(model, ABM_TOTAL_TESTED_FALSE_POSITIVE), 
+			abm_get_counter(model, ABM_TOTAL_TESTED_FALSE_NEGATIVE), abm_get_counter(model, ABM_TOTAL_VACCINATED)};
+		const std::vector<int> expected = {abm.get_num_infected(), abm.get_num_exposed(),
+			abm.get_num_active_cases(), abm.get_total_infected(), abm.get_total_dead(),
+			abm.get_tested_dead(), abm.get_not_tested_dead(), abm.get_total_recovered(),
+			abm.get_total_tested(), abm.get_total_tested_positive(), abm.get_total_tested_negative(),
+			abm.get_total_tested_false_positive(), abm.get_total_tested_false_negative(),
+			abm.get_total_vaccinated()};
+		if (counters != expected){
+			std::cerr << "Counters differ from the model" << std::endl;
+			passed = false;
+		}
+
+		const std::vector<abm_series> series = {ABM_INFECTED_DAY, ABM_TESTED_DAY, ABM_TESTED_POSITIVE_DAY,
+			ABM_TESTED_NEGATIVE_DAY, ABM_TESTED_FALSE_POSITIVE_DAY, ABM_TESTED_FALSE_NEGATIVE_DAY, 
+			ABM_VACCINATED_DAY};
+		const std::vector<std::vector<int>> expected_series = {abm.get_infected_day(), abm.get_tested_day(),
+			abm.get_tested_positive_day(), abm.get_tested_negative_day(), abm.get_tested_false_positive_day(),
+			abm.get_tested_false_negative_day(), abm.get_vaccinated_day()};
+		for (int is = 0; is < series.size(); ++is){
+			const int* values = abm_get_series(model, series.at(is), &length);
+			if (values == nullptr || std::vector<int>(values, values + length) != expected_series.at(is)){
+				std::cerr << "Series " << is << " differs from the model" << std::endl;
+				passed = false;
+			}
+		}
+	}
+	abm_destroy(from_file);
+	abm_destroy(from_buffer);
+
+	if (abm.get_total_tested() == 0){
+		std::cerr << "No testing during the simulation" << std::endl;
+		passed = false;
+	}
+	return passed;
+}
+
+/// Model created from the input files has the 
+/// requested number of initially infected
+bool c_api_files_test()
+{
+	const int n_infected = 50;
+	const abm_input_files files = input_files();
+	abm_model* model = abm_create(0.25, &files, n_infected, 1);
+	if (model == nullptr){
+		std::cerr << "Model not created: " << abm_last_error() << std::endl;
+		return false;
+	}
+	bool passed = true;
+	if (abm_api_version() != ABM_C_API_VERSION){
+		std::cerr << "Wrong version of the interface" << std::endl;
+		passed = false;
+	}
+	if (abm_get_counter(model, ABM_TOTAL_INFECTED) != n_infected 
+			|| abm_get_counter(model, ABM_NUM_INFECTED) != n_infected){
+		std::cerr << "Wrong number of initially infected" << std::endl;
+		passed = false;
+	}
+	std::size_t length = 1;
+	if (abm_get_series(model, ABM_INFECTED_DAY, &length) != nullptr || length != 0){
+		std::cerr << "Series not empty before the first step" << std::endl;
+		passed = false;
+	}
+	if (abm_step(model, 4) != 0 || !float_equality<double>(abm_get_time(model), 1.0, 1e-10)){
+		std::cerr << "Wrong time after the steps" << std::endl;
+		passed = false;
+	}
+	abm_destroy(model);
+	return passed;
+}
+
+/// Wrong input is reported through the last error
+bool c_api_errors_test()
+{
+	abm_input_files files = input_files();
+	files.schools = "no_such_file.txt";
+	if (abm_create(0.25, &files, 0, 1) != nullptr || std::string(abm_last_error()).empty()){
+		std::cerr << "No error for a missing file" << std::endl;
+		return false;
+	}
+	files.schools = nullptr;
+	if (abm_create(0.25, &files, 0, 1) != nullptr || abm_create(0.25, nullptr, 0, 1) != nullptr){
+		std::cerr << "No error for missing paths" << std::endl;
+		return false;
+	}
+	if (abm_create_from_segment(0.25, "no_such_segment.bin", 0, 1) != nullptr
+			|| abm_create_from_segment(0.25, nullptr, 0, 1) != nullptr){
+		std::cerr << "No error for a missing segment" << std::endl;
+		return false;
+	}
+	const std::vector<double> not_segment(100, 1.0);
+	if (abm_create_from_buffer(0.25, not_segment.data(), 800, 0, 1) != nullptr
+			|| abm_create_from_buffer(0.25, nullptr, 0, 0, 1) != nullptr){
+		std::cerr << "No error for a wrong buffer" << std::endl;
+		return false;
+	}
+
+	// Handles and enumerations
+	std::size_t length = 1;
+	if (abm_step(nullptr, 1) != -1 || abm_set_random_seed(nullptr, 1) != -1
+			|| abm_get_counter(nullptr, ABM_TOTAL_INFECTED) != -1
+			|| abm_get_series(nullptr, ABM_INFECTED_DAY, &length) != nullptr || length != 0){
+		std::cerr << "No error for a NULL model" << std::endl;
+		return false;
+	}
+	abm_destroy(nullptr);
+	files = input_files();
+	abm_model* model = abm_create(0.25, &files, 0, 1);
+	if (model == nullptr){
+		std::cerr << "Model not created: " << abm_last_error() << std::endl;
+		return false;
+	}
+	const bool wrong_enums = abm_get_counter(model, static_cast<abm_counter>(100)) == -1
+			&& abm_get_series(model, static_cast<abm_series>(100), &length) == nullptr
+			&& std::string(abm_last_error()).find("Wrong series") != std::string::npos;
+	abm_destroy(model);
+	if (!wrong_enums){
+		std::cerr << "No error for a wrong counter or series" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+abm_input_files input_files()
+{
+	abm_input_files files;
+	files.infection_parameters = "../abm/test_data/infection_parameters.txt";
+	files.exposed_never_symptomatic = "../abm/test_data/age_dist_exposed_never_sy.txt";
+	files.hospitalization = "../abm/test_data/age_dist_hospitalization.txt";
+	files.icu = "../abm/test_data/age_dist_hosp_ICU.txt";
+	files.mortality = "../abm/test_data/age_dist_mortality.txt";
+	files.testing = "../abm/test_data/tests_with_time.txt";
+	files.households = "../abm/test_data/NR_households.txt";
+	files.schools = "../abm/test_data/NR_schools.txt";
+	files.workplaces = "../abm/test_data/NR_workplaces.txt";
+	files.hospitals = "../abm/test_data/NR_hospitals.txt";
+	files.retirement_homes = "../abm/test_data/NR_retirement_homes.txt";
+	files.agents = "../abm/test_data/NR_agents.txt";
+	return files;
+}
+
+ABM create_abm(const double dt, int inf0)
+{
+	// Input files
+	std::string fin("../abm/test_data/NR_agents.txt");
+	std::string hfile("../abm/test_data/NR_households.txt");
+	std::string sfile("../abm/test_data/NR_schools.txt");
+	std::string wfile("../abm/test_data/NR_workplaces.txt");
+	std::string hsp_file("../abm/test_data/NR_hospitals.txt");
+	std::string rh_file("../abm/test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("../abm/test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("../abm/test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("../abm/test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("../abm/test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("../abm/test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles =
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name},
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with testing changes
+	std::string tfname("../abm/test_data/tests_with_time.txt");
+
+	ABM abm(dt, pfname, dfiles, tfname);
+
+	// First the places
+	abm.create_households(hfile);
+	abm.create_schools(sfile);
+	abm.create_workplaces(wfile);
+	abm.create_hospitals(hsp_file);
+	abm.create_retirement_homes(rh_file);
+
+	// Then the agents
+	abm.create_agents(fin, inf0);
+
+	return abm;
+}
@@ -0,0 +1,73 @@
+import subprocess, glob, os
+
+#
+# Input 
+#
+
+# Path to the main directory
+path = '../../src/'
+# Compiler options
+cx = 'g++'
+std = '-std=c++11'
+opt = '-O0'
+# Common source files
+src_files = path + 'abm.cpp' 
+src_files += ' ' + path + 'agent.cpp' 
+src_files += ' ' + path + 'infection.cpp'
+src_files += ' ' + path + 'testing.cpp'
+src_files += ' ' + path + 'interventions.cpp'
+src_files += ' ' + path + 'spatial_transmission.cpp'
+src_files += ' ' + path + 'vaccination_campaign.cpp'
+src_files += ' ' + path + 'metrics.cpp'
+src_files += ' ' + path + 'lineage_log.cpp'
+src_files += ' ' + path + 'memory_arena.cpp'
+src_files += ' ' + path + 'io_operations/state_snapshots.cpp'
+src_files += ' ' + path + 'io_operations/input_validator.cpp'
+src_files += ' ' + path + 'shared_population/population_segment.cpp'
+src_files += ' ' + path + 'contributions.cpp'
+src_files += ' ' + path + 'transitions/transitions.cpp'
+src_files += ' ' + path + 'transitions/regular_transitions.cpp'
+src_files += ' ' + path + 'transitions/hsp_employee_transitions.cpp'
+src_files += ' ' + path + 'transitions/hsp_patient_transitions.cpp'
+src_files += ' ' + path + 'transitions/flu_transitions.cpp'
+src_files += ' ' + path + 'states_manager/states_manager.cpp'
+src_files += ' ' + path + 'states_manager/regular_states_manager.cpp'
+src_files += ' ' + path + 'states_manager/hsp_employee_states_manager.cpp'
+src_files += ' ' + path + 'flu.cpp'
+src_files += ' ' + path + 'utils.cpp'
+src_files += ' ' + path + 'places/place.cpp'
+src_files += ' ' + path + 'places/roster.cpp'
+src_files += ' ' + path + 'places/household.cpp'
+src_files += ' ' + path + 'places/workplace.cpp'
+src_files += ' ' + path + 'places/school.cpp'
+src_files += ' ' + path + 'places/hospital.cpp'
+src_files += ' ' + path + 'places/retirement_home.cpp'
+src_files += ' ' + path + 'io_operations/FileHandler.cpp'
+src_files += ' ' + path + 'io_operations/load_parameters.cpp'
+tst_files = '../common/test_utils.cpp'
+# Sources of the library
+lib_files = src_files + ' ' + path + 'c_api/abm_c_api.cpp'
+
+#
+# Library
+#
+
+# Shared library with the C interface
+lib_name = 'libabm.so'
+compile_com = ' '.join([cx, std, opt, '-fPIC -shared', '-o', lib_name, lib_files])
+subprocess.call([compile_com], shell=True)
+
+#
+# Tests
+#
+
+# Test 1
+# C interface through the shared library
+# Name of the executable
+exe_name = 'c_api_test'
+# Files needed only for this build, the model itself
+# is needed only for the reference results
+spec_files = 'c_api_tests.cpp '
+compile_com = ' '.join([cx, std, opt, '-o', exe_name, spec_files, tst_files, src_files, 
+							'-L. -labm -Wl,-rpath,.'])
+subprocess.call([compile_com], shell=True)
@@ -0,0 +1,309 @@
+#include "../../include/calibration/calibration.h"
+#include "../common/test_utils.h"
+
+/*****************************************************
+ *
+ * Test suite for the calibration
+ *
+******************************************************/
+
+// Tests
+bool calibration_evaluation_test();
+bool calibration_methods_test();
+bool calibration_errors_test();
+
+// Supporting functions
+ABM create_abm(const double dt, int i0);
+Calibration::Observation observation(const double time, const double value);
+
+int main()
+{
+	test_pass(calibration_evaluation_test(), "Errors from simulations with replicates");
+	test_pass(calibration_methods_test(), "Nelder-Mead, CMA-ES, and ABC-SMC");
+	test_pass(calibration_errors_test(), "Observations from a file and wrong input");
+}
+
+/// Zero error for the parameters of synthetic data,
+/// the same errors for any number of threads, and
+/// candidates above the bound abandoned
+bool calibration_evaluation_test()
+{
+	const ABM abm = create_abm(0.25, 5);
+	const std::string name("household transmission rate");
+	const double true_value = abm.get_infection_parameters().at(name);
+
+	// Synthetic data from the first replicate
+	Calibration calibration(abm);
+	calibration.add_parameter(name, 0.5*true_value, 2.0*true_value);
+	ABM abm_data(abm);
+	abm_data.set_infection_parameters({{name, true_value}});
+	abm_data.set_random_seed(calibration.replicate_seed(0));
+	std::vector<Calibration::Observation> infected, active;
+	for (int ti = 1; ti <= 24; ++ti){
+		abm_data.transmit_infection();
+		if (ti%8 == 0){
+			infected.push_back(observation(abm_data.get_time(), abm_data.get_total_infected()));
+			active.push_back(observation(abm_data.get_time(), abm_data.get_num_infected()));
+		}
+	}
+	calibration.add_target(Calibration::total_infected, infected);
+	calibration.add_target(Calibration::active_infected, active, 0.5);
+
+	if (!float_equality<double>(calibration.evaluate({true_value}), 0.0, 1e-10)){
+		std::cerr << "Nonzero error for the parameters of the data" << std::endl;
+		return false;
+	}
+	const double error = calibration.evaluate({1.5*true_value});
+	if (error <= 0.0){
+		std::cerr << "Zero error for other parameters" << std::endl;
+		return false;
+	}
+
+	// Replicates in parallel
+	calibration.set_replicates(4);
+	const double error_serial = calibration.evaluate({1.5*true_value});
+	calibration.set_number_of_threads(3);
+	const double error_parallel = calibration.evaluate({1.5*true_value});
+	if (!float_equality<double>(error_serial, error_parallel, 1e-10)){
+		std::cerr << "Errors depend on the number of threads" << std::endl;
+		return false;
+	}
+
+	// Abandoned candidates
+	if (!std::isinf(calibration.evaluate({1.5*true_value}, 0.5*error_serial))
+			|| calibration.get_number_abandoned() != 1){
+		std::cerr << "Candidate above the bound not abandoned" << std::endl;
+		return false;
+	}
+	if (calibration.evaluate({1.5*true_value}, 2.0*error_serial) != error_serial
+			|| calibration.get_number_abandoned() != 1 || calibration.get_number_of_evaluations() != 6){
+		std::cerr << "Wrong evaluation below the bound" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Methods find the minimum of an analytic objective
+bool calibration_methods_test()
+{
+	const ABM abm = create_abm(0.25, 1);
+	const std::vector<double> minimum = {0.3, 1.7};
+	auto quadratic = [&minimum](const std::vector<std::vector<double>>& candidates, 
+									const std::vector<double>& bounds){
+			std::vector<double> errors;
+			for (int i = 0; i < candidates.size(); ++i){
+				const double error = std::pow(candidates.at(i).at(0) - minimum.at(0), 2)
+									+ 2.0*std::pow(candidates.at(i).at(1) - minimum.at(1), 2);
+				errors.push_back(error > bounds.at(i) ? std::numeric_limits<double>::infinity() : error);
+			}
+			return errors;
+		};
+	auto near = [&minimum](const std::vector<double>& values, const double tol){
+			return std::abs(values.at(0) - minimum.at(0)) < tol && std::abs(values.at(1) - minimum.at(1)) < tol;
+		};
+
+	// Nelder-Mead
+	Calibration nm(abm);
+	nm.add_parameter("household transmission rate", 0.0, 1.0);
+	nm.add_parameter("school transmission rate", 1.0, 3.0);
+	nm.set_objective(quadratic);
+	const Calibration::Candidate nm_best = nm.nelder_mead({0.8, 2.5}, 500, 1e-8);
+	if (!near(nm_best.parameters, 1e-3) || nm.get_number_of_evaluations() > 500){
+		std::cerr << "Nelder-Mead did not find the minimum" << std::endl;
+		return false;
+	}
+	if (nm.get_number_abandoned() == 0){
+		std::cerr << "Nelder-Mead did not abandon any candidates" << std::endl;
+		return false;
+	}
+
+	// CMA-ES
+	Calibration cma(abm);
+	cma.add_parameter("household transmission rate", 0.0, 1.0);
+	cma.add_parameter("school transmission rate", 1.0, 3.0);
+	cma.set_objective(quadratic);
+	const Calibration::Candidate cma_best = cma.cma_es({0.8, 2.5}, 0.3, 1000);
+	if (!near(cma_best.parameters, 1e-3) || cma.get_number_of_evaluations() > 1000){
+		std::cerr << "CMA-ES did not find the minimum" << std::endl;
+		return false;
+	}
+
+	// ABC-SMC concentrates around the minimum
+	Calibration abc(abm);
+	abc.add_parameter("household transmission rate", 0.0, 1.0);
+	abc.add_parameter("school transmission rate", 1.0, 3.0);
+	abc.set_objective(quadratic);
+	const std::vector<Calibration::Candidate> particles = abc.abc_smc(200, 4, 0.5, 20000);
+	const std::vector<double>& tolerances = abc.get_tolerances();
+	if (particles.size() != 200 || tolerances.size() != 5){
+		std::cerr << "Wrong number of particles or generations" << std::endl;
+		return false;
+	}
+	for (int i = 2; i < tolerances.size(); ++i){
+		if (tolerances.at(i) >= tolerances.at(i-1)){
+			std::cerr << "Tolerances not decreasing" << std::endl;
+			return false;
+		}
+	}
+	std::vector<double> mean(2, 0.0);
+	double total_weight = 0.0;
+	for (const auto& particle : particles){
+		if (particle.error > tolerances.back()){
+			std::cerr << "Particle above the last tolerance" << std::endl;
+			return false;
+		}
+		mean.at(0) += particle.weight*particle.parameters.at(0);
+		mean.at(1) += particle.weight*particle.parameters.at(1);
+		total_weight += particle.weight;
+	}
+	if (!float_equality<double>(total_weight, 1.0, 1e-10) || !near(mean, 0.05)){
+		std::cerr << "Particles not around the minimum" << std::endl;
+		return false;
+	}
+
+	// Error equal to the first parameter, the posterior is uniform between
+	// zero and the last tolerance where the kernel is strongly truncated
+	Calibration edge(abm);
+	edge.add_parameter("household transmission rate", 0.0, 1.0);
+	edge.add_parameter("school transmission rate", 1.0, 3.0);
+	edge.set_objective([](const std::vector<std::vector<double>>& candidates, 
+							const std::vector<double>& bounds){ 
+			std::vector<double> errors;
+			for (const auto& candidate : candidates){
+				errors.push_back(candidate.at(0));
+			}
+			return errors;
+		});
+	const std::vector<Calibration::Candidate> posterior = edge.abc_smc(8000, 4, 0.5, 200000);
+	const double eps = edge.get_tolerances().back();
+	double edge_mean = 0.0, edge_mass = 0.0;
+	for (const auto& particle : posterior){
+		edge_mean += particle.weight*particle.parameters.at(0)/eps;
+		if (particle.parameters.at(0) < 0.2*eps){
+			edge_mass += particle.weight;
+		}
+	}
+	if (!float_equality<double>(edge_mean, 0.5, 0.01) || !float_equality<double>(edge_mass, 0.2, 0.015)){
+		std::cerr << "Weighted particles not uniform near the edge of the prior: mean " 
+				  << edge_mean << ", fraction in the first fifth " << edge_mass << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Observations from a file and wrong input
+bool calibration_errors_test()
+{
+	// Days and total number of cases, rows with missing values skipped
+	const std::vector<Calibration::Observation> observations = 
+		Calibration::load_observations("../abm/test_data/New_Rochelle_covid_data.txt", 1, 3, 10.0);
+	if (observations.size() != 77 
+			|| !float_equality<double>(observations.front().time, 10.0, 1e-10)
+			|| !float_equality<double>(observations.front().value, 1.0, 1e-10)
+			|| !float_equality<double>(observations.back().time, 150.0, 1e-10)
+			|| !float_equality<double>(observations.back().value, 3122.0, 1e-10)){
+		std::cerr << "Wrong observations from the file" << std::endl;
+		return false;
+	}
+
+	const ABM abm = create_abm(0.25, 1);
+	Calibration calibration(abm);
+	bool verbose = false;
+	if (!exception_test(verbose, new std::runtime_error("No parameters"), 
+			[&calibration](){ calibration.evaluate({}); })){
+		std::cerr << "Evaluation without parameters" << std::endl;
+		return false;
+	}
+	if (!exception_test(verbose, new std::invalid_argument("Unknown parameter"), 
+			[&calibration](){ calibration.add_parameter("not a parameter", 0.0, 1.0); })){
+		std::cerr << "Unknown parameter accepted" << std::endl;
+		return false;
+	}
+	if (!exception_test(verbose, new std::invalid_argument("Wrong range"), 
+			[&calibration](){ calibration.add_parameter("household transmission rate", 1.0, 1.0); })){
+		std::cerr << "Empty range accepted" << std::endl;
+		return false;
+	}
+	calibration.add_parameter("household transmission rate", 0.0, 1.0);
+	if (!exception_test(verbose, new std::runtime_error("No observations"), 
+			[&calibration](){ calibration.evaluate({0.5}); })){
+		std::cerr << "Evaluation without observations" << std::endl;
+		return false;
+	}
+	if (!exception_test(verbose, new std::invalid_argument("Negative time"), 
+			[&calibration](){ calibration.add_target(Calibration::total_dead, {observation(-1.0, 0.0)}); })){
+		std::cerr << "Observation before the start accepted" << std::endl;
+		return false;
+	}
+	calibration.add_target(Calibration::total_dead, {observation(1.0, 0.0)});
+	if (!exception_test(verbose, new std::invalid_argument("Wrong number of values"), 
+			[&calibration](){ calibration.evaluate({0.5, 0.5}); })){
+		std::cerr << "Wrong number of values accepted" << std::endl;
+		return false;
+	}
+	if (!exception_test(verbose, new std::runtime_error("Missing file"), 
+			[](){ Calibration::load_observations("not_a_file.txt", 0, 1); })){
+		std::cerr << "Missing file of observations" << std::endl;
+		return false;
+	}
+
+	// Too many evaluations needed
+	calibration.set_objective([](const std::vector<std::vector<double>>& candidates, 
+									const std::vector<double>& bounds){
+			return std::vector<double>(candidates.size(), 1.0); 
+		});
+	if (!exception_test(verbose, new std::runtime_error("Evaluation limit"), 
+			[&calibration](){ calibration.abc_smc(10, 2, 0.5, 15); })){
+		std::cerr << "ABC-SMC above the evaluation limit" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+Calibration::Observation observation(const double time, const double value)
+{
+	Calibration::Observation obs;
+	obs.time = time;
+	obs.value = value;
+	return obs;
+}
+
+ABM create_abm(const double dt, int inf0)
+{
+	// Input files
+	std::string fin("../abm/test_data/NR_agents.txt");
+	std::string hfile("../abm/test_data/NR_households.txt");
+	std::string sfile("../abm/test_data/NR_schools.txt");
+	std::string wfile("../abm/test_data/NR_workplaces.txt");
+	std::string hsp_file("../abm/test_data/NR_hospitals.txt");
+	std::string rh_file("../abm/test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("../abm/test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("../abm/test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("../abm/test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("../abm/test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("../abm/test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles =
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name},
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with testing changes
+	std::string tfname("../abm/test_data/tests_with_time.txt");
+
+	ABM abm(dt, pfname, dfiles, tfname);
+
+	// First the places
+	abm.create_households(hfile);
+	abm.create_schools(sfile);
+	abm.create_workplaces(wfile);
+	abm.create_hospitals(hsp_file);
+	abm.create_retirement_homes(rh_file);
+
+	// Then the agents, the same initially infected in each run
+	abm.set_random_seed(2);
+	abm.create_agents(fin, inf0);
+
+	return abm;
+}
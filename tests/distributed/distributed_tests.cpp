@@ -0,0 +1,530 @@
+#include "../../include/distributed/local_communicator.h"
+#include "../../include/distributed/population_partitioner.h"
+#include "../../include/distributed/distributed_abm.h"
+#include "../../include/utils.h"
+#include "../common/test_utils.h"
+
+/*****************************************************
+ *
+ * Test suite for the distributed execution
+ *
+******************************************************/
+
+// Tests
+bool communicator_test();
+bool partition_test();
+bool distributed_contributions_test();
+bool distributed_run_test();
+bool numa_topology_test();
+bool numa_run_test();
+
+// Supporting functions
+ABM create_abm(const double dt, int i0);
+template <typename T>
+bool compare_contributions(const std::vector<T>& places, const std::vector<T>& expected,
+							const std::vector<int>& ranks, const int rank, const std::string& place_type);
+template <typename T>
+bool check_place_ranks(const std::vector<T>& places, const std::vector<int>& ranks,
+						const PopulationPartitioner& partition);
+
+int main()
+{
+	test_pass(communicator_test(), "Communication between processes");
+	test_pass(partition_test(), "Population partitioning");
+	test_pass(distributed_contributions_test(), "Place contributions from all processes");
+	test_pass(distributed_run_test(), "Collected simulation data");
+	test_pass(numa_topology_test(), "Memory nodes and their processes");
+	test_pass(numa_run_test(), "Processes pinned to memory nodes");
+}
+
+/// Sums of values from all processes
+bool communicator_test()
+{
+	const int n_ranks = 3;
+	std::unique_ptr<LocalCommunicator> comm = LocalCommunicator::spawn(n_ranks);
+	const int rank = comm->rank();
+	int n_errors = 0;
+
+	if (comm->size() != n_ranks){
+		++n_errors;
+	}
+
+	// Sums on every process
+	std::vector<double> dvals = {0.5*rank, 1.0, -2.0*rank};
+	comm->allreduce_sum(dvals);
+	if (!float_equality<double>(dvals.at(0), 1.5, 1e-12)
+			|| !float_equality<double>(dvals.at(1), 3.0, 1e-12)
+			|| !float_equality<double>(dvals.at(2), -6.0, 1e-12)){
+		++n_errors;
+	}
+	std::vector<int> ivals = {rank, 1};
+	comm->allreduce_sum(ivals);
+	if (ivals.at(0) != 3 || ivals.at(1) != 3){
+		++n_errors;
+	}
+
+	// Sums on rank 0 only
+	ivals = {rank + 1};
+	comm->reduce_sum(ivals);
+	if ((rank == 0 && ivals.at(0) != 6) || (rank != 0 && ivals.at(0) != rank + 1)){
+		++n_errors;
+	}
+	comm->barrier();
+
+	// Collect the errors
+	std::vector<int> errors = {n_errors};
+	comm->reduce_sum(errors);
+	if (!comm->finalize()){
+		std::cerr << "Not all processes exited normally" << std::endl;
+		return false;
+	}
+	if (errors.at(0) != 0){
+		std::cerr << "Wrong sums on " << errors.at(0) << " occasions" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Households are not split, processes have similar loads,
+/// and owners of places are valid
+bool partition_test()
+{
+	const int n_ranks = 4;
+	ABM abm = create_abm(0.25, 1);
+	PopulationPartitioner partition(abm, n_ranks);
+	const std::vector<Agent>& agents = abm.get_vector_of_agents();
+
+	if (partition.get_number_of_ranks() != n_ranks){
+		std::cerr << "Wrong number of ranks" << std::endl;
+		return false;
+	}
+
+	// Every agent on exactly one process
+	std::vector<int> n_local(agents.size(), 0);
+	for (int r = 0; r < n_ranks; ++r){
+		const std::vector<bool> local_flags = partition.get_local_agents(r);
+		for (int i = 0; i < local_flags.size(); ++i){
+			if (local_flags.at(i)){
+				++n_local.at(i);
+			}
+		}
+	}
+	if (std::any_of(n_local.begin(), n_local.end(), [](const int n){ return n != 1; })){
+		std::cerr << "Agents not assigned to exactly one process" << std::endl;
+		return false;
+	}
+
+	// Households and retirement homes residents together
+	for (const auto& house : abm.get_vector_of_households()){
+		for (const auto& aID : house.get_agent_IDs_ref()){
+			if (partition.get_agent_rank(aID) != partition.get_agent_rank(house.get_agent_IDs_ref().front())){
+				std::cerr << "Household " << house.get_ID() << " split between processes" << std::endl;
+				return false;
+			}
+		}
+	}
+	for (const auto& rh : abm.get_vector_of_retirement_homes()){
+		int rh_rank = -1;
+		for (const auto& aID : rh.get_agent_IDs_ref()){
+			const Agent& agent = agents.at(aID-1);
+			if (!agent.retirement_home_resident()){
+				continue;
+			}
+			if (rh_rank >= 0 && partition.get_agent_rank(aID) != rh_rank){
+				std::cerr << "Residents of retirement home " << rh.get_ID()
+						  << " split between processes" << std::endl;
+				return false;
+			}
+			rh_rank = partition.get_agent_rank(aID);
+		}
+	}
+
+	// Balance within the size of the largest unit
+	int max_unit = 1;
+	for (const auto& house : abm.get_vector_of_households()){
+		max_unit = std::max(max_unit, static_cast<int>(house.get_agent_IDs_ref().size()));
+	}
+	for (const auto& rh : abm.get_vector_of_retirement_homes()){
+		max_unit = std::max(max_unit, static_cast<int>(rh.get_agent_IDs_ref().size()));
+	}
+	const std::vector<int> n_agents = partition.get_number_of_agents_per_rank();
+	const int n_ideal = agents.size()/n_ranks;
+	for (const auto& n : n_agents){
+		if (std::abs(n - n_ideal) > max_unit + 1){
+			std::cerr << "Unbalanced partition, " << n << " agents instead of " << n_ideal << std::endl;
+			return false;
+		}
+	}
+
+	// Owners within range, and owning the most members
+	const std::vector<School>& schools = abm.get_vector_of_schools();
+	const std::vector<int>& owners = partition.get_school_owners();
+	if (owners.size() != schools.size()){
+		std::cerr << "Wrong number of school owners" << std::endl;
+		return false;
+	}
+	for (int i = 0; i < schools.size(); ++i){
+		std::vector<int> n_members(n_ranks, 0);
+		for (const auto& aID : schools.at(i).get_agent_IDs_ref()){
+			++n_members.at(partition.get_agent_rank(aID));
+		}
+		if (owners.at(i) < 0 || owners.at(i) >= n_ranks
+				|| n_members.at(owners.at(i)) != *std::max_element(n_members.begin(), n_members.end())){
+			std::cerr << "Wrong owner of school " << schools.at(i).get_ID() << std::endl;
+			return false;
+		}
+	}
+	// Processes of places not shared include all their registered agents
+	if (!check_place_ranks(abm.get_vector_of_households(), partition.get_household_ranks(), partition)
+			|| !check_place_ranks(schools, partition.get_school_ranks(), partition)
+			|| !check_place_ranks(abm.get_vector_of_workplaces(), partition.get_workplace_ranks(), partition)
+			|| !check_place_ranks(abm.get_vector_of_retirement_homes(), 
+									partition.get_retirement_home_ranks(), partition)){
+		return false;
+	}
+	for (const auto& place_owners : {partition.get_workplace_owners(), partition.get_hospital_owners(),
+										partition.get_retirement_home_owners()}){
+		for (const auto& owner : place_owners){
+			if (owner < 0 || owner >= n_ranks){
+				std::cerr << "Place owner outside of the range of processes" << std::endl;
+				return false;
+			}
+		}
+	}
+
+	// Wrong input
+	if (!exception_test(false, new std::invalid_argument("Wrong number of ranks"),
+			[&abm](){ PopulationPartitioner wrong(abm, 0); })){
+		std::cerr << "Failed to throw for zero processes" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Contributions of places equal to a single process computation,
+/// including changes in registered agents by one of the processes
+bool distributed_contributions_test()
+{
+	const int n_ranks = 3;
+	ABM abm = create_abm(0.25, 500);
+	PopulationPartitioner partition(abm, n_ranks);
+	// Time when most of the initially infected are infectious
+	for (int ti = 0; ti < 40; ++ti){
+		abm.advance_in_time();
+	}
+
+	// Student not on rank 0 removed from a school
+	int moved_ID = 0;
+	for (const auto& agent : abm.get_vector_of_agents()){
+		if (agent.student() && partition.get_agent_rank(agent.get_ID()) != 0){
+			moved_ID = agent.get_ID();
+			break;
+		}
+	}
+	const int school_ID = abm.get_vector_of_agents().at(moved_ID-1).get_school_ID();
+
+	// Single process reference
+	ABM reference(abm);
+	reference.vector_of_schools().at(school_ID-1).remove_agent(moved_ID);
+	reference.compute_place_contributions();
+
+	std::unique_ptr<LocalCommunicator> comm = LocalCommunicator::spawn(n_ranks);
+	DistributedABM dabm(abm, *comm, partition, 2021);
+	if (partition.get_agent_rank(moved_ID) == comm->rank()){
+		abm.vector_of_schools().at(school_ID-1).remove_agent(moved_ID);
+	}
+	dabm.compute_place_contributions();
+
+	int n_errors = 0;
+	const std::vector<School>& ref_schools = reference.get_vector_of_schools();
+	if (std::none_of(ref_schools.begin(), ref_schools.end(), 
+			[](const School& school){ return school.get_infected_contribution() > 0.0; })){
+		std::cerr << "No infectious agents in schools" << std::endl;
+		++n_errors;
+	}
+	const int rank = comm->rank();
+	if (!compare_contributions(abm.get_vector_of_households(), reference.get_vector_of_households(),
+								partition.get_household_ranks(), rank, "household")){
+		++n_errors;
+	}
+	if (!compare_contributions(abm.get_vector_of_schools(), reference.get_vector_of_schools(),
+								partition.get_school_ranks(), rank, "school")){
+		++n_errors;
+	}
+	if (!compare_contributions(abm.get_vector_of_workplaces(), reference.get_vector_of_workplaces(),
+								partition.get_workplace_ranks(), rank, "workplace")){
+		++n_errors;
+	}
+	const std::vector<int> hospital_ranks(abm.get_vector_of_hospitals().size(), -1);
+	if (!compare_contributions(abm.get_vector_of_hospitals(), reference.get_vector_of_hospitals(),
+								hospital_ranks, rank, "hospital")){
+		++n_errors;
+	}
+	if (!compare_contributions(abm.get_vector_of_retirement_homes(), reference.get_vector_of_retirement_homes(),
+								partition.get_retirement_home_ranks(), rank, "retirement home")){
+		++n_errors;
+	}
+
+	// Only places with members on several processes are exchanged
+	const int n_places = abm.get_vector_of_households().size() + abm.get_vector_of_schools().size()
+							+ abm.get_vector_of_workplaces().size() + abm.get_vector_of_hospitals().size()
+							+ abm.get_vector_of_retirement_homes().size();
+	if (dabm.get_number_of_shared_places() < abm.get_vector_of_hospitals().size()
+			|| dabm.get_number_of_shared_places() >= n_places/2){
+		std::cerr << "Wrong number of shared places: " << dabm.get_number_of_shared_places() 
+				  << " out of " << n_places << std::endl;
+		++n_errors;
+	}
+
+	std::vector<int> errors = {n_errors};
+	comm->reduce_sum(errors);
+	if (!comm->finalize()){
+		std::cerr << "Not all processes exited normally" << std::endl;
+		return false;
+	}
+	return errors.at(0) == 0;
+}
+
+/// Totals collected from all processes are consistent
+/// with the daily series and the population
+bool distributed_run_test()
+{
+	const int n_ranks = 2;
+	const int n_steps = 120;
+	ABM abm = create_abm(0.25, 100);
+	PopulationPartitioner partition(abm, n_ranks);
+	const int n_agents = abm.get_vector_of_agents().size();
+	const int n_initial = abm.get_total_infected();
+
+	std::unique_ptr<LocalCommunicator> comm = LocalCommunicator::spawn(n_ranks);
+	DistributedABM dabm(abm, *comm, partition, 7);
+
+	std::vector<int> infected_counts;
+	for (int ti = 0; ti < n_steps; ++ti){
+		dabm.transmit_infection();
+		infected_counts.push_back(dabm.get_num_infected());
+	}
+	const int n_infected = dabm.get_total_infected();
+	const int n_tested = dabm.get_total_tested();
+	const std::vector<int> infected_day = dabm.get_infected_day();
+	const std::vector<int> tested_day = dabm.get_tested_day();
+	const int n_current = dabm.get_num_infected();
+	const bool same_time = float_equality<double>(dabm.get_time(), n_steps*0.25, 1e-10);
+
+	// Only rank 0 continues past this point
+	if (!comm->finalize()){
+		std::cerr << "Not all processes exited normally" << std::endl;
+		return false;
+	}
+
+	if (!same_time || infected_day.size() != n_steps){
+		std::cerr << "Wrong number of steps" << std::endl;
+		return false;
+	}
+	if (std::accumulate(infected_day.begin(), infected_day.end(), 0) + n_initial != n_infected){
+		std::cerr << "Daily infections inconsistent with the total" << std::endl;
+		return false;
+	}
+	if (std::accumulate(tested_day.begin(), tested_day.end(), 0) != n_tested){
+		std::cerr << "Daily tests inconsistent with the total" << std::endl;
+		return false;
+	}
+	if (n_current > n_infected || n_infected > n_agents){
+		std::cerr << "Currently infected inconsistent with the totals" << std::endl;
+		return false;
+	}
+	if (n_infected <= n_initial){
+		std::cerr << "Infection did not spread" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Nodes read from the sysfs layout and the mapping of processes
+bool numa_topology_test()
+{
+	const std::vector<int> cpus = NumaTopology::parse_cpu_list(" 0-3,8, 10-11");
+	if (cpus != std::vector<int>({0, 1, 2, 3, 8, 10, 11}) || !NumaTopology::parse_cpu_list("").empty()){
+		std::cerr << "Wrong CPU list" << std::endl;
+		return false;
+	}
+	const std::invalid_argument err("Wrong CPU list");
+	for (const std::string list : {"3-1", "a", "1-", "0,-2"}){
+		if (!exception_test(false, &err, NumaTopology::parse_cpu_list, list)){
+			std::cerr << "Wrong CPU list accepted: " << list << std::endl;
+			return false;
+		}
+	}
+
+	// Two nodes with CPUs and one with memory only
+	NumaTopology topology("test_data/numa");
+	if (topology.get_number_of_nodes() != 2 || !topology.is_numa()
+			|| topology.get_cpus(0) != std::vector<int>({0, 1, 4})
+			|| topology.get_cpus(1) != std::vector<int>({2, 3, 5})){
+		std::cerr << "Wrong nodes" << std::endl;
+		return false;
+	}
+	const std::vector<int> four = {0, 0, 1, 1}, three = {0, 0, 1};
+	for (int rank = 0; rank < 4; ++rank){
+		if (topology.get_rank_node(rank, 4) != four.at(rank) 
+				|| (rank < 3 && topology.get_rank_node(rank, 3) != three.at(rank))){
+			std::cerr << "Wrong default node of rank " << rank << std::endl;
+			return false;
+		}
+	}
+	topology.set_rank_nodes({1, 0});
+	if (topology.get_rank_node(0, 2) != 1 || topology.get_rank_node(1, 2) != 0){
+		std::cerr << "Wrong node of a rank set by the user" << std::endl;
+		return false;
+	}
+	if (!exception_test(false, &err, [&topology](){ topology.get_rank_node(0, 3); })
+			|| !exception_test(false, &err, [&topology](){ topology.set_rank_nodes({0, 2}); })){
+		std::cerr << "Wrong mapping of ranks accepted" << std::endl;
+		return false;
+	}
+
+	// Fallback
+	const NumaTopology single("test_data/no_such_directory");
+	if (single.get_number_of_nodes() != 1 || single.is_numa() || single.get_cpus(0).empty()){
+		std::cerr << "Wrong fallback without node information" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Pinned processes give the same results as the regular run
+bool numa_run_test()
+{
+	const int n_ranks = 2;
+	const int n_steps = 60;
+	ABM abm = create_abm(0.25, 100);
+	PopulationPartitioner partition(abm, n_ranks);
+	const NumaTopology topology;
+
+	std::vector<std::vector<int>> infected_counts(2);
+	std::vector<int> totals;
+	for (int run = 0; run < 2; ++run){
+		ABM model(abm);
+		std::unique_ptr<LocalCommunicator> comm = LocalCommunicator::spawn(n_ranks);
+		std::unique_ptr<DistributedABM> dabm;
+		if (run == 0){
+			dabm.reset(new DistributedABM(model, *comm, partition, 11));
+		} else {
+			dabm.reset(new DistributedABM(model, *comm, partition, 11, topology));
+		}
+		const int node = dabm->get_node();
+		for (int ti = 0; ti < n_steps; ++ti){
+			dabm->transmit_infection();
+			infected_counts.at(run).push_back(dabm->get_num_infected());
+		}
+		totals.push_back(dabm->get_total_infected());
+		totals.push_back(dabm->get_total_tested());
+		// Only rank 0 continues past this point
+		if (!comm->finalize()){
+			std::cerr << "Not all processes exited normally" << std::endl;
+			return false;
+		}
+		if ((run == 0 && node != -1) || (run == 1 && (node < 0 || node >= topology.get_number_of_nodes()))){
+			std::cerr << "Wrong node of rank 0" << std::endl;
+			return false;
+		}
+	}
+
+	if (infected_counts.at(0) != infected_counts.at(1) || totals.at(0) != totals.at(2) 
+			|| totals.at(1) != totals.at(3)){
+		std::cerr << "Pinned run differs from the regular run" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Compare contributions of shared places to the reference,
+// also verify that the owners were used
+template <typename T>
+bool compare_contributions(const std::vector<T>& places, const std::vector<T>& expected,
+							const std::vector<int>& ranks, const int rank, const std::string& place_type)
+{
+	if (places.size() != ranks.size()){
+		std::cerr << "Wrong number of " << place_type << " processes" << std::endl;
+		return false;
+	}
+	for (int i = 0; i < places.size(); ++i){
+		// Places not shared are only computed by the process of their members
+		if (ranks.at(i) >= 0 && ranks.at(i) != rank){
+			continue;
+		}
+		if (!float_equality<double>(places.at(i).get_infected_contribution(),
+					expected.at(i).get_infected_contribution(), 1e-10)
+				|| places.at(i).get_total_infected() != expected.at(i).get_total_infected()){
+			std::cerr << "Wrong contribution of " << place_type << " "
+					  << places.at(i).get_ID() << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename T>
+bool check_place_ranks(const std::vector<T>& places, const std::vector<int>& ranks,
+						const PopulationPartitioner& partition)
+{
+	if (places.size() != ranks.size()){
+		std::cerr << "Wrong number of place processes" << std::endl;
+		return false;
+	}
+	for (int i = 0; i < places.size(); ++i){
+		if (ranks.at(i) < -1 || ranks.at(i) >= partition.get_number_of_ranks()){
+			std::cerr << "Process of place " << places.at(i).get_ID() << " out of range" << std::endl;
+			return false;
+		}
+		if (ranks.at(i) == -1){
+			continue;
+		}
+		for (const auto& aID : places.at(i).get_agent_IDs_ref()){
+			if (partition.get_agent_rank(aID) != ranks.at(i)){
+				std::cerr << "Place " << places.at(i).get_ID() << " has members on other processes" << std::endl;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+ABM create_abm(const double dt, int inf0)
+{
+	// Input files
+	std::string fin("../abm/test_data/NR_agents.txt");
+	std::string hfile("../abm/test_data/NR_households.txt");
+	std::string sfile("../abm/test_data/NR_schools.txt");
+	std::string wfile("../abm/test_data/NR_workplaces.txt");
+	std::string hsp_file("../abm/test_data/NR_hospitals.txt");
+	std::string rh_file("../abm/test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("../abm/test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("../abm/test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("../abm/test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("../abm/test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("../abm/test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles =
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name},
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with testing changes
+	std::string tfname("../abm/test_data/tests_with_time.txt");
+
+	ABM abm(dt, pfname, dfiles, tfname);
+
+	// First the places
+	abm.create_households(hfile);
+	abm.create_schools(sfile);
+	abm.create_workplaces(wfile);
+	abm.create_hospitals(hsp_file);
+	abm.create_retirement_homes(rh_file);
+
+	// Then the agents
+	abm.create_agents(fin, inf0);
+
+	return abm;
+}
@@ -0,0 +1,63 @@
+import subprocess, glob, os
+
+#
+# Input 
+#
+
+# Path to the main directory
+path = '../../src/'
+# Compiler options
+cx = 'g++'
+std = '-std=c++11'
+opt = '-O0'
+threads = '-pthread'
+# Common source files
+src_files = path + 'abm.cpp' 
+src_files += ' ' + path + 'agent.cpp' 
+src_files += ' ' + path + 'infection.cpp'
+src_files += ' ' + path + 'testing.cpp'
+src_files += ' ' + path + 'interventions.cpp'
+src_files += ' ' + path + 'spatial_transmission.cpp'
+src_files += ' ' + path + 'vaccination_campaign.cpp'
+src_files += ' ' + path + 'metrics.cpp'
+src_files += ' ' + path + 'lineage_log.cpp'
+src_files += ' ' + path + 'memory_arena.cpp'
+src_files += ' ' + path + 'io_operations/state_snapshots.cpp'
+src_files += ' ' + path + 'io_operations/input_validator.cpp'
+src_files += ' ' + path + 'shared_population/population_segment.cpp'
+src_files += ' ' + path + 'contributions.cpp'
+src_files += ' ' + path + 'transitions/transitions.cpp'
+src_files += ' ' + path + 'transitions/regular_transitions.cpp'
+src_files += ' ' + path + 'transitions/hsp_employee_transitions.cpp'
+src_files += ' ' + path + 'transitions/hsp_patient_transitions.cpp'
+src_files += ' ' + path + 'transitions/flu_transitions.cpp'
+src_files += ' ' + path + 'states_manager/states_manager.cpp'
+src_files += ' ' + path + 'states_manager/regular_states_manager.cpp'
+src_files += ' ' + path + 'states_manager/hsp_employee_states_manager.cpp'
+src_files += ' ' + path + 'flu.cpp'
+src_files += ' ' + path + 'utils.cpp'
+src_files += ' ' + path + 'places/place.cpp'
+src_files += ' ' + path + 'places/roster.cpp'
+src_files += ' ' + path + 'places/household.cpp'
+src_files += ' ' + path + 'places/workplace.cpp'
+src_files += ' ' + path + 'places/school.cpp'
+src_files += ' ' + path + 'places/hospital.cpp'
+src_files += ' ' + path + 'places/retirement_home.cpp'
+src_files += ' ' + path + 'io_operations/FileHandler.cpp'
+src_files += ' ' + path + 'io_operations/load_parameters.cpp'
+src_files += ' ' + path + 'parameter_sweep/work_stealing_pool.cpp'
+src_files += ' ' + path + 'ensemble/splitting_ensemble.cpp'
+tst_files = '../common/test_utils.cpp'
+
+#
+# Tests
+#
+
+# Test 1
+# Splitting ensemble
+# Name of the executable
+exe_name = 'ensemble_test'
+# Files needed only for this build
+spec_files = 'splitting_ensemble_tests.cpp '
+compile_com = ' '.join([cx, std, opt, threads, '-o', exe_name, spec_files, tst_files, src_files])
+subprocess.call([compile_com], shell=True)
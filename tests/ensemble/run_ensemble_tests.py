@@ -0,0 +1,19 @@
+import subprocess
+
+import sys
+py_path = '../../scripts/'
+sys.path.insert(0, py_path)
+
+import utils as ut
+from colors import *
+
+#
+# Compile and run all the splitting ensemble tests
+#
+
+# Compile
+subprocess.call(['python3.6 compilation.py'], shell=True)
+
+# Test suite 1
+ut.msg('Splitting ensemble test', CYAN)
+subprocess.call(['./ensemble_test'], shell=True)
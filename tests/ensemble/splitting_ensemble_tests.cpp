@@ -0,0 +1,227 @@
+#include "../../include/ensemble/splitting_ensemble.h"
+#include "../common/test_utils.h"
+
+/*****************************************************
+ *
+ * Test suite for the splitting ensemble
+ *
+******************************************************/
+
+// Tests
+bool ensemble_no_selection_test();
+bool ensemble_splitting_test();
+bool ensemble_errors_test();
+
+// Supporting functions
+ABM create_abm(const double dt, int i0);
+
+int main()
+{
+	test_pass(ensemble_no_selection_test(), "Clones and ensemble without selection");
+	test_pass(ensemble_splitting_test(), "Splitting and pruning of replicates");
+	test_pass(ensemble_errors_test(), "Wrong input");
+}
+
+/// Clones made during a run continue the same simulation,
+/// and without selection replicates are independent runs
+bool ensemble_no_selection_test()
+{
+	const int n_steps = 24, n_rep = 4;
+	const ABM abm = create_abm(0.25, 5);
+
+	// Clone in the middle of a run 
+	ABM original(abm);
+	original.set_random_seed(10);
+	for (int ti = 0; ti < n_steps/2; ++ti){
+		original.transmit_infection();
+	}
+	ABM clone(original);
+	original.set_random_seed(11);
+	clone.set_random_seed(11);
+	for (int ti = n_steps/2; ti < n_steps; ++ti){
+		original.transmit_infection();
+		clone.transmit_infection();
+		if (original.get_num_infected() != clone.get_num_infected()
+				|| original.get_total_tested() != clone.get_total_tested()){
+			std::cerr << "Clone differs from the original at step " << ti << std::endl;
+			return false;
+		}
+	}
+
+	// Selection strength 0
+	SplittingEnsemble ensemble(abm, n_rep, n_steps);
+	ensemble.set_selection([](const ABM& model){ return model.get_num_infected(); }, 6, 0.0);
+	ensemble.run(2);
+	if (ensemble.get_checkpoints().size() != 3){
+		std::cerr << "Wrong number of checkpoints" << std::endl;
+		return false;
+	}
+	for (const auto& checkpoint : ensemble.get_checkpoints()){
+		if (checkpoint.n_split != 0 || checkpoint.n_removed != 0 
+				|| !float_equality<double>(checkpoint.ess, n_rep, 1e-10)){
+			std::cerr << "Replicates selected without selection" << std::endl;
+			return false;
+		}
+	}
+	for (int ir = 0; ir < n_rep; ++ir){
+		const SplittingEnsemble::Replicate& rep = ensemble.get_replicates().at(ir);
+		ABM single(abm);
+		single.set_random_seed(ensemble.replicate_seed(0, ir));
+		for (int ti = 0; ti < n_steps; ++ti){
+			single.transmit_infection();
+		}
+		if (rep.origin != ir || !float_equality<double>(rep.weight, 1.0/n_rep, 1e-10)
+				|| rep.abm.get_total_infected() != single.get_total_infected()
+				|| rep.abm.get_total_tested() != single.get_total_tested()){
+			std::cerr << "Replicate " << ir << " differs from a single run" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Replicates with high scores are split, weights
+/// keep the estimates consistent, and results do not
+/// depend on the number of threads
+bool ensemble_splitting_test()
+{
+	const int n_steps = 32, n_rep = 12;
+	const ABM abm = create_abm(0.25, 5);
+	auto infected = [](const ABM& model){ return model.get_num_infected(); };
+
+	SplittingEnsemble plain(abm, n_rep, n_steps);
+	plain.set_selection(infected, 8, 0.0);
+	plain.run(3);
+	SplittingEnsemble splitting(abm, n_rep, n_steps);
+	splitting.set_selection(infected, 8, 0.5);
+	splitting.run(3);
+
+	int n_split = 0;
+	for (const auto& checkpoint : splitting.get_checkpoints()){
+		if (checkpoint.n_split != checkpoint.n_removed || checkpoint.ess > n_rep + 1e-10){
+			std::cerr << "Wrong selection at step " << checkpoint.step << std::endl;
+			return false;
+		}
+		n_split += checkpoint.n_split;
+	}
+	if (n_split == 0){
+		std::cerr << "No replicates split" << std::endl;
+		return false;
+	}
+
+	// More replicates in the tail, estimates within the plain ensemble
+	double plain_score = 0.0, splitting_score = 0.0;
+	double plain_min = 1e10, plain_max = 0.0;
+	for (int ir = 0; ir < n_rep; ++ir){
+		const SplittingEnsemble::Replicate& plain_rep = plain.get_replicates().at(ir);
+		const SplittingEnsemble::Replicate& split_rep = splitting.get_replicates().at(ir);
+		plain_score += plain_rep.max_score/n_rep;
+		splitting_score += split_rep.max_score/n_rep;
+		plain_min = std::min(plain_min, plain_rep.max_score);
+		plain_max = std::max(plain_max, plain_rep.max_score);
+		if (split_rep.weight <= 0.0 || split_rep.origin < 0 || split_rep.origin >= n_rep){
+			std::cerr << "Wrong weight or origin of a replicate" << std::endl;
+			return false;
+		}
+	}
+	if (splitting_score <= plain_score){
+		std::cerr << "Splitting did not favor high scores" << std::endl;
+		return false;
+	}
+	const double mean_score = splitting.estimate([](const SplittingEnsemble::Replicate& rep){ return rep.max_score; })
+								/splitting.estimate([](const SplittingEnsemble::Replicate& rep){ return 1.0; });
+	if (mean_score < plain_min || mean_score > plain_max){
+		std::cerr << "Weighted estimate outside of the plain ensemble" << std::endl;
+		return false;
+	}
+	if (splitting.exceedance_probability(plain_min) <= 0.0 
+			|| splitting.exceedance_probability(1e10) != 0.0){
+		std::cerr << "Wrong exceedance probabilities" << std::endl;
+		return false;
+	}
+
+	// Serial run
+	SplittingEnsemble serial(abm, n_rep, n_steps);
+	serial.set_selection(infected, 8, 0.5);
+	serial.run(1);
+	for (int ir = 0; ir < n_rep; ++ir){
+		const SplittingEnsemble::Replicate& rep = serial.get_replicates().at(ir);
+		const SplittingEnsemble::Replicate& split_rep = splitting.get_replicates().at(ir);
+		if (rep.weight != split_rep.weight || rep.origin != split_rep.origin
+				|| rep.abm.get_total_infected() != split_rep.abm.get_total_infected()){
+			std::cerr << "Results depend on the number of threads" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Wrong input
+bool ensemble_errors_test()
+{
+	const ABM abm = create_abm(0.25, 1);
+	bool verbose = false;
+	if (!exception_test(verbose, new std::invalid_argument("No replicates"), 
+			[&abm](){ SplittingEnsemble ensemble(abm, 0, 10); })){
+		std::cerr << "Ensemble without replicates" << std::endl;
+		return false;
+	}
+	if (!exception_test(verbose, new std::invalid_argument("No steps"), 
+			[&abm](){ SplittingEnsemble ensemble(abm, 2, 0); })){
+		std::cerr << "Ensemble without steps" << std::endl;
+		return false;
+	}
+	SplittingEnsemble ensemble(abm, 2, 10);
+	auto infected = [](const ABM& model){ return model.get_num_infected(); };
+	if (!exception_test(verbose, new std::invalid_argument("Wrong interval"), 
+			[&ensemble, &infected](){ ensemble.set_selection(infected, 0, 1.0); })){
+		std::cerr << "Checkpoints without steps" << std::endl;
+		return false;
+	}
+	if (!exception_test(verbose, new std::invalid_argument("Negative strength"), 
+			[&ensemble, &infected](){ ensemble.set_selection(infected, 2, -1.0); })){
+		std::cerr << "Negative selection strength" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+ABM create_abm(const double dt, int inf0)
+{
+	// Input files
+	std::string fin("../abm/test_data/NR_agents.txt");
+	std::string hfile("../abm/test_data/NR_households.txt");
+	std::string sfile("../abm/test_data/NR_schools.txt");
+	std::string wfile("../abm/test_data/NR_workplaces.txt");
+	std::string hsp_file("../abm/test_data/NR_hospitals.txt");
+	std::string rh_file("../abm/test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("../abm/test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("../abm/test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("../abm/test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("../abm/test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("../abm/test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles =
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name},
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with testing changes
+	std::string tfname("../abm/test_data/tests_with_time.txt");
+
+	ABM abm(dt, pfname, dfiles, tfname);
+
+	// First the places
+	abm.create_households(hfile);
+	abm.create_schools(sfile);
+	abm.create_workplaces(wfile);
+	abm.create_hospitals(hsp_file);
+	abm.create_retirement_homes(rh_file);
+
+	// Then the agents, the same initially infected in each run
+	abm.set_random_seed(2021);
+	abm.create_agents(fin, inf0);
+
+	return abm;
+}
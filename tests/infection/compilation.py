@@ -14,6 +14,7 @@ opt = '-O0'
 src_files = path + 'infection.cpp' 
 src_files += ' ' + path + 'agent.cpp'
 src_files += ' ' + path + 'places/place.cpp'
+src_files += ' ' + path + 'places/roster.cpp'
 src_files += ' ' + path + 'places/household.cpp'
 src_files += ' ' + path + 'utils.cpp'
 src_files += ' ' + path + 'io_operations/FileHandler.cpp'
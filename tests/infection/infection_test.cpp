@@ -35,6 +35,9 @@ bool check_distribution(dist_sampling, Infection&, double);
 bool check_simple_distributions(Infection&, std::vector<double>);
 bool check_random_ID(Infection&);
 bool check_testing_wait_distribution(Infection&);
+bool check_batch_infection(Infection&, const double);
+bool check_place_exposures(Infection&, const double);
+bool check_continuous_exposures(Infection&);
 
 int main()
 {
@@ -78,6 +81,21 @@ bool infection_transmission_test()
 		std::cerr << "Infection computation: should not be infected" << std::endl;
 		return false;
 	}
+	// Batched version
+	if (!check_batch_infection(infection, delta_t)){
+		std::cerr << "Issue with batched infection computation" << std::endl;
+		return false;
+	}
+	// Place-centric version
+	if (!check_place_exposures(infection, delta_t)){
+		std::cerr << "Issue with sampling of exposures in places" << std::endl;
+		return false;
+	}
+	// Continuous time version
+	if (!check_continuous_exposures(infection)){
+		std::cerr << "Issue with exposures in continuous time" << std::endl;
+		return false;
+	}
 
 	// Other probabilities:
 	// Arguments:
@@ -712,3 +730,166 @@ bool check_testing_wait_distribution(Infection& infection)
 	}
 	return true;
 }
+
+/// \brief Verification of batched infection draws
+bool check_batch_infection(Infection& infection, const double dt)
+{
+	// Deterministic outcomes
+	std::vector<double> lambdas = {1e16, 1e-16, 0.0, 1e3, 1e-16};
+	std::vector<int> infected = {10, 20};
+	infection.infected_batch(lambdas, infected);
+	if (infected != std::vector<int>({0, 3})){
+		std::cerr << "Wrong infected agents in a deterministic batch" << std::endl;
+		return false;
+	}
+
+	// Empty batch
+	lambdas.clear();
+	infection.infected_batch(lambdas, infected);
+	if (!infected.empty()){
+		std::cerr << "Infected agents in an empty batch" << std::endl;
+		return false;
+	}
+
+	// Fractions of infected compared to the probability, 
+	// exponentials compared to the standard library
+	const int n_tot = 1e6;
+	const std::vector<double> lambda_values = {0.01, 0.1, 0.5, 2.0};
+	for (const auto& lambda : lambda_values){
+		lambdas.assign(n_tot, lambda);
+		infection.infected_batch(lambdas, infected);
+		const double exp_fraction = 1.0 - std::exp(-dt*lambda);
+		const double fraction = static_cast<double>(infected.size())/static_cast<double>(n_tot);
+		if (!float_equality<double>(fraction, exp_fraction, 0.01)){
+			std::cerr << "Wrong fraction of infected in a batch\nExpected value: " << exp_fraction 
+					  << "\nComputed value: " << fraction << std::endl;
+			return false;
+		}
+		// Indices are unique and in order
+		for (std::size_t i = 1; i < infected.size(); ++i){
+			if (infected.at(i) <= infected.at(i-1)){
+				std::cerr << "Infected indices not in increasing order" << std::endl;
+				return false;
+			}
+		}
+	}
+	for (double x = 0.0; x > -708.0; x -= 0.0137){
+		if (!float_equality<double>(exp_non_positive(x), std::exp(x), 1e-12)){
+			std::cerr << "Wrong exponential for " << x << "\nExpected value: " << std::exp(x) 
+					  << "\nComputed value: " << exp_non_positive(x) << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/// \brief Verification of exposures sampled in places
+bool check_place_exposures(Infection& infection, const double dt)
+{
+	// Deterministic outcomes
+	std::vector<int> exposed = {10, 20};
+	infection.sample_place_exposures(1e16, 5, exposed);
+	if (exposed != std::vector<int>({0, 1, 2, 3, 4})){
+		std::cerr << "Not all members exposed in a place" << std::endl;
+		return false;
+	}
+	infection.sample_place_exposures(0.0, 5, exposed);
+	if (!exposed.empty()){
+		std::cerr << "Exposed members in a place without infected" << std::endl;
+		return false;
+	}
+	if (infection.confirm_exposure(0.1, 1.0) == false){
+		std::cerr << "Exposure with the full lambda should be confirmed" << std::endl;
+		return false;
+	}
+
+	// Fractions of exposed compared to the probability for 
+	// the full and a partial lambda
+	const int n_tot = 1e6;
+	const std::vector<double> lambda_values = {0.01, 0.1, 0.5, 2.0};
+	const double fraction = 0.5;
+	for (const auto& lambda : lambda_values){
+		infection.sample_place_exposures(lambda, n_tot, exposed);
+		double exp_fraction = 1.0 - std::exp(-dt*lambda);
+		double fr_exposed = static_cast<double>(exposed.size())/static_cast<double>(n_tot);
+		if (!float_equality<double>(fr_exposed, exp_fraction, 0.01)){
+			std::cerr << "Wrong fraction of exposed in a place\nExpected value: " << exp_fraction 
+					  << "\nComputed value: " << fr_exposed << std::endl;
+			return false;
+		}
+		for (std::size_t i = 1; i < exposed.size(); ++i){
+			if (exposed.at(i) <= exposed.at(i-1) || exposed.at(i) >= n_tot){
+				std::cerr << "Exposed positions not increasing or out of range" << std::endl;
+				return false;
+			}
+		}
+		int n_confirmed = 0;
+		for (std::size_t i = 0; i < exposed.size(); ++i){
+			if (infection.confirm_exposure(lambda, fraction)){
+				++n_confirmed;
+			}
+		}
+		exp_fraction = 1.0 - std::exp(-dt*lambda*fraction);
+		fr_exposed = static_cast<double>(n_confirmed)/static_cast<double>(n_tot);
+		if (!float_equality<double>(fr_exposed, exp_fraction, 0.01)){
+			std::cerr << "Wrong fraction of confirmed exposures\nExpected value: " << exp_fraction 
+					  << "\nComputed value: " << fr_exposed << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/// \brief Verification of exposures in continuous time
+bool check_continuous_exposures(Infection& infection)
+{
+	// Deterministic outcomes
+	if (infection.time_to_exposure(0.0) != std::numeric_limits<double>::infinity()){
+		std::cerr << "Exposure without any rate" << std::endl;
+		return false;
+	}
+	if (infection.accept_exposure(1.0) == false){
+		std::cerr << "Exposure with the full rate should be accepted" << std::endl;
+		return false;
+	}
+	if (infection.select_by_rate({0.0, 0.0, 2.0, 0.0}, 2.0) != 2){
+		std::cerr << "Selected an entry without a rate" << std::endl;
+		return false;
+	}
+
+	// Mean waiting time, frequencies of selection 
+	// and of accepted exposures
+	const int n_tot = 1e6;
+	const double rate = 2.5, fraction = 0.3;
+	const std::vector<double> rates = {0.5, 0.0, 1.5, 2.0};
+	const double total_rate = 4.0;
+	std::vector<int> n_selected(rates.size(), 0);
+	double t_sum = 0.0;
+	int n_accepted = 0;
+	for (int i = 0; i < n_tot; ++i){
+		t_sum += infection.time_to_exposure(rate);
+		++n_selected.at(infection.select_by_rate(rates, total_rate));
+		if (infection.accept_exposure(fraction)){
+			++n_accepted;
+		}
+	}
+	if (!float_equality<double>(t_sum/n_tot, 1.0/rate, 0.01)){
+		std::cerr << "Wrong mean time to exposure\nExpected value: " << 1.0/rate 
+				  << "\nComputed value: " << t_sum/n_tot << std::endl;
+		return false;
+	}
+	for (std::size_t i = 0; i < rates.size(); ++i){
+		const double fr_selected = static_cast<double>(n_selected.at(i))/n_tot;
+		if (!float_equality<double>(fr_selected, rates.at(i)/total_rate, 0.01)){
+			std::cerr << "Wrong frequency of selection\nExpected value: " << rates.at(i)/total_rate 
+					  << "\nComputed value: " << fr_selected << std::endl;
+			return false;
+		}
+	}
+	if (!float_equality<double>(static_cast<double>(n_accepted)/n_tot, fraction, 0.01)){
+		std::cerr << "Wrong fraction of accepted exposures\nExpected value: " << fraction
+				  << "\nComputed value: " << static_cast<double>(n_accepted)/n_tot << std::endl;
+		return false;
+	}
+	return true;
+}
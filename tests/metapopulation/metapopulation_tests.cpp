@@ -0,0 +1,315 @@
+#include "../../include/metapopulation/metapopulation_abm.h"
+#include "../common/test_utils.h"
+
+/*****************************************************
+ *
+ * Test suite for communities coupled by commuters
+ *
+******************************************************/
+
+typedef PopulationSegment PS;
+
+// Tests
+bool metapopulation_independent_test();
+bool metapopulation_links_test();
+bool metapopulation_threads_test();
+bool metapopulation_errors_test();
+
+// Supporting functions
+ABM create_abm(const double dt, int i0);
+MetapopulationABM create_region(const ABM& north, const ABM& south);
+
+int main()
+{
+	test_pass(metapopulation_independent_test(), "Communities without links");
+	test_pass(metapopulation_links_test(), "Contributions of linked places");
+	test_pass(metapopulation_threads_test(), "Serial and threaded runs");
+	test_pass(metapopulation_errors_test(), "Wrong input");
+}
+
+/// Without links every community runs the same as
+/// on its own, and regional totals are their sums
+bool metapopulation_independent_test()
+{
+	const int n_steps = 40;
+	const ABM abm = create_abm(0.25, 50);
+	ABM alone(abm);
+	alone.set_random_seed(7);
+
+	MetapopulationABM region;
+	region.add_community("north", ABM(abm));
+	region.add_community("south", ABM(abm));
+	region.get_community(0).set_random_seed(7);
+	region.get_community(1).set_random_seed(8);
+
+	for (int ti = 0; ti < n_steps; ++ti){
+		alone.transmit_infection();
+		region.transmit_infection();
+		const ABM& north = region.get_community(0);
+		if (north.get_num_infected() != alone.get_num_infected()
+				|| north.get_total_tested() != alone.get_total_tested()
+				|| !float_equality<double>(north.get_time(), alone.get_time(), 1e-9)){
+			std::cerr << "Community differs from a standalone run at step " << ti << std::endl;
+			return false;
+		}
+	}
+
+	const ABM& south = region.get_community(1);
+	if (region.get_total_infected() != alone.get_total_infected() + south.get_total_infected()
+			|| region.get_infected_day().size() != alone.get_infected_day().size()){
+		std::cerr << "Wrong regional totals" << std::endl;
+		return false;
+	}
+	for (std::size_t i = 0; i < alone.get_infected_day().size(); ++i){
+		if (region.get_infected_day().at(i) != alone.get_infected_day().at(i) + south.get_infected_day().at(i)){
+			std::cerr << "Wrong regional series" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Owners and mirrors have the contribution of all
+/// their agents, other places are not affected
+bool metapopulation_links_test()
+{
+	const double tol = 1e-10;
+	ABM north = create_abm(0.25, 200);
+	ABM south = create_abm(0.25, 300);
+	// Until some of the agents are infectious
+	for (int ti = 0; ti < 12; ++ti){
+		north.transmit_infection();
+		south.transmit_infection();
+	}
+	MetapopulationABM region = create_region(north, south);
+	MetapopulationABM from_file = create_region(north, south);
+	north.compute_place_contributions();
+	south.compute_place_contributions();
+
+	const int n_workplaces = north.get_vector_of_workplaces().size();
+	for (int iw = 1; iw <= n_workplaces/2; ++iw){
+		region.link_places("north", PS::workplaces, iw, "south", iw);
+	}
+	region.compute_place_contributions();
+
+	int n_nonzero = 0;
+	const std::vector<Workplace>& north_work = region.get_community(0).get_vector_of_workplaces();
+	const std::vector<Workplace>& south_work = region.get_community(1).get_vector_of_workplaces();
+	for (int iw = 0; iw < n_workplaces; ++iw){
+		const Workplace& wn = north.get_vector_of_workplaces().at(iw);
+		const Workplace& ws = south.get_vector_of_workplaces().at(iw);
+		double expected_north = wn.get_infected_contribution();
+		double expected_south = ws.get_infected_contribution();
+		if (iw < n_workplaces/2){
+			const int n_agents = wn.get_agent_IDs_ref().size() + ws.get_agent_IDs_ref().size();
+			expected_north = (n_agents == 0) ? 0.0 : (wn.get_lambda_sum() + ws.get_lambda_sum())/n_agents;
+			expected_south = expected_north;
+			n_nonzero += (expected_north > 0.0);
+		}
+		if (!float_equality<double>(north_work.at(iw).get_infected_contribution(), expected_north, tol)
+				|| !float_equality<double>(south_work.at(iw).get_infected_contribution(), expected_south, tol)){
+			std::cerr << "Wrong contribution of workplace " << iw + 1 << std::endl;
+			return false;
+		}
+	}
+	if (n_nonzero == 0){
+		std::cerr << "No linked workplaces with infected agents" << std::endl;
+		return false;
+	}
+
+	// Schools are not linked
+	const std::vector<School>& schools = region.get_community(0).get_vector_of_schools();
+	for (std::size_t is = 0; is < schools.size(); ++is){
+		if (!float_equality<double>(schools.at(is).get_infected_contribution(),
+				north.get_vector_of_schools().at(is).get_infected_contribution(), tol)){
+			std::cerr << "Contribution of a school that is not linked changed" << std::endl;
+			return false;
+		}
+	}
+
+	// Several mirrors of one owner
+	from_file.load_links("test_data/links.txt");
+	from_file.compute_place_contributions();
+	const std::vector<Workplace>& mirrors = from_file.get_community(0).get_vector_of_workplaces();
+	const Workplace& owner = from_file.get_community(1).get_vector_of_workplaces().at(4);
+	const double sum = north.get_vector_of_workplaces().at(2).get_lambda_sum()
+						+ north.get_vector_of_workplaces().at(3).get_lambda_sum()
+						+ south.get_vector_of_workplaces().at(4).get_lambda_sum();
+	const int n_agents = north.get_vector_of_workplaces().at(2).get_agent_IDs_ref().size()
+						+ north.get_vector_of_workplaces().at(3).get_agent_IDs_ref().size()
+						+ south.get_vector_of_workplaces().at(4).get_agent_IDs_ref().size();
+	if (from_file.get_number_of_links() != 3
+			|| !float_equality<double>(owner.get_infected_contribution(), sum/n_agents, tol)
+			|| !float_equality<double>(mirrors.at(2).get_infected_contribution(), sum/n_agents, tol)
+			|| !float_equality<double>(mirrors.at(3).get_infected_contribution(), sum/n_agents, tol)){
+		std::cerr << "Wrong contribution of an owner with two mirrors" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Threads do not change the results, regional
+/// metrics are sums of those of the communities
+bool metapopulation_threads_test()
+{
+	const int n_steps = 30;
+	const ABM north = create_abm(0.25, 100);
+	const ABM south = create_abm(0.25, 150);
+
+	std::vector<Metrics> results;
+	for (const bool threads : {true, false}){
+		MetapopulationABM region = create_region(north, south);
+		region.load_links("test_data/links.txt");
+		for (int iw = 10; iw <= 200; ++iw){
+			region.link_places("south", PS::workplaces, iw, "north", iw);
+		}
+		if (!threads){
+			region.set_executor([](int n_tasks, const std::function<void(int)>& task){
+					for (int i = n_tasks - 1; i >= 0; --i){
+						task(i);
+					}
+				});
+		}
+		region.get_community(0).set_random_seed(3);
+		region.get_community(1).set_random_seed(4);
+		for (int ti = 0; ti < n_steps; ++ti){
+			region.transmit_infection();
+		}
+		results.push_back(region.get_metrics());
+	}
+
+	const Metrics& metrics = results.at(0);
+	if (metrics.size() != results.at(1).size() || metrics.get_n_steps() != n_steps){
+		std::cerr << "Wrong number of metrics or steps" << std::endl;
+		return false;
+	}
+	for (int im = 0; im < metrics.size(); ++im){
+		if (metrics.get_values(im) != results.at(1).get_values(im)){
+			std::cerr << "Threaded run differs in " << metrics.get_name(im) << std::endl;
+			return false;
+		}
+	}
+	const std::vector<int>& region_infected = metrics.get_values(metrics.find("region/total infected"));
+	const std::vector<int>& north_infected = metrics.get_values(metrics.find("north/total infected"));
+	const std::vector<int>& south_infected = metrics.get_values(metrics.find("south/total infected"));
+	for (int ti = 0; ti < n_steps; ++ti){
+		if (region_infected.at(ti) != north_infected.at(ti) + south_infected.at(ti)){
+			std::cerr << "Regional metric is not the sum of the communities" << std::endl;
+			return false;
+		}
+	}
+	if (region_infected.back() <= region_infected.front()){
+		std::cerr << "No new infections, the test is not meaningful" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Wrong communities, links, and files
+bool metapopulation_errors_test()
+{
+	const std::invalid_argument arg_err("Wrong argument");
+	const std::out_of_range range_err("Out of range");
+	const std::runtime_error run_err("Wrong file");
+	const ABM abm = create_abm(0.25, 10);
+	MetapopulationABM region = create_region(abm, abm);
+	region.link_places("north", PS::workplaces, 3, "south", 5);
+
+	bool verbose = false;
+	auto add = [&region](const std::string& name, const ABM& model){ region.add_community(name, ABM(model)); };
+	auto link = [&region](const std::string& community, const PS::place_type type, const int ID,
+							const std::string& owner, const int owner_ID)
+		{ region.link_places(community, type, ID, owner, owner_ID); };
+
+	// Communities
+	if (!exception_test(verbose, &arg_err, add, "north", abm)
+			|| !exception_test(verbose, &arg_err, add, "", abm)){
+		std::cerr << "Community name not unique or empty" << std::endl;
+		return false;
+	}
+	ABM later(abm);
+	later.transmit_infection();
+	if (!exception_test(verbose, &arg_err, add, "east", later)){
+		std::cerr << "Community with a different time" << std::endl;
+		return false;
+	}
+
+	// Links
+	if (!exception_test(verbose, &arg_err, link, "north", PS::hospitals, 1, "south", 1)
+			|| !exception_test(verbose, &arg_err, link, "north", PS::workplaces, 1, "north", 2)){
+		std::cerr << "Link of wrong type or within a community" << std::endl;
+		return false;
+	}
+	if (!exception_test(verbose, &range_err, link, "west", PS::workplaces, 1, "south", 1)
+			|| !exception_test(verbose, &range_err, link, "north", PS::schools, 0, "south", 1)
+			|| !exception_test(verbose, &range_err, link, "north", PS::workplaces, 1, "south", 100000)){
+		std::cerr << "Link to a community or place that does not exist" << std::endl;
+		return false;
+	}
+	if (!exception_test(verbose, &arg_err, link, "north", PS::workplaces, 3, "south", 6)
+			|| !exception_test(verbose, &arg_err, link, "south", PS::workplaces, 5, "north", 1)
+			|| !exception_test(verbose, &arg_err, link, "south", PS::workplaces, 1, "north", 3)){
+		std::cerr << "Place linked twice or mirror as an owner" << std::endl;
+		return false;
+	}
+
+	// Files
+	if (!exception_test(verbose, &run_err, [&region](){ region.load_links("test_data/no_such_file.txt"); })
+			|| !exception_test(verbose, &arg_err, [&region](){ region.load_links("test_data/links_wrong.txt"); })){
+		std::cerr << "Wrong file with links" << std::endl;
+		return false;
+	}
+	if (region.get_number_of_links() != 1){
+		std::cerr << "Wrong links were added" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Region with two communities, north and south
+MetapopulationABM create_region(const ABM& north, const ABM& south)
+{
+	MetapopulationABM region;
+	region.add_community("north", ABM(north));
+	region.add_community("south", ABM(south));
+	return region;
+}
+
+ABM create_abm(const double dt, int inf0)
+{
+	// Input files
+	std::string fin("../abm/test_data/NR_agents.txt");
+	std::string hfile("../abm/test_data/NR_households.txt");
+	std::string sfile("../abm/test_data/NR_schools.txt");
+	std::string wfile("../abm/test_data/NR_workplaces.txt");
+	std::string hsp_file("../abm/test_data/NR_hospitals.txt");
+	std::string rh_file("../abm/test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("../abm/test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("../abm/test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("../abm/test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("../abm/test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("../abm/test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles =
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name},
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with testing changes
+	std::string tfname("../abm/test_data/tests_with_time.txt");
+
+	ABM abm(dt, pfname, dfiles, tfname);
+
+	// First the places
+	abm.create_households(hfile);
+	abm.create_schools(sfile);
+	abm.create_workplaces(wfile);
+	abm.create_hospitals(hsp_file);
+	abm.create_retirement_homes(rh_file);
+
+	// Then the agents
+	abm.create_agents(fin, inf0);
+
+	return abm;
+}
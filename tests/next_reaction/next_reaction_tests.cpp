@@ -0,0 +1,241 @@
+#include "../../include/next_reaction/next_reaction_abm.h"
+#include "../../include/utils.h"
+#include "../common/test_utils.h"
+
+/*****************************************************
+ *
+ * Test suite for the continuous time execution
+ *
+******************************************************/
+
+// Tests
+bool next_reaction_contributions_test();
+bool next_reaction_run_test();
+
+// Supporting functions
+ABM create_abm(const double dt, int i0);
+bool check_contributions(const bool with_interventions);
+template <typename T>
+bool compare_sums(const std::vector<T>& places, const std::vector<T>& expected,
+							const std::string& place_type);
+
+int main()
+{
+	test_pass(next_reaction_contributions_test(), "Place contributions maintained between events");
+	test_pass(next_reaction_run_test(), "Collected simulation data");
+}
+
+/// Sums maintained by the engine equal a computation
+/// from all the agents in their current states, also
+/// after interventions change transmission in places
+bool next_reaction_contributions_test()
+{
+	for (const bool with_interventions : {false, true}){
+		if (!check_contributions(with_interventions)){
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Compare the sums after a run to a computation from the agents
+bool check_contributions(const bool with_interventions)
+{
+	const int n_steps = 40;
+	ABM abm = create_abm(0.25, 500);
+	if (with_interventions){
+		abm.load_interventions("../abm/test_data/interventions.txt");
+	}
+	NextReactionABM nr_abm(abm);
+	for (int ti = 0; ti < n_steps; ++ti){
+		nr_abm.transmit_infection();
+	}
+	if (!float_equality<double>(nr_abm.get_time(), n_steps*0.25, 1e-10)){
+		std::cerr << "Wrong time after " << n_steps << " steps" << std::endl;
+		return false;
+	}
+
+	// Reference from the current states; events due exactly at the
+	// end of the step are processed in the next one, so the
+	// reference is computed for a time just before, with 
+	// times stored as steps that is the last step
+	ABM reference(abm);
+	reference.reset_contributions();
+	Contributions contributions;
+#ifdef ABM_STEP_TIMES
+	const double time = nr_abm.get_time() - 0.25;
+#else
+	const double time = nr_abm.get_time() - 1e-9;
+#endif
+	for (const auto& agent : reference.get_vector_of_agents()){
+		if (agent.removed() || agent.vaccinated() || !agent.infected()){
+			continue;
+		}
+		if (agent.exposed()){
+			contributions.compute_exposed_contributions(agent, time, reference.vector_of_households(),
+				reference.vector_of_schools(), reference.vector_of_workplaces(),
+				reference.vector_of_hospitals(), reference.vector_of_retirement_homes());
+		}else{
+			contributions.compute_symptomatic_contributions(agent, time, reference.vector_of_households(),
+				reference.vector_of_schools(), reference.vector_of_workplaces(),
+				reference.vector_of_hospitals(), reference.vector_of_retirement_homes());
+		}
+	}
+
+	const std::vector<School>& ref_schools = reference.get_vector_of_schools();
+	if (std::none_of(ref_schools.begin(), ref_schools.end(),
+			[](const School& school){ return school.get_lambda_sum() > 0.0; })){
+		std::cerr << "No infectious agents in schools" << std::endl;
+		return false;
+	}
+	if (!compare_sums(abm.get_vector_of_households(), reference.get_vector_of_households(), "household")){
+		return false;
+	}
+	if (!compare_sums(abm.get_vector_of_schools(), reference.get_vector_of_schools(), "school")){
+		return false;
+	}
+	if (!compare_sums(abm.get_vector_of_workplaces(), reference.get_vector_of_workplaces(), "workplace")){
+		return false;
+	}
+	if (!compare_sums(abm.get_vector_of_hospitals(), reference.get_vector_of_hospitals(), "hospital")){
+		return false;
+	}
+	if (!compare_sums(abm.get_vector_of_retirement_homes(), reference.get_vector_of_retirement_homes(),
+						"retirement home")){
+		return false;
+	}
+	return true;
+}
+
+/// Totals are consistent with the daily series, the metrics, and the population
+bool next_reaction_run_test()
+{
+	const int n_steps = 120;
+	ABM abm = create_abm(0.25, 100);
+	const int n_agents = abm.get_vector_of_agents().size();
+	const int n_initial = abm.get_total_infected();
+
+	NextReactionABM nr_abm(abm);
+	for (int ti = 0; ti < n_steps; ++ti){
+		nr_abm.transmit_infection();
+		if (nr_abm.get_num_infected() > n_agents){
+			std::cerr << "More infected than agents" << std::endl;
+			return false;
+		}
+	}
+	const std::vector<int> infected_day = nr_abm.get_infected_day();
+	const std::vector<int> tested_day = nr_abm.get_tested_day();
+	const int n_infected = nr_abm.get_total_infected();
+
+	if (infected_day.size() != n_steps || tested_day.size() != n_steps){
+		std::cerr << "Wrong number of steps" << std::endl;
+		return false;
+	}
+	if (std::accumulate(infected_day.begin(), infected_day.end(), 0) + n_initial != n_infected){
+		std::cerr << "Daily infections inconsistent with the total" << std::endl;
+		return false;
+	}
+	if (std::accumulate(tested_day.begin(), tested_day.end(), 0) != nr_abm.get_total_tested()){
+		std::cerr << "Daily tests inconsistent with the total" << std::endl;
+		return false;
+	}
+	if (nr_abm.get_num_infected() > n_infected || n_infected > n_agents){
+		std::cerr << "Currently infected inconsistent with the totals" << std::endl;
+		return false;
+	}
+	if (nr_abm.get_total_dead() + nr_abm.get_total_recovered() > n_infected){
+		std::cerr << "More removed than infected" << std::endl;
+		return false;
+	}
+	if (n_infected <= n_initial || nr_abm.get_number_of_events() == 0){
+		std::cerr << "Infection did not spread" << std::endl;
+		return false;
+	}
+
+	// Each daily series in the metrics of the ABM adds up to its
+	// total, and the totals at the last step are the final ones
+	for (int ti = n_steps; ti < 400; ++ti){
+		nr_abm.transmit_infection();
+	}
+	const Metrics& metrics = abm.get_metrics();
+	const std::vector<std::pair<std::string, int>> series_totals = {
+		{"new infected", nr_abm.get_total_infected() - n_initial},
+		{"new dead", nr_abm.get_total_dead()}, {"new recovered", nr_abm.get_total_recovered()},
+		{"new tested", nr_abm.get_total_tested()}, 
+		{"new tested positive", nr_abm.get_total_tested_positive()}};
+	for (const auto& series : series_totals){
+		const std::vector<int>& values = metrics.get_values(metrics.find(series.first));
+		if (values.size() != 400 || series.second == 0
+				|| std::accumulate(values.begin(), values.end(), 0) != series.second){
+			std::cerr << "Series " << series.first << " inconsistent with its total " 
+					  << series.second << std::endl;
+			return false;
+		}
+	}
+	const std::vector<std::pair<std::string, int>> totals = {
+		{"total infected", nr_abm.get_total_infected()}, {"total dead", nr_abm.get_total_dead()},
+		{"total recovered", nr_abm.get_total_recovered()}, {"total tested", nr_abm.get_total_tested()}};
+	for (const auto& total : totals){
+		if (metrics.get_values(metrics.find(total.first)).back() != total.second){
+			std::cerr << "Wrong " << total.first << " in the metrics" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+// Compare sums of contributions of all places to the reference
+template <typename T>
+bool compare_sums(const std::vector<T>& places, const std::vector<T>& expected,
+							const std::string& place_type)
+{
+	for (int i = 0; i < places.size(); ++i){
+		if (!float_equality<double>(places.at(i).get_lambda_sum(),
+					expected.at(i).get_lambda_sum(), 1e-8)
+				|| places.at(i).get_total_infected() != expected.at(i).get_total_infected()){
+			std::cerr << "Wrong contribution of " << place_type << " "
+					  << places.at(i).get_ID() << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+ABM create_abm(const double dt, int inf0)
+{
+	// Input files
+	std::string fin("../abm/test_data/NR_agents.txt");
+	std::string hfile("../abm/test_data/NR_households.txt");
+	std::string sfile("../abm/test_data/NR_schools.txt");
+	std::string wfile("../abm/test_data/NR_workplaces.txt");
+	std::string hsp_file("../abm/test_data/NR_hospitals.txt");
+	std::string rh_file("../abm/test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("../abm/test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("../abm/test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("../abm/test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("../abm/test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("../abm/test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles =
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name},
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with testing changes
+	std::string tfname("../abm/test_data/tests_with_time.txt");
+
+	ABM abm(dt, pfname, dfiles, tfname);
+
+	// First the places
+	abm.create_households(hfile);
+	abm.create_schools(sfile);
+	abm.create_workplaces(wfile);
+	abm.create_hospitals(hsp_file);
+	abm.create_retirement_homes(rh_file);
+
+	// Then the agents
+	abm.create_agents(fin, inf0);
+
+	return abm;
+}
@@ -0,0 +1,273 @@
+#include "../../include/parameter_sweep/parameter_sweep.h"
+#include "../common/test_utils.h"
+
+/*****************************************************
+ *
+ * Test suite for the parameter sweep
+ *
+******************************************************/
+
+// Tests
+bool sweep_designs_test();
+bool sweep_parameter_override_test();
+bool sweep_jobs_test();
+
+// Supporting functions
+ABM create_abm(const double dt, int i0);
+bool stratified(const std::vector<std::vector<double>>& points, const int dim, 
+					const double lo, const double hi, const int n_strata);
+
+int main()
+{
+	test_pass(sweep_designs_test(), "Grid, Latin hypercube, and Sobol designs");
+	test_pass(sweep_parameter_override_test(), "Model set up from new parameter values");
+	test_pass(sweep_jobs_test(), "Parallel jobs reproduce serial simulations");
+}
+
+/// Parameter sets of each design cover the ranges
+bool sweep_designs_test()
+{
+	const ABM abm = create_abm(0.25, 1);
+	ParameterSweep sweep(abm, 1);
+	sweep.add_range("household transmission rate", 0.1, 0.5);
+	sweep.add_range("school transmission rate", 1.0, 2.0);
+	sweep.add_range("fraction with flu", 0.0, 0.1);
+
+	// Grid with the ends of the ranges
+	sweep.generate(ParameterSweep::grid, 3);
+	const std::vector<std::vector<double>>& sets = sweep.get_parameter_sets();
+	if (sets.size() != 27){
+		std::cerr << "Wrong number of grid points" << std::endl;
+		return false;
+	}
+	const std::vector<double> middle = {0.3, 1.5, 0.05};
+	const std::vector<double> last = {0.5, 2.0, 0.1};
+	for (int i = 0; i < 3; ++i){
+		if (!float_equality<double>(sets.at(13).at(i), middle.at(i), 1e-10)
+				|| !float_equality<double>(sets.at(26).at(i), last.at(i), 1e-10)){
+			std::cerr << "Wrong values of grid points" << std::endl;
+			return false;
+		}
+	}
+
+	// One point per stratum in each dimension
+	const int n = 16;
+	for (const auto design : {ParameterSweep::latin_hypercube, ParameterSweep::sobol}){
+		sweep.generate(design, n);
+		if (sweep.get_parameter_sets().size() != n
+				|| !stratified(sweep.get_parameter_sets(), 0, 0.1, 0.5, n)
+				|| !stratified(sweep.get_parameter_sets(), 1, 1.0, 2.0, n)
+				|| !stratified(sweep.get_parameter_sets(), 2, 0.0, 0.1, n)){
+			std::cerr << "Points of design " << design << " not stratified" << std::endl;
+			return false;
+		}
+	}
+
+	// Known start of the Sobol sequence in two dimensions
+	ParameterSweep sweep_2D(abm, 1);
+	sweep_2D.add_range("household transmission rate", 0.0, 1.0);
+	sweep_2D.add_range("school transmission rate", 0.0, 1.0);
+	sweep_2D.generate(ParameterSweep::sobol, 4);
+	const std::vector<std::vector<double>> expected = {{0.0, 0.0}, {0.5, 0.5}, {0.75, 0.25}, {0.25, 0.75}};
+	if (sweep_2D.get_parameter_sets() != expected){
+		std::cerr << "Wrong Sobol points" << std::endl;
+		return false;
+	}
+
+	// Wrong input
+	bool verbose = false;
+	if (!exception_test(verbose, new std::invalid_argument("Unknown parameter"), 
+			[&sweep](){ sweep.add_range("not a parameter", 0.0, 1.0); })){
+		return false;
+	}
+	if (!exception_test(verbose, new std::invalid_argument("Wrong range"), 
+			[&sweep](){ sweep.add_range("workplace transmission rate", 1.0, 0.0); })){
+		return false;
+	}
+	return true;
+}
+
+/// Places and other model objects from new values 
+/// are the same as created from a parameter file 
+bool sweep_parameter_override_test()
+{
+	const double tol = 1e-10;
+	ABM abm = create_abm(0.25, 1);
+	const std::map<std::string, double> new_values = {{"household transmission rate", 0.123}, 
+		{"school employee transmission rate", 0.456}, {"high school absenteeism correction", 0.789},
+		{"workplace transmission rate", 0.321}, {"RH resident transmission rate", 0.654}};
+	const int n_in_house = abm.get_vector_of_households().at(0).get_agent_IDs().size();
+	abm.set_infection_parameters(new_values);
+
+	if (!float_equality<double>(abm.get_infection_parameters().at("household transmission rate"), 0.123, tol)){
+		std::cerr << "Parameter value not changed" << std::endl;
+		return false;
+	}
+	for (const auto& house : abm.get_vector_of_households()){
+		if (!float_equality<double>(house.get_transmission_rate(), 0.123, tol)){
+			std::cerr << "Wrong household transmission rate" << std::endl;
+			return false;
+		}
+	}
+	for (const auto& school : abm.get_vector_of_schools()){
+		if (!float_equality<double>(school.get_employee_transmission_rate(), 0.456, tol)){
+			std::cerr << "Wrong school employee transmission rate" << std::endl;
+			return false;
+		}
+	}
+	for (const auto& work : abm.get_vector_of_workplaces()){
+		if (!float_equality<double>(work.get_transmission_rate(), 0.321, tol)){
+			std::cerr << "Wrong workplace transmission rate" << std::endl;
+			return false;
+		}
+	}
+	for (const auto& rh : abm.get_vector_of_retirement_homes()){
+		if (!float_equality<double>(rh.get_transmission_rate(), 0.654, tol)){
+			std::cerr << "Wrong retirement home transmission rate" << std::endl;
+			return false;
+		}
+	}
+	if (abm.get_vector_of_households().at(0).get_agent_IDs().size() != n_in_house){
+		std::cerr << "Agents not kept in the places" << std::endl;
+		return false;
+	}
+
+	// Only before the first step and only known parameters
+	bool verbose = false;
+	if (!exception_test(verbose, new std::invalid_argument("Unknown parameter"), 
+			[&abm](){ abm.set_infection_parameters({{"not a parameter", 1.0}}); })){
+		return false;
+	}
+	abm.transmit_infection();
+	if (!exception_test(verbose, new std::runtime_error("After the first step"), 
+			[&abm](){ abm.set_infection_parameters(std::map<std::string, double>()); })){
+		return false;
+	}
+	return true;
+}
+
+/// Each job gives the same results as a simulation run on 
+/// its own, independently of the number of threads 
+bool sweep_jobs_test()
+{
+	const int n_steps = 20;
+	const ABM abm = create_abm(0.25, 200);
+	ParameterSweep sweep(abm, n_steps);
+	sweep.add_range("household transmission rate", 0.2, 0.8);
+	sweep.add_range("workplace transmission rate", 0.2, 0.8);
+	sweep.generate(ParameterSweep::latin_hypercube, 3);
+	sweep.set_replicates(2);
+	sweep.set_collect_series();
+
+	sweep.run(3);
+	const std::vector<ParameterSweep::Result> results = sweep.get_results();
+	if (results.size() != 6){
+		std::cerr << "Wrong number of results" << std::endl;
+		return false;
+	}
+
+	for (const auto& result : results){
+		ABM serial(abm);
+		serial.set_infection_parameters(sweep.parameter_values(result.set));
+		serial.set_random_seed(sweep.replicate_seed(result.replicate));
+		for (int ti = 0; ti < n_steps; ++ti){
+			serial.transmit_infection();
+		}
+		if (result.seed != sweep.replicate_seed(result.replicate)
+				|| result.metrics.at(0) != serial.get_total_infected()
+				|| result.metrics.at(5) != serial.get_num_infected()
+				|| result.series.at(0) != serial.get_infected_day()){
+			std::cerr << "Different results of set " << result.set 
+					  << " replicate " << result.replicate << std::endl;
+			return false;
+		}
+	}
+	// Different seeds of replicates
+	if (results.at(0).seed == results.at(1).seed){
+		std::cerr << "Replicates with the same seed" << std::endl;
+		return false;
+	}
+
+	// Same results with one thread
+	sweep.run(1);
+	for (int i = 0; i < results.size(); ++i){
+		if (sweep.get_results().at(i).metrics != results.at(i).metrics){
+			std::cerr << "Results depend on the number of threads" << std::endl;
+			return false;
+		}
+	}
+
+	// Table with a header and one row per job
+	const std::string fname("sweep_results.txt");
+	sweep.print_results(fname);
+	std::ifstream input(fname);
+	std::string line;
+	int n_lines = 0;
+	while (std::getline(input, line)){
+		++n_lines;
+	}
+	input.close();
+	std::remove(fname.c_str());
+	if (n_lines != results.size() + 1){
+		std::cerr << "Wrong number of rows in the results table" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/// True if each of n_strata equal parts of [lo, hi] has one point 
+bool stratified(const std::vector<std::vector<double>>& points, const int dim, 
+					const double lo, const double hi, const int n_strata)
+{
+	std::vector<int> counts(n_strata, 0);
+	for (const auto& point : points){
+		const double value = point.at(dim);
+		if (value < lo || value > hi){
+			return false;
+		}
+		// Sobol points lie on the boundaries of the strata
+		const int is = std::min(static_cast<int>((value - lo)/(hi - lo)*n_strata + 1e-9), n_strata - 1);
+		++counts.at(is);
+	}
+	return std::all_of(counts.begin(), counts.end(), [](const int count){ return count == 1; });
+}
+
+ABM create_abm(const double dt, int inf0)
+{
+	// Input files
+	std::string fin("../abm/test_data/NR_agents.txt");
+	std::string hfile("../abm/test_data/NR_households.txt");
+	std::string sfile("../abm/test_data/NR_schools.txt");
+	std::string wfile("../abm/test_data/NR_workplaces.txt");
+	std::string hsp_file("../abm/test_data/NR_hospitals.txt");
+	std::string rh_file("../abm/test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("../abm/test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("../abm/test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("../abm/test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("../abm/test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("../abm/test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles =
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name},
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with testing changes
+	std::string tfname("../abm/test_data/tests_with_time.txt");
+
+	ABM abm(dt, pfname, dfiles, tfname);
+
+	// First the places
+	abm.create_households(hfile);
+	abm.create_schools(sfile);
+	abm.create_workplaces(wfile);
+	abm.create_hospitals(hsp_file);
+	abm.create_retirement_homes(rh_file);
+
+	// Then the agents
+	abm.create_agents(fin, inf0);
+
+	return abm;
+}
@@ -12,6 +12,7 @@ std = '-std=c++11'
 opt = '-O0'
 # Common source files
 src_files = path + 'places/place.cpp' 
+src_files += ' ' + path + 'places/roster.cpp'
 src_files += ' ' + path + 'places/household.cpp'
 src_files += ' ' + path + 'places/school.cpp'
 src_files += ' ' + path + 'places/retirement_home.cpp'
@@ -15,6 +15,7 @@ bool workplace_test();
 bool household_test();
 bool hospital_test();
 bool school_and_workplace_transmission_changes();
+bool roster_test();
 
 // Tests for contributions
 bool contribution_test_hospitals();
@@ -54,6 +55,89 @@ int main()
 	test_pass(contribution_test_retirement_home(), "Contribution test for retirement home");
 	
 	test_pass(school_and_workplace_transmission_changes(), "School and workplaces transmission parameters modifications");
+
+	test_pass(roster_test(), "Rosters in a shared buffer");
+}
+
+/// Rosters laid out in one buffer, changed in place
+/// or, if shared with copies, independently of them
+bool roster_test()
+{
+	std::vector<Roster> rosters = {Roster({1, 4, 7}), Roster(), Roster({2, 3}), Roster({5, 5, 6})};
+	const std::vector<std::vector<int>> expected = {{1, 4, 7}, {}, {2, 3}, {5, 5, 6}};
+	Roster::pack(rosters);
+	for (int i = 0; i < rosters.size(); ++i){
+		if (!rosters.at(i).shares_buffer() || rosters.at(i).to_vector() != expected.at(i)){
+			std::cerr << "Wrong roster " << i << " after packing" << std::endl;
+			return false;
+		}
+		// Contiguous
+		if (i > 0 && rosters.at(i).begin() != rosters.at(i-1).end()){
+			std::cerr << "Rosters not contiguous" << std::endl;
+			return false;
+		}
+	}
+
+	// Places share the buffer until they change
+	Household house_1(1, 0.0, 0.0, 1.0, 1.0, 1.0, 1.0);
+	house_1.register_agents(rosters.at(0), 1);
+	Household house_2(house_1);
+	house_2.add_agent(9);
+	house_1.remove_agent(4);
+	if (house_1.get_agent_IDs() != std::vector<int>({1, 7}) 
+			|| house_2.get_agent_IDs() != std::vector<int>({1, 4, 7, 9})
+			|| rosters.at(0).to_vector() != expected.at(0)
+			|| rosters.at(1).begin() != rosters.at(0).end()){
+		std::cerr << "Changes of a roster affect others" << std::endl;
+		return false;
+	}
+	if (!rosters.at(0).shares_buffer() || house_1.get_agent_IDs_ref().shares_buffer()){
+		std::cerr << "Changed roster still in the shared buffer" << std::endl;
+		return false;
+	}
+
+	// The only user of a span changes it in place, up to its original size
+	const int* span_2 = rosters.at(2).begin();
+	rosters.at(2).remove(2);
+	rosters.at(2).push_back(8);
+	if (!rosters.at(2).shares_buffer() || rosters.at(2).begin() != span_2
+			|| rosters.at(2).to_vector() != std::vector<int>({3, 8})){
+		std::cerr << "Roster not changed in place" << std::endl;
+		return false;
+	}
+	rosters.at(2).push_back(9);
+	if (rosters.at(2).shares_buffer() || rosters.at(2).to_vector() != std::vector<int>({3, 8, 9})
+			|| rosters.at(3).to_vector() != expected.at(3)){
+		std::cerr << "Roster that outgrew its span still in the shared buffer" << std::endl;
+		return false;
+	}
+
+	// Remap keeps the order
+	Roster remapped = rosters.at(3);
+	remapped.remap({7, 6, 5, 4, 3, 2, 1});
+	if (remapped.to_vector() != std::vector<int>({2, 3, 3}) || rosters.at(3).to_vector() != expected.at(3)){
+		std::cerr << "Wrong remapped roster" << std::endl;
+		return false;
+	}
+
+	// Entries of repeated IDs, found again after a change
+	if (remapped.multiplicity(3) != 2 || remapped.multiplicity(2) != 1){
+		std::cerr << "Wrong number of entries of an ID" << std::endl;
+		return false;
+	}
+	remapped.push_back(2);
+	remapped.remove(3);
+	if (remapped.multiplicity(2) != 2){
+		std::cerr << "Number of entries of an ID not updated after a change" << std::endl;
+		return false;
+	}
+
+	const std::out_of_range out_range("Outside of the roster");
+	if (!exception_test(false, &out_range, &Roster::at, rosters.at(2), 3)){
+		std::cerr << "Position outside of the roster not recognized as an error" << std::endl;
+		return false;
+	}
+	return true;
 }
 
 /// Tests all public functions from the Place class  
@@ -0,0 +1,274 @@
+#include "../../include/replicate_server/replicate_server.h"
+#include "../common/test_utils.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*****************************************************
+ *
+ * Test suite for the replicate server
+ *
+******************************************************/
+
+// Tests
+bool server_parse_test();
+bool server_same_results_test();
+bool server_errors_test();
+bool server_slow_client_test();
+
+// Supporting functions
+ABM create_abm(const double dt, int i0);
+int connect_to(const std::string& path);
+std::string exchange(const int fd, const std::string& request);
+pid_t start_server(ReplicateServer& server);
+bool stop_server(const pid_t pid);
+
+const std::string socket_file("replicate_server_test.sock");
+
+int main()
+{
+	test_pass(server_parse_test(), "Parsing of requests");
+	test_pass(server_same_results_test(), "Same results in children, in process, and without the server");
+	test_pass(server_errors_test(), "Errors reported to the client");
+	test_pass(server_slow_client_test(), "Clients served while another one is silent");
+}
+
+/// Fields of a request and wrong lines
+bool server_parse_test()
+{
+	const std::vector<std::string> lines = {"seed 2021", "", "steps  40", 
+		"parameter household_transmission_rate 0.5", "output tested_positive", "output infected"};
+	const ReplicateServer::Request request = ReplicateServer::parse_request(lines);
+	const std::map<std::string, double> parameters = {{"household transmission rate", 0.5}};
+	const std::vector<std::string> outputs = {"tested positive", "infected"};
+	if (request.seed != 2021 || request.steps != 40 || request.parameters != parameters
+			|| request.outputs != outputs){
+		std::cerr << "Wrong fields of the request" << std::endl;
+		return false;
+	}
+
+	bool verbose = false;
+	const std::vector<std::string> wrong = {"seed -1", "seed 1 2", "steps -5", "steps",
+		"parameter household_transmission_rate", "parameter 0.5", "output", "wrong 1"};
+	for (const auto& line : wrong){
+		if (!exception_test(verbose, new std::invalid_argument("Wrong line"), 
+				[&line](){ ReplicateServer::parse_request({line}); })){
+			std::cerr << "No error for " << line << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Requests served by forked children and in the server 
+/// process give the results of runs without the server
+bool server_same_results_test()
+{
+	const ABM abm = create_abm(0.25, 50);
+	const std::vector<std::string> requests = {
+		"run\nseed 2021\nsteps 40\noutput infected\noutput tested_positive\nend\n",
+		"run\nseed 7\nsteps 40\nparameter household_transmission_rate 0.9\noutput tested\nend\n",
+		"run\nseed 2021\nsteps 20\nend\n"};
+	const std::vector<ReplicateServer::Request> expected_requests = {
+		ReplicateServer::parse_request({"seed 2021", "steps 40", "output infected", "output tested_positive"}),
+		ReplicateServer::parse_request({"seed 7", "steps 40", "parameter household_transmission_rate 0.9", "output tested"}),
+		ReplicateServer::parse_request({"seed 2021", "steps 20"})};
+
+	for (const auto mode : {ReplicateServer::fork_children, ReplicateServer::in_process}){
+		ReplicateServer server(abm, socket_file);
+		server.set_mode(mode);
+		std::vector<std::string> expected;
+		for (const auto& request : expected_requests){
+			expected.push_back(server.run(request) + "end\n");
+		}
+		if (expected.at(0).find("series infected ") == std::string::npos 
+				|| expected.at(0).find("series tested_positive ") == std::string::npos){
+			std::cerr << "Requested series missing" << std::endl;
+			return false;
+		}
+
+		const pid_t pid = start_server(server);
+		// Two connections open at the same time, the first one 
+		// with two requests
+		const int first = connect_to(socket_file);
+		const int second = connect_to(socket_file);
+		const std::vector<std::string> responses = {exchange(first, requests.at(0)), 
+			exchange(first, requests.at(1))};
+		close(first);
+		const std::string last = exchange(second, requests.at(2));
+		close(second);
+
+		if (!stop_server(pid)){
+			return false;
+		}
+		if (responses.at(0) != expected.at(0) || responses.at(1) != expected.at(1) 
+				|| last != expected.at(2)){
+			std::cerr << "Different results from the server in mode " << mode << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Wrong requests get an error and the
+/// connection can still be used
+bool server_errors_test()
+{
+	const ABM abm = create_abm(0.25, 50);
+	ReplicateServer server(abm, socket_file);
+	const pid_t pid = start_server(server);
+	const int fd = connect_to(socket_file);
+
+	const std::vector<std::string> wrong = {"run\nparameter not_a_parameter 1.0\nend\n",
+		"run\noutput not_a_series\nend\n", "run\nsteps many\nend\n", "start\n", "run\nshutdown\nend\n"};
+	bool passed = true;
+	for (const auto& request : wrong){
+		const std::string response = exchange(fd, request);
+		if (response.compare(0, 6, "error ") != 0 || response.find("\nend\n") == std::string::npos){
+			std::cerr << "No error for request " << request << std::endl;
+			passed = false;
+		}
+	}
+	const std::string response = exchange(fd, "run\nseed 1\nsteps 4\nend\n");
+	if (response.find("metric time 1\n") == std::string::npos){
+		std::cerr << "Connection not usable after errors" << std::endl;
+		passed = false;
+	}
+	close(fd);
+
+	bool verbose = false;
+	if (!exception_test(verbose, new std::invalid_argument("No children"), 
+			[&server](){ server.set_max_children(0); })){
+		passed = false;
+	}
+	return stop_server(pid) && passed;
+}
+
+/// A client that connects and does not send anything
+/// does not delay the connections that come after it
+bool server_slow_client_test()
+{
+	const ABM abm = create_abm(0.25, 50);
+	ReplicateServer server(abm, socket_file);
+	const pid_t pid = start_server(server);
+	const int silent = connect_to(socket_file);
+	const int fd = connect_to(socket_file);
+
+	// No response within the timeout if the server waits for the silent client
+	timeval timeout = {10, 0};
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	const std::string response = exchange(fd, "run\nseed 1\nsteps 4\nend\n");
+	close(fd);
+	bool passed = true;
+	if (response.find("metric time 1\n") == std::string::npos){
+		std::cerr << "Connection not served while another client is silent" << std::endl;
+		passed = false;
+	}
+
+	// Server waits for the child of the silent client to finish
+	close(silent);
+	return stop_server(pid) && passed;
+}
+
+/// Connection to the server
+int connect_to(const std::string& path)
+{
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	std::strcpy(address.sun_path, path.c_str());
+	const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0){
+		throw std::runtime_error("Error connecting to the server");
+	}
+	return fd;
+}
+
+/// Send a request and read the response up to and including "end"
+std::string exchange(const int fd, const std::string& request)
+{
+	if (write(fd, request.data(), request.size()) != static_cast<ssize_t>(request.size())){
+		throw std::runtime_error("Error sending the request");
+	}
+	std::string response;
+	char c = 0;
+	while (read(fd, &c, 1) == 1){
+		response.push_back(c);
+		if (response == "end\n" || (response.size() > 5 
+				&& response.compare(response.size() - 5, 5, "\nend\n") == 0)){
+			break;
+		}
+	}
+	return response;
+}
+
+/// Server running in a child of the test
+pid_t start_server(ReplicateServer& server)
+{
+	const pid_t pid = fork();
+	if (pid == 0){
+		int status = 0;
+		try {
+			server.serve();
+		} catch (...) {
+			status = 1;
+		}
+		_exit(status);
+	}
+	return pid;
+}
+
+/// Shutdown request, true if the server stopped normally
+bool stop_server(const pid_t pid)
+{
+	const int fd = connect_to(socket_file);
+	const std::string response = exchange(fd, "shutdown\n");
+	close(fd);
+	int status = 0;
+	waitpid(pid, &status, 0);
+	if (response != "end\n" || !WIFEXITED(status) || WEXITSTATUS(status) != 0){
+		std::cerr << "Server did not stop normally" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+ABM create_abm(const double dt, int inf0)
+{
+	// Input files
+	std::string fin("../abm/test_data/NR_agents.txt");
+	std::string hfile("../abm/test_data/NR_households.txt");
+	std::string sfile("../abm/test_data/NR_schools.txt");
+	std::string wfile("../abm/test_data/NR_workplaces.txt");
+	std::string hsp_file("../abm/test_data/NR_hospitals.txt");
+	std::string rh_file("../abm/test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("../abm/test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("../abm/test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("../abm/test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("../abm/test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("../abm/test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles =
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name},
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with testing changes
+	std::string tfname("../abm/test_data/tests_with_time.txt");
+
+	ABM abm(dt, pfname, dfiles, tfname);
+
+	// First the places
+	abm.create_households(hfile);
+	abm.create_schools(sfile);
+	abm.create_workplaces(wfile);
+	abm.create_hospitals(hsp_file);
+	abm.create_retirement_homes(rh_file);
+
+	// Then the agents
+	abm.create_agents(fin, inf0);
+
+	return abm;
+}
@@ -110,6 +110,69 @@ os.chdir('abm/')
 subprocess.call(['python3.6 run_abm_tests.py'], shell=True)
 os.chdir('../')
 
+# Distributed execution
+print('\n'*2)
+ut.msg('- '*nSim + 'DISTRIBUTED EXECUTION TESTS' + ' -'*nSim, REVERSE+RED)
+os.chdir('distributed/')
+subprocess.call(['python3.6 run_distributed_tests.py'], shell=True)
+os.chdir('../')
+
+# Continuous time execution
+print('\n'*2)
+ut.msg('- '*nSim + 'CONTINUOUS TIME EXECUTION TESTS' + ' -'*nSim, REVERSE+RED)
+os.chdir('next_reaction/')
+subprocess.call(['python3.6 run_next_reaction_tests.py'], shell=True)
+os.chdir('../')
+
+# Parameter sweep
+print('\n'*2)
+ut.msg('- '*nSim + 'PARAMETER SWEEP TESTS' + ' -'*nSim, REVERSE+RED)
+os.chdir('parameter_sweep/')
+subprocess.call(['python3.6 run_parameter_sweep_tests.py'], shell=True)
+os.chdir('../')
+
+# Shared population segment
+print('\n'*2)
+ut.msg('- '*nSim + 'SHARED POPULATION TESTS' + ' -'*nSim, REVERSE+RED)
+os.chdir('shared_population/')
+subprocess.call(['python3.6 run_shared_population_tests.py'], shell=True)
+os.chdir('../')
+
+# Calibration
+print('\n'*2)
+ut.msg('- '*nSim + 'CALIBRATION TESTS' + ' -'*nSim, REVERSE+RED)
+os.chdir('calibration/')
+subprocess.call(['python3.6 run_calibration_tests.py'], shell=True)
+os.chdir('../')
+
+# Splitting ensemble
+print('\n'*2)
+ut.msg('- '*nSim + 'SPLITTING ENSEMBLE TESTS' + ' -'*nSim, REVERSE+RED)
+os.chdir('ensemble/')
+subprocess.call(['python3.6 run_ensemble_tests.py'], shell=True)
+os.chdir('../')
+
+# Metapopulation
+print('\n'*2)
+ut.msg('- '*nSim + 'METAPOPULATION TESTS' + ' -'*nSim, REVERSE+RED)
+os.chdir('metapopulation/')
+subprocess.call(['python3.6 run_metapopulation_tests.py'], shell=True)
+os.chdir('../')
+
+# C interface
+print('\n'*2)
+ut.msg('- '*nSim + 'C INTERFACE TESTS' + ' -'*nSim, REVERSE+RED)
+os.chdir('c_api/')
+subprocess.call(['python3.6 run_c_api_tests.py'], shell=True)
+os.chdir('../')
+
+# Replicate server
+print('\n'*2)
+ut.msg('- '*nSim + 'REPLICATE SERVER TESTS' + ' -'*nSim, REVERSE+RED)
+os.chdir('replicate_server/')
+subprocess.call(['python3.6 run_replicate_server_tests.py'], shell=True)
+os.chdir('../')
+
 # Integration tests
 print('\n'*2)
 ut.msg('- '*nSim + 'INTEGRATION TESTS' + ' -'*nSim, REVERSE+RED)
@@ -0,0 +1,348 @@
+#include "../../include/abm.h"
+#include "../common/test_utils.h"
+#include <sys/wait.h>
+#include <unistd.h>
+#include <malloc.h>
+
+/*****************************************************
+ *
+ * Test suite for the shared population segment
+ *
+******************************************************/
+
+// Tests
+bool segment_same_model_test();
+bool segment_worker_processes_test();
+bool segment_worker_memory_test();
+bool segment_errors_test();
+
+// Supporting functions
+ABM create_abm(const double dt, int i0);
+template <typename T>
+bool same_places(const std::vector<T>& places, const std::vector<T>& expected);
+long resident_anonymous_kB();
+long model_memory_in_worker(const bool from_segment);
+
+const std::string segment_file("population_segment.bin");
+
+int main()
+{
+	test_pass(segment_same_model_test(), "Model created from a published population");
+	test_pass(segment_worker_processes_test(), "Worker processes sharing one segment");
+	test_pass(segment_worker_memory_test(), "Resident memory of a worker process");
+	test_pass(segment_errors_test(), "Wrong or incomplete segments");
+	std::remove(segment_file.c_str());
+}
+
+/// Model created from the segment is the same as
+/// the one created from the input files
+bool segment_same_model_test()
+{
+	const double dt = 0.25;
+	const ABM loaded = create_abm(dt, 0);
+	PopulationSegment::publish(loaded, segment_file);
+	PopulationSegment segment(segment_file);
+	ABM abm(dt, segment);
+	abm.create_population(segment);
+
+	if (abm.get_infection_parameters() != loaded.get_infection_parameters()
+			|| abm.get_age_dependent_distributions() != loaded.get_age_dependent_distributions()
+			|| abm.get_testing_object().get_time_varying() != loaded.get_testing_object().get_time_varying()){
+		std::cerr << "Different model parameters" << std::endl;
+		return false;
+	}
+
+	const std::vector<Agent>& agents = abm.get_vector_of_agents();
+	const std::vector<Agent>& expected = loaded.get_vector_of_agents();
+	if (agents.size() != expected.size() || abm.get_total_infected() != loaded.get_total_infected()){
+		std::cerr << "Different number of agents or infected" << std::endl;
+		return false;
+	}
+	for (int i = 0; i < agents.size(); ++i){
+		const Agent& agent = agents.at(i);
+		const Agent& exp_agent = expected.at(i);
+		const std::vector<int> properties = {agent.get_ID(), agent.get_age(), agent.get_household_ID(),
+			agent.get_school_ID(), agent.get_work_ID(), agent.get_hospital_ID(), agent.student(), 
+			agent.works(), agent.hospital_employee(), agent.hospital_non_covid_patient(),
+			agent.retirement_home_employee(), agent.school_employee(), 
+			agent.retirement_home_resident(), agent.infected()};
+		const std::vector<int> exp_properties = {exp_agent.get_ID(), exp_agent.get_age(), 
+			exp_agent.get_household_ID(), exp_agent.get_school_ID(), exp_agent.get_work_ID(), 
+			exp_agent.get_hospital_ID(), exp_agent.student(), exp_agent.works(), 
+			exp_agent.hospital_employee(), exp_agent.hospital_non_covid_patient(),
+			exp_agent.retirement_home_employee(), exp_agent.school_employee(), 
+			exp_agent.retirement_home_resident(), exp_agent.infected()};
+		if (properties != exp_properties 
+				|| agent.get_x_location() != exp_agent.get_x_location()
+				|| agent.get_y_location() != exp_agent.get_y_location()){
+			std::cerr << "Different properties of agent " << agent.get_ID() << std::endl;
+			return false;
+		}
+	}
+
+	if (!same_places(abm.get_vector_of_households(), loaded.get_vector_of_households())
+			|| !same_places(abm.get_vector_of_retirement_homes(), loaded.get_vector_of_retirement_homes())
+			|| !same_places(abm.get_vector_of_schools(), loaded.get_vector_of_schools())
+			|| !same_places(abm.get_vector_of_workplaces(), loaded.get_vector_of_workplaces())
+			|| !same_places(abm.get_vector_of_hospitals(), loaded.get_vector_of_hospitals())){
+		return false;
+	}
+	for (int i = 0; i < abm.get_vector_of_schools().size(); ++i){
+		if (abm.get_vector_of_schools().at(i).get_type() != loaded.get_vector_of_schools().at(i).get_type()){
+			std::cerr << "Different school types" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Several processes attach to the same segment 
+/// and run their own simulations
+bool segment_worker_processes_test()
+{
+	const int n_workers = 3;
+	std::vector<pid_t> workers;
+	for (int iw = 0; iw < n_workers; ++iw){
+		const pid_t pid = fork();
+		if (pid == 0){
+			int status = 1;
+			try {
+				PopulationSegment segment(segment_file);
+				ABM abm(0.25, segment);
+				abm.create_population(segment, 100);
+				abm.set_random_seed(2021 + iw);
+				for (int ti = 0; ti < 20; ++ti){
+					abm.transmit_infection();
+				}
+				status = (abm.get_total_infected() >= 100) ? 0 : 1;
+			} catch (...) {
+				status = 2;
+			}
+			_exit(status);
+		}
+		workers.push_back(pid);
+	}
+
+	bool all_passed = true;
+	for (const auto& pid : workers){
+		int status = 0;
+		waitpid(pid, &status, 0);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+			std::cerr << "Worker process failed" << std::endl;
+			all_passed = false;
+		}
+	}
+	return all_passed;
+}
+
+/// Workers read agent profiles and initial rosters from
+/// the segment and only store the state of their agents 
+bool segment_worker_memory_test()
+{
+	PopulationSegment segment(segment_file);
+	const long n_agents = segment.get_number_of_agents();
+
+	// Profiles and rosters are not copied
+	ABM abm(0.25, segment);
+	abm.create_population(segment, 10);
+	const std::vector<Agent>& agents = abm.get_vector_of_agents();
+	for (int i = 0; i < agents.size(); ++i){
+		if (&agents.at(i).get_profile() != segment.get_agent_profile(i)){
+			std::cerr << "Profile of agent " << i + 1 << " copied from the segment" << std::endl;
+			return false;
+		}
+	}
+	const std::vector<Workplace>& workplaces = abm.get_vector_of_workplaces();
+	if (std::any_of(workplaces.begin(), workplaces.end(), 
+			[](const Workplace& place){ return !place.get_agent_IDs_ref().shares_buffer(); })){
+		std::cerr << "Rosters copied from the segment" << std::endl;
+		return false;
+	}
+
+	// Resident memory of a worker, measured in a new process
+	const long segment_kB = model_memory_in_worker(true);
+	const long files_kB = model_memory_in_worker(false);
+	if (segment_kB <= 0 || files_kB <= 0){
+		std::cerr << "Resident memory could not be measured" << std::endl;
+		return false;
+	}
+	// Agent states and place objects with a margin for the allocator
+	const long state_kB = (n_agents*sizeof(Agent) 
+			+ abm.get_vector_of_households().size()*sizeof(Household)
+			+ abm.get_vector_of_retirement_homes().size()*sizeof(RetirementHome)
+			+ abm.get_vector_of_schools().size()*sizeof(School)
+			+ workplaces.size()*sizeof(Workplace)
+			+ abm.get_vector_of_hospitals().size()*sizeof(Hospital))/1024;
+	const long profile_kB = n_agents*sizeof(AgentProfile)/1024;
+	if (segment_kB > 1.25*state_kB){
+		std::cerr << "Worker stores " << segment_kB << " kB, agent states and places take " 
+				  << state_kB << " kB" << std::endl;
+		return false;
+	}
+	// A model from the files also stores the profiles
+	if (files_kB - segment_kB < 0.75*profile_kB){
+		std::cerr << "Worker stores " << segment_kB << " kB, a model from files " 
+				  << files_kB << " kB" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// Missing, wrong, and incomplete files are not used
+bool segment_errors_test()
+{
+	bool verbose = false;
+	if (!exception_test(verbose, new std::runtime_error("Missing file"), 
+			[](){ PopulationSegment segment("no_such_segment.bin"); })){
+		return false;
+	}
+
+	// Wrong file
+	const std::string wrong_file("wrong_segment.bin");
+	std::ofstream out(wrong_file);
+	out << std::string(512, 'x');
+	out.close();
+	if (!exception_test(verbose, new std::runtime_error("Wrong file"), 
+			[&wrong_file](){ PopulationSegment segment(wrong_file); })){
+		return false;
+	}
+
+	// Incomplete segment
+	std::ifstream in(segment_file, std::ios::binary);
+	std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	in.close();
+	out.open(wrong_file, std::ios::binary);
+	out << content.substr(0, content.size()/2);
+	out.close();
+	if (!exception_test(verbose, new std::runtime_error("Incomplete file"), 
+			[&wrong_file](){ PopulationSegment segment(wrong_file); })){
+		return false;
+	}
+	std::remove(wrong_file.c_str());
+
+	// Only at the initial time
+	ABM abm = create_abm(0.25, 10);
+	abm.transmit_infection();
+	if (!exception_test(verbose, new std::runtime_error("After the first step"), 
+			[&abm](){ PopulationSegment::publish(abm, "late_segment.bin"); })){
+		return false;
+	}
+	return true;
+}
+
+/// Same places with the same registered agents and transmission rates
+template <typename T>
+bool same_places(const std::vector<T>& places, const std::vector<T>& expected)
+{
+	if (places.size() != expected.size()){
+		std::cerr << "Different number of places" << std::endl;
+		return false;
+	}
+	for (int i = 0; i < places.size(); ++i){
+		const T& place = places.at(i);
+		const T& exp_place = expected.at(i);
+		if (place.get_ID() != exp_place.get_ID() 
+				|| place.get_x_location() != exp_place.get_x_location()
+				|| place.get_y_location() != exp_place.get_y_location()
+				|| place.get_transmission_rate() != exp_place.get_transmission_rate()
+				|| place.get_agent_IDs_ref() != exp_place.get_agent_IDs_ref()){
+			std::cerr << "Different properties of place " << place.get_ID() << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+ABM create_abm(const double dt, int inf0)
+{
+	// Input files
+	std::string fin("../abm/test_data/NR_agents.txt");
+	std::string hfile("../abm/test_data/NR_households.txt");
+	std::string sfile("../abm/test_data/NR_schools.txt");
+	std::string wfile("../abm/test_data/NR_workplaces.txt");
+	std::string hsp_file("../abm/test_data/NR_hospitals.txt");
+	std::string rh_file("../abm/test_data/NR_retirement_homes.txt");
+
+	// File with infection parameters
+	std::string pfname("../abm/test_data/infection_parameters.txt");
+	// Files with age-dependent distributions
+	std::string dexp_name("../abm/test_data/age_dist_exposed_never_sy.txt");
+	std::string dh_name("../abm/test_data/age_dist_hospitalization.txt");
+	std::string dhicu_name("../abm/test_data/age_dist_hosp_ICU.txt");
+	std::string dmort_name("../abm/test_data/age_dist_mortality.txt");
+	// Map for abm loading of distributions
+	std::map<std::string, std::string> dfiles =
+		{ {"exposed never symptomatic", dexp_name}, {"hospitalization", dh_name},
+		  {"ICU", dhicu_name}, {"mortality", dmort_name} };
+	// File with testing changes
+	std::string tfname("../abm/test_data/tests_with_time.txt");
+
+	ABM abm(dt, pfname, dfiles, tfname);
+
+	// First the places
+	abm.create_households(hfile);
+	abm.create_schools(sfile);
+	abm.create_workplaces(wfile);
+	abm.create_hospitals(hsp_file);
+	abm.create_retirement_homes(rh_file);
+
+	// Then the agents
+	abm.create_agents(fin, inf0);
+
+	return abm;
+}
+
+/// Resident anonymous memory of this process, -1 if unknown
+long resident_anonymous_kB()
+{
+	// Freed memory is returned so that only live objects count
+	malloc_trim(0);
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line)){
+		if (line.compare(0, 8, "RssAnon:") == 0){
+			return std::stol(line.substr(8));
+		}
+	}
+	return -1;
+}
+
+/// Resident memory of a model created in a new worker process, kB
+long model_memory_in_worker(const bool from_segment)
+{
+	int fds[2];
+	if (pipe(fds) != 0){
+		return -1;
+	}
+	const pid_t pid = fork();
+	if (pid == 0){
+		close(fds[0]);
+		long memory = -1;
+		try {
+			const long before = resident_anonymous_kB();
+			if (from_segment){
+				PopulationSegment segment(segment_file);
+				ABM abm(0.25, segment);
+				abm.create_population(segment, 10);
+				memory = resident_anonymous_kB() - before;
+			} else {
+				ABM abm = create_abm(0.25, 10);
+				memory = resident_anonymous_kB() - before;
+			}
+		} catch (...) {
+			memory = -1;
+		}
+		const ssize_t n_written = write(fds[1], &memory, sizeof(memory));
+		close(fds[1]);
+		_exit(n_written == sizeof(memory) ? 0 : 1);
+	}
+	close(fds[1]);
+	long memory = -1;
+	if (read(fds[0], &memory, sizeof(memory)) != sizeof(memory)){
+		memory = -1;
+	}
+	close(fds[0]);
+	int status = 0;
+	waitpid(pid, &status, 0);
+	return memory;
+}
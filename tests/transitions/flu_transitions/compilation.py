@@ -15,6 +15,15 @@ src_files = path + 'abm.cpp'
 src_files += ' ' + path + 'agent.cpp' 
 src_files += ' ' + path + 'infection.cpp'
 src_files += ' ' + path + 'testing.cpp'
+src_files += ' ' + path + 'interventions.cpp'
+src_files += ' ' + path + 'spatial_transmission.cpp'
+src_files += ' ' + path + 'vaccination_campaign.cpp'
+src_files += ' ' + path + 'metrics.cpp'
+src_files += ' ' + path + 'lineage_log.cpp'
+src_files += ' ' + path + 'memory_arena.cpp'
+src_files += ' ' + path + 'io_operations/state_snapshots.cpp'
+src_files += ' ' + path + 'io_operations/input_validator.cpp'
+src_files += ' ' + path + 'shared_population/population_segment.cpp'
 src_files += ' ' + path + 'contributions.cpp'
 src_files += ' ' + path + 'transitions/transitions.cpp'
 src_files += ' ' + path + 'transitions/regular_transitions.cpp'
@@ -27,6 +36,7 @@ src_files += ' ' + path + 'states_manager/hsp_employee_states_manager.cpp'
 src_files += ' ' + path + 'flu.cpp'
 src_files += ' ' + path + 'utils.cpp'
 src_files += ' ' + path + 'places/place.cpp'
+src_files += ' ' + path + 'places/roster.cpp'
 src_files += ' ' + path + 'places/household.cpp'
 src_files += ' ' + path + 'places/workplace.cpp'
 src_files += ' ' + path + 'places/school.cpp'
@@ -51,4 +61,10 @@ spec_files = 'flu_transitions_tests.cpp '
 compile_com = ' '.join([cx, std, opt, '-o', exe_name, spec_files, tst_files, src_files])
 subprocess.call([compile_com], shell=True)
 
+# Test 2
+# Same tests with event times stored as time steps
+# Name of the executable
+exe_name = 'flu_tr_steps_test'
+compile_com = ' '.join([cx, std, opt, '-DABM_STEP_TIMES', '-o', exe_name, spec_files, tst_files, src_files])
+subprocess.call([compile_com], shell=True)
 
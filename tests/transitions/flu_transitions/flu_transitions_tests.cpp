@@ -42,7 +42,7 @@ bool test_susceptible_transitions()
 	std::vector<RetirementHome>& retirement_homes = abm.vector_of_retirement_homes();
 	Infection& infection = abm.get_infection_object();
     const std::map<std::string, double> infection_parameters = abm.get_infection_parameters(); 
-    std::vector<int> state_changes(4,0);
+    StateChanges state_changes = {};
 
 	FluTransitions flu_tr;
 	Flu& flu = abm.get_flu_object();
@@ -87,7 +87,7 @@ bool test_susceptible_transitions()
 					households, schools, workplaces, hospitals, retirement_homes, 
 					infection_parameters, agents, flu, testing, dt);
 			}
-			if (state_changes.at(0) == 0){
+			if (state_changes.infected == 0){
 				// Testing flags
 				if (agent.tested()){
 					if ((agent.tested()) && (agent.get_time_for_flu_isolation() <= time)
@@ -103,7 +103,7 @@ bool test_susceptible_transitions()
 						}
 					}
 					// Just tested
-					if (state_changes.at(1)){
+					if (state_changes.tested){
 						++n_tested_flu;	
 						// Should still be home isolated
 						if (!agent.home_isolated()){
@@ -131,7 +131,7 @@ bool test_susceptible_transitions()
 
 				// Just got results 
 				// Confirmed negative 
-				if (state_changes.at(2)){
+				if (state_changes.tested_negative){
 					++n_flu_negative;
 					// Should not be home isolated 
 					if (agent.home_isolated()){
@@ -172,7 +172,7 @@ bool test_susceptible_transitions()
 				}
 
 				// False positive 
-				if (state_changes.at(3)){
+				if (state_changes.tested_false_positive){
 					++n_flu_false_pos;
 					// Should be home isolated 
 					if (!agent.home_isolated()){
@@ -17,4 +17,7 @@ subprocess.call(['python3.6 compilation.py'], shell=True)
 ut.msg('FluTransitions class tests', CYAN)
 subprocess.call(['./flu_tr_test'], shell=True)
 
+ut.msg('Same tests with event times stored as time steps', CYAN)
+subprocess.call(['./flu_tr_steps_test'], shell=True)
+
 
@@ -17,7 +17,7 @@ bool check_isolation(const Agent&, const std::vector<School>&,
 				const std::vector<Hospital>&, bool check_in_isolation = true);
 bool check_testing_transitions(const Agent& agent, const std::vector<Household>& households, 
 				const std::vector<School>& schools, const std::vector<Hospital>& hospitals,
-				std::vector<int>& state_changes, int& n_tested_exposed, int& n_tested_sy, int& n_waiting_for_res, 
+				const StateChanges& state_changes, int& n_tested_exposed, int& n_tested_sy, int& n_waiting_for_res, 
 				int& n_positive, int& n_false_neg, int& n_hsp, int& n_hsp_icu, int& n_ih, double time, double dt);
 bool check_treatment_setup(const Agent& agent, const std::vector<Household>& households,
 				const std::vector<School>& schools, const std::vector<Hospital>& hospitals,
@@ -27,7 +27,7 @@ bool check_hospitalized_isolation(const Agent& agent, const std::vector<Househol
 				const std::vector<School>& schools, const std::vector<Hospital>& hospitals);
 bool check_symptomatic_agent_removal(const Agent& agent, const std::vector<Household>& households,
 				const std::vector<School>& schools, const std::vector<Hospital>& hospitals,
-				std::vector<int>& state_changes, int& n_rh, int& n_rd, double time, double dt);
+				const StateChanges& state_changes, int& n_rh, int& n_rd, double time, double dt);
 
 int main()
 {
@@ -206,7 +206,7 @@ bool test_exposed_transitions()
 	int n_sy_recovering = 0, n_sy_dying = 0;
 	int n_tr_hsp = 0, n_hsp_icu = 0, n_ih = 0;
 	// Recovered, dead (not applicable), tested, tested positive, tested false negative
-    std::vector<int> state_changes(5,0);
+    StateChanges state_changes = {};
 
 	// To initialize Flu agents
 	testing.check_switch_time(0);
@@ -268,7 +268,7 @@ bool test_exposed_transitions()
 					}
 				} else if (agent.removed()){
 					// Correct flags
-					if (state_changes.at(0) != 1){
+					if (state_changes.recovered != 1){
 						std::cerr << "Wrong return value/flag for recovery " << std::endl;
 						return false;
 					}
@@ -354,7 +354,7 @@ bool test_symptomatic_transitions()
 	int n_sy_recovering = 0, n_sy_dying = 0;
 	int n_tr_hsp = 0, n_hsp_icu = 0, n_ih = 0;
 	// Recovered, dead (not applicable), tested, tested positive, tested false negative
-    std::vector<int> state_changes(5,0);
+    StateChanges state_changes = {};
 
 	// To initialize Flu agents
 	testing.check_switch_time(0);
@@ -497,7 +497,7 @@ bool check_fractions(int num1, int num2, double fr_expected, std::string msg)
 /// Tests for exposed agent that is undergoing testing or gets the results
 bool check_testing_transitions(const Agent& agent, const std::vector<Household>& households,
 				const std::vector<School>& schools, const std::vector<Hospital>& hospitals,
-				std::vector<int>& state_changes, int& n_tested_exposed, int& n_tested_sy, int& n_waiting_for_res, 
+				const StateChanges& state_changes, int& n_tested_exposed, int& n_tested_sy, int& n_waiting_for_res, 
 				int& n_positive, int& n_false_neg, int& n_hsp, int& n_hsp_icu, int& n_ih, double time, double dt)
 {
 	// Testing flags
@@ -527,7 +527,7 @@ bool check_testing_transitions(const Agent& agent, const std::vector<Household>&
 			}
 		}
 		// Just tested
-		if (state_changes.at(2)){
+		if (state_changes.tested){
 			if (agent.exposed()){
 				++n_tested_exposed;
 			} else {
@@ -569,7 +569,7 @@ bool check_testing_transitions(const Agent& agent, const std::vector<Household>&
 	}
 	// Just got results 
 	// Confirmed positive
-	if (state_changes.at(3)){
+	if (state_changes.tested_positive){
 		++n_positive;
 		if (agent.exposed()){
 			// Should still be home isolated 
@@ -600,7 +600,7 @@ bool check_testing_transitions(const Agent& agent, const std::vector<Household>&
 	}
 	// Symptomatic cannot be false negative right now, and the flag may be set before 
 	// transitioning to symptomatic - i.e. at the same step
-	if (state_changes.at(4) && agent.exposed()){
+	if (state_changes.tested_false_negative && agent.exposed()){
 		++n_false_neg;
 		// Should still be home isolated 
 		if (agent.home_isolated()){
@@ -742,10 +742,10 @@ bool check_hospitalized_isolation(const Agent& agent, const std::vector<Househol
 /// Test for properties related to removal of a symptomatic agent
 bool check_symptomatic_agent_removal(const Agent& agent, const std::vector<Household>& households,
 				const std::vector<School>& schools, const std::vector<Hospital>& hospitals,
-				std::vector<int>& state_changes, int& n_rh, int& n_rd, double time, double dt)
+				const StateChanges& state_changes, int& n_rh, int& n_rd, double time, double dt)
 {
 	const int aID = agent.get_ID();
-	if (state_changes.at(1)){
+	if (state_changes.dead_tested || state_changes.dead_not_tested){
 		++n_rd;
 		// If the agent died - removed from all places
 		if (agent.retirement_home_resident()){
@@ -768,11 +768,11 @@ bool check_symptomatic_agent_removal(const Agent& agent, const std::vector<House
 			return false;
 		}
 		// Not tested/not treated/false negative
-		if (!agent.tested_covid_positive() && state_changes.at(1) != 2){
+		if (!agent.tested_covid_positive() && state_changes.dead_not_tested != 1){
 			std::cerr << "Wrong flag for an untreated agent that died." << std::endl;
 			return false;
 		}
-	} else if (state_changes.at(0)){
+	} else if (state_changes.recovered){
 		++n_rh;
 		// If recovering
 		// Checked if no home isolation
@@ -17,4 +17,7 @@ subprocess.call(['python3.6 compilation.py'], shell=True)
 ut.msg('HspEmployeeTransitions class tests', CYAN)
 subprocess.call(['./hsp_em_tr_test'], shell=True)
 
+ut.msg('Same tests with event times stored as time steps', CYAN)
+subprocess.call(['./hsp_em_tr_steps_test'], shell=True)
+
 
@@ -24,7 +24,7 @@ bool check_fractions(int, int, double, std::string);
 bool check_testing_transitions(const Agent& agent, const std::vector<Household>& households, 
 				const std::vector<School>& schools, const std::vector<Hospital>& hospitals,
 				const std::vector<RetirementHome>& retirement_homes, const std::vector<Workplace>& workplaces, 
-				std::vector<int>& state_changes, int& n_tested_exposed, int& n_tested_sy, int& n_waiting_for_res, 
+				const StateChanges& state_changes, int& n_tested_exposed, int& n_tested_sy, int& n_waiting_for_res, 
 				int& n_positive, int& n_false_neg, int& n_hsp, int& n_hsp_icu, int& n_ih, double time, double dt);
 bool check_treatment_setup(const Agent& agent, const std::vector<Household> households,
 				const std::vector<School>& schools, const std::vector<Hospital> hospitals,
@@ -36,7 +36,7 @@ bool check_hospitalized_isolation(const Agent& agent, const std::vector<Househol
 bool check_symptomatic_agent_removal(const Agent& agent, const std::vector<Household>& households,
 				const std::vector<School>& schools, const std::vector<Hospital>& hospitals,
 				const std::vector<RetirementHome>& retirement_homes, const std::vector<Workplace>& workplaces, 
-				std::vector<int>& state_changes, int& n_rh, int& n_rd, double time, double dt);
+				const StateChanges& state_changes, int& n_rh, int& n_rd, double time, double dt);
 
 int main()
 {
@@ -237,7 +237,7 @@ bool test_exposed_transitions()
 	int n_sy_recovering = 0, n_sy_dying = 0;
 	int n_tr_hsp = 0, n_hsp_icu = 0, n_ih = 0;
 	// Recovered, dead (not applicable), tested, tested positive, tested false negative
-    std::vector<int> state_changes(5,0);
+    StateChanges state_changes = {};
 
 	// To initialize Flu agents
 	testing.check_switch_time(0);
@@ -303,7 +303,7 @@ bool test_exposed_transitions()
 					}
 				} else if (agent.removed()){
 					// Correct flags
-					if (state_changes.at(0) != 1){
+					if (state_changes.recovered != 1){
 						std::cerr << "Wrong return value/flag for recovery" << std::endl;
 					}
 					// Recovery time
@@ -389,7 +389,7 @@ bool test_symptomatic_transitions()
 	int n_sy_recovering = 0, n_sy_dying = 0;
 	int n_tr_hsp = 0, n_hsp_icu = 0, n_ih = 0;
 	// Recovered, dead (not applicable), tested, tested positive, tested false negative
-    std::vector<int> state_changes(5,0);
+    StateChanges state_changes = {};
 
 	// To initialize Flu agents
 	testing.check_switch_time(0);
@@ -552,7 +552,7 @@ bool check_fractions(int num1, int num2, double fr_expected, std::string msg)
 bool check_testing_transitions(const Agent& agent, const std::vector<Household>& households,
 				const std::vector<School>& schools, const std::vector<Hospital>& hospitals,
 				const std::vector<RetirementHome>& retirement_homes, const std::vector<Workplace>& workplaces, 
-				std::vector<int>& state_changes, int& n_tested_exposed, int& n_tested_sy, int& n_waiting_for_res, 
+				const StateChanges& state_changes, int& n_tested_exposed, int& n_tested_sy, int& n_waiting_for_res, 
 				int& n_positive, int& n_false_neg, int& n_hsp, int& n_hsp_icu, int& n_ih, double time, double dt)
 {
 	// Testing flags
@@ -567,7 +567,7 @@ bool check_testing_transitions(const Agent& agent, const std::vector<Household>&
 			return false;
 		}
 		// Just tested
-		if (state_changes.at(2)){
+		if (state_changes.tested){
 			if (agent.exposed()){
 				++n_tested_exposed;
 			} else {
@@ -598,7 +598,7 @@ bool check_testing_transitions(const Agent& agent, const std::vector<Household>&
 	}
 	// Just got results 
 	// Confirmed positive
-	if (state_changes.at(3)){
+	if (state_changes.tested_positive){
 		++n_positive;
 		if (agent.exposed()){
 			// Should still be home isolated 
@@ -632,7 +632,7 @@ bool check_testing_transitions(const Agent& agent, const std::vector<Household>&
 	}
 	// Symptomatic cannot be false negative right now, and the flag may be set before 
 	// transitioning to symptomatic - i.e. at the same step
-	if (state_changes.at(4) && agent.exposed()){
+	if (state_changes.tested_false_negative && agent.exposed()){
 		++n_false_neg;
 		// Should still be home isolated 
 		if (agent.home_isolated()){
@@ -777,10 +777,10 @@ bool check_hospitalized_isolation(const Agent& agent, const std::vector<Househol
 bool check_symptomatic_agent_removal(const Agent& agent, const std::vector<Household>& households,
 				const std::vector<School>& schools, const std::vector<Hospital>& hospitals,
 				const std::vector<RetirementHome>& retirement_homes, const std::vector<Workplace>& workplaces, 
-				std::vector<int>& state_changes, int& n_rh, int& n_rd, double time, double dt)
+				const StateChanges& state_changes, int& n_rh, int& n_rd, double time, double dt)
 {
 	const int aID = agent.get_ID();
-	if (state_changes.at(1)){
+	if (state_changes.dead_tested || state_changes.dead_not_tested){
 		++n_rd;
 		// If the agent died - removed from all places
 		if (agent.retirement_home_resident()){
@@ -811,11 +811,11 @@ bool check_symptomatic_agent_removal(const Agent& agent, const std::vector<House
 			return false;
 		}
 		// Not tested/not treated/false negative
-		if (!agent.tested_covid_positive() && state_changes.at(1) != 2){
+		if (!agent.tested_covid_positive() && state_changes.dead_not_tested != 1){
 			std::cerr << "Wrong flag for an untreated agent that died." << std::endl;
 			return false;
 		}
-	} else if (state_changes.at(0)){
+	} else if (state_changes.recovered){
 		++n_rh;
 		// If recovering
 		// Checked if no home isolation